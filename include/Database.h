@@ -5,17 +5,16 @@
  * @brief Inverted index wrapper
  */
 
+#include "index/IDatabase.h"
+#include "index/BloomFilter.h"
+
 #include <lmdb.h>
+#include <functional>
+#include <shared_mutex>
 #include <string>
 #include <vector>
 
-// Struct to store in LMDB
-struct Data {
-    int priority;         // Priority value (used for ranking)
-    int docId;            // docId for specific document
-};
-
-class Database {
+class Database : public IDatabase {
 public:
     /**
      * @brief Constructor with database path
@@ -27,7 +26,7 @@ public:
     /**
      * @brief Destructor to clean up LMDB resources
      */
-    ~Database();
+    ~Database() override;
 
     /**
      * @brief Add data to database
@@ -35,14 +34,14 @@ public:
      * @param key Index to add data to.
      * @param data Data to be added.
      */
-    void add(const std::string& key, const Data& data);
+    void add(const std::string& key, const Data& data) override;
 
     /**
      * @brief Remove all data for a specific key
      * 
      * @param key Index to remove data from.
      */
-    void remove(const std::string& key);
+    void remove(const std::string& key) override;
 
     /**
      * @brief Retrieve the first value for a given key
@@ -50,7 +49,7 @@ public:
      * @param key Index to retrieve from.
      * @return First entry at provided key.
      */
-    std::vector<Data> get(const std::string& key);
+    std::vector<Data> get(const std::string& key) override;
 
     /**
      * @brief Retrieve the first 'n' values for a given key
@@ -59,7 +58,38 @@ public:
      * @param n Maximum number of values returned
      * @return At most the first 'n' entries at provided key
      */
-    std::vector<Data> get(const std::string& key, size_t n);
+    std::vector<Data> get(const std::string& key, size_t n) override;
+
+    /**
+     * @brief Retrieve the first 'n' values for a given key without throwing on a miss
+     *
+     * Keys that were never added are rejected by an in-memory filter
+     * without opening a transaction.
+     *
+     * @param key Index to retrieve from.
+     * @param n Maximum number of values returned
+     * @return At most the first 'n' entries, or nullopt if the key has none
+     */
+    std::optional<std::vector<Data>> find(const std::string& key, size_t n) override;
+
+    /**
+     * @brief find() for many keys under one read transaction and cursor
+     *
+     * @param keys Indexes to retrieve from.
+     * @param n Maximum number of values returned per key
+     * @return One result per key, in the order of @a keys
+     */
+    std::vector<std::optional<std::vector<Data>>> getMany(const std::vector<std::string>& keys, size_t n) override;
+
+    /**
+     * @brief getMany() decoding straight into caller-provided storage
+     *
+     * @param keys Indexes to retrieve from.
+     * @param n Maximum number of values returned per key
+     * @param out Receives one list per key, allocated from its resource
+     */
+    void getManyInto(const std::pmr::vector<std::pmr::string>& keys, size_t n,
+                     std::pmr::vector<std::pmr::vector<Data>>& out) override;
 
     /**
      * @brief Retrieve the number of documents containing a given term
@@ -67,7 +97,21 @@ public:
      * @param key Index to retrieve from.
      * @return Number of documents associated with that term
      */
-    unsigned int termDocCount(const std::string& key);
+    unsigned int termDocCount(const std::string& key) override;
+
+    /**
+     * @brief Visit every key in key order under one read transaction
+     *
+     * @param fn Called as fn(key, number of values, highest priority).
+     */
+    void forEachKey(const std::function<void(const std::string&, unsigned int, int)>& fn);
+
+    /**
+     * @brief Write a compacted copy of the database to another directory
+     *
+     * @param dest_path Existing, empty directory to copy into.
+     */
+    void compactTo(const std::string& dest_path) const;
 
 private:
     MDB_env* env = nullptr;
@@ -75,6 +119,23 @@ private:
     MDB_txn* write_txn = nullptr;
     MDB_txn* read_txn = nullptr;
 
+    // Filter over every key in the database (removed keys stay set until the
+    // next rebuild). Lookups hold the mutex shared, updates exclusively.
+    std::shared_mutex key_filter_mutex;
+    BloomFilter key_filter;
+    size_t key_count = 0;
+    size_t removed_keys = 0;
+
+    // Look up every key under one read transaction and cursor, calling
+    // emit(key index, value) for at most n values per key. Scratch space
+    // comes from 'scratch'.
+    template <typename Keys, typename Emit>
+    void read_postings(const Keys& keys, size_t n, std::pmr::memory_resource* scratch, Emit&& emit);
+
+    // Refill key_filter from the keys visible to write_txn. Caller holds
+    // key_filter_mutex exclusively.
+    void rebuild_key_filter();
+
     // Serialize the Data struct
     void serialize_data(const Data& data, MDB_val& value);
 
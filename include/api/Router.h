@@ -1,10 +1,18 @@
 #pragma once
 
 #include "external/crow_all.h"
+#include "query-processing/completionTrie.h"
+
+#include <memory>
 
 namespace SearchRPI {
 class Router {
 public:
-    static void setupRoutes(crow::SimpleApp& app);
+    /**
+     * @param app The application to add the routes to.
+     * @param completions Completion trie for /suggest; without one, /suggest answers 503.
+     */
+    static void setupRoutes(crow::SimpleApp& app,
+                            std::shared_ptr<const completion::CompletionTrie> completions = nullptr);
 };
 }
\ No newline at end of file
@@ -2,9 +2,24 @@
 
 #include "Router.h"
 
+#include <string>
+
 namespace SearchRPI{
 class Server {
 public:
+    /**
+     * @param completionsPath Completion trie image written by tools/build_completions;
+     *                        empty to run without one (/suggest then answers 503).
+     */
+    explicit Server(std::string completionsPath = "");
+
+    /**
+     * @brief Maps the completion trie, if any, and serves requests on port 8080.
+     * @throws std::runtime_error if the completion trie image cannot be opened.
+     */
     void start();
+
+private:
+    std::string completionsPath_;
 };
 }
@@ -0,0 +1,55 @@
+#pragma once
+
+/**
+ * @file  BlockCache.h
+ * @brief LRU cache of decompressed document store blocks
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+/** Default capacity of a BlockCache in bytes of decompressed data. */
+constexpr size_t kDefaultBlockCacheBytes = 8 * 1024 * 1024;
+
+/**
+ * @brief Thread-safe LRU cache of immutable blocks keyed by block id
+ *
+ * Blocks are handed out as shared pointers, so a block evicted while a
+ * reader still holds it stays valid for that reader.
+ */
+class BlockCache {
+public:
+    /**
+     * @param capacityBytes Total decompressed bytes kept before evicting
+     */
+    explicit BlockCache(size_t capacityBytes = kDefaultBlockCacheBytes) : capacity_(capacityBytes) {}
+
+    /**
+     * @param id Block id
+     * @returns The cached block, or nullptr on a miss
+     */
+    std::shared_ptr<const std::string> get(uint32_t id);
+
+    /**
+     * @brief Insert a block, evicting least recently used blocks to make room
+     */
+    void put(uint32_t id, std::shared_ptr<const std::string> block);
+
+    // Decompressed bytes currently cached.
+    size_t bytes() const;
+
+private:
+    using Entry = std::pair<uint32_t, std::shared_ptr<const std::string>>;
+
+    mutable std::mutex mutex_;
+    size_t capacity_;
+    size_t bytes_ = 0;
+    std::list<Entry> lru_; // most recently used first
+    std::unordered_map<uint32_t, std::list<Entry>::iterator> index_;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+/**
+ * @file  BloomFilter.h
+ * @brief Cache-blocked Bloom filter for fast negative lookups
+ *
+ * Every key maps to a single 64-byte block and sets kProbes bits inside it,
+ * so a lookup touches one cache line. With 10 bits per key the false
+ * positive rate is about 1%. Keys cannot be removed; owners rebuild the
+ * filter when too many of its keys are stale.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * @returns 64-bit hash of @a key, stable across runs and platforms
+ */
+uint64_t bloomHash(std::string_view key);
+
+class BloomFilter {
+public:
+    /**
+     * @param expectedKeys Number of keys the filter is sized for
+     * @param bitsPerKey Filter bits per expected key
+     */
+    explicit BloomFilter(size_t expectedKeys = 0, size_t bitsPerKey = 10);
+
+    void add(std::string_view key) { addHash(bloomHash(key)); }
+
+    /**
+     * @returns False if @a key was definitely never added
+     */
+    bool mayContain(std::string_view key) const { return mayContainHash(bloomHash(key)); }
+
+    void addHash(uint64_t hash);
+    bool mayContainHash(uint64_t hash) const;
+
+    // Number of keys the filter was sized for.
+    size_t capacity() const { return capacity_; }
+
+private:
+    static constexpr int kProbes = 6;
+    static constexpr size_t kWordsPerBlock = 8; // 512 bits, one cache line
+
+    size_t capacity_;
+    size_t numBlocks_;
+    std::vector<uint64_t> words_;
+
+    size_t blockOf(uint64_t hash) const;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+/**
+ * @file  Coding.h
+ * @brief Varint and length-prefixed encoding helpers for on-disk records
+ */
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace coding {
+
+/**
+ * @brief Append @a value as a little-endian base-128 varint.
+ */
+inline void putVarint32(std::string& dst, uint32_t value) {
+    while (value >= 0x80) {
+        dst.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    dst.push_back(static_cast<char>(value));
+}
+
+/**
+ * @brief Decode a varint written by putVarint32().
+ *
+ * @param p Read position, advanced past the varint on success.
+ * @param limit End of the readable buffer.
+ * @param value Decoded value.
+ * @return False if the buffer ends mid-varint or the value overflows.
+ */
+inline bool getVarint32(const char*& p, const char* limit, uint32_t& value) {
+    uint32_t result = 0;
+    for (int shift = 0; shift <= 28 && p < limit; shift += 7) {
+        uint32_t byte = static_cast<unsigned char>(*p++);
+        result |= (byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Append a varint length followed by the bytes of @a value.
+ */
+inline void putLengthPrefixed(std::string& dst, std::string_view value) {
+    putVarint32(dst, static_cast<uint32_t>(value.size()));
+    dst.append(value.data(), value.size());
+}
+
+/**
+ * @brief Decode a field written by putLengthPrefixed() without copying it.
+ *
+ * @param p Read position, advanced past the field on success.
+ * @param limit End of the readable buffer.
+ * @param value View into the buffer.
+ * @return False if the buffer is truncated.
+ */
+inline bool getLengthPrefixed(const char*& p, const char* limit, std::string_view& value) {
+    uint32_t len;
+    if (!getVarint32(p, limit, len) || static_cast<size_t>(limit - p) < len)
+        return false;
+    value = std::string_view(p, len);
+    p += len;
+    return true;
+}
+
+} // namespace coding
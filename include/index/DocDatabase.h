@@ -6,20 +6,34 @@
  */
 
 #include "index/IDocDatabase.h"
+#include "index/BlockCache.h"
+#include "index/BloomFilter.h"
+#include "index/DocRecord.h"
+#include "index/ForwardIndex.h"
+#include "index/LruCache.h"
 #include "types.h"
 
 #include <lmdb.h>
 
+#include <cstdint>
+#include <initializer_list>
 #include <memory>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
 #include <set>
-#include <sstream>
+#include <vector>
 #include <cstring>
 
 class DocDatabase : public IDocDatabase {
 public:
-    DocDatabase() { DocDatabase("../docdb"); }
-    explicit DocDatabase(const std::string& dbPath);
+    DocDatabase() : DocDatabase("../docdb") {}
+    /**
+     * @param dbPath Directory of the LMDB environment
+     * @param storePositions Whether added documents record term positions in
+     *                       the forward index (needed for snippets/phrases)
+     */
+    explicit DocDatabase(const std::string& dbPath, bool storePositions = false);
     ~DocDatabase();
 
     /**
@@ -37,11 +51,27 @@ public:
     /**
      * @param url Page URL
      * @param title Page Title (Shown in search results)
-     * @param words Text of the page // TODO: Update format to include punctuation & support field weighting
+     * @param text Page text, stored compressed for snippets; its words are
+     *             indexed as analyzer::DocumentAnalyzer yields them (stop
+     *             words dropped, stemmed), the same chain queries go through
+     * @returns ID Generated for Added Document
+     */
+    SearchRPI::docid addDoc(const std::string& url, const std::string& title, std::string_view text);
+
+    /**
+     * @param url Page URL
+     * @param title Page Title (Shown in search results)
+     * @param words Words of the page, added as the text "word word ..."
      * @returns ID Generated for Added Document
      */
     SearchRPI::docid addDoc(const std::string& url, const std::string& title, std::vector<std::string> words);
 
+    // Lets a braced word list such as {"a", "b"} pick the overload above over the text one.
+    SearchRPI::docid addDoc(const std::string& url, const std::string& title,
+                            std::initializer_list<std::string> words) {
+        return addDoc(url, title, std::vector<std::string>(words));
+    }
+
     /**
      * @param url Page URL
      * @returns ID associated with URL
@@ -54,27 +84,118 @@ public:
      */
     std::set<std::string> getWords(SearchRPI::docid id) const;
 
+    /**
+     * @param id Document ID
+     * @returns The document's term ids with frequencies (and positions if stored)
+     */
+    TermVector getTermVector(SearchRPI::docid id) const;
+
+    /**
+     * @brief Fetch the stored fields of many documents under one read snapshot
+     *
+     * @param ids Document IDs, in the order results should be returned
+     * @param arena Memory for the returned vector and field bytes; results
+     *              stay valid as long as the arena does
+     * @param withText Also return the stored page text, decoded from the same block read
+     * @returns One summary per requested id, in request order (id 0 if missing)
+     */
+    std::pmr::vector<DocSummary> getDocs(const std::vector<SearchRPI::docid>& ids,
+                                         std::pmr::memory_resource& arena, bool withText = false) const;
+
+    /**
+     * @param id Document ID
+     * @returns The stored page text (empty if none was stored)
+     */
+    std::string getText(SearchRPI::docid id) const;
+
+    /**
+     * @param termId Term id from a term vector
+     * @returns The term's text
+     */
+    std::string getTerm(uint32_t termId) const;
+
     /**
      * @param id Document ID
      * @returns Whether document existed and was removed (false if doc didn't exist)
      */
     bool remove(SearchRPI::docid id);
 
+    /**
+     * @param destPath Existing, empty directory to write a compacted copy into
+     */
+    void compactTo(const std::string& destPath) const;
+
+    /**
+     * @brief Convert a database written in the legacy text format
+     *
+     * Legacy databases keyed records by decimal strings and stored them as
+     * "url\ntitle\nword,word,...". Document ids are preserved.
+     *
+     * @param legacyPath Directory of the legacy database (opened read-only)
+     * @param destPath Existing, empty directory for the converted database
+     * @returns Number of documents migrated
+     */
+    static size_t migrateLegacy(const std::string& legacyPath, const std::string& destPath);
+
 private:
     // LMDB environment and database handles.
     MDB_env* env_;
     MDB_dbi dbi_meta_;
-    MDB_dbi dbi_docs_;
-    MDB_dbi dbi_urls_;
-    
-    // Helper: simple serialization of a document record.
-    // Format: <url>\n<title>\n<word1,word2,...>
-    std::string serializeDoc(const std::string& url, const std::string& title, const std::vector<std::string>& words);
-    
-    // Helper: deserialize a document record into its parts.
-    void deserializeDoc(const std::string& data, std::string& url, std::string& title, std::vector<std::string>& words) const;
-    
-    // Helper: convert a document ID to a string.
-    std::string docidToStr(SearchRPI::docid id) const { return std::to_string(id); }
+    MDB_dbi dbi_docs_;      // docid (MDB_INTEGERKEY) -> record location, see DocRecord.h
+    MDB_dbi dbi_blocks_;    // block id (MDB_INTEGERKEY) -> block of records
+    MDB_dbi dbi_tail_;      // docid (MDB_INTEGERKEY) -> record not yet sealed into a block
+    MDB_dbi dbi_urls_;      // url -> docid (native unsigned int)
+    MDB_dbi dbi_terms_;     // term -> term id (native uint32_t)
+    MDB_dbi dbi_termstr_;   // term id (MDB_INTEGERKEY) -> term
+    MDB_dbi dbi_fwd_;       // docid (MDB_INTEGERKEY) -> term vector, see ForwardIndex.h
+    bool storePositions_;
+
+    // Decompressed sealed blocks; tail records are read straight from LMDB.
+    mutable BlockCache blockCache_;
+
+    // Every stored URL is in the filter, so lookups of new URLs never open a
+    // transaction; recent hits are cached. Lookups hold the mutex shared,
+    // filter updates and rebuilds hold it exclusively.
+    mutable std::shared_mutex urlMutex_;
+    BloomFilter urlFilter_;
+    size_t urlCount_ = 0;       // URLs in the urls database at the last update
+    size_t removedUrls_ = 0;    // URLs removed since the last rebuild (still set in the filter)
+    mutable LruCache<std::string, SearchRPI::docid> urlCache_;
+
+    // Helper: refill the URL filter from the urls database. Caller holds urlMutex_ exclusively.
+    void rebuildUrlFilter();
+
+    // Helpers: keep the URL filter and cache in step with committed changes.
+    void noteUrlAdded(const std::string& url, SearchRPI::docid id);
+    void noteUrlRemoved(const std::string& url);
+
+    // Helper: write a document record, term vector and URL mapping under a given id.
+    void putDoc(MDB_txn* txn, SearchRPI::docid id, const std::string& url, const std::string& title,
+                std::string_view text, const std::vector<std::string>& words);
+
+    // A decompressed sealed block held by a reader, and its block id (0 if none).
+    struct BlockPin {
+        uint32_t block = 0;
+        std::shared_ptr<const std::string> data;
+    };
+
+    // Helper: append a record to the tail, sealing the tail first if it is full.
+    DocLocation appendRecord(MDB_txn* txn, SearchRPI::docid id, const std::string& record);
+
+    // Helper: pack the tail records into a compressed block and update their locations.
+    void sealTail(MDB_txn* txn, uint32_t tail);
+
+    // Helper: find and parse a document's record. 'pin' keeps a decompressed
+    // block alive for as long as the view is used and is reused while
+    // records come from the same block; views into tail records are only
+    // valid until the transaction ends.
+    bool readRecord(MDB_txn* txn, SearchRPI::docid id, DocRecordView& record, BlockPin& pin) const;
+
+    // Helper: look up a term's id, assigning the next free one if it is new.
+    uint32_t internTerm(MDB_txn* txn, const std::string& term);
+
+    // Helper: read a native integer stored in the meta DB (0 if missing).
+    uint64_t getMeta(MDB_txn* txn, const char* name) const;
+    void putMeta(MDB_txn* txn, const char* name, uint64_t value);
 
 };
\ No newline at end of file
@@ -0,0 +1,114 @@
+#pragma once
+
+/**
+ * @file  DocRecord.h
+ * @brief Binary layout of records in the document database
+ *
+ * Format version 3. Records are packed back to back into blocks of about
+ * kDocBlockSize bytes. Records of the last (tail) block are kept one per
+ * key in the tail database, keyed by docid, so an append writes only its
+ * own record; once the tail is full its records are packed in docid order,
+ * compressed into a block and their locations rewritten. Until then a
+ * location's offset is provisional.
+ *
+ * Record:
+ *
+ *     u8      format version
+ *     varint  url length,   url bytes
+ *     varint  title length, title bytes
+ *     varint  text length,  text bytes (stored page text, may be empty)
+ *
+ * Location (value of the docs database, keyed by docid):
+ *
+ *     varint  block id
+ *     varint  offset of the record in the uncompressed block
+ *     varint  record length
+ *
+ * Block (value of the blocks database, keyed by block id):
+ *
+ *     u8      codec (BlockCodec)
+ *     varint  uncompressed size
+ *     payload
+ *
+ * The document's terms live in the forward index (see ForwardIndex.h).
+ */
+
+#include "index/Coding.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/** Current version byte written at the start of every record. */
+constexpr uint8_t kDocRecordVersion = 3;
+
+/** Uncompressed size at which the tail is sealed into a block. */
+constexpr size_t kDocBlockSize = 32 * 1024;
+
+enum class BlockCodec : uint8_t {
+    None = 0,
+    Lz4 = 1,
+};
+
+/**
+ * @param url Page URL
+ * @param title Page title
+ * @param text Stored page text
+ * @returns Encoded record
+ */
+std::string encodeDocRecord(std::string_view url, std::string_view title, std::string_view text = {});
+
+/**
+ * @brief Zero-copy view over an encoded record.
+ *
+ * Views point into the buffer passed to parse(), which must outlive them
+ * (for LMDB values: until the read transaction ends).
+ */
+class DocRecordView {
+public:
+    /**
+     * @param data Encoded record
+     * @returns False if the record is truncated or has an unknown version
+     */
+    bool parse(std::string_view data);
+
+    std::string_view url() const { return url_; }
+    std::string_view title() const { return title_; }
+    std::string_view text() const { return text_; }
+
+private:
+    std::string_view url_;
+    std::string_view title_;
+    std::string_view text_;
+};
+
+/**
+ * @brief Where a record lives in the block store
+ */
+struct DocLocation {
+    uint32_t block;
+    uint32_t offset;
+    uint32_t size;
+};
+
+std::string encodeDocLocation(const DocLocation& location);
+
+/**
+ * @returns False if the location is truncated
+ */
+bool decodeDocLocation(std::string_view data, DocLocation& location);
+
+/**
+ * @param payload Concatenated records
+ * @param compress Whether to try compressing the payload (sealed blocks);
+ *                 it is stored as is if compression does not shrink it
+ * @returns Encoded block
+ */
+std::string encodeBlock(std::string_view payload, bool compress);
+
+/**
+ * @brief Split an encoded block into its header fields and payload
+ * @returns False if the header is truncated or the codec is unknown
+ */
+bool decodeBlockHeader(std::string_view data, BlockCodec& codec, uint32_t& size, std::string_view& payload);
@@ -0,0 +1,182 @@
+#pragma once
+
+/**
+ * @file  ForwardIndex.h
+ * @brief Compressed per-document term vectors
+ *
+ * Encoded term vector:
+ *
+ *     u8      flags (bit 0: positions stored)
+ *     varint  number of distinct terms
+ *     varint  document length (number of term occurrences)
+ *     blocks of up to kTermVectorBlockSize terms, ascending by term id:
+ *         varint  terms in block
+ *         varint  last term id in block (lets lookups skip whole blocks)
+ *         varint  payload length in bytes
+ *         payload:
+ *             varint term id gaps (from the previous term, across blocks)
+ *             varint frequencies
+ *             if positions: per term, 'frequency' varint position gaps
+ */
+
+#include "index/Coding.h"
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/** Maximum number of terms per block of a term vector. */
+constexpr uint32_t kTermVectorBlockSize = 128;
+
+/**
+ * @brief Builds the encoded term vector of one document.
+ */
+class TermVectorBuilder {
+public:
+    /**
+     * @param storePositions Whether to record where each term occurs
+     */
+    explicit TermVectorBuilder(bool storePositions = false) : storePositions_(storePositions) {}
+
+    /**
+     * @brief Record one occurrence of a term.
+     * @param termId Term id
+     * @param position Token offset of the occurrence in the document
+     */
+    void add(uint32_t termId, uint32_t position) { occurrences_.emplace_back(termId, position); }
+
+    /**
+     * @returns The encoded term vector
+     */
+    std::string finish();
+
+private:
+    bool storePositions_;
+    std::vector<std::pair<uint32_t, uint32_t>> occurrences_; // (term id, position)
+};
+
+/**
+ * @brief Zero-copy view over an encoded term vector.
+ *
+ * The buffer passed to parse() must outlive the view.
+ */
+class TermVectorView {
+public:
+    /**
+     * @param data Encoded term vector
+     * @returns False if the header is truncated
+     */
+    bool parse(std::string_view data);
+
+    // Number of distinct terms.
+    uint32_t termCount() const { return termCount_; }
+
+    // Number of term occurrences in the document.
+    uint32_t length() const { return length_; }
+
+    // Whether positions were stored.
+    bool hasPositions() const { return flags_ & kPositionsFlag; }
+
+    /**
+     * @brief Decode every term in ascending id order.
+     * @param fn Called as fn(termId, frequency).
+     * @returns False if the vector is corrupt.
+     */
+    template <typename Fn>
+    bool forEach(Fn&& fn) const;
+
+    /**
+     * @param termId Term id
+     * @returns Occurrences of the term in the document (0 if absent)
+     */
+    uint32_t freq(uint32_t termId) const;
+
+    /**
+     * @param termId Term id
+     * @returns Positions of the term, ascending (empty if absent or not stored)
+     */
+    std::vector<uint32_t> positions(uint32_t termId) const;
+
+private:
+    static constexpr uint8_t kPositionsFlag = 1;
+
+    struct Block {
+        uint32_t count;
+        uint32_t lastId;
+        const char* payload;
+        const char* end;
+    };
+
+    // Read the block header at p; advances p past the payload.
+    bool nextBlock(const char*& p, Block& block) const;
+
+    // Locate termId in the block holding it; on success, 'index' is its slot
+    // within the block and 'freqs' points at the block's frequency list.
+    bool find(uint32_t termId, Block& block, uint32_t& index, const char*& freqs) const;
+
+    uint8_t flags_ = 0;
+    uint32_t termCount_ = 0;
+    uint32_t length_ = 0;
+    const char* blocks_ = nullptr;
+    const char* end_ = nullptr;
+};
+
+/**
+ * @brief An owned term vector, as returned by DocDatabase::getTermVector().
+ */
+class TermVector {
+public:
+    TermVector() = default;
+    explicit TermVector(std::string encoded) : data_(std::move(encoded)) {}
+
+    /**
+     * @returns View over the owned buffer (valid while this object is unchanged)
+     * @throws std::runtime_error if the header of the encoded vector is corrupt
+     */
+    TermVectorView view() const {
+        TermVectorView v;
+        if (!v.parse(data_))
+            throw std::runtime_error("Corrupt term vector");
+        return v;
+    }
+
+    // Size of the encoded vector in bytes.
+    size_t byteSize() const { return data_.size(); }
+
+private:
+    std::string data_;
+};
+
+template <typename Fn>
+bool TermVectorView::forEach(Fn&& fn) const {
+    const char* p = blocks_;
+    uint32_t id = 0;
+    uint32_t remaining = termCount_;
+    while (remaining > 0) {
+        Block block;
+        if (!nextBlock(p, block) || block.count > remaining)
+            return false;
+
+        const char* ids = block.payload;
+        const char* freqs = ids;
+        // Skip past the id gaps to reach the frequencies.
+        for (uint32_t i = 0; i < block.count; i++) {
+            uint32_t gap;
+            if (!coding::getVarint32(freqs, block.end, gap))
+                return false;
+        }
+        for (uint32_t i = 0; i < block.count; i++) {
+            uint32_t gap, freq;
+            if (!coding::getVarint32(ids, block.end, gap) ||
+                !coding::getVarint32(freqs, block.end, freq))
+                return false;
+            id += gap;
+            fn(id, freq);
+        }
+        remaining -= block.count;
+    }
+    return true;
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <memory_resource>
+#include <optional>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -53,6 +56,74 @@ public:
      */
     virtual std::vector<Data> get(const std::string& key, size_t n) = 0;
 
+    /**
+     * @brief Retrieve the first 'n' values for a given key without throwing on a miss
+     *
+     * Terms missing from the index are an ordinary outcome of a query, so they
+     * are reported through the return value; exceptions are left for real
+     * failures. The default implementation adapts get().
+     *
+     * @param key Index to retrieve from.
+     * @param n Max number of values returned
+     * @return At most the first 'n' entries, or nullopt if the key has none
+     */
+    virtual std::optional<std::vector<Data>> find(const std::string& key, size_t n) {
+        try {
+            std::vector<Data> results = get(key, n);
+            if (results.empty())
+                return std::nullopt;
+            return results;
+        } catch (const std::runtime_error&) {
+            return std::nullopt;
+        }
+    }
+
+    /**
+     * @brief find() for many keys at once
+     *
+     * Implementations should serve the whole batch from one transaction.
+     * The default implementation calls find() for each key.
+     *
+     * @param keys Indexes to retrieve from.
+     * @param n Max number of values returned per key
+     * @return One result per key, in the order of @a keys
+     */
+    virtual std::vector<std::optional<std::vector<Data>>> getMany(const std::vector<std::string>& keys, size_t n) {
+        std::vector<std::optional<std::vector<Data>>> results;
+        results.reserve(keys.size());
+        for (const std::string& key : keys)
+            results.push_back(find(key, n));
+        return results;
+    }
+
+    /**
+     * @brief getMany() into caller-provided storage
+     *
+     * Lets a query keep its posting lists in its own memory, e.g. a
+     * per-request arena: @a out is resized to one list per key and the lists
+     * are allocated from its resource. A key with no values gets an empty list.
+     * The default implementation copies the result of getMany().
+     *
+     * @param keys Indexes to retrieve from.
+     * @param n Max number of values returned per key
+     * @param out Receives one list per key, in the order of @a keys
+     */
+    virtual void getManyInto(const std::pmr::vector<std::pmr::string>& keys, size_t n,
+                             std::pmr::vector<std::pmr::vector<Data>>& out) {
+        std::vector<std::string> copies;
+        copies.reserve(keys.size());
+        for (const std::pmr::string& key : keys)
+            copies.emplace_back(key);
+
+        std::vector<std::optional<std::vector<Data>>> results = getMany(copies, n);
+        out.clear();
+        out.resize(keys.size());
+        for (size_t i = 0; i < results.size(); i++) {
+            if (results[i])
+                out[i].assign(results[i]->begin(), results[i]->end());
+        }
+    }
+
     /**
      * @brief Retrieve the number of documents containing a given term
      *
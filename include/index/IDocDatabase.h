@@ -5,12 +5,27 @@
  * @brief Interface for database containing document information
 */
 
+#include "index/ForwardIndex.h"
 #include "types.h"
 
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <set>
 
+/**
+ * @brief Stored fields of one document, as returned by IDocDatabase::getDocs()
+ *
+ * The views point into the arena passed to getDocs().
+ */
+struct DocSummary {
+    SearchRPI::docid id;    // 0 if the requested document does not exist
+    std::string_view url;
+    std::string_view title;
+    std::string_view text;  // stored page text, empty unless getDocs() was asked for it
+};
+
 /**
  * @brief Interface for Document Databases
  */
@@ -55,6 +70,24 @@ public:
      */
     virtual std::set<std::string> getWords(SearchRPI::docid id) const = 0;
 
+    /**
+     * @param id Document ID
+     * @returns The document's term ids with frequencies (and positions if stored)
+     */
+    virtual TermVector getTermVector(SearchRPI::docid id) const = 0;
+
+    /**
+     * @brief Fetch the stored fields of many documents under one read snapshot
+     *
+     * @param ids Document IDs, in the order results should be returned
+     * @param arena Memory for the returned vector and field bytes; results
+     *              stay valid as long as the arena does
+     * @param withText Also return the stored page text (e.g. for snippets)
+     * @returns One summary per requested id, in request order
+     */
+    virtual std::pmr::vector<DocSummary> getDocs(const std::vector<SearchRPI::docid>& ids,
+                                                 std::pmr::memory_resource& arena, bool withText = false) const = 0;
+
     /**
      * @param id Document ID
      * @returns Whether document existed and was removed (false if doc didn't exist)
@@ -0,0 +1,147 @@
+#pragma once
+
+/**
+ * @file  IndexManager.h
+ * @brief Versioned index generations with atomic hot swapping
+ *
+ * Layout of the index root directory:
+ *
+ *     <root>/CURRENT              name of the published generation
+ *     <root>/gen-000001/index/    inverted index (Database)
+ *     <root>/gen-000001/docdb/    document database (DocDatabase)
+ *     <root>/gen-000001/lexicon   term dictionary (Lexicon, optional)
+ *     <root>/gen-000002/...
+ *
+ * Searchers call acquire() once per query and hold the returned snapshot
+ * until the query is done. Publishing a new generation opens and warms it
+ * off to the side, then swaps the shared pointer; queries already running
+ * keep the old generation alive until they release it.
+ */
+
+#include "Database.h"
+#include "index/DocDatabase.h"
+#include "index/Lexicon.h"
+
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief One opened index generation, as published
+ *
+ * Generations are filled by a builder before publish() and are not written
+ * afterwards; queries and compaction only read them. The handles are not
+ * const because the database read APIs (IDatabase::get and friends) are not
+ * const-qualified, so nothing stops a write through them: do not write to a
+ * snapshot, build a new generation instead.
+ */
+struct IndexSnapshot {
+    uint64_t generation;
+    std::string path;
+    std::shared_ptr<Database> index;
+    std::shared_ptr<DocDatabase> docs;
+    std::shared_ptr<const Lexicon> lexicon; // null if the generation has none
+};
+
+class IndexManager {
+public:
+    /**
+     * @param rootPath Directory holding the index generations (created if missing)
+     *
+     * Opens the generation named in CURRENT, or creates and publishes an
+     * empty first generation if the root has none yet.
+     */
+    explicit IndexManager(const std::string& rootPath);
+    ~IndexManager();
+
+    // Disable Copy Constructor/Assignment Operator
+    IndexManager(const IndexManager&) = delete;
+    IndexManager& operator=(IndexManager const&) = delete;
+
+    /**
+     * @returns The currently published snapshot. Hold it for the lifetime
+     *          of a query; it stays valid even if a new generation is
+     *          published in the meantime.
+     */
+    std::shared_ptr<const IndexSnapshot> acquire() const;
+
+    /**
+     * @brief Allocate a new, empty generation directory for a builder to fill
+     * @returns Number of the new generation
+     */
+    uint64_t createGeneration();
+
+    /**
+     * @param generation Generation number
+     * @returns Directory of that generation
+     */
+    std::string generationPath(uint64_t generation) const;
+
+    /**
+     * @brief Open and warm a generation, then make it the published one
+     *
+     * The previous snapshot is retired: it is closed once the last query
+     * holding it releases it. A generation older than the published one is
+     * never swapped in, so concurrent publishes cannot go back in time.
+     *
+     * @param generation Generation previously returned by createGeneration()
+     */
+    void publish(uint64_t generation);
+
+    /**
+     * @brief Same as publish(), but opening and warming run on a background thread
+     */
+    std::future<void> publishAsync(uint64_t generation);
+
+    /**
+     * @brief Copy the published generation into a compacted new one and publish it
+     * @returns Number of the new generation
+     */
+    uint64_t compact();
+
+    /**
+     * @param terms Terms looked up in a freshly opened generation before it is
+     *              published, so their pages are resident when queries arrive
+     */
+    void setWarmupTerms(std::vector<std::string> terms);
+
+    /**
+     * @brief Delete directories of retired generations no query still holds
+     * @returns Number of generations removed
+     */
+    size_t collectGarbage();
+
+private:
+    std::string root_;
+
+    // Published snapshot, read with std::atomic_load / written with std::atomic_store
+    std::shared_ptr<const IndexSnapshot> current_;
+
+    // Serializes publishers; readers never take it
+    mutable std::mutex publishMutex_;
+    uint64_t nextGeneration_ = 1;
+    std::vector<std::string> warmupTerms_;
+
+    // Snapshots that were replaced but may still be held by queries
+    std::list<std::pair<uint64_t, std::weak_ptr<const IndexSnapshot>>> retired_;
+
+    // Background publishes; finished ones are joined by the next
+    // publishAsync(), the rest in the destructor
+    struct Worker {
+        std::thread thread;
+        std::shared_ptr<std::atomic<bool>> done;
+    };
+    std::list<Worker> workers_;
+
+    std::shared_ptr<const IndexSnapshot> open(uint64_t generation) const;
+    void warm(const IndexSnapshot& snapshot) const;
+    void swap(std::shared_ptr<const IndexSnapshot> next);
+    void writeCurrent(uint64_t generation) const;
+    uint64_t readCurrent() const;
+};
@@ -0,0 +1,192 @@
+#pragma once
+
+/**
+ * @file  Lexicon.h
+ * @brief Immutable, memory-mapped term dictionary
+ *
+ * Terms are sorted and numbered densely in that order, so a term id is the
+ * term's rank and any prefix or range of terms is a contiguous id range.
+ *
+ * File layout (native byte order):
+ *
+ *     header      magic, version, term count, terms per block, section offsets
+ *     stats       per term id: u32 document frequency, f32 max score
+ *     block index per block: u32 offset of the block in the blocks section
+ *     blocks      front-coded runs of kLexiconBlockSize terms:
+ *                     varint length, bytes                   (first term, verbatim)
+ *                     varint shared, varint suffix length, suffix bytes
+ *                                                            (each following term)
+ *
+ * The first term of every block is stored whole, so lookups binary search
+ * the block index without decoding anything and then scan one block.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+class Database;
+
+/** Number of terms per front-coded block. */
+constexpr uint32_t kLexiconBlockSize = 16;
+
+/**
+ * @brief Per-term metadata stored in the lexicon
+ */
+struct TermInfo {
+    uint32_t id;       // dense term id (rank of the term in sorted order)
+    uint32_t df;       // number of documents containing the term
+    float maxScore;    // upper bound on the term's score contribution to any document
+};
+
+class Lexicon {
+public:
+    /**
+     * @brief Map a lexicon file written by LexiconBuilder
+     * @param path Lexicon file
+     */
+    explicit Lexicon(const std::string& path);
+    ~Lexicon();
+
+    // Disable Copy Constructor/Assignment Operator
+    Lexicon(const Lexicon&) = delete;
+    Lexicon& operator=(Lexicon const&) = delete;
+
+    // Number of terms.
+    uint32_t size() const { return termCount_; }
+
+    /**
+     * @param term Term text
+     * @returns The term's metadata, or nullopt if it is not in the lexicon
+     */
+    std::optional<TermInfo> find(std::string_view term) const;
+
+    /**
+     * @param id Term id (< size())
+     * @returns Metadata of that term
+     */
+    TermInfo info(uint32_t id) const;
+
+    /**
+     * @param id Term id (< size())
+     * @returns Text of that term
+     */
+    std::string term(uint32_t id) const;
+
+    /**
+     * @returns Id of the first term not less than @a term (size() if none)
+     */
+    uint32_t lowerBound(std::string_view term) const;
+
+    /**
+     * @returns The half-open id range of all terms starting with @a prefix
+     */
+    std::pair<uint32_t, uint32_t> prefixRange(std::string_view prefix) const;
+
+    /**
+     * @brief Sequential decoder over the terms, starting at any id.
+     *
+     * Decoding consecutive terms costs one front-coded step each, and
+     * shared() tells callers how much of the previous term is unchanged.
+     */
+    class Iterator {
+    public:
+        bool valid() const { return id_ < lexicon_->termCount_; }
+        uint32_t id() const { return id_; }
+        std::string_view term() const { return term_; }
+
+        // Length of the prefix this term shares with the previously visited one.
+        size_t shared() const { return shared_; }
+
+        void next();
+
+        /**
+         * @brief Move forward to the first term not less than @a target
+         *
+         * Targets within the current block are reached by stepping; farther
+         * ones gallop over the following blocks, so short skips stay cheap.
+         * Never moves backwards;
+         * afterwards shared() is relative to the term before the skip.
+         */
+        void skipTo(std::string_view target);
+
+    private:
+        friend class Lexicon;
+        Iterator(const Lexicon* lexicon, uint32_t id);
+
+        const Lexicon* lexicon_;
+        uint32_t id_;
+        const char* p_ = nullptr;
+        std::string term_;
+        size_t shared_ = 0;
+
+        void loadBlockStart(uint32_t block);
+        void decodeNext();
+    };
+
+    /**
+     * @param id First term id to visit
+     */
+    Iterator iterate(uint32_t id = 0) const { return Iterator(this, id); }
+
+    /**
+     * @brief Build a lexicon file from every key of an inverted index
+     *
+     * @param db Inverted index to read the terms from
+     * @param path Output file (replaced atomically)
+     * @param maxScore Computes a term's max score from (df, highest priority);
+     *                 defaults to the highest priority
+     */
+    static void build(Database& db, const std::string& path,
+                      const std::function<float(uint32_t, int)>& maxScore = nullptr);
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+
+    uint32_t termCount_ = 0;
+    uint32_t blockCount_ = 0;
+    const char* stats_ = nullptr;
+    const char* blockIndex_ = nullptr;
+    const char* blocks_ = nullptr;
+    const char* end_ = nullptr;
+
+    // First term of a block, read in place.
+    std::string_view blockFirstTerm(uint32_t block) const;
+    const char* blockStart(uint32_t block) const;
+
+    // Index of the last block whose first term is <= term (0 if none).
+    uint32_t findBlock(std::string_view term) const { return findBlock(term, 0, blockCount_); }
+
+    // Same, searching blocks [lo, hi) only (lo if none).
+    uint32_t findBlock(std::string_view term, uint32_t lo, uint32_t hi) const;
+};
+
+/**
+ * @brief Collects terms and writes a lexicon file
+ */
+class LexiconBuilder {
+public:
+    /**
+     * @brief Add a term; terms may arrive in any order but must be unique
+     */
+    void add(std::string term, uint32_t df, float maxScore);
+
+    /**
+     * @param path Output file, written to a temporary name and renamed into place
+     */
+    void write(const std::string& path);
+
+private:
+    struct Entry {
+        std::string term;
+        uint32_t df;
+        float maxScore;
+    };
+    std::vector<Entry> entries_;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+/**
+ * @file  LruCache.h
+ * @brief Small thread-safe LRU map with a fixed number of entries
+ */
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+template <typename Key, typename Value>
+class LruCache {
+public:
+    /**
+     * @param capacity Maximum number of entries kept
+     */
+    explicit LruCache(size_t capacity) : capacity_(capacity) {}
+
+    /**
+     * @returns The cached value, or nullopt on a miss
+     */
+    std::optional<Value> get(const Key& key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it == index_.end())
+            return std::nullopt;
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return it->second->second;
+    }
+
+    /**
+     * @brief Insert or replace an entry, evicting the least recently used one if full
+     */
+    void put(const Key& key, Value value) {
+        if (capacity_ == 0)
+            return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            it->second->second = std::move(value);
+            lru_.splice(lru_.begin(), lru_, it->second);
+            return;
+        }
+        if (lru_.size() >= capacity_) {
+            index_.erase(lru_.back().first);
+            lru_.pop_back();
+        }
+        lru_.emplace_front(key, std::move(value));
+        index_.emplace(key, lru_.begin());
+    }
+
+    void erase(const Key& key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it == index_.end())
+            return;
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lru_.clear();
+        index_.clear();
+    }
+
+private:
+    using Entry = std::pair<Key, Value>;
+
+    std::mutex mutex_;
+    size_t capacity_;
+    std::list<Entry> lru_; // most recently used first
+    std::unordered_map<Key, typename std::list<Entry>::iterator> index_;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+/**
+ * @file  Lz4.h
+ * @brief LZ4 block-format compressor used for stored document fields
+ *
+ * Output follows the LZ4 block format (sequences of literals and
+ * back-references with 16-bit offsets), so blocks can also be inspected with
+ * the reference library. There is no frame header: callers store the
+ * uncompressed size themselves.
+ */
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace lz4 {
+
+/**
+ * @param input Bytes to compress
+ * @returns Compressed block
+ */
+std::string compress(std::string_view input);
+
+/**
+ * @brief Decompress a block produced by compress().
+ *
+ * @param input Compressed block
+ * @param output Destination buffer of exactly @a outputSize bytes
+ * @param outputSize Uncompressed size of the block
+ * @return False if the block is corrupt or does not decode to @a outputSize bytes.
+ */
+bool decompress(std::string_view input, char* output, size_t outputSize);
+
+} // namespace lz4
@@ -0,0 +1,237 @@
+#pragma once
+
+/**
+  ******************************************************************************
+  * @file           : analyzer.h
+  * @brief          : Text analysis chain shared by document ingestion and queries.
+  ******************************************************************************
+
+  An Analyzer tokenizes text (tokenizer::tokenize splits, lowercases and
+  strips punctuation) and passes every token through a chain of stages
+  fixed at compile time:
+
+      Analyzer<StopwordFilter, Stemming> documents;
+      documents.analyze(body, [&](const analyzer::Token& token) { ... });
+
+  A stage is any type with `bool operator()(Token&)`: it may rewrite the
+  token in place and returns false to drop it, which ends the chain for
+  that token. Text can be fed in chunks, e.g. a page body as it arrives;
+  only a token cut by a chunk boundary is copied. An Analyzer reuses its
+  buffers, so steady-state analysis does not allocate; it must only be
+  used by one thread at a time.
+*/
+
+#include "queryTree.h"
+#include "spellingCorrector.h"
+#include "stemmer.h"
+#include "stopwords.h"
+#include "tokenizer.h"
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+namespace analyzer {
+
+/**
+ * @brief A token on its way through the stages.
+ */
+struct Token {
+    std::string text;  // normalized text; stages may rewrite it
+};
+
+/**
+ * @class StopwordFilter
+ * @brief Drops stop words.
+ */
+class StopwordFilter {
+public:
+    /** Uses the built-in list (stopwords::isStopWord). */
+    StopwordFilter() = default;
+
+    /** @param words Stop word list; must outlive the filter. */
+    explicit StopwordFilter(const stopwords::StopwordSet& words) : words(&words) {}
+
+    bool operator()(Token& token) const {
+        return !(words ? words->contains(token.text) : stopwords::isStopWord(token.text));
+    }
+
+private:
+    const stopwords::StopwordSet* words = nullptr;
+};
+
+/**
+ * @class SpellingCorrection
+ * @brief Replaces words missing from the dictionary with the closest dictionary word.
+ *
+ * Wildcard and fuzzy terms are expanded against the index, not corrected.
+ */
+class SpellingCorrection {
+public:
+    /** Corrects nothing. */
+    SpellingCorrection() = default;
+
+    /**
+     * @param corrector Spelling corrector over the dictionary words.
+     * @param isWord Returns whether a token is a dictionary word.
+     * Both must outlive the stage.
+     */
+    SpellingCorrection(const spell::SpellingCorrector& corrector,
+                       const std::function<bool(std::string_view)>& isWord)
+            : corrector(&corrector), isWord(&isWord) {}
+
+    bool operator()(Token& token) const {
+        if (corrector && !queryTree::isWildcard(token.text) && !queryTree::isFuzzy(token.text) &&
+            !(*isWord)(token.text)) {
+            token.text = corrector->findClosest(token.text);
+        }
+        return true;
+    }
+
+private:
+    const spell::SpellingCorrector* corrector = nullptr;
+    const std::function<bool(std::string_view)>* isWord = nullptr;
+};
+
+/**
+ * @class Stemming
+ * @brief Reduces words to their Porter stem; wildcard terms are left as they
+ *        are, and fuzzy terms keep their "~N" suffix after the stem.
+ */
+class Stemming {
+public:
+    /** Stems every word in place. */
+    Stemming() = default;
+
+    /** @param cache Memo of stems shared by ingest threads; must outlive the stage. */
+    explicit Stemming(stemmer::StemCache& cache) : cache(&cache) {}
+
+    bool operator()(Token& token) const {
+        if (queryTree::isWildcard(token.text)) {
+            return true;
+        }
+        if (queryTree::isFuzzy(token.text)) {
+            size_t tilde = token.text.rfind(queryTree::FUZZY_CHAR);
+            size_t stemmed = stemmer::stemInPlace(token.text.data(), tilde);
+            token.text.erase(stemmed, tilde - stemmed);
+            return true;
+        }
+        if (cache) {
+            token.text = cache->stem(token.text);
+        } else {
+            token.text.resize(stemmer::stemInPlace(token.text.data(), token.text.size()));
+        }
+        return true;
+    }
+
+private:
+    stemmer::StemCache* cache = nullptr;
+};
+
+/**
+ * @class Analyzer
+ * @brief Tokenizer followed by a compile-time chain of stages.
+ * @tparam Stages Stage types, applied in order.
+ */
+template <typename... Stages>
+class Analyzer {
+public:
+    Analyzer() = default;
+
+    /** @param stages The configured stages, in order. */
+    template <typename First, typename... Rest>
+    explicit Analyzer(First&& first, Rest&&... rest)
+            : stages(std::forward<First>(first), std::forward<Rest>(rest)...) {}
+
+    /**
+     * @brief Keep the query term operators, for wildcard and fuzzy terms such
+     *        as "comput*" and "colour~1" (see tokenizer::tokenize).
+     */
+    void setKeepOperators(bool keep) { keepOperators = keep; }
+
+    /**
+     * @return The stage of type @a Stage, e.g. to rebind it to per-request state.
+     */
+    template <typename Stage>
+    Stage& stage() { return std::get<Stage>(stages); }
+
+    /**
+     * @brief Analyzes the next chunk of a text.
+     *
+     * Tokens are cut at ASCII whitespace only, so UTF-8 sequences split
+     * across chunks are reassembled; the token straddling the end of the
+     * chunk waits for the next chunk or finish().
+     * @param chunk The next bytes of the text.
+     * @param sink Called with each resulting `const Token&`, in text order.
+     */
+    template <typename Sink>
+    void feed(std::string_view chunk, Sink&& sink) {
+        size_t first = chunk.find_first_of(SPACES);
+        if (first == std::string_view::npos) {
+            carry.append(chunk);
+            return;
+        }
+        size_t start = 0;
+        if (!carry.empty()) {
+            carry.append(chunk.substr(0, first));
+            run(carry, sink);
+            carry.clear();
+            start = first;
+        }
+        size_t last = chunk.find_last_of(SPACES);
+        run(chunk.substr(start, last - start), sink);
+        carry.assign(chunk.substr(last + 1));
+    }
+
+    /**
+     * @brief Analyzes what remains of a text fed in chunks.
+     * @param sink Called with each resulting `const Token&`.
+     */
+    template <typename Sink>
+    void finish(Sink&& sink) {
+        run(carry, sink);
+        carry.clear();
+    }
+
+    /**
+     * @brief Analyzes a whole text.
+     * @param sink Called with each resulting `const Token&`, in text order.
+     */
+    template <typename Sink>
+    void analyze(std::string_view text, Sink&& sink) {
+        feed(text, sink);
+        finish(sink);
+    }
+
+private:
+    static constexpr std::string_view SPACES = " \t\n\v\f\r";
+
+    std::tuple<Stages...> stages;
+    bool keepOperators = false;
+    tokenizer::TokenBuffer buffer;
+    Token token;
+    std::string carry;  // start of a token cut by the end of the last chunk
+
+    template <typename Sink>
+    void run(std::string_view text, Sink& sink) {
+        if (text.empty()) return;
+        tokenizer::tokenize(text, buffer, keepOperators);
+        for (std::string_view word : buffer) {
+            token.text.assign(word);
+            bool keep = std::apply([this](Stages&... stage) { return (stage(token) && ...); }, stages);
+            if (keep) {
+                sink(static_cast<const Token&>(token));
+            }
+        }
+    }
+};
+
+/** Documents: words without stop words, stemmed (DocDatabase::addDoc). */
+using DocumentAnalyzer = Analyzer<StopwordFilter, Stemming>;
+
+/** Queries: as documents, with misspelled words corrected before stemming. */
+using QueryAnalyzer = Analyzer<StopwordFilter, SpellingCorrection, Stemming>;
+
+} // namespace analyzer
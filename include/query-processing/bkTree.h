@@ -9,10 +9,12 @@
   NOTE: This could fit in a utils folder
 */
 
-#include <unordered_map>
+#include "spellingCorrector.h"
+
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <memory>
 #include <unordered_set>
 
 /**
@@ -25,13 +27,19 @@ namespace bk {
 /**
  * @class BKTree
  * @brief A Burkhard-Keller Tree for approximate string matching using edit distance.
+ *
+ * Nodes live in one array and the children of a node are a contiguous span
+ * of it, sorted by their distance to the parent; words live in one shared
+ * character buffer. Searches walk the array with an explicit stack.
  */
-class BKTree {
+class BKTree : public spell::SpellingCorrector {
 public:
     struct Node {
-        std::string word;
-        std::unordered_map<int, std::unique_ptr<Node>> children;
-        explicit Node(const std::string& w) : word(w) {}
+        uint32_t offset;      // start of the word in the word buffer
+        uint32_t length;      // length of the word
+        uint32_t distance;    // edit distance to the parent's word
+        uint32_t firstChild;  // index of the first child in the node array
+        uint32_t childCount;  // children occupy [firstChild, firstChild + childCount)
     };
 
     /**
@@ -47,9 +55,28 @@ public:
 
     /**
      * @brief Tree root getter.
-     * @return root of tree.
+     * @return root of tree (nullptr if empty).
+     */
+    const Node* getRoot() const { return nodes.empty() ? nullptr : &nodes[0]; }
+
+    /**
+     * @brief Word stored at a node.
+     * @param node A node of this tree.
+     * @return The node's word.
+     */
+    std::string_view word(const Node& node) const {
+        return std::string_view(words).substr(node.offset, node.length);
+    }
+
+    /**
+     * @brief Number of distinct words in the tree.
+     */
+    size_t size() const { return nodes.size() - unusedNodes; }
+
+    /**
+     * @brief Bytes held by the node array and the word buffer.
      */
-    const Node* getRoot() const { return root.get(); }
+    size_t memoryUsage() const { return nodes.capacity() * sizeof(Node) + words.capacity(); }
 
     /**
      * @brief Inserts a word into the BK-Tree.
@@ -63,29 +90,26 @@ public:
      * @param threshold Maximum edit distance allowed.
      * @return The closest word found in the tree.
      */
-    std::string findClosest(const std::string& query, int threshold = 2) const;
+    std::string findClosest(const std::string& query, int threshold = 2) const override;
 
 private:
 
-    std::unique_ptr<Node> root;
+    std::vector<Node> nodes;     // nodes[0] is the root
+    std::string words;           // every word, back to back
+    size_t unusedNodes = 0;      // array slots left behind by relocated child spans
 
     /**
-     * @brief Recursively searches for the closest match in the BK-Tree.
-     * @param node The current node being examined.
-     * @param query The word to search for.
-     * @param threshold The maximum allowed edit distance.
-     * @param bestMatch The best match found so far.
-     * @param bestDistance The minimum edit distance found so far.
+     * @brief Adds a node for a word as a child of a given parent.
+     * @param parent Index of the parent node.
+     * @param word The word to store.
+     * @param distance Edit distance between the word and the parent's word.
      */
-    void search(const Node* node, const std::string& query, int threshold,
-                std::string& bestMatch, int& bestDistance) const;
+    void addChild(uint32_t parent, const std::string& word, int distance);
 
     /**
-     * @brief Computes the edit distance between two words.
-     * @param a First word.
-     * @param b Second word.
-     * @return The Levenshtein edit distance.
+     * @brief Rewrites the node array in breadth-first order, dropping unused
+     *        slots and storing each span's words next to each other.
      */
-    static int editDistance(const std::string& a, const std::string& b);
+    void compact();
 };
 } // namespace bk
@@ -0,0 +1,155 @@
+#pragma once
+
+/**
+  ******************************************************************************
+  * @file           : completionTrie.h
+  * @brief          : Memory-mapped weighted trie for query autocompletion.
+  ******************************************************************************
+
+  Completions (past queries and dictionary words, each with a weight) are
+  compiled offline (tools/build_completions.cc) into a radix trie whose
+  every node stores its best completions, so a prefix is answered by one
+  walk down the trie and a copy of that node's list, however many
+  completions share the prefix. Edge labels are not stored: they point into
+  the completion text. The image is memory mapped and used in place.
+  Layout (native byte order):
+
+      header    magic, version, counts, file size
+      nodes     u32 label offset, label length, first child, child count,
+                first top, top count; children are contiguous and sorted
+                by the first byte of their label, node 0 is the root
+      tops      u32 completion ids, best first, for each node
+      weights   u64 weight of each completion
+      offsets   u32 offset of each completion in the text, plus the end offset
+      text      completion bytes, in sorted order
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @namespace completion
+ * @brief Query autocompletion.
+ */
+namespace completion {
+
+/** Version of the image format; images of other versions are rejected. */
+constexpr uint32_t COMPLETION_TRIE_VERSION = 1;
+
+/** Completions kept at each node, and so the most one lookup returns. */
+constexpr uint32_t DEFAULT_TOP_K = 10;
+
+/** Completion text (normalized with CompletionTrie::normalize) and its weight. */
+using Completions = std::unordered_map<std::string, uint64_t>;
+
+/**
+ * @brief A completion of a prefix.
+ */
+struct Suggestion {
+    std::string_view text;  // points into the mapped image
+    uint64_t weight;
+};
+
+/**
+ * @class CompletionTrie
+ * @brief Read-only view of a completion trie image.
+ */
+class CompletionTrie {
+public:
+    /**
+     * @brief Maps an image written by CompletionTrie::build.
+     * @param path The image file.
+     */
+    explicit CompletionTrie(const std::string& path);
+    ~CompletionTrie();
+
+    // Disable Copy Constructor/Assignment Operator
+    CompletionTrie(const CompletionTrie&) = delete;
+    CompletionTrie& operator=(const CompletionTrie&) = delete;
+
+    /**
+     * @brief Finds the best completions of a normalized prefix.
+     * @param prefix Prefix of normalized text, e.g. "ski re".
+     * @param limit Maximum number of completions; at most topK() are stored.
+     * @return Completions starting with @a prefix, by descending weight
+     *         (equal weights in text order).
+     */
+    std::vector<Suggestion> complete(std::string_view prefix, size_t limit = DEFAULT_TOP_K) const;
+
+    /**
+     * @brief complete() for text as typed, e.g. "Ski  Re".
+     *
+     * The text is normalized; a trailing space is kept, so "ski " only
+     * completes to queries with more words.
+     */
+    std::vector<Suggestion> suggest(std::string_view typed, size_t limit = DEFAULT_TOP_K) const;
+
+    /**
+     * @brief Number of completions.
+     */
+    size_t size() const { return completionCount; }
+
+    /**
+     * @brief Completions stored at each node.
+     */
+    size_t topK() const { return k; }
+
+    /**
+     * @brief Bytes of the image.
+     */
+    size_t memoryUsage() const { return size_; }
+
+    /**
+     * @brief Normalizes text as completions are stored: tokens joined by single spaces.
+     */
+    static std::string normalize(std::string_view text);
+
+    /**
+     * @brief Compiles completions into an image file.
+     * @param completions Normalized completion texts and their weights; empty texts are skipped.
+     * @param path Output file, written to a temporary name and renamed into place.
+     * @param topK Completions stored at each node.
+     */
+    static void build(const Completions& completions, const std::string& path, uint32_t topK = DEFAULT_TOP_K);
+
+private:
+    const char* data = nullptr;
+    size_t size_ = 0;
+
+    uint32_t k = 0;
+    uint32_t nodeCount = 0;
+    uint32_t completionCount = 0;
+    const char* nodes = nullptr;
+    const char* tops = nullptr;
+    const char* weights = nullptr;
+    const char* offsets = nullptr;
+    const char* text = nullptr;
+    uint32_t textSize = 0;
+
+    /**
+     * @return The label of the edge into a node.
+     */
+    std::string_view label(uint32_t node) const;
+
+    /**
+     * @return The child of a node whose label starts with @a c, or UINT32_MAX.
+     */
+    uint32_t child(uint32_t node, char c) const;
+
+    /**
+     * @return The text of a completion.
+     */
+    std::string_view completionText(uint32_t id) const;
+
+    /**
+     * @brief Validates the header and sets up the section pointers.
+     * @return False if the bytes are not a valid trie.
+     */
+    bool attach();
+};
+
+} // namespace completion
@@ -0,0 +1,47 @@
+#pragma once
+
+/**
+  ******************************************************************************
+  * @file           : editDistance.h
+  * @brief          : Levenshtein distance against a fixed pattern.
+  ******************************************************************************
+*/
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace spell {
+
+/**
+ * @class EditDistance
+ * @brief Computes edit distances from one pattern to many texts.
+ *
+ * Patterns of up to 64 characters use Myers' bit-parallel algorithm in
+ * Hyyrö's formulation for global edit distance, which processes one text
+ * character per handful of word operations. Longer patterns fall back to the
+ * dynamic programming recurrence. The pattern is not copied.
+ */
+class EditDistance {
+public:
+    /**
+     * @param pattern The string every distance is measured from.
+     */
+    explicit EditDistance(std::string_view pattern);
+
+    /**
+     * @brief Computes the distance to a text, giving up past a cutoff.
+     * @param text The text to compare with the pattern.
+     * @param cutoff Largest distance that needs to be exact.
+     * @return The edit distance, or cutoff + 1 if it is larger than cutoff.
+     */
+    int distance(std::string_view text, int cutoff) const;
+
+private:
+    std::string_view pattern;
+    std::array<uint64_t, 256> peq;  // peq[c] has bit i set where pattern[i] == c
+
+    int scalarDistance(std::string_view text, int cutoff) const;
+};
+
+} // namespace spell
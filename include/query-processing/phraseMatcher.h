@@ -0,0 +1,140 @@
+#pragma once
+
+/**
+  ******************************************************************************
+  * @file           : phraseMatcher.h
+  * @brief          : Multi-word phrase detection with a token-level Aho-Corasick automaton.
+  ******************************************************************************
+
+  The phrases of a TermDictionary are compiled into an automaton over word
+  ids, so a query is matched against every phrase in one pass over its
+  tokens, however long the phrases are and however many there are.
+
+  The automaton is a flat image (native byte order), used in place either
+  from memory or from a section of a mapped file:
+
+      header    magic, version, counts
+      slots     open addressing table: u32 word id + 1 (0 = empty), by word hash
+      words     u32 offset of each word in the text, plus the end offset
+      root      u32 state reached from the root by each word id (0 = none)
+      states    u32 first edge of each state, plus the end
+      edges     u32 word id, u32 target state; sorted by word id per state
+      fail      u32 failure link of each state
+      output    u32 nearest phrase-ending state on the failure chain (0 = none)
+      length    u32 words in the phrase ending at each state (0 = none)
+      text      word bytes
+*/
+
+#include "queryTree.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+namespace queryTree {
+
+/**
+ * @brief A phrase found in a token list.
+ */
+struct PhraseMatch {
+    uint32_t start;   // index of the first token
+    uint32_t length;  // number of tokens
+};
+
+/**
+ * @class PhraseMatcher
+ * @brief Compiled phrase dictionary for finding phrases in query tokens.
+ */
+class PhraseMatcher {
+public:
+    /**
+     * @brief A matcher without phrases.
+     */
+    PhraseMatcher();
+
+    /**
+     * @brief Compiles the phrases of a dictionary.
+     *
+     * Keys are space-separated, normalized words; keys of fewer than two
+     * words are not phrases and are skipped.
+     * @param dict The phrase dictionary.
+     */
+    explicit PhraseMatcher(const TermDictionary& dict);
+
+    /**
+     * @brief Uses a compiled matcher already in memory, e.g. a section of a mapped file.
+     * @param image Start of the bytes written by serialize; must outlive this object.
+     * @param size Number of bytes.
+     */
+    PhraseMatcher(const char* image, size_t size);
+
+    // Disable Copy Constructor/Assignment Operator
+    PhraseMatcher(const PhraseMatcher&) = delete;
+    PhraseMatcher& operator=(const PhraseMatcher&) = delete;
+
+    /**
+     * @brief Finds the phrases in a token list.
+     *
+     * Phrases do not overlap: scanning left to right, the longest phrase
+     * starting at the earliest unused token wins.
+     * @param tokens The query tokens.
+     * @param matches Receives the phrases in token order; scratch space comes from its resource.
+     */
+    void findPhrases(const TokenList& tokens, std::pmr::vector<PhraseMatch>& matches) const;
+
+    /**
+     * @brief Number of phrases.
+     */
+    size_t size() const { return phraseCount; }
+
+    /**
+     * @brief Bytes of the compiled matcher.
+     */
+    size_t memoryUsage() const { return size_; }
+
+    /**
+     * @brief Compiles the phrases of a dictionary into an image.
+     * @param dict The phrase dictionary.
+     * @return The image bytes.
+     */
+    static std::string serialize(const TermDictionary& dict);
+
+private:
+    std::string owned;  // the image, when compiled by this object
+    const char* data = nullptr;
+    size_t size_ = 0;
+
+    uint32_t wordCount = 0;
+    uint32_t slotCount = 0;
+    uint32_t stateCount = 0;
+    uint32_t phraseCount = 0;
+    const char* slots = nullptr;
+    const char* words = nullptr;
+    const char* root = nullptr;
+    const char* states = nullptr;
+    const char* edges = nullptr;
+    const char* fail = nullptr;
+    const char* output = nullptr;
+    const char* lengths = nullptr;
+    const char* text = nullptr;
+
+    /**
+     * @return The id of a word, or UINT32_MAX if no phrase contains it.
+     */
+    uint32_t wordId(std::string_view word) const;
+
+    /**
+     * @return The state reached from a state by a word, 0 if there is no edge.
+     */
+    uint32_t next(uint32_t state, uint32_t word) const;
+
+    /**
+     * @brief Validates the header and sets up the section pointers.
+     * @return False if the bytes are not a valid matcher.
+     */
+    bool attach();
+};
+
+} // namespace queryTree
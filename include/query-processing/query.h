@@ -8,11 +8,15 @@
   ******************************************************************************
 */
 
+#include <memory_resource>
 #include <string>
 #include <vector>
 #include <unordered_set>
 #include "bkTree.h"
+#include "symSpell.h"
 #include "queryTree.h"
+#include "phraseMatcher.h"
+#include "queryResources.h"
 
 /**
  * @namespace query
@@ -21,7 +25,7 @@
 namespace query {
 
 using Dictionary = std::unordered_set<std::string>;
-using TokenList = std::vector<std::string>;
+using TokenList = queryTree::TokenList;
 
 /**
  * @brief Loads a dictionary from a given file path.
@@ -31,19 +35,50 @@ using TokenList = std::vector<std::string>;
  */
 Dictionary loadDictionary(const std::string& filepath);
 
+/**
+ * @brief Loads a phrase dictionary from a given file path.
+ *
+ * Each line holds a phrase, optionally followed by a tab and a
+ * comma-separated list of values ("ski resort\tresort,lodge").
+ *
+ * @param filepath The path to the file containing the phrases.
+ * @return The phrases and their values.
+ */
+queryTree::TermDictionary loadTermDictionary(const std::string& filepath);
+
 /**
  * @brief Processes a query string
  *
+ * Compile the phrase dictionary (loadTermDictionary) into a
+ * queryTree::PhraseMatcher once and reuse it for every query.
+ *
  * @param rawQuery The raw query string to process.
  * @param dictionary The dictionary for typo detection.
- * @param tree The BK-Tree containing dictionary words.
- * @param termDictionary The dictionary for identifying multi-word phrases.
+ * @param corrector Spelling corrector over the dictionary words (e.g. bk::BKTree or spell::SymSpell).
+ * @param phrases The compiled phrase dictionary.
+ * @param resource Memory for the tokens and the tree, e.g. a per-request arena.
  * @return The queryTree structure created from the processed query.
  */
 queryTree::QueryTree processQuery(
     const std::string& rawQuery,
     const Dictionary& dictionary,
-    const bk::BKTree& tree,
-    const queryTree::TermDictionary& termDictionary
+    const spell::SpellingCorrector& corrector,
+    const queryTree::PhraseMatcher& phrases,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource()
 );
+
+/**
+ * @brief Processes a query string against a mapped resources image
+ *
+ * Tokens, corrections and the tree are allocated from @a resource, so with a
+ * per-request arena a query of correctly spelled words does not touch the
+ * global heap once the arena has grown to fit it.
+ *
+ * @param rawQuery The raw query string to process.
+ * @param resources Dictionary, spelling corrector and phrases built by QueryResources::build.
+ * @param resource Memory for the tokens and the tree, e.g. a per-request arena.
+ * @return The queryTree structure created from the processed query.
+ */
+queryTree::QueryTree processQuery(const std::string& rawQuery, const QueryResources& resources,
+                                  std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 } // namespace query
@@ -7,7 +7,10 @@
   ******************************************************************************
 */
 
+#include <cstdint>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include "queryOperator.h"
 
 /**
@@ -16,12 +19,18 @@
  */
 namespace queryTree {
 
+/** Term id of a term node that is not in the index term dictionary, or not resolved yet. */
+constexpr uint32_t UNKNOWN_TERM = UINT32_MAX;
+
 /**
  * @class QueryNode
  * @brief Represents a node in the indexed query representation.
  */
 class QueryNode {
 public:
+    /** Nodes keep their value in the memory of the vector holding them. */
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
     /**
      * @brief Constructs a query node.
      * @param nodeIndex The position of this node in the array.
@@ -29,9 +38,17 @@ public:
      * @param value The term value (for value nodes).
      * @param childStart The index of the first child in the array (-1 if none).
      * @param childCount The number of children this node has.
+     * @param alloc Allocator for the value.
      */
-    QueryNode(int nodeIndex, QueryOperator operation, const std::string& value,
-              int childStart, int childCount);
+    QueryNode(int nodeIndex, QueryOperator operation, std::string_view value,
+              int childStart, int childCount, const allocator_type& alloc = {});
+
+    QueryNode(const QueryNode& other) = default;
+    QueryNode(QueryNode&& other) = default;
+    QueryNode(const QueryNode& other, const allocator_type& alloc);
+    QueryNode(QueryNode&& other, const allocator_type& alloc);
+    QueryNode& operator=(const QueryNode& other) = default;
+    QueryNode& operator=(QueryNode&& other) = default;
 
     /**
      * @brief Checks if this node is an operation node.
@@ -49,7 +66,19 @@ public:
      * @brief Gets the value associated with this node.
      * @return The value string, NULL otherwise
      */
-    const std::string& getValue() const;
+    const std::pmr::string& getValue() const;
+
+    /**
+     * @brief Gets the index term id of a term node.
+     * @return The term id, or UNKNOWN_TERM if the term is unresolved or not in the index.
+     */
+    uint32_t getTermId() const;
+
+    /**
+     * @brief Gets the document frequency of a resolved term node.
+     * @return The number of documents containing the term, 0 if unknown.
+     */
+    uint32_t getDocFrequency() const;
 
     /**
      * @brief Gets the index of the first child.
@@ -69,6 +98,18 @@ public:
      */
     int getNodeIndex() const;
 
+    /**
+     * @brief Gets the index of this node's parent.
+     * @return The index of the parent node (-1 for the root).
+     */
+    int getParentIndex() const;
+
+    /**
+     * @brief Gets the depth of this node in the tree.
+     * @return The number of edges from the root (0 for the root).
+     */
+    int getDepth() const;
+
     /**
     * @brief Set child start
     * @param start The start index
@@ -80,13 +121,31 @@ public:
     */
     void incrementChildCount();
 
+    /**
+    * @brief Set the parent and depth
+    * @param parent The index of the parent node (-1 for the root)
+    * @param nodeDepth The parent's depth plus one (0 for the root)
+    */
+    void setParent(int parent, int nodeDepth);
+
+    /**
+    * @brief Set the index term id and document frequency
+    * @param id The term id in the index term dictionary
+    * @param df The term's document frequency
+    */
+    void setTerm(uint32_t id, uint32_t df);
+
 
 private:
     int nodeIndex;
     QueryOperator operation;
-    std::string value;
+    std::pmr::string value;
     int childStart;
     int childCount;
+    int parentIndex = -1;
+    int depth = 0;
+    uint32_t termId = UNKNOWN_TERM;
+    uint32_t docFrequency = 0;
 };
 
 } // namespace queryTree
\ No newline at end of file
@@ -27,7 +27,7 @@ enum class QueryOperator {
     LOGPROBNOT, ALL, BAND, ANY, BOR, BNOT, BOOL_TO_COUNT, BOOL, REQUIRE,
     REJECT, INSIDE, GREATER, LESS, BETWEEN, EQUALS, PASSAGEFILTER, PL2SCORER,
     PASSAGELENGTHS, STOPSTRUCTURE, STOPWORD, COUNTS, EXTENTS, INDICATOR,
-    LENGTHS, NAMES, PRIOR, SCORES, UNKNOWN
+    LENGTHS, NAMES, PRIOR, SCORES, WILDCARD, FUZZY, UNKNOWN
 };
 
 // Mapping string operators to enum values remains unchanged
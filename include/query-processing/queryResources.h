@@ -0,0 +1,99 @@
+#pragma once
+
+/**
+  ******************************************************************************
+  * @file           : queryResources.h
+  * @brief          : Memory-mapped image of the query-processing resources.
+  ******************************************************************************
+
+  The dictionary, its spelling corrector and the phrase dictionary are
+  compiled offline (tools/build_query_resources.cc) into one file that is
+  memory mapped and used in place, so processes start without loading or
+  building anything and share the pages. Layout (native byte order):
+
+      header    magic, version, offset and size of each section, file size
+      spelling  a spell::SymSpell index over the dictionary words; it also
+                answers dictionary membership
+      matcher   a queryTree::PhraseMatcher compiled from the phrases; phrase
+                detection only needs the phrases, so their values are not kept
+*/
+
+#include "symSpell.h"
+#include "queryTree.h"
+#include "phraseMatcher.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace query {
+
+/** Version of the image format; images of other versions are rejected. */
+constexpr uint32_t QUERY_RESOURCES_VERSION = 3;
+
+/**
+ * @class QueryResources
+ * @brief Read-only view of a query resources image.
+ */
+class QueryResources {
+public:
+    /**
+     * @brief Maps an image written by QueryResources::build.
+     * @param path The image file.
+     */
+    explicit QueryResources(const std::string& path);
+    ~QueryResources();
+
+    // Disable Copy Constructor/Assignment Operator
+    QueryResources(const QueryResources&) = delete;
+    QueryResources& operator=(const QueryResources&) = delete;
+
+    /**
+     * @brief Checks whether a word is in the dictionary.
+     */
+    bool isWord(std::string_view word) const { return spelling->contains(word); }
+
+    /**
+     * @brief Spelling corrector over the dictionary words.
+     */
+    const spell::SpellingCorrector& corrector() const { return *spelling; }
+
+    /**
+     * @brief Compiled phrase dictionary for finding phrases in query tokens.
+     */
+    const queryTree::PhraseMatcher& phraseMatcher() const { return *matcher; }
+
+    /**
+     * @brief Number of dictionary words.
+     */
+    size_t wordCount() const { return spelling->size(); }
+
+    /**
+     * @brief Number of phrases.
+     */
+    size_t phraseCount() const { return matcher->size(); }
+
+    /**
+     * @brief Writes an image.
+     * @param dictionary Dictionary words.
+     * @param termDictionary Multi-word phrases; their values are not stored.
+     * @param path Output file, written to a temporary name and renamed into place.
+     * @param maxDistance Largest edit distance the corrector will support.
+     */
+    static void build(const std::unordered_set<std::string>& dictionary,
+                      const queryTree::TermDictionary& termDictionary,
+                      const std::string& path, int maxDistance = 2);
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+
+    std::unique_ptr<spell::SymSpell> spelling;
+    std::unique_ptr<queryTree::PhraseMatcher> matcher;
+};
+
+} // namespace query
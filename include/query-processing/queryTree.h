@@ -7,14 +7,28 @@
  ******************************************************************************
 */
 
+#include <algorithm>
+#include <cstdint>
 #include <vector>
 #include <unordered_map>
-#include <unordered_set>
-#include <map>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <functional>
+#include <utility>
 #include "queryNode.h"
 
+class Lexicon;
+
+namespace synonyms {
+class SynonymDictionary;
+}
+
+namespace queryTree {
+class PhraseMatcher;
+struct PhraseMatch;
+}
+
 /**
  * @namespace queryTree
  * @brief Contains the core structures for query processing.
@@ -22,20 +36,69 @@
 namespace queryTree {
 
 using TermDictionary = std::unordered_map<std::string, std::vector<std::string>>;
-using TokenList = std::vector<std::string>;
+using TokenList = std::pmr::vector<std::pmr::string>;
+
+/** Wildcard character in query terms ('*' matches any run of characters). */
+constexpr char WILDCARD_CHAR = '*';
+
+/**
+ * @brief Checks whether a token is a wildcard term such as "comput*".
+ * @param token The token to check.
+ * @return True if the token contains a wildcard character.
+ */
+inline bool isWildcard(std::string_view token) {
+    return token.find(WILDCARD_CHAR) != std::string_view::npos;
+}
+
+/** Fuzzy operator in query terms ("colour~1" matches terms within one edit). */
+constexpr char FUZZY_CHAR = '~';
+
+/** Largest edit distance of a fuzzy term; larger ones are clamped to it. */
+constexpr int MAX_FUZZY_DISTANCE = 2;
+
+/**
+ * @brief Checks whether a token is a fuzzy term such as "colour~1".
+ *
+ * The tokenizer only keeps '~' as the fuzzy suffix of a term.
+ * @param token The token to check.
+ * @return True if the token contains the fuzzy operator.
+ */
+inline bool isFuzzy(std::string_view token) {
+    return token.find(FUZZY_CHAR) != std::string_view::npos;
+}
+
+/**
+ * @brief Splits a fuzzy term into the term and its edit distance.
+ * @param token A fuzzy term, e.g. "colour~1".
+ * @return The term ("colour") and the distance, at most MAX_FUZZY_DISTANCE.
+ */
+inline std::pair<std::string_view, int> splitFuzzy(std::string_view token) {
+    size_t tilde = token.rfind(FUZZY_CHAR);
+    int distance = tilde + 1 < token.size() ? token[tilde + 1] - '0' : MAX_FUZZY_DISTANCE;
+    return {token.substr(0, tilde), std::min(distance, MAX_FUZZY_DISTANCE)};
+}
 
 /**
  * @class QueryTree
  * @brief Represents a structured, indexed query for traversal and ranking.
+ *
+ * Nodes are stored in pre-order: every node comes before its descendants and
+ * each subtree is contiguous. Nodes know their parent and depth, so every
+ * traversal is a single pass over the array.
  */
 class QueryTree {
 public:
     /**
     * @brief Constructs a QueryTree from tokenized input.
+    *
+    * Compile the phrase dictionary into a PhraseMatcher once (it is built
+    * from a TermDictionary) and reuse it for every tree.
     * @param tokens The list of processed tokens.
-    * @param dict The dictionary for phrase detection.
+    * @param phrases The compiled phrase dictionary; phrases of any length become OD nodes.
+    * @param resource Memory for the nodes, e.g. a per-request arena.
     */
-    QueryTree(const TokenList& tokens, const TermDictionary& dict);
+    QueryTree(const TokenList& tokens, const PhraseMatcher& phrases,
+              std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
     /**
     * @brief Retrieves a specific node by index.
@@ -48,14 +111,62 @@ public:
     * @brief Retrieves a all the query tree nodes
     * @return Pointer to the requested QueryNodes
     */
-    const std::vector<QueryNode>* getNodes() const { return &nodes; }
+    const std::pmr::vector<QueryNode>* getNodes() const { return &nodes; }
 
     /**
-     * @brief Helper function for itterating through query tree
+    * @brief Resolves term nodes against the index term dictionary.
+    *
+    * Gives every TEXT node its term id and document frequency once, right
+    * after normalization, so later stages work with integers. Terms not in
+    * the dictionary keep UNKNOWN_TERM. A SYNONYM node gets the id of its
+    * group's merged posting list when the index has one.
+    * @param lexicon The index term dictionary.
+    * @return The number of query terms not in the dictionary; a synonym
+    *         group counts only if neither its merged list nor any member is.
+    */
+    size_t resolveTerms(const Lexicon& lexicon);
+
+    /**
+    * @brief Replaces terms that have synonyms with SYNONYM nodes.
+    *
+    * A term directly under the root becomes a SYNONYM node whose value is
+    * the group's merged term and whose TEXT children are the term followed
+    * by the rest of its group. Terms of phrases are left alone, since a
+    * phrase matches its exact words. Run before resolveTerms.
+    * @param dictionary The synonym groups.
+    * @return The number of terms expanded.
+    */
+    size_t expandSynonyms(const synonyms::SynonymDictionary& dictionary);
+
+    /**
+     * @brief Helper function for itterating through query tree in pre-order
      */
     void forEachNodeWithDepth(
         const std::function<void(const QueryNode&, int depth)>& callback) const;
 
+    /**
+     * @brief Visits every node before its children.
+     * @param callback Called once per node.
+     */
+    void forEachPreOrder(const std::function<void(const QueryNode&)>& callback) const;
+
+    /**
+     * @brief Visits every node after its children.
+     * @param callback Called once per node.
+     */
+    void forEachPostOrder(const std::function<void(const QueryNode&)>& callback) const;
+
+    /**
+     * @brief Computes a canonical 64-bit hash of the tree's structure.
+     *
+     * Covers every node's operator and value. The children of a COMBINE node
+     * are hashed as a multiset, so "ski resort" and "resort ski" hash alike,
+     * while the order of terms under ordered operators such as OD matters.
+     * Term ids are not hashed, so the hash is stable across index rebuilds.
+     * @return The hash, 0 for an empty tree.
+     */
+    uint64_t structuralHash() const;
+
 
     /**
     * @brief Prints the structured query tree for debugging.
@@ -64,14 +175,14 @@ public:
 
 private:
     void addPhraseNodes(const queryTree::TokenList& tokens,
-        const std::map<int, std::pair<std::string, std::vector<int>>>& phraseMap,
-        std::unordered_set<int>& usedTokens, int& nodeIndex);
+        const std::pmr::vector<PhraseMatch>& phrases,
+        std::pmr::vector<bool>& usedTokens, int& nodeIndex);
 
     void addTermNodes(const queryTree::TokenList& tokens,
-                      const std::unordered_set<int>& usedTokens,
+                      const std::pmr::vector<bool>& usedTokens,
                       int& nodeIndex);
 
-    std::vector<QueryNode> nodes;
+    std::pmr::vector<QueryNode> nodes;
 };
 
 } // namespace queryTree
@@ -0,0 +1,35 @@
+#pragma once
+
+/**
+  ******************************************************************************
+  * @file           : spellingCorrector.h
+  * @brief          : Common interface of the query spelling correctors.
+  ******************************************************************************
+*/
+
+#include <string>
+
+/**
+ * @namespace spell
+ * Namespace for spelling correction of query words.
+ */
+namespace spell {
+
+/**
+ * @class SpellingCorrector
+ * @brief Maps a possibly misspelled word to the closest dictionary word.
+ */
+class SpellingCorrector {
+public:
+    virtual ~SpellingCorrector() = default;
+
+    /**
+     * @brief Finds the closest dictionary word to a given query within a certain edit distance.
+     * @param query The input word.
+     * @param threshold Maximum edit distance allowed.
+     * @return The closest word, or the query itself if none is within the threshold.
+     */
+    virtual std::string findClosest(const std::string& query, int threshold = 2) const = 0;
+};
+
+} // namespace spell
@@ -8,10 +8,18 @@
   ******************************************************************************
 */
 
+#include <cstddef>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace stemmer {
 
+/** Default number of words a StemCache remembers. */
+constexpr size_t DEFAULT_STEM_CACHE_ENTRIES = 1 << 20;
+
 /**
  * @brief Reduces a word to its stem using the Porter stemming algorithm.
  *
@@ -22,4 +30,52 @@ namespace stemmer {
  */
 std::string stem(const std::string &word);
 
+/**
+ * @brief Stems a word in its own buffer.
+ *
+ * Same result as stem(), without allocating for words of up to 64
+ * characters. A stem is never longer than its word.
+ *
+ * @param word The characters of the word; overwritten with the stem.
+ * @param length The length of the word.
+ * @return The length of the stem.
+ */
+size_t stemInPlace(char* word, size_t length);
+
+/**
+ * @class StemCache
+ * @brief Thread-safe memo of word to stem, for stemming large volumes of text.
+ *
+ * Words are spread over independently locked shards, so concurrent
+ * ingest threads rarely contend. A shard that reaches its share of the
+ * capacity is cleared and refills with the words still in use.
+ */
+class StemCache {
+public:
+    /**
+     * @param capacity Number of words remembered across all shards.
+     * @param shardCount Number of independently locked shards.
+     */
+    explicit StemCache(size_t capacity = DEFAULT_STEM_CACHE_ENTRIES, size_t shardCount = 16);
+
+    /**
+     * @brief Stems a word, reusing the stem computed for an earlier call.
+     */
+    std::string stem(std::string_view word);
+
+    /**
+     * @brief Number of words currently remembered.
+     */
+    size_t size() const;
+
+private:
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, std::string> stems;
+    };
+
+    std::vector<Shard> shards;
+    size_t shardCapacity;
+};
+
 } // namespace stemmer
@@ -0,0 +1,68 @@
+#pragma once
+
+/**
+  ******************************************************************************
+  * @file           : stopwords.h
+  * @brief          : Stop word lookup through minimal perfect hashing.
+  ******************************************************************************
+*/
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace stopwords {
+
+/**
+ * @brief Checks a token against the built-in stop words.
+ *
+ * The list is src/query-processing/stopwords.txt, normalized like tokenizer
+ * output ("ain't" becomes "aint") and compiled into a minimal perfect hash
+ * table, so a lookup is two short hashes and one comparison.
+ *
+ * @param word A normalized token.
+ * @return True if the token is a stop word.
+ */
+bool isStopWord(std::string_view word);
+
+/**
+ * @class StopwordSet
+ * @brief Stop word list loaded at runtime, with the same lookup as isStopWord.
+ */
+class StopwordSet {
+public:
+    /**
+     * @param words Stop words; each is normalized like tokenizer output.
+     */
+    explicit StopwordSet(const std::vector<std::string>& words);
+
+    /**
+     * @brief Loads a list of words separated by whitespace or commas.
+     *
+     * Both one word per line and the quoted, comma-separated format of
+     * stopwords.txt are accepted.
+     *
+     * @param path The list file.
+     * @throws std::runtime_error if the file cannot be read.
+     */
+    static StopwordSet load(const std::string& path);
+
+    /**
+     * @param word A normalized token.
+     * @return True if the token is in the set.
+     */
+    bool contains(std::string_view word) const;
+
+    /**
+     * @brief Number of distinct words.
+     */
+    size_t size() const { return seeds.size(); }
+
+private:
+    std::vector<int32_t> seeds;     // per bucket: displacement seed, or -(slot + 1)
+    std::vector<uint32_t> offsets;  // per slot: start of its word in 'chars', plus end
+    std::string chars;
+};
+
+} // namespace stopwords
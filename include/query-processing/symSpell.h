@@ -0,0 +1,148 @@
+#pragma once
+
+/**
+  ******************************************************************************
+  * @file           : symSpell.h
+  * @brief          : Spelling correction by symmetric deletion.
+  ******************************************************************************
+
+  Every dictionary word is indexed under each string obtained by deleting up
+  to maxDistance of its characters. Two words within edit distance d share a
+  deletion of at most d characters each, so a lookup only has to generate the
+  deletions of the query and verify the words indexed under them.
+
+  The index is built once into a file and memory mapped (native byte order):
+
+      header    magic, version, max distance, word count, bucket count, offsets
+      buckets   open addressing table: u32 deletion fingerprint, u32 value, u32 word count
+                (value is the word id if the count is 1, else the first posting)
+      postings  u32 word ids of buckets holding several words
+      words     per word id: u32 offset, u32 length, u32 frequency
+      strings   word bytes
+
+  Word ids are assigned by descending frequency. Deletions are keyed by a
+  32-bit fingerprint, so deletions sharing one also share a bucket; that only
+  adds candidates, which fail verification.
+*/
+
+#include "spellingCorrector.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace spell {
+
+/**
+ * @class SymSpell
+ * @brief Memory-mapped symmetric deletion index for spelling correction.
+ */
+class SymSpell : public SpellingCorrector {
+public:
+    using Frequencies = std::unordered_map<std::string, uint32_t>;
+
+    /**
+     * @brief Maps an index file written by SymSpell::build.
+     * @param path The index file.
+     */
+    explicit SymSpell(const std::string& path);
+
+    /**
+     * @brief Uses an index already in memory, e.g. a section of a larger mapped file.
+     * @param image Start of the index bytes; must outlive this object.
+     * @param size Number of index bytes.
+     */
+    SymSpell(const char* image, size_t size);
+
+    ~SymSpell();
+
+    // Disable Copy Constructor/Assignment Operator
+    SymSpell(const SymSpell&) = delete;
+    SymSpell& operator=(const SymSpell&) = delete;
+
+    /**
+     * @brief Finds the closest dictionary word to a given query within a certain edit distance.
+     *
+     * Among words at the same distance the most frequent one wins.
+     *
+     * @param query The input word.
+     * @param threshold Maximum edit distance allowed (at most maxDistance()).
+     * @return The closest word, or the query itself if none is within the threshold.
+     */
+    std::string findClosest(const std::string& query, int threshold = 2) const override;
+
+    /**
+     * @brief Checks whether a word is in the dictionary.
+     * @param word The word to look up.
+     */
+    bool contains(std::string_view word) const;
+
+    /**
+     * @brief Largest edit distance the index supports.
+     */
+    int maxDistance() const { return maxDistance_; }
+
+    /**
+     * @brief Number of dictionary words.
+     */
+    size_t size() const { return wordCount; }
+
+    /**
+     * @brief Bytes of the index.
+     */
+    size_t memoryUsage() const { return size_; }
+
+    /**
+     * @brief Builds an index file.
+     * @param words Dictionary words with their frequencies.
+     * @param path Output file, written to a temporary name and renamed into place.
+     * @param maxDistance Largest edit distance lookups will support.
+     */
+    static void build(const Frequencies& words, const std::string& path, int maxDistance = 2);
+
+    /**
+     * @brief Builds an index in memory, in the same format as build writes.
+     * @param words Dictionary words with their frequencies.
+     * @param maxDistance Largest edit distance lookups will support.
+     * @return The index bytes.
+     */
+    static std::string serialize(const Frequencies& words, int maxDistance = 2);
+
+private:
+    const char* data = nullptr;
+    size_t size_ = 0;
+    bool mapped = false;  // whether data is a mapping this object must unmap
+
+    int maxDistance_ = 0;
+    uint32_t wordCount = 0;
+    uint32_t bucketCount = 0;
+    const char* buckets = nullptr;
+    const char* postings = nullptr;
+    const char* words = nullptr;
+    const char* strings = nullptr;
+    size_t stringsSize = 0;
+
+    /**
+     * @brief Text of a word.
+     * @param id Word id.
+     */
+    std::string_view word(uint32_t id) const;
+
+    /**
+     * @brief Word ids indexed under a deletion.
+     * @param fingerprint Fingerprint of the deletion.
+     * @param count Receives the number of ids (0 if none).
+     * @return Pointer to the first id (unaligned u32s).
+     */
+    const char* lookup(uint32_t fingerprint, uint32_t& count) const;
+
+    /**
+     * @brief Validates the header and sets up the section pointers.
+     * @return False if the bytes are not a valid index.
+     */
+    bool attach();
+};
+
+} // namespace spell
@@ -0,0 +1,101 @@
+#pragma once
+
+/**
+  ******************************************************************************
+  * @file           : synonyms.h
+  * @brief          : Groups of interchangeable query terms.
+  ******************************************************************************
+
+  A query term that belongs to a group is expanded into a SYNONYM node over
+  every member of the group, and the members are scored as one pseudo-term.
+  The posting lists of frequently queried groups can be merged ahead of time
+  into one index key, mergedTerm(group), so such a term costs one read.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace synonyms {
+
+/** Prefix of the index keys holding merged synonym lists; tokens never contain '#'. */
+constexpr std::string_view MERGED_TERM_PREFIX = "#syn:";
+
+/** Group id of a term that has no synonyms. */
+constexpr uint32_t NO_GROUP = UINT32_MAX;
+
+/**
+ * @class SynonymDictionary
+ * @brief Term to synonym group lookup.
+ */
+class SynonymDictionary {
+public:
+    SynonymDictionary() = default;
+
+    /**
+     * @brief Adds a group of interchangeable terms.
+     *
+     * Terms must be normalized like query tokens (tokenized and stemmed).
+     * A term already in a group stays there; a group left with fewer than
+     * two terms is ignored.
+     * @param terms The terms of the group.
+     */
+    void addGroup(const std::vector<std::string>& terms);
+
+    /**
+     * @brief Loads one group per line, terms separated by commas.
+     *
+     * Terms are normalized like query tokens, so "Car, automobiles" and
+     * "car, automobile" are the same group. Entries of several words are
+     * skipped.
+     * @param path The synonyms file.
+     * @throws std::runtime_error if the file cannot be read.
+     */
+    static SynonymDictionary load(const std::string& path);
+
+    /**
+     * @param term A normalized query term.
+     * @return The term's group, or NO_GROUP.
+     */
+    uint32_t groupOf(std::string_view term) const;
+
+    /**
+     * @param group A group id (< size()).
+     * @return The terms of the group, sorted.
+     */
+    const std::vector<std::string>& members(uint32_t group) const { return groups[group]; }
+
+    /**
+     * @brief Index key of the group's merged posting list.
+     *
+     * Built from every member, so a key written for an older version of the
+     * group is not found and the members are read one by one instead.
+     * @param group A group id (< size()).
+     * @return e.g. "#syn:auto,automobil,car"
+     */
+    std::string mergedTerm(uint32_t group) const;
+
+    /**
+     * @brief Ranks groups by how many queries of a log contain one of their terms.
+     *
+     * The groups worth a merged posting list.
+     * @param queries Raw query strings, normalized like queries are.
+     * @param limit Number of groups to return.
+     * @return Up to @a limit groups, most queried first.
+     */
+    std::vector<uint32_t> mostQueried(const std::vector<std::string>& queries, size_t limit) const;
+
+    /**
+     * @brief Number of groups.
+     */
+    size_t size() const { return groups.size(); }
+
+private:
+    std::vector<std::vector<std::string>> groups;
+    std::unordered_map<std::string, uint32_t> index;
+};
+
+} // namespace synonyms
@@ -0,0 +1,66 @@
+#pragma once
+
+/**
+  ******************************************************************************
+  * @file           : tokenizer.h
+  * @brief          : Single-pass tokenizer shared by queries and documents.
+  ******************************************************************************
+*/
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tokenizer {
+
+/**
+ * @class TokenBuffer
+ * @brief Reusable output of tokenize().
+ *
+ * Tokens are views into the buffer's own normalized copy of the text, so
+ * they stay valid until the buffer is tokenized into again. Reusing one
+ * buffer keeps its storage, so steady-state tokenizing does not allocate.
+ */
+class TokenBuffer {
+public:
+    TokenBuffer() = default;
+
+    // Tokens point into 'text'; copying would leave them dangling.
+    TokenBuffer(const TokenBuffer&) = delete;
+    TokenBuffer& operator=(const TokenBuffer&) = delete;
+
+    const std::vector<std::string_view>& tokens() const { return views; }
+    size_t size() const { return views.size(); }
+    bool empty() const { return views.empty(); }
+    std::string_view operator[](size_t index) const { return views[index]; }
+    std::vector<std::string_view>::const_iterator begin() const { return views.begin(); }
+    std::vector<std::string_view>::const_iterator end() const { return views.end(); }
+
+private:
+    friend void tokenize(std::string_view text, TokenBuffer& buffer, bool keepOperators);
+
+    std::string text;
+    std::vector<std::string_view> views;
+};
+
+/**
+ * @brief Splits text into normalized tokens.
+ *
+ * Tokens are separated by whitespace. Within a token ASCII letters are
+ * lowercased and ASCII punctuation is removed; tokens left empty are
+ * dropped. ASCII runs are classified 16 bytes at a time with SSE2 where
+ * available. Non-ASCII input is decoded as UTF-8: letters of other scripts
+ * are kept, Latin-1 capitals are lowercased, Unicode spaces separate
+ * tokens, common Unicode punctuation is removed, and malformed bytes are
+ * dropped.
+ *
+ * @param text The text to split.
+ * @param buffer Receives the tokens, replacing its previous contents.
+ * @param keepOperators Keep the query term operators: '*' inside tokens
+ *        ("comput*") and a fuzzy suffix '~' plus one digit ending a token
+ *        ("colour~1"); tokens made only of operators are dropped, and any
+ *        other '~' is removed like punctuation.
+ */
+void tokenize(std::string_view text, TokenBuffer& buffer, bool keepOperators = false);
+
+} // namespace tokenizer
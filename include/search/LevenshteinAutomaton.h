@@ -0,0 +1,67 @@
+#pragma once
+
+/**
+ * @file  LevenshteinAutomaton.h
+ * @brief Automaton accepting every string within an edit distance of a term
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Ranking {
+
+/**
+ * A state is one row of the edit distance table against the query term: entry
+ * j is the distance between the characters consumed so far and the term's
+ * first j characters, capped at max_distance + 1. Rows are stored by the
+ * caller, so walking a sorted dictionary can keep one row per prefix depth
+ * and reuse the rows of a prefix shared with the previous term.
+ */
+class LevenshteinAutomaton {
+public:
+    /**
+     * @param term Term to match against
+     * @param max_distance Largest accepted edit distance
+     */
+    LevenshteinAutomaton(std::string_view term, int max_distance);
+
+    // Number of entries in a state row.
+    size_t row_size() const { return term.size() + 1; }
+
+    int max_distance() const { return k; }
+
+    /**
+     * @brief Write the start state (nothing consumed) into @a row
+     */
+    void start(uint8_t* row) const;
+
+    /**
+     * @brief Consume one character
+     * @param from Current state
+     * @param c Character consumed
+     * @param to Next state
+     * @return Whether any extension of the consumed string can still be accepted
+     */
+    bool step(const uint8_t* from, char c, uint8_t* to) const;
+
+    /**
+     * @brief Smallest character that keeps a state alive
+     * @param row Current state
+     * @param after Only characters greater than this (as unsigned char) are considered
+     * @return The character as unsigned char, or -1 if there is none
+     */
+    int next_live_char(const uint8_t* row, unsigned char after) const;
+
+    /**
+     * @return Edit distance of the consumed string if accepted, max_distance + 1 otherwise
+     */
+    int distance(const uint8_t* row) const { return row[term.size()]; }
+
+private:
+    std::string term;
+    int k;
+};
+
+}
@@ -8,6 +8,7 @@
 #include "types.h"
 #include "SearchResult.h"
 
+#include <memory_resource>
 #include <vector>
 #include <algorithm>
 
@@ -21,9 +22,15 @@ class MatchingDocs {
 public:
     MatchingDocs() {}
 
+    /**
+     * @param resource Memory for the results, e.g. a per-request arena.
+     */
+    explicit MatchingDocs(std::pmr::memory_resource* resource) : results(resource) {}
+
     // Temporary Functions
     void add_result(const SearchResult& sr) { results.push_back(sr); }
-    const std::vector<SearchResult>& get_all_results() const { return results; }
+    void reserve(size_t n) { results.reserve(n); }
+    const std::pmr::vector<SearchResult>& get_all_results() const { return results; }
 
     // Returns the number of search results in the collection.
     unsigned int size() const { return (unsigned int) results.size(); }
@@ -32,7 +39,7 @@ public:
     bool empty() const { return size() == 0; }
 
 private:
-    std::vector<SearchResult> results;
+    std::pmr::vector<SearchResult> results;
 };
 
 }
\ No newline at end of file
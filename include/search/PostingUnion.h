@@ -0,0 +1,37 @@
+#pragma once
+
+/**
+ * @file  PostingUnion.h
+ * @brief Merging the posting lists of several terms into one pseudo-term
+ */
+
+#include "index/IDatabase.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace Ranking {
+
+/** Up to this many lists are merged with a heap; more go through a dense accumulator. */
+constexpr size_t HEAP_UNION_MAX_LISTS = 16;
+
+/** The accumulator is used only while the largest docId is under this many times the postings. */
+constexpr size_t ACCUMULATOR_MAX_SPREAD = 8;
+
+/**
+ * @brief Union posting lists, summing the priorities of shared documents
+ *
+ * @param lists Posting lists in any order (may be reordered)
+ * @return One entry per document, ordered by docId
+ */
+std::vector<Data> union_postings(std::vector<std::vector<Data>>& lists);
+
+/**
+ * @brief union_postings() of lists already ordered by docId, read in place
+ *
+ * @param lists Posting lists, each ordered by docId
+ * @return One entry per document, ordered by docId
+ */
+std::vector<Data> union_sorted_postings(const std::vector<const std::vector<Data>*>& lists);
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+/**
+ * @file  QueryArena.h
+ * @brief Per-request memory for the transient structures of a search
+ */
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+namespace Ranking {
+
+/** Size of the first block a QueryArena allocates. */
+constexpr size_t DEFAULT_ARENA_BLOCK_SIZE = 64 * 1024;
+
+/** Memory a QueryArena keeps across reset() for the next request. */
+constexpr size_t DEFAULT_ARENA_RETAINED_SIZE = 4 * 1024 * 1024;
+
+/**
+ * @class QueryArena
+ * @brief Monotonic memory resource that is rewound, not freed, between requests
+ *
+ * Everything one request builds - tokens, query tree nodes, posting lists,
+ * scores and results - is allocated from the arena and released all at once
+ * by reset(). Blocks are kept for the next request, so once a worker has
+ * served a query of a given shape, serving it again touches no global heap.
+ *
+ * Deallocation is a no-op, and a QueryArena must only be used by one thread.
+ * Anything allocated from it must be destroyed before reset().
+ */
+class QueryArena : public std::pmr::memory_resource {
+public:
+    /**
+     * @param block_size Size of the first block; later blocks double.
+     * @param retained_size Blocks beyond this total are freed by reset().
+     */
+    explicit QueryArena(size_t block_size = DEFAULT_ARENA_BLOCK_SIZE,
+                        size_t retained_size = DEFAULT_ARENA_RETAINED_SIZE);
+    ~QueryArena() override;
+
+    // Disable Copy Constructor/Assignment Operator
+    QueryArena(const QueryArena&) = delete;
+    QueryArena& operator=(const QueryArena&) = delete;
+
+    /**
+     * @brief Make all memory available again for the next request
+     */
+    void reset();
+
+    // Bytes handed out since the last reset(), including alignment padding.
+    size_t used() const { return used_bytes; }
+
+    // Bytes held in blocks.
+    size_t capacity() const { return capacity_bytes; }
+
+    /**
+     * @return The calling thread's arena, created on first use
+     */
+    static QueryArena& for_thread();
+
+private:
+    struct Block {
+        char* data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t current = 0;       // block being allocated from
+    size_t offset = 0;        // first free byte in blocks[current]
+    size_t used_bytes = 0;
+    size_t capacity_bytes = 0;
+    size_t block_size;
+    size_t retained_size;
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+}
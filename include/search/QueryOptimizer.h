@@ -0,0 +1,118 @@
+#pragma once
+
+/**
+ * @file  QueryOptimizer.h
+ * @brief Cost-based planning of which posting lists a query scans and how
+ */
+
+#include "search/query.h"
+
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+
+namespace Ranking {
+
+/** Terms in more than this fraction of the collection are common terms. */
+constexpr double DEFAULT_COMMON_TERM_RATIO = 0.5;
+
+/**
+ * @brief A resolved query term as the plan evaluates it
+ */
+struct PlannedTerm {
+    uint32_t id;       // lexicon term id
+    uint32_t df;       // document frequency, i.e. length of the posting list
+    double weight;     // multiplier on the term's score (repeats add up; 0 if dropped)
+};
+
+/**
+ * @class QueryPlan
+ * @brief The posting lists a query scans, in scan order, and how they are combined
+ *
+ * Only the resolved terms of a Query are planned; its text, wildcard,
+ * fuzzy and synonym terms are always scored disjunctively as before.
+ */
+class QueryPlan {
+public:
+    /**
+     * @param resource Memory for the terms, e.g. a per-request arena.
+     */
+    explicit QueryPlan(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : scanned(resource), skipped(resource) {}
+
+    /**
+     * @brief The unoptimized plan: every resolved term in query order, scored disjunctively
+     *
+     * @param resource Memory for the terms, e.g. a per-request arena.
+     */
+    explicit QueryPlan(const Query& query,
+                       std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    // Terms whose posting lists are fetched and scored, in that order.
+    const std::pmr::vector<PlannedTerm>& terms() const { return scanned; }
+
+    // Terms left out because they are too common to affect the ranking.
+    const std::pmr::vector<PlannedTerm>& dropped() const { return skipped; }
+
+    // Estimated postings read by this plan.
+    uint64_t estimated_cost() const;
+
+    // Postings the unoptimized plan would read.
+    uint64_t unoptimized_cost() const;
+
+    /**
+     * @return One line for logging, e.g. "terms=[7:12 3:40x2] dropped=[9:900] cost=92/992"
+     */
+    std::string describe() const;
+
+private:
+    friend class QueryOptimizer;
+
+    std::pmr::vector<PlannedTerm> scanned;
+    std::pmr::vector<PlannedTerm> skipped;
+};
+
+/**
+ * @class QueryOptimizer
+ * @brief Plans a query from the document frequencies of its terms
+ *
+ * Runs between query processing and Searcher::Search. The plan
+ *   - scans one list per distinct term, rarest first;
+ *   - drops (or down-weights) terms in more than a ratio of the collection,
+ *     unless every term is that common.
+ *
+ * Documents are always scored disjunctively: posting lists can only be
+ * read whole, so matching every term first would read no fewer postings.
+ */
+class QueryOptimizer {
+public:
+    /**
+     * @param collection_size Number of documents in the index.
+     */
+    explicit QueryOptimizer(uint32_t collection_size) : collection_size(collection_size) {}
+
+    /**
+     *  @brief Terms in more than this fraction of the collection are treated as common.
+     */
+    void set_common_term_ratio(double ratio) { common_term_ratio = ratio; }
+
+    /**
+     *  @brief Weight given to common terms; 0 (the default) drops them from the scan.
+     */
+    void set_common_term_weight(double weight) { common_term_weight = weight; }
+
+    /**
+     * @param query Query whose terms were resolved against the lexicon.
+     * @param resource Memory for the plan, e.g. a per-request arena.
+     * @return The plan to pass to Searcher::Search.
+     */
+    QueryPlan optimize(const Query& query,
+                       std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+
+private:
+    uint32_t collection_size;
+    double common_term_ratio = DEFAULT_COMMON_TERM_RATIO;
+    double common_term_weight = 0.0;
+};
+
+}
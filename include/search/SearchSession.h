@@ -0,0 +1,215 @@
+#pragma once
+
+/**
+ * @file  SearchSession.h
+ * @brief Search-as-you-type: incremental evaluation of a query being typed
+ */
+
+#include "types.h"
+#include "index/IDatabase.h"
+#include "index/Lexicon.h"
+#include "query-processing/queryResources.h"
+#include "search/MatchingDocs.h"
+#include "search/TermExpansion.h"
+#include "search/weight.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Ranking {
+
+/** Default number of clients whose sessions are kept. */
+constexpr size_t DEFAULT_MAX_SESSIONS = 10000;
+
+/** Default number of postings one session keeps between keystrokes (8 bytes each). */
+constexpr size_t DEFAULT_MAX_SESSION_POSTINGS = 1 << 20;
+
+/** Default number of postings all sessions of a SessionManager keep together. */
+constexpr size_t DEFAULT_MAX_CACHED_POSTINGS = 1 << 23;
+
+/**
+ * @class SearchSession
+ * @brief The query one client is typing, evaluated keystroke by keystroke
+ *
+ * The text up to the last space is complete: it is processed like any
+ * query (processQuery, then resolveTerms) and scored as its terms and
+ * wildcards. The word being typed after it is matched as a prefix, i.e. as
+ * the wildcard "word*". Results are the same as Searcher::Search of that
+ * query, but each keystroke only evaluates what changed:
+ *   - while the complete text is unchanged, its parse and scores are reused;
+ *   - a word added to it only adds the scores of its new terms;
+ *   - a longer prefix narrows the previous prefix's expansions instead of
+ *     walking the lexicon again;
+ *   - posting lists already read are not read again.
+ * Editing the complete text (e.g. backspace over a space) rescores it from
+ * the lists it still has. Updates of one session are serialized.
+ *
+ * What is kept between keystrokes is bounded by set_max_cached_postings():
+ * once the results are ranked, a session over its budget drops the lists of
+ * the prefix's terms, then the other lists, then the prefix's merged list
+ * and finally the complete text's scores, and rebuilds them when needed.
+ */
+class SearchSession {
+public:
+    // Disable default constructor
+    SearchSession() = delete;
+
+    /**
+     * @param db The database to search.
+     * @param weight The weighting scheme to use for ranking results.
+     * @param lexicon Term dictionary the query terms are resolved against.
+     * @param resources Dictionary, spelling corrector and phrases for query processing.
+     */
+    SearchSession(std::shared_ptr<IDatabase> db, std::shared_ptr<const Weight> weight,
+                  std::shared_ptr<const Lexicon> lexicon, std::shared_ptr<const query::QueryResources> resources)
+            : db(db), weight_scheme(weight), lexicon(lexicon), resources(resources) {}
+
+    // Disable Copy Constructor/Assignment Operator
+    SearchSession(const SearchSession&) = delete;
+    SearchSession& operator=(const SearchSession&) = delete;
+
+    /**
+     *  @brief Limit how many dictionary terms the prefix being typed expands to.
+     */
+    void set_max_expansions(size_t n) { max_expansions = n; }
+
+    /**
+     *  @brief Limit how many postings (and scored documents) are kept between keystrokes.
+     */
+    void set_max_cached_postings(size_t n) { max_cached = n; }
+
+    /**
+     *  @brief Evaluate the query as typed so far.
+     *  @param text Raw query text, e.g. "ski res".
+     *  @param max_items Maximum number of documents to return.
+     *  @return Ordered list of documents that match the text.
+     */
+    MatchingDocs update(const std::string& text, unsigned int max_items);
+
+    // Posting lists read from the database by this session so far.
+    size_t lists_read() const { return reads; }
+
+    // Postings and scored documents kept for the next keystroke.
+    size_t cached_postings() const;
+
+private:
+    // A posting list scored for the complete text: a term (keyed by its
+    // text) or a wildcard (keyed by its pattern, scored as one list).
+    struct Unit {
+        std::string key;
+        uint32_t df;
+    };
+
+    std::shared_ptr<IDatabase> db;
+    std::shared_ptr<const Weight> weight_scheme;
+    std::shared_ptr<const Lexicon> lexicon;
+    std::shared_ptr<const query::QueryResources> resources;
+    size_t max_expansions = DEFAULT_MAX_EXPANSIONS;
+    size_t max_cached = DEFAULT_MAX_SESSION_POSTINGS;
+
+    mutable std::mutex mutex;
+
+    std::string complete_text;                      // text before the word being typed
+    std::vector<Unit> units;                        // its terms and wildcards
+    std::unordered_map<int, double> complete_scores; // mdocs[docid] = score of the complete text
+
+    std::string prefix;                             // normalized word being typed
+    std::vector<std::string> expansions;            // dictionary terms starting with it
+    bool expansions_complete = false;               // false if capped at max_expansions
+    std::vector<Data> prefix_postings;              // union of their lists, by docId
+
+    std::unordered_map<std::string, std::vector<Data>> lists; // lists read, by key, each by docId
+    size_t reads = 0;
+
+    // Read the lists of keys not read yet, in one batch.
+    void fetch(const std::vector<std::string>& keys);
+
+    // Re-evaluate the complete text if it changed.
+    void update_complete(const std::string& text);
+
+    // Re-expand the prefix if it changed.
+    void update_prefix(const std::string& word);
+
+    // Add the scores of a unit to the complete text's scores.
+    void add_unit(const Unit& unit);
+
+    // cached_postings() with the mutex held.
+    size_t count_postings() const;
+
+    // Drop cached state until it is within max_cached.
+    void trim();
+};
+
+/**
+ * @class SessionManager
+ * @brief Search sessions by client token, the least recently used evicted first
+ *
+ * Sessions are evicted both beyond max_sessions and while the postings they
+ * cache together exceed max_postings; each session's own budget is at most
+ * max_postings, so the session just typed in always fits.
+ */
+class SessionManager {
+public:
+    /**
+     * @param db The database to search.
+     * @param weight The weighting scheme to use for ranking results.
+     * @param lexicon Term dictionary the query terms are resolved against.
+     * @param resources Dictionary, spelling corrector and phrases for query processing.
+     * @param max_sessions Number of clients whose sessions are kept.
+     * @param max_postings Number of postings all sessions keep together.
+     */
+    SessionManager(std::shared_ptr<IDatabase> db, std::shared_ptr<const Weight> weight,
+                   std::shared_ptr<const Lexicon> lexicon, std::shared_ptr<const query::QueryResources> resources,
+                   size_t max_sessions = DEFAULT_MAX_SESSIONS, size_t max_postings = DEFAULT_MAX_CACHED_POSTINGS)
+            : db(db), weight_scheme(weight), lexicon(lexicon), resources(resources), max_sessions(max_sessions),
+              max_postings(max_postings) {}
+
+    /**
+     *  @brief Evaluate what a client has typed so far, in the client's session.
+     *  @param client Token identifying the client, e.g. from a cookie.
+     *  @param text Raw query text.
+     *  @param max_items Maximum number of documents to return.
+     *  @return Ordered list of documents that match the text.
+     */
+    MatchingDocs type(const std::string& client, const std::string& text, unsigned int max_items);
+
+    /**
+     *  @brief Drop a client's session, e.g. once the query is submitted.
+     */
+    void end(const std::string& client);
+
+    /**
+     *  @brief Postings cached by all sessions, as of their last update.
+     */
+    size_t cached_postings() const;
+
+private:
+    struct Entry {
+        std::string client;
+        std::shared_ptr<SearchSession> session;
+        size_t postings;
+    };
+
+    std::shared_ptr<IDatabase> db;
+    std::shared_ptr<const Weight> weight_scheme;
+    std::shared_ptr<const Lexicon> lexicon;
+    std::shared_ptr<const query::QueryResources> resources;
+    size_t max_sessions;
+    size_t max_postings;
+
+    mutable std::mutex mutex;
+    std::list<Entry> sessions;  // most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    size_t postings = 0;
+
+    // Evict least recently used sessions until within both limits.
+    void evict();
+};
+
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+/**
+ * @file  SynonymPostings.h
+ * @brief Pre-merged posting lists of synonym groups
+ */
+
+#include "index/IDatabase.h"
+#include "query-processing/synonyms.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Ranking {
+
+/**
+ * @brief Store the union of each group's posting lists under the group's merged term
+ *
+ * A synonym query term then costs one read instead of one per member, with
+ * the same scores: the stored list is what the searcher would merge itself.
+ * Existing lists under the merged terms are replaced. The lexicon must be
+ * rebuilt afterwards for queries to find the new keys.
+ *
+ * The merged lists are a snapshot: later adds and removes of member
+ * postings do not reach them, so run this again (tools/merge_synonyms)
+ * after every ingest, before the lexicon is rebuilt.
+ *
+ * @param db Inverted index to read the members from and write the merged lists to.
+ * @param dictionary The synonym groups.
+ * @param groups Groups to merge, e.g. SynonymDictionary::mostQueried.
+ * @return Number of postings written.
+ */
+size_t merge_synonym_postings(IDatabase& db, const synonyms::SynonymDictionary& dictionary,
+                              const std::vector<uint32_t>& groups);
+
+}
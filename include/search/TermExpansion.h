@@ -0,0 +1,77 @@
+#pragma once
+
+/**
+ * @file  TermExpansion.h
+ * @brief Expansion of wildcard and fuzzy query terms against the term dictionary
+ */
+
+#include "index/Lexicon.h"
+#include "query-processing/queryTree.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Ranking {
+
+/** Default cap on the number of terms one wildcard or fuzzy term expands to. */
+constexpr size_t DEFAULT_MAX_EXPANSIONS = 1000;
+
+/** Cap on the postings read from one posting list. */
+constexpr size_t MAX_LIST_POSTINGS = 100000;
+
+/** Largest edit distance accepted for fuzzy terms, as in the query syntax. */
+constexpr int MAX_FUZZY_DISTANCE = queryTree::MAX_FUZZY_DISTANCE;
+
+/**
+ * @brief A dictionary term within the edit distance of a fuzzy term
+ */
+struct FuzzyMatch {
+    uint32_t id;        // lexicon term id
+    int distance;       // edit distance to the fuzzy term
+    std::string term;
+};
+
+/**
+ * @param pattern Wildcard pattern, e.g. "comput*" or "c*t"
+ * @param term Term to test
+ * @return Whether the pattern matches the whole term
+ */
+bool wildcard_match(std::string_view pattern, std::string_view term);
+
+/**
+ * @brief Find the dictionary terms matching a wildcard pattern
+ *
+ * Only the terms sharing the pattern's literal prefix are scanned. When more
+ * than @a max_expansions terms match, the ones with the highest document
+ * frequency are kept.
+ *
+ * @param lexicon Term dictionary
+ * @param pattern Wildcard pattern
+ * @param max_expansions Maximum number of terms returned
+ * @return Matching terms in dictionary order
+ */
+std::vector<std::string> expand_wildcard(const Lexicon& lexicon, std::string_view pattern,
+                                         size_t max_expansions = DEFAULT_MAX_EXPANSIONS);
+
+/**
+ * @brief Find the dictionary terms within an edit distance of a term
+ *
+ * Intersects a Levenshtein automaton with the sorted dictionary. Terms reuse
+ * the automaton states of the prefix they share with the previous term, and
+ * once a prefix cannot be extended to a match the walk seeks straight to the
+ * next prefix that can.
+ *
+ * @param lexicon Term dictionary
+ * @param term Fuzzy term
+ * @param max_distance Largest edit distance accepted, 0 to MAX_FUZZY_DISTANCE
+ * @param max_expansions Maximum number of terms returned
+ * @return The closest matches, by distance and then by descending document frequency
+ * @throws std::invalid_argument if max_distance is out of range
+ */
+std::vector<FuzzyMatch> expand_fuzzy(const Lexicon& lexicon, std::string_view term, int max_distance,
+                                     size_t max_expansions = DEFAULT_MAX_EXPANSIONS);
+
+}
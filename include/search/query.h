@@ -5,24 +5,87 @@
  * @brief Query Class
 */
 
+#include <cstdint>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 
+namespace queryTree {
+class QueryTree;
+}
+
 namespace Ranking {
 
+// A term matching every dictionary term within an edit distance
+struct FuzzyTerm {
+    std::pmr::string term;
+    int max_distance;
+};
+
+// A term resolved against the index term dictionary
+struct QueryTerm {
+    uint32_t id;    // lexicon term id
+    uint32_t df;    // document frequency
+};
+
 // Class representing a query
 class Query {
 public:
 
-    Query() {}
+    Query() : Query(std::pmr::get_default_resource()) {}
+
+    /**
+     * @param resource Memory for the terms, e.g. a per-request arena.
+     */
+    explicit Query(std::pmr::memory_resource* resource)
+            : query(resource), resolved(resource), wildcard_terms(resource), synonym_groups(resource),
+              fuzzy(resource) {}
+
+    /**
+     * @brief Build a query from a parsed tree whose terms were resolved
+     *        with QueryTree::resolveTerms
+     *
+     * Term nodes become term ids, wildcard nodes become wildcards, fuzzy
+     * nodes ("colour~1") become fuzzy terms, and terms missing from the
+     * dictionary are left out. A synonym node becomes the
+     * term id of its merged posting list if the index has one, and a
+     * synonym group of its terms otherwise.
+     *
+     * @param resource Memory for the terms, e.g. a per-request arena.
+     */
+    static Query from_tree(const queryTree::QueryTree& tree,
+                           std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
     // Temporary functions while implementation is not concrete
-    std::vector<std::string> terms() const { return query; }
-    void addTerm(std::string term) { query.push_back(term); }
+    const std::pmr::vector<std::pmr::string>& terms() const { return query; }
+    void addTerm(std::string_view term) { query.emplace_back(term); }
+
+    // Terms resolved to lexicon ids, fetched without re-parsing or re-hashing the text
+    const std::pmr::vector<QueryTerm>& term_ids() const { return resolved; }
+    void addTerm(uint32_t id, uint32_t df) { resolved.push_back({id, df}); }
+
+    // Wildcard terms (e.g. "comput*"), each scored as one pseudo-term
+    const std::pmr::vector<std::pmr::string>& wildcards() const { return wildcard_terms; }
+    void addWildcard(std::string_view pattern) { wildcard_terms.emplace_back(pattern); }
+
+    // Synonym groups without a merged posting list, each scored as one pseudo-term
+    const std::pmr::vector<std::pmr::vector<std::pmr::string>>& synonyms() const { return synonym_groups; }
+    void addSynonym(std::pmr::vector<std::pmr::string> terms) { synonym_groups.push_back(std::move(terms)); }
+
+    // Fuzzy terms, each scored as one pseudo-term like a wildcard
+    const std::pmr::vector<FuzzyTerm>& fuzzy_terms() const { return fuzzy; }
+    void addFuzzy(std::string_view term, int max_distance) {
+        fuzzy.push_back({std::pmr::string(term, fuzzy.get_allocator()), max_distance});
+    }
 
 private:
-    std::vector<std::string> query;
+    std::pmr::vector<std::pmr::string> query;
+    std::pmr::vector<QueryTerm> resolved;
+    std::pmr::vector<std::pmr::string> wildcard_terms;
+    std::pmr::vector<std::pmr::vector<std::pmr::string>> synonym_groups;
+    std::pmr::vector<FuzzyTerm> fuzzy;
 
 };
 
-}
\ No newline at end of file
+}
@@ -7,16 +7,28 @@
 
 #include "types.h"
 #include "index/IDatabase.h"
+#include "index/Lexicon.h"
 #include "query.h"
+#include "search/TermExpansion.h"
 #include "search/weight.h"
 #include "search/MatchingDocs.h"
+#include "search/QueryOptimizer.h"
 
 #include <vector>
 #include <string>
 #include <memory>
+#include <memory_resource>
 
 namespace Ranking {
 
+/**
+ *  @brief Score of one posting of a term with the given document frequency.
+ *
+ *  Every evaluation path (Searcher, SearchSession) scores postings with it,
+ *  so they rank documents alike.
+ */
+double posting_score(const Weight& weight, int term_freq, unsigned int doc_freq);
+
 /**
  *  A Searcher object represents a querying session - most of the options for
  *  running a query can be set on it, and the query is run via Searcher::Search().
@@ -33,6 +45,20 @@ public:
     Searcher(std::shared_ptr<IDatabase> db, std::shared_ptr<Weight> weight) 
             : db(db), weight_scheme(weight) {}
 
+    /** 
+     * @param db The database to search.
+     * @param weight The weighting scheme to use for ranking results.
+     * @param lexicon Term dictionary used to expand wildcard and fuzzy terms.
+     */
+    Searcher(std::shared_ptr<IDatabase> db, std::shared_ptr<Weight> weight,
+             std::shared_ptr<const Lexicon> lexicon)
+            : db(db), weight_scheme(weight), lexicon(lexicon) {}
+
+    /**
+     *  @brief Limit how many dictionary terms a single wildcard or fuzzy term expands to.
+     */
+    void set_max_expansions(size_t n) { max_expansions = n; }
+
     /**
      *  @brief Search database using query and any other internal settings.
      *  @param query Query used to search database.
@@ -41,12 +67,46 @@ public:
      */
     MatchingDocs Search(const Query& query, unsigned int max_items);
 
+    /**
+     *  @brief Search() with every transient structure allocated from @a resource.
+     *
+     *  Posting lists, scores and the returned results live in @a resource,
+     *  e.g. the worker's QueryArena, and must be used before it is reset.
+     *  Wildcard and fuzzy expansions still use the global heap.
+     *
+     *  @param query Query used to search database.
+     *  @param max_items Maximum number of documents to return.
+     *  @param resource Memory for postings, scores and results.
+     *  @return Ordered list of documents that match query.
+     */
+    MatchingDocs Search(const Query& query, unsigned int max_items, std::pmr::memory_resource* resource);
+
+    /**
+     *  @brief Search() following a plan made by QueryOptimizer.
+     *
+     *  The resolved terms of @a query are scanned as the plan says; its text,
+     *  wildcard, fuzzy and synonym terms are scored as in Search().
+     *
+     *  @param query Query used to search database.
+     *  @param plan Plan for the resolved terms of @a query.
+     *  @param max_items Maximum number of documents to return.
+     *  @param resource Memory for postings, scores and results.
+     *  @return Ordered list of documents that match query.
+     */
+    MatchingDocs Search(const Query& query, const QueryPlan& plan, unsigned int max_items,
+                        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
 
 private:
     std::shared_ptr<IDatabase> db;
     std::shared_ptr<Weight> weight_scheme;
+    std::shared_ptr<const Lexicon> lexicon; // null: wildcard and fuzzy terms match nothing
     
     // Configuration Settings Here as needed
+    size_t max_expansions = DEFAULT_MAX_EXPANSIONS;
+
+    // Fetch the expansions of one wildcard, fuzzy or synonym term as a single merged posting list.
+    std::vector<Data> fetch_expansions(const std::vector<std::string>& expansions);
     // double time_limit;
 };
 
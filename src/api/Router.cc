@@ -1,7 +1,15 @@
 #include "api/Router.h" 
 
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
 namespace SearchRPI {
-    void Router::setupRoutes(crow::SimpleApp& app){
+    void Router::setupRoutes(crow::SimpleApp& app, std::shared_ptr<const completion::CompletionTrie> completions){
         //get search results
         CROW_ROUTE(app, "/search").methods(crow::HTTPMethod::GET)([](const crow::request& req){
             auto query_params = crow::query_string(req.url_params);
@@ -32,6 +40,32 @@ namespace SearchRPI {
             return crow::response(200, response);
         });
         
+        // Get query completions for what the user has typed so far
+        CROW_ROUTE(app, "/suggest").methods(crow::HTTPMethod::GET)([completions](const crow::request& req){
+            if (!completions) return crow::response(503);
+            auto query_params = crow::query_string(req.url_params);
+
+            std::string prefix = query_params.get("prefix") ? query_params.get("prefix") : "";
+            uint32_t limit = completion::DEFAULT_TOP_K;
+            if (const char* param = query_params.get("limit")) {
+                std::string_view text(param);
+                auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), limit);
+                // Too large a limit is left at the default, like any limit above it.
+                if (ec == std::errc::invalid_argument || end != text.data() + text.size()) return crow::response(400);
+                limit = std::min(limit, completion::DEFAULT_TOP_K);
+            }
+
+            std::vector<crow::json::wvalue> suggestions;
+            for (const completion::Suggestion& suggestion : completions->suggest(prefix, limit)) {
+                suggestions.emplace_back(std::string(suggestion.text));
+            }
+
+            crow::json::wvalue response;
+            response["prefix"] = prefix;
+            response["suggestions"] = std::move(suggestions);
+            return crow::response(200, response);
+        });
+
         // Get the logo for a specific document
         CROW_ROUTE(app, "/favicon/<int>").methods(crow::HTTPMethod::GET)([](const crow::request& req, int docid){
             crow::response res;
@@ -1,10 +1,20 @@
 #include "api/Server.h"
 #include "api/Router.h"
 
+#include <memory>
+#include <utility>
+
 namespace SearchRPI {
+    Server::Server(std::string completionsPath) : completionsPath_(std::move(completionsPath)) {}
+
     void Server::start() {
+        std::shared_ptr<const completion::CompletionTrie> completions;
+        if (!completionsPath_.empty()) {
+            completions = std::make_shared<const completion::CompletionTrie>(completionsPath_);
+        }
+
         crow::SimpleApp app;
-        Router::setupRoutes(app);
+        Router::setupRoutes(app, std::move(completions));
         app.port(8080).multithreaded().run();
     }   
 }
\ No newline at end of file
@@ -0,0 +1,36 @@
+#include "index/BlockCache.h"
+
+std::shared_ptr<const std::string> BlockCache::get(uint32_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(id);
+    if (it == index_.end())
+        return nullptr;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->second;
+}
+
+void BlockCache::put(uint32_t id, std::shared_ptr<const std::string> block) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(id);
+    if (it != index_.end()) {
+        bytes_ -= it->second->second->size();
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    bytes_ += block->size();
+    lru_.emplace_front(id, std::move(block));
+    index_[id] = lru_.begin();
+
+    // Always keep the newest block, even if it alone exceeds the capacity.
+    while (bytes_ > capacity_ && lru_.size() > 1) {
+        bytes_ -= lru_.back().second->size();
+        index_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+}
+
+size_t BlockCache::bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_;
+}
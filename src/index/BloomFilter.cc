@@ -0,0 +1,64 @@
+#include "index/BloomFilter.h"
+
+#include <cstring>
+
+uint64_t bloomHash(std::string_view key) {
+    // FNV-1a over 8-byte words, finished with a 64-bit avalanche mix.
+    const char* p = key.data();
+    size_t n = key.size();
+    uint64_t h = 0xcbf29ce484222325ull ^ n;
+    while (n >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        h = (h ^ word) * 0x100000001b3ull;
+        h ^= h >> 29;
+        p += 8;
+        n -= 8;
+    }
+    while (n > 0) {
+        h = (h ^ static_cast<unsigned char>(*p++)) * 0x100000001b3ull;
+        n--;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+BloomFilter::BloomFilter(size_t expectedKeys, size_t bitsPerKey)
+    : capacity_(expectedKeys) {
+    size_t bits = expectedKeys * bitsPerKey;
+    numBlocks_ = bits / (kWordsPerBlock * 64) + 1;
+    words_.assign(numBlocks_ * kWordsPerBlock, 0);
+}
+
+size_t BloomFilter::blockOf(uint64_t hash) const {
+    // Map the high bits onto [0, numBlocks_) without a division.
+    return static_cast<size_t>(((hash >> 32) * numBlocks_) >> 32);
+}
+
+void BloomFilter::addHash(uint64_t hash) {
+    uint64_t* block = &words_[blockOf(hash) * kWordsPerBlock];
+    uint32_t h = static_cast<uint32_t>(hash);
+    uint32_t delta = (h >> 17) | (h << 15);
+    for (int i = 0; i < kProbes; i++) {
+        uint32_t bit = h & 511;
+        block[bit >> 6] |= uint64_t(1) << (bit & 63);
+        h += delta;
+    }
+}
+
+bool BloomFilter::mayContainHash(uint64_t hash) const {
+    const uint64_t* block = &words_[blockOf(hash) * kWordsPerBlock];
+    uint32_t h = static_cast<uint32_t>(hash);
+    uint32_t delta = (h >> 17) | (h << 15);
+    for (int i = 0; i < kProbes; i++) {
+        uint32_t bit = h & 511;
+        if (!(block[bit >> 6] & (uint64_t(1) << (bit & 63))))
+            return false;
+        h += delta;
+    }
+    return true;
+}
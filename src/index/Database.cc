@@ -1,8 +1,15 @@
 #include "Database.h"
+#include <algorithm>
 #include <cstring>
 #include <iostream>
+#include <limits>
+#include <mutex>
 #include <stdexcept>
 
+// The key filter is sized for twice the stored keys (and at least this many)
+// so it only needs rebuilding after the vocabulary doubles.
+static const size_t MIN_KEY_FILTER_KEYS = 1024;
+
 // Constructor with database path
 Database::Database(const std::string& db_path) {
     // Initialize LMDB environment
@@ -28,6 +35,32 @@ Database::Database(const std::string& db_path) {
 
     // Set custom comparison function
     mdb_set_dupsort(write_txn, dbi, custom_compare);
+
+    rebuild_key_filter();
+}
+
+void Database::rebuild_key_filter() {
+    MDB_cursor* cursor;
+    if (mdb_cursor_open(write_txn, dbi, &cursor) != 0) {
+        throw std::runtime_error("Failed to open LMDB cursor in rebuild_key_filter");
+    }
+
+    // Collect the distinct keys first so the filter can be sized for them.
+    std::vector<std::string> keys;
+    MDB_val mdb_key, mdb_value;
+    int rc = mdb_cursor_get(cursor, &mdb_key, &mdb_value, MDB_FIRST);
+    while (rc == 0) {
+        keys.emplace_back((const char*)mdb_key.mv_data, mdb_key.mv_size);
+        rc = mdb_cursor_get(cursor, &mdb_key, &mdb_value, MDB_NEXT_NODUP);
+    }
+    mdb_cursor_close(cursor);
+
+    key_filter = BloomFilter(std::max(keys.size() * 2, MIN_KEY_FILTER_KEYS));
+    for (const std::string& key : keys) {
+        key_filter.add(key);
+    }
+    key_count = keys.size();
+    removed_keys = 0;
 }
 
 // Destructor to clean up LMDB resources
@@ -86,6 +119,16 @@ void Database::add(const std::string& key, const Data& data) {
     // Ensure transaction commits
     mdb_txn_commit(write_txn);
     mdb_txn_begin(env, nullptr, 0, &write_txn);
+
+    std::unique_lock<std::shared_mutex> lock(key_filter_mutex);
+    if (!key_filter.mayContain(key)) {
+        key_count++;
+        if (key_count > key_filter.capacity()) {
+            rebuild_key_filter();
+            return;
+        }
+    }
+    key_filter.add(key);
 }
 
 // Remove data for a specific key
@@ -110,44 +153,68 @@ void Database::remove(const std::string& key) {
     // Ensure transaction commits
     mdb_txn_commit(write_txn);
     mdb_txn_begin(env, nullptr, 0, &write_txn);
+
+    // Removed keys stay in the filter as false positives until they dominate.
+    std::unique_lock<std::shared_mutex> lock(key_filter_mutex);
+    if (key_count > 0) key_count--;
+    removed_keys++;
+    if (removed_keys > std::max(key_count, MIN_KEY_FILTER_KEYS)) {
+        rebuild_key_filter();
+    }
 }
 
 std::vector<Data> Database::get(const std::string& key) {
-    MDB_txn* txn;
-    if (mdb_txn_begin(env, nullptr, MDB_RDONLY, &txn) != 0) {
-        throw std::runtime_error("Failed to begin read transaction");
-    }
+    return get(key, std::numeric_limits<size_t>::max());
+}
 
-    MDB_cursor* cursor;
-    if (mdb_cursor_open(txn, dbi, &cursor) != 0) {
-        mdb_txn_abort(txn);
-        throw std::runtime_error("Failed to open LMDB cursor");
+std::vector<Data> Database::get(const std::string& key, size_t n) {
+    std::optional<std::vector<Data>> results = find(key, n);
+    if (!results) {
+        throw std::runtime_error("Key not found: " + key);
     }
+    return std::move(*results);
+}
 
-    MDB_val mdb_key, mdb_value;
-    mdb_key.mv_size = key.size();
-    mdb_key.mv_data = (void*)key.c_str();
+std::optional<std::vector<Data>> Database::find(const std::string& key, size_t n) {
+    return std::move(getMany({key}, n)[0]);
+}
 
-    std::vector<Data> results;
-    if (mdb_cursor_get(cursor, &mdb_key, &mdb_value, MDB_SET) == 0) {
-        do {
-            Data data;
-            deserialize_data(mdb_value, data);
-            results.push_back(data);
-        } while (mdb_cursor_get(cursor, &mdb_key, &mdb_value, MDB_NEXT_DUP) == 0);
-    }
+std::vector<std::optional<std::vector<Data>>> Database::getMany(const std::vector<std::string>& keys, size_t n) {
+    std::vector<std::optional<std::vector<Data>>> results(keys.size());
+    read_postings(keys, n, std::pmr::get_default_resource(), [&](size_t i, const Data& data) {
+        if (!results[i]) {
+            results[i].emplace();
+        }
+        results[i]->push_back(data);
+    });
+    return results;
+}
 
-    mdb_cursor_close(cursor);
-    mdb_txn_abort(txn);  // Always abort read-only transactions
+void Database::getManyInto(const std::pmr::vector<std::pmr::string>& keys, size_t n,
+                           std::pmr::vector<std::pmr::vector<Data>>& out) {
+    out.clear();
+    out.resize(keys.size());
+    read_postings(keys, n, out.get_allocator().resource(), [&](size_t i, const Data& data) {
+        out[i].push_back(data);
+    });
+}
 
-    if (results.empty()) {
-        throw std::runtime_error("Key not found: " + key);
+template <typename Keys, typename Emit>
+void Database::read_postings(const Keys& keys, size_t n, std::pmr::memory_resource* scratch, Emit&& emit) {
+    // Keys that were never added need no transaction at all.
+    std::pmr::vector<size_t> candidates(scratch);
+    {
+        std::shared_lock<std::shared_mutex> lock(key_filter_mutex);
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (key_filter.mayContain(keys[i])) {
+                candidates.push_back(i);
+            }
+        }
+    }
+    if (candidates.empty()) {
+        return;
     }
 
-    return results;
-}
-
-std::vector<Data> Database::get(const std::string& key, size_t n) {
     MDB_txn* txn;
     if (mdb_txn_begin(env, nullptr, MDB_RDONLY, &txn) != 0) {
         throw std::runtime_error("Failed to begin read transaction");
@@ -159,30 +226,40 @@ std::vector<Data> Database::get(const std::string& key, size_t n) {
         throw std::runtime_error("Failed to open LMDB cursor");
     }
 
-    MDB_val mdb_key, mdb_value;
-    mdb_key.mv_size = key.size();
-    mdb_key.mv_data = (void*)key.c_str();
-
-    std::vector<Data> results;
-    size_t count = 0;
-
-    if (mdb_cursor_get(cursor, &mdb_key, &mdb_value, MDB_SET) == 0) {
-        do {
-            Data data;
-            deserialize_data(mdb_value, data);
-            results.push_back(data);
-            count++;
-        } while (count < n && mdb_cursor_get(cursor, &mdb_key, &mdb_value, MDB_NEXT_DUP) == 0);
+    // emit() may throw (e.g. bad_alloc), so every error path closes the cursor and txn.
+    try {
+        for (size_t i : candidates) {
+            const auto& key = keys[i];
+            MDB_val mdb_key, mdb_value;
+            mdb_key.mv_size = key.size();
+            mdb_key.mv_data = (void*)key.data();
+
+            size_t count = 0;
+
+            // Only a missing key is an empty list; any other failure is an error.
+            int rc = mdb_cursor_get(cursor, &mdb_key, &mdb_value, MDB_SET);
+            while (rc == 0) {
+                Data data;
+                deserialize_data(mdb_value, data);
+                emit(i, data);
+                count++;
+                if (count >= n) {
+                    break;
+                }
+                rc = mdb_cursor_get(cursor, &mdb_key, &mdb_value, MDB_NEXT_DUP);
+            }
+            if (rc != 0 && rc != MDB_NOTFOUND) {
+                throw std::runtime_error("Failed to read postings from LMDB");
+            }
+        }
+    } catch (...) {
+        mdb_cursor_close(cursor);
+        mdb_txn_abort(txn);
+        throw;
     }
 
     mdb_cursor_close(cursor);
-    mdb_txn_abort(txn);
-
-    if (results.empty()) {
-        throw std::runtime_error("Key not found: " + key);
-    }
-
-    return results;
+    mdb_txn_abort(txn);  // Always abort read-only transactions
 }
 
 unsigned int Database::termDocCount(const std::string& key) {
@@ -228,3 +305,47 @@ unsigned int Database::termDocCount(const std::string& key) {
 
     return static_cast<unsigned int>(count);
 }
+
+void Database::forEachKey(const std::function<void(const std::string&, unsigned int, int)>& fn) {
+    MDB_txn* txn;
+    if (mdb_txn_begin(env, nullptr, MDB_RDONLY, &txn) != 0) {
+        throw std::runtime_error("Failed to begin read transaction in forEachKey");
+    }
+
+    MDB_cursor* cursor;
+    if (mdb_cursor_open(txn, dbi, &cursor) != 0) {
+        mdb_txn_abort(txn);
+        throw std::runtime_error("Failed to open LMDB cursor in forEachKey");
+    }
+
+    // Values are sorted by descending priority, so each key's first value
+    // carries its highest priority.
+    MDB_val mdb_key, mdb_value;
+    std::string key;
+    int rc = mdb_cursor_get(cursor, &mdb_key, &mdb_value, MDB_FIRST);
+    try {
+        while (rc == 0) {
+            size_t count = 0;
+            mdb_cursor_count(cursor, &count);
+            Data first;
+            deserialize_data(mdb_value, first);
+            key.assign((const char*)mdb_key.mv_data, mdb_key.mv_size);
+            fn(key, static_cast<unsigned int>(count), first.priority);
+            rc = mdb_cursor_get(cursor, &mdb_key, &mdb_value, MDB_NEXT_NODUP);
+        }
+    } catch (...) {
+        mdb_cursor_close(cursor);
+        mdb_txn_abort(txn);
+        throw;
+    }
+
+    mdb_cursor_close(cursor);
+    mdb_txn_abort(txn);
+}
+
+void Database::compactTo(const std::string& dest_path) const {
+    int rc = mdb_env_copy2(env, dest_path.c_str(), MDB_CP_COMPACT);
+    if (rc != 0) {
+        throw std::runtime_error("Failed to copy database: " + std::string(mdb_strerror(rc)));
+    }
+}
@@ -1,12 +1,56 @@
 #include "index/DocDatabase.h"
+#include "index/Lz4.h"
+#include "query-processing/analyzer.h"
 
-DocDatabase::DocDatabase(const std::string& dbPath) {
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+const char* kNextDocIdKey = "next_docid";
+const char* kNextTermIdKey = "next_termid";
+const char* kFormatVersionKey = "format_version";
+const char* kTailBlockKey = "tail_block";
+const char* kTailBytesKey = "tail_bytes";
+
+// LMDB rejects keys longer than this (the default mdb_env_get_maxkeysize()).
+const size_t kMaxTermLength = 511;
+
+// Recent url -> docid hits kept in memory.
+const size_t kUrlCacheEntries = 4096;
+
+// The URL filter is sized for twice the stored URLs (and at least this many)
+// so it only needs rebuilding after the corpus doubles.
+const size_t kMinUrlFilterKeys = 1024;
+
+// Stems shared by every database and ingest thread, so a word is stemmed once per process.
+stemmer::StemCache& ingestStems() {
+    static stemmer::StemCache stems;
+    return stems;
+}
+
+MDB_val docidKey(const SearchRPI::docid& id) {
+    MDB_val key;
+    key.mv_size = sizeof(id);
+    key.mv_data = (void*)&id;
+    return key;
+}
+
+}
+
+DocDatabase::DocDatabase(const std::string& dbPath, bool storePositions)
+    : storePositions_(storePositions), urlCache_(kUrlCacheEntries) {
     int rc = mdb_env_create(&env_);
     if (rc != MDB_SUCCESS)
         throw std::runtime_error("Failed to create LMDB environment");
     
-    // We use 3 named databases (meta, docs, urls)
-    rc = mdb_env_set_maxdbs(env_, 3);
+    // We use 8 named databases (meta, docs, blocks, tail, urls, terms, termstr, fwd)
+    rc = mdb_env_set_maxdbs(env_, 8);
     if (rc != MDB_SUCCESS)
         throw std::runtime_error("Failed to set maxdbs");
     
@@ -19,46 +63,82 @@ DocDatabase::DocDatabase(const std::string& dbPath) {
     if (rc != MDB_SUCCESS)
         throw std::runtime_error("Failed to begin LMDB transaction");
     
-    // Open/create the meta, docs, and urls databases.
     rc = mdb_dbi_open(txn, "meta", MDB_CREATE, &dbi_meta_);
     if (rc != MDB_SUCCESS) {
         mdb_txn_abort(txn);
         throw std::runtime_error("Failed to open meta database");
     }
-    rc = mdb_dbi_open(txn, "docs", MDB_CREATE, &dbi_docs_);
+
+    // Refuse to open databases written in another record format; the docs
+    // database of a legacy environment is not keyed by integers.
+    bool fresh = getMeta(txn, kNextDocIdKey) == 0;
+    uint64_t version = getMeta(txn, kFormatVersionKey);
+    if (!fresh && version != kDocRecordVersion) {
+        mdb_txn_abort(txn);
+        mdb_env_close(env_);
+        if (version == 0)
+            throw std::runtime_error("Document database uses the legacy text format; convert it with docdb_migrate");
+        throw std::runtime_error("Unsupported document database format version " + std::to_string(version));
+    }
+
+    // Open/create the docs, block store, tail, urls, term vocabulary and forward index databases.
+    rc = mdb_dbi_open(txn, "docs", MDB_CREATE | MDB_INTEGERKEY, &dbi_docs_);
     if (rc != MDB_SUCCESS) {
         mdb_txn_abort(txn);
         throw std::runtime_error("Failed to open docs database");
     }
+    rc = mdb_dbi_open(txn, "blocks", MDB_CREATE | MDB_INTEGERKEY, &dbi_blocks_);
+    if (rc != MDB_SUCCESS) {
+        mdb_txn_abort(txn);
+        throw std::runtime_error("Failed to open blocks database");
+    }
+    rc = mdb_dbi_open(txn, "tail", MDB_CREATE | MDB_INTEGERKEY, &dbi_tail_);
+    if (rc != MDB_SUCCESS) {
+        mdb_txn_abort(txn);
+        throw std::runtime_error("Failed to open tail database");
+    }
     rc = mdb_dbi_open(txn, "urls", MDB_CREATE, &dbi_urls_);
     if (rc != MDB_SUCCESS) {
         mdb_txn_abort(txn);
         throw std::runtime_error("Failed to open urls database");
     }
+    rc = mdb_dbi_open(txn, "terms", MDB_CREATE, &dbi_terms_);
+    if (rc != MDB_SUCCESS) {
+        mdb_txn_abort(txn);
+        throw std::runtime_error("Failed to open terms database");
+    }
+    rc = mdb_dbi_open(txn, "termstr", MDB_CREATE | MDB_INTEGERKEY, &dbi_termstr_);
+    if (rc != MDB_SUCCESS) {
+        mdb_txn_abort(txn);
+        throw std::runtime_error("Failed to open termstr database");
+    }
+    rc = mdb_dbi_open(txn, "fwd", MDB_CREATE | MDB_INTEGERKEY, &dbi_fwd_);
+    if (rc != MDB_SUCCESS) {
+        mdb_txn_abort(txn);
+        throw std::runtime_error("Failed to open fwd database");
+    }
     
-    // Initialize next_docid in meta DB if it does not exist.
-    MDB_val key, data;
-    const char* nextKey = "next_docid";
-    key.mv_size = std::strlen(nextKey);
-    key.mv_data = (void*)nextKey;
-    rc = mdb_get(txn, dbi_meta_, &key, &data);
-    if (rc == MDB_NOTFOUND) {
-        uint64_t next = 1;
-        data.mv_size = sizeof(next);
-        data.mv_data = &next;
-        rc = mdb_put(txn, dbi_meta_, &key, &data, 0);
-        if (rc != MDB_SUCCESS) {
-            mdb_txn_abort(txn);
-            throw std::runtime_error("Failed to initialize next_docid");
-        }
+    // Initialize counters and format version in a new database.
+    if (fresh) {
+        putMeta(txn, kNextDocIdKey, 1);
+        putMeta(txn, kNextTermIdKey, 1);
+        putMeta(txn, kTailBlockKey, 1);
+        putMeta(txn, kFormatVersionKey, kDocRecordVersion);
     }
     mdb_txn_commit(txn);
+    
+    rebuildUrlFilter();
 }
 
 DocDatabase::~DocDatabase() {
     mdb_dbi_close(env_, dbi_meta_);
     mdb_dbi_close(env_, dbi_docs_);
+    mdb_dbi_close(env_, dbi_blocks_);
     mdb_dbi_close(env_, dbi_urls_);
+    mdb_dbi_close(env_, dbi_terms_);
+    mdb_dbi_close(env_, dbi_termstr_);
+    mdb_dbi_close(env_, dbi_fwd_);
+    mdb_dbi_close(env_, dbi_tail_);
     mdb_env_close(env_);
 }
 
@@ -68,11 +148,7 @@ bool DocDatabase::contains(SearchRPI::docid id) const {
     if (rc != MDB_SUCCESS)
         return false;
     
-    std::string keyStr = docidToStr(id);
-    MDB_val key, data;
-    key.mv_size = keyStr.size();
-    key.mv_data = (void*)keyStr.data();
-    
+    MDB_val key = docidKey(id), data;
     rc = mdb_get(txn, dbi_docs_, &key, &data);
     mdb_txn_commit(txn);
     
@@ -80,6 +156,14 @@ bool DocDatabase::contains(SearchRPI::docid id) const {
 }
 
 bool DocDatabase::contains(const std::string& url) const {
+    // Held across the lookup so a concurrent remove() cannot be undone by
+    // caching what this reader saw.
+    std::shared_lock<std::shared_mutex> lock(urlMutex_);
+    if (!urlFilter_.mayContain(url))
+        return false;
+    if (urlCache_.get(url))
+        return true;
+    
     MDB_txn* txn;
     int rc = mdb_txn_begin(env_, nullptr, MDB_RDONLY, &txn);
     if (rc != MDB_SUCCESS)
@@ -90,12 +174,33 @@ bool DocDatabase::contains(const std::string& url) const {
     key.mv_data = (void*)url.data();
     
     rc = mdb_get(txn, dbi_urls_, &key, &data);
+    if (rc == MDB_SUCCESS) {
+        SearchRPI::docid docId;
+        std::memcpy(&docId, data.mv_data, sizeof(docId));
+        urlCache_.put(url, docId);
+    }
     mdb_txn_commit(txn);
     
     return (rc == MDB_SUCCESS);
 }
 
 SearchRPI::docid DocDatabase::addDoc(const std::string& url, const std::string& title, std::vector<std::string> words) {
+    std::string text;
+    for (const std::string& word : words) {
+        if (!text.empty())
+            text += ' ';
+        text += word;
+    }
+    return addDoc(url, title, text);
+}
+
+SearchRPI::docid DocDatabase::addDoc(const std::string& url, const std::string& title, std::string_view text) {
+    // Analyze before the write transaction so stemming does not hold the writer lock.
+    // The analyzer (and its buffers) is reused across documents, as in query::processQuery.
+    thread_local analyzer::DocumentAnalyzer analyzer{analyzer::StopwordFilter(), analyzer::Stemming(ingestStems())};
+    std::vector<std::string> words;
+    analyzer.analyze(text, [&words](const analyzer::Token& token) { words.push_back(token.text); });
+
     MDB_txn* txn;
     int rc = mdb_txn_begin(env_, nullptr, 0, &txn);
     if (rc != MDB_SUCCESS)
@@ -108,69 +213,39 @@ SearchRPI::docid DocDatabase::addDoc(const std::string& url, const std::string&
     rc = mdb_get(txn, dbi_urls_, &urlKey, &urlData);
     if (rc == MDB_SUCCESS) {
         // URL exists – return the existing document id.
-        std::string docidStr((char*)urlData.mv_data, urlData.mv_size);
-        uint64_t existingDocId = std::stoull(docidStr);
+        SearchRPI::docid existingDocId;
+        std::memcpy(&existingDocId, urlData.mv_data, sizeof(existingDocId));
         mdb_txn_commit(txn);
         return existingDocId;
     }
     
     // Retrieve the next_docid from the meta DB.
-    const char* nextKey = "next_docid";
-    MDB_val metaKey, metaData;
-    metaKey.mv_size = std::strlen(nextKey);
-    metaKey.mv_data = (void*)nextKey;
-    rc = mdb_get(txn, dbi_meta_, &metaKey, &metaData);
-    if (rc != MDB_SUCCESS) {
+    uint64_t docId = getMeta(txn, kNextDocIdKey);
+    if (docId == 0) {
         mdb_txn_abort(txn);
         throw std::runtime_error("Failed to get next_docid");
     }
-    uint64_t docId;
-    std::memcpy(&docId, metaData.mv_data, sizeof(docId));
-    
-    // Serialize the document record.
-    std::string docRecord = serializeDoc(url, title, words);
-    
-    // Insert the document record into the docs DB.
-    std::string docKeyStr = docidToStr(docId);
-    MDB_val docKey, docValue;
-    docKey.mv_size = docKeyStr.size();
-    docKey.mv_data = (void*)docKeyStr.data();
-    docValue.mv_size = docRecord.size();
-    docValue.mv_data = (void*)docRecord.data();
-    rc = mdb_put(txn, dbi_docs_, &docKey, &docValue, 0);
-    if (rc != MDB_SUCCESS) {
-        mdb_txn_abort(txn);
-        throw std::runtime_error("Failed to put document record");
-    }
     
-    // Insert the URL mapping (url -> docid) into the urls DB.
-    MDB_val putUrlKey, putUrlValue;
-    putUrlKey.mv_size = url.size();
-    putUrlKey.mv_data = (void*)url.data();
-    std::string docIdStr = docidToStr(docId);
-    putUrlValue.mv_size = docIdStr.size();
-    putUrlValue.mv_data = (void*)docIdStr.data();
-    rc = mdb_put(txn, dbi_urls_, &putUrlKey, &putUrlValue, 0);
-    if (rc != MDB_SUCCESS) {
-        mdb_txn_abort(txn);
-        throw std::runtime_error("Failed to put URL mapping");
-    }
+    // Insert the document record and URL mapping.
+    putDoc(txn, static_cast<SearchRPI::docid>(docId), url, title, text, words);
     
     // Increment next_docid and update the meta DB.
-    uint64_t nextDocId = docId + 1;
-    metaData.mv_size = sizeof(nextDocId);
-    metaData.mv_data = &nextDocId;
-    rc = mdb_put(txn, dbi_meta_, &metaKey, &metaData, 0);
-    if (rc != MDB_SUCCESS) {
-        mdb_txn_abort(txn);
-        throw std::runtime_error("Failed to update next_docid");
-    }
+    putMeta(txn, kNextDocIdKey, docId + 1);
     
-    mdb_txn_commit(txn);
+    rc = mdb_txn_commit(txn);
+    if (rc != MDB_SUCCESS)
+        throw std::runtime_error("Failed to commit document");
+    noteUrlAdded(url, static_cast<SearchRPI::docid>(docId));
     return docId;
 }
 
 SearchRPI::docid DocDatabase::getDocId(const std::string& url) const {
+    std::shared_lock<std::shared_mutex> lock(urlMutex_);
+    if (!urlFilter_.mayContain(url))
+        throw std::runtime_error("URL not found");
+    if (auto cached = urlCache_.get(url))
+        return *cached;
+    
     MDB_txn* txn;
     int rc = mdb_txn_begin(env_, nullptr, MDB_RDONLY, &txn);
     if (rc != MDB_SUCCESS)
@@ -184,9 +259,10 @@ SearchRPI::docid DocDatabase::getDocId(const std::string& url) const {
         mdb_txn_commit(txn);
         throw std::runtime_error("URL not found");
     }
-    std::string docidStr((char*)data.mv_data, data.mv_size);
-    uint64_t docId = std::stoull(docidStr);
+    SearchRPI::docid docId;
+    std::memcpy(&docId, data.mv_data, sizeof(docId));
     mdb_txn_commit(txn);
+    urlCache_.put(url, docId);
     return docId;
 }
 
@@ -196,24 +272,155 @@ std::set<std::string> DocDatabase::getWords(SearchRPI::docid id) const {
     if (rc != MDB_SUCCESS)
         throw std::runtime_error("Failed to begin transaction in getWords");
     
-    std::string keyStr = docidToStr(id);
-    MDB_val key, data;
-    key.mv_size = keyStr.size();
-    key.mv_data = (void*)keyStr.data();
-    rc = mdb_get(txn, dbi_docs_, &key, &data);
+    MDB_val key = docidKey(id), data;
+    rc = mdb_get(txn, dbi_fwd_, &key, &data);
     if (rc != MDB_SUCCESS) {
         mdb_txn_commit(txn);
         throw std::runtime_error("Document not found");
     }
     
-    std::string docData((char*)data.mv_data, data.mv_size);
-    mdb_txn_commit(txn);
+    TermVectorView vector;
+    if (!vector.parse(std::string_view((const char*)data.mv_data, data.mv_size))) {
+        mdb_txn_abort(txn);
+        throw std::runtime_error("Corrupt term vector");
+    }
     
-    std::string docUrl, docTitle;
-    std::vector<std::string> words;
-    deserializeDoc(docData, docUrl, docTitle, words);
+    // Resolve term ids inside the same snapshot; the vector is never copied.
+    std::set<std::string> words;
+    bool missing = false;
+    bool ok = vector.forEach([&](uint32_t termId, uint32_t) {
+        MDB_val termKey, termData;
+        termKey.mv_size = sizeof(termId);
+        termKey.mv_data = &termId;
+        if (mdb_get(txn, dbi_termstr_, &termKey, &termData) != MDB_SUCCESS) {
+            missing = true;
+            return;
+        }
+        words.emplace((const char*)termData.mv_data, termData.mv_size);
+    });
+    mdb_txn_abort(txn);
+    
+    if (!ok || missing)
+        throw std::runtime_error("Corrupt term vector");
+    return words;
+}
+
+TermVector DocDatabase::getTermVector(SearchRPI::docid id) const {
+    MDB_txn* txn;
+    int rc = mdb_txn_begin(env_, nullptr, MDB_RDONLY, &txn);
+    if (rc != MDB_SUCCESS)
+        throw std::runtime_error("Failed to begin transaction in getTermVector");
+    
+    MDB_val key = docidKey(id), data;
+    rc = mdb_get(txn, dbi_fwd_, &key, &data);
+    if (rc != MDB_SUCCESS) {
+        mdb_txn_abort(txn);
+        throw std::runtime_error("Document not found");
+    }
+    TermVector vector(std::string((const char*)data.mv_data, data.mv_size));
+    mdb_txn_abort(txn);
+    return vector;
+}
+
+std::pmr::vector<DocSummary> DocDatabase::getDocs(const std::vector<SearchRPI::docid>& ids,
+                                                  std::pmr::memory_resource& arena, bool withText) const {
+    std::pmr::vector<DocSummary> results(ids.size(), DocSummary{0, {}, {}, {}}, &arena);
+    if (ids.empty())
+        return results;
+    
+    // Visit ids in key order so consecutive lookups hit neighbouring pages.
+    std::pmr::vector<uint32_t> order(ids.size(), &arena);
+    for (uint32_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return ids[a] < ids[b]; });
+    
+    MDB_txn* txn;
+    int rc = mdb_txn_begin(env_, nullptr, MDB_RDONLY, &txn);
+    if (rc != MDB_SUCCESS)
+        throw std::runtime_error("Failed to begin transaction in getDocs");
+    
+    // Neighbouring ids usually share a block, so the pin saves repeated block lookups.
+    BlockPin pin;
+    const DocSummary* previous = nullptr;
+    for (uint32_t index : order) {
+        SearchRPI::docid id = ids[index];
+        // Duplicate ids share the first copy.
+        if (previous && previous->id == id) {
+            results[index] = *previous;
+            continue;
+        }
+        
+        DocRecordView record;
+        try {
+            if (!readRecord(txn, id, record, pin))
+                continue;
+        } catch (...) {
+            mdb_txn_abort(txn);
+            throw;
+        }
+        
+        // Copy the fields into one arena allocation before the snapshot closes.
+        std::string_view text = withText ? record.text() : std::string_view();
+        size_t bytes = record.url().size() + record.title().size() + text.size();
+        char* out = static_cast<char*>(arena.allocate(bytes ? bytes : 1, 1));
+        std::memcpy(out, record.url().data(), record.url().size());
+        std::memcpy(out + record.url().size(), record.title().data(), record.title().size());
+        if (!text.empty())
+            std::memcpy(out + record.url().size() + record.title().size(), text.data(), text.size());
+        
+        DocSummary& summary = results[index];
+        summary.id = id;
+        summary.url = std::string_view(out, record.url().size());
+        summary.title = std::string_view(out + record.url().size(), record.title().size());
+        summary.text = std::string_view(out + record.url().size() + record.title().size(), text.size());
+        previous = &summary;
+    }
+    
+    mdb_txn_abort(txn);
+    return results;
+}
+
+std::string DocDatabase::getText(SearchRPI::docid id) const {
+    MDB_txn* txn;
+    int rc = mdb_txn_begin(env_, nullptr, MDB_RDONLY, &txn);
+    if (rc != MDB_SUCCESS)
+        throw std::runtime_error("Failed to begin transaction in getText");
+    
+    DocRecordView record;
+    BlockPin pin;
+    bool found;
+    try {
+        found = readRecord(txn, id, record, pin);
+    } catch (...) {
+        mdb_txn_abort(txn);
+        throw;
+    }
+    if (!found) {
+        mdb_txn_abort(txn);
+        throw std::runtime_error("Document not found");
+    }
+    std::string text(record.text());
+    mdb_txn_abort(txn);
+    return text;
+}
+
+std::string DocDatabase::getTerm(uint32_t termId) const {
+    MDB_txn* txn;
+    int rc = mdb_txn_begin(env_, nullptr, MDB_RDONLY, &txn);
+    if (rc != MDB_SUCCESS)
+        throw std::runtime_error("Failed to begin transaction in getTerm");
     
-    return std::set<std::string>(words.begin(), words.end());
+    MDB_val key, data;
+    key.mv_size = sizeof(termId);
+    key.mv_data = &termId;
+    rc = mdb_get(txn, dbi_termstr_, &key, &data);
+    if (rc != MDB_SUCCESS) {
+        mdb_txn_abort(txn);
+        throw std::runtime_error("Term not found");
+    }
+    std::string term((const char*)data.mv_data, data.mv_size);
+    mdb_txn_abort(txn);
+    return term;
 }
 
 bool DocDatabase::remove(SearchRPI::docid id) {
@@ -222,29 +429,41 @@ bool DocDatabase::remove(SearchRPI::docid id) {
     if (rc != MDB_SUCCESS)
         return false;
     
-    std::string keyStr = docidToStr(id);
-    MDB_val key, data;
-    key.mv_size = keyStr.size();
-    key.mv_data = (void*)keyStr.data();
-    
-    rc = mdb_get(txn, dbi_docs_, &key, &data);
-    if (rc != MDB_SUCCESS) {
+    // Only the URL is needed. Copy it: values are invalidated by the deletes below.
+    DocRecordView record;
+    BlockPin pin;
+    bool found;
+    try {
+        found = readRecord(txn, id, record, pin);
+    } catch (...) {
+        mdb_txn_abort(txn);
+        return false;
+    }
+    if (!found) {
         mdb_txn_commit(txn);
         return false;
     }
+    std::string docUrl(record.url());
     
-    // Retrieve the document record to extract the URL.
-    std::string docData((char*)data.mv_data, data.mv_size);
-    std::string docUrl, docTitle;
-    std::vector<std::string> words;
-    deserializeDoc(docData, docUrl, docTitle, words);
-    
-    // Delete the document record from the docs DB.
+    // Delete the record's location and its term vector. A record still in the
+    // tail is dropped; sealed record bytes stay in their block until the
+    // database is rebuilt.
+    MDB_val key = docidKey(id);
     rc = mdb_del(txn, dbi_docs_, &key, nullptr);
     if (rc != MDB_SUCCESS) {
         mdb_txn_abort(txn);
         return false;
     }
+    rc = mdb_del(txn, dbi_tail_, &key, nullptr);
+    if (rc != MDB_SUCCESS && rc != MDB_NOTFOUND) {
+        mdb_txn_abort(txn);
+        return false;
+    }
+    rc = mdb_del(txn, dbi_fwd_, &key, nullptr);
+    if (rc != MDB_SUCCESS && rc != MDB_NOTFOUND) {
+        mdb_txn_abort(txn);
+        return false;
+    }
     
     // Remove the URL mapping.
     MDB_val urlKey;
@@ -256,32 +475,420 @@ bool DocDatabase::remove(SearchRPI::docid id) {
         return false;
     }
     
-    mdb_txn_commit(txn);
+    if (mdb_txn_commit(txn) != MDB_SUCCESS)
+        return false;
+    noteUrlRemoved(docUrl);
+    return true;
+}
+
+void DocDatabase::compactTo(const std::string& destPath) const {
+    int rc = mdb_env_copy2(env_, destPath.c_str(), MDB_CP_COMPACT);
+    if (rc != MDB_SUCCESS)
+        throw std::runtime_error("Failed to copy document database");
+}
+
+void DocDatabase::putDoc(MDB_txn* txn, SearchRPI::docid id, const std::string& url, const std::string& title,
+                         std::string_view text, const std::vector<std::string>& words) {
+    // Build the term vector, interning each distinct word once.
+    TermVectorBuilder builder(storePositions_);
+    std::unordered_map<std::string_view, uint32_t> termIds;
+    uint32_t position = 0;
+    for (const std::string& word : words) {
+        if (word.empty() || word.size() > kMaxTermLength)
+            continue;
+        auto it = termIds.find(word);
+        if (it == termIds.end())
+            it = termIds.emplace(word, internTerm(txn, word)).first;
+        builder.add(it->second, position++);
+    }
+    std::string termVector = builder.finish();
+    
+    std::string location = encodeDocLocation(appendRecord(txn, id, encodeDocRecord(url, title, text)));
+    MDB_val docKey = docidKey(id), docValue;
+    docValue.mv_size = location.size();
+    docValue.mv_data = (void*)location.data();
+    int rc = mdb_put(txn, dbi_docs_, &docKey, &docValue, 0);
+    if (rc != MDB_SUCCESS) {
+        mdb_txn_abort(txn);
+        throw std::runtime_error("Failed to put document location");
+    }
+    
+    MDB_val fwdValue;
+    fwdValue.mv_size = termVector.size();
+    fwdValue.mv_data = (void*)termVector.data();
+    rc = mdb_put(txn, dbi_fwd_, &docKey, &fwdValue, 0);
+    if (rc != MDB_SUCCESS) {
+        mdb_txn_abort(txn);
+        throw std::runtime_error("Failed to put term vector");
+    }
+    
+    // Insert the URL mapping (url -> docid) into the urls DB.
+    MDB_val putUrlKey, putUrlValue;
+    putUrlKey.mv_size = url.size();
+    putUrlKey.mv_data = (void*)url.data();
+    putUrlValue.mv_size = sizeof(id);
+    putUrlValue.mv_data = &id;
+    rc = mdb_put(txn, dbi_urls_, &putUrlKey, &putUrlValue, 0);
+    if (rc != MDB_SUCCESS) {
+        mdb_txn_abort(txn);
+        throw std::runtime_error("Failed to put URL mapping");
+    }
+}
+
+void DocDatabase::rebuildUrlFilter() {
+    MDB_txn* txn;
+    int rc = mdb_txn_begin(env_, nullptr, MDB_RDONLY, &txn);
+    if (rc != MDB_SUCCESS)
+        throw std::runtime_error("Failed to begin transaction in rebuildUrlFilter");
+    
+    MDB_stat stat;
+    mdb_stat(txn, dbi_urls_, &stat);
+    BloomFilter filter(std::max<size_t>(stat.ms_entries * 2, kMinUrlFilterKeys));
+    
+    MDB_cursor* cursor;
+    if (mdb_cursor_open(txn, dbi_urls_, &cursor) != MDB_SUCCESS) {
+        mdb_txn_abort(txn);
+        throw std::runtime_error("Failed to open cursor in rebuildUrlFilter");
+    }
+    MDB_val key, data;
+    rc = mdb_cursor_get(cursor, &key, &data, MDB_FIRST);
+    while (rc == MDB_SUCCESS) {
+        filter.add(std::string_view((const char*)key.mv_data, key.mv_size));
+        rc = mdb_cursor_get(cursor, &key, &data, MDB_NEXT);
+    }
+    mdb_cursor_close(cursor);
+    mdb_txn_abort(txn);
+    
+    urlFilter_ = std::move(filter);
+    urlCount_ = stat.ms_entries;
+    removedUrls_ = 0;
+}
+
+void DocDatabase::noteUrlAdded(const std::string& url, SearchRPI::docid id) {
+    std::unique_lock<std::shared_mutex> lock(urlMutex_);
+    urlCount_++;
+    if (urlCount_ > urlFilter_.capacity()) {
+        // Rebuilding scans the committed urls, which already include this one.
+        rebuildUrlFilter();
+    } else {
+        urlFilter_.add(url);
+    }
+    urlCache_.put(url, id);
+}
+
+void DocDatabase::noteUrlRemoved(const std::string& url) {
+    std::unique_lock<std::shared_mutex> lock(urlMutex_);
+    urlCache_.erase(url);
+    urlCount_--;
+    removedUrls_++;
+    // Stale bits only cost false positives; rebuild once they dominate.
+    if (removedUrls_ > std::max(urlCount_, kMinUrlFilterKeys))
+        rebuildUrlFilter();
+}
+
+DocLocation DocDatabase::appendRecord(MDB_txn* txn, SearchRPI::docid id, const std::string& record) {
+    uint32_t tail = static_cast<uint32_t>(getMeta(txn, kTailBlockKey));
+    uint64_t tailBytes = getMeta(txn, kTailBytesKey);
+    
+    if (tailBytes > 0 && tailBytes + record.size() > kDocBlockSize) {
+        sealTail(txn, tail);
+        tail++;
+        putMeta(txn, kTailBlockKey, tail);
+        tailBytes = 0;
+    }
+    
+    // Tail records are stored on their own, so an append writes only its record.
+    MDB_val recordKey = docidKey(id), data;
+    data.mv_size = record.size();
+    data.mv_data = (void*)record.data();
+    if (mdb_put(txn, dbi_tail_, &recordKey, &data, 0) != MDB_SUCCESS) {
+        mdb_txn_abort(txn);
+        throw std::runtime_error("Failed to put document record");
+    }
+    putMeta(txn, kTailBytesKey, tailBytes + record.size());
+    return DocLocation{tail, static_cast<uint32_t>(tailBytes), static_cast<uint32_t>(record.size())};
+}
+
+void DocDatabase::sealTail(MDB_txn* txn, uint32_t tail) {
+    // Pack the tail records in docid order and point their locations at the block.
+    MDB_cursor* cursor;
+    if (mdb_cursor_open(txn, dbi_tail_, &cursor) != MDB_SUCCESS) {
+        mdb_txn_abort(txn);
+        throw std::runtime_error("Failed to open tail cursor");
+    }
+    std::string payload;
+    MDB_val key, data;
+    int rc = mdb_cursor_get(cursor, &key, &data, MDB_FIRST);
+    while (rc == MDB_SUCCESS) {
+        SearchRPI::docid id;
+        std::memcpy(&id, key.mv_data, sizeof(id));
+        std::string location = encodeDocLocation(
+                DocLocation{tail, static_cast<uint32_t>(payload.size()), static_cast<uint32_t>(data.mv_size)});
+        payload.append((const char*)data.mv_data, data.mv_size);
+        
+        MDB_val docKey = docidKey(id), docValue;
+        docValue.mv_size = location.size();
+        docValue.mv_data = (void*)location.data();
+        if (mdb_put(txn, dbi_docs_, &docKey, &docValue, 0) != MDB_SUCCESS) {
+            mdb_cursor_close(cursor);
+            mdb_txn_abort(txn);
+            throw std::runtime_error("Failed to put document location");
+        }
+        rc = mdb_cursor_get(cursor, &key, &data, MDB_NEXT);
+    }
+    mdb_cursor_close(cursor);
+    if (rc != MDB_NOTFOUND) {
+        mdb_txn_abort(txn);
+        throw std::runtime_error("Failed to read tail records");
+    }
+    
+    std::string sealed = encodeBlock(payload, true);
+    key.mv_size = sizeof(tail);
+    key.mv_data = &tail;
+    data.mv_size = sealed.size();
+    data.mv_data = (void*)sealed.data();
+    if (mdb_put(txn, dbi_blocks_, &key, &data, 0) != MDB_SUCCESS || mdb_drop(txn, dbi_tail_, 0) != MDB_SUCCESS) {
+        mdb_txn_abort(txn);
+        throw std::runtime_error("Failed to seal document block");
+    }
+}
+
+bool DocDatabase::readRecord(MDB_txn* txn, SearchRPI::docid id, DocRecordView& record, BlockPin& pin) const {
+    MDB_val key = docidKey(id), data;
+    if (mdb_get(txn, dbi_docs_, &key, &data) != MDB_SUCCESS)
+        return false;
+    DocLocation location;
+    if (!decodeDocLocation(std::string_view((const char*)data.mv_data, data.mv_size), location))
+        throw std::runtime_error("Corrupt document location");
+    
+    std::string_view records;
+    if (pin.block && pin.block == location.block) {
+        // Sealed blocks never change: reuse the one the caller already holds.
+        records = *pin.data;
+    } else {
+        MDB_val blockKey, blockData;
+        blockKey.mv_size = sizeof(location.block);
+        blockKey.mv_data = &location.block;
+        int rc = mdb_get(txn, dbi_blocks_, &blockKey, &blockData);
+        if (rc == MDB_NOTFOUND) {
+            // Not sealed yet: the record is in the tail database.
+            if (mdb_get(txn, dbi_tail_, &key, &data) != MDB_SUCCESS ||
+                !record.parse(std::string_view((const char*)data.mv_data, data.mv_size)))
+                throw std::runtime_error("Missing document record");
+            return true;
+        }
+        if (rc != MDB_SUCCESS)
+            throw std::runtime_error("Failed to read document block");
+        
+        BlockCodec codec;
+        uint32_t size;
+        std::string_view payload;
+        if (!decodeBlockHeader(std::string_view((const char*)blockData.mv_data, blockData.mv_size), codec, size,
+                               payload))
+            throw std::runtime_error("Corrupt document block");
+        
+        records = payload;
+        if (codec == BlockCodec::Lz4) {
+            // Compressed blocks are sealed and never change, so they can be cached
+            // across transactions.
+            std::shared_ptr<const std::string> block = blockCache_.get(location.block);
+            if (!block) {
+                auto decompressed = std::make_shared<std::string>(size, '\0');
+                if (!lz4::decompress(payload, decompressed->data(), size))
+                    throw std::runtime_error("Corrupt document block");
+                block = std::move(decompressed);
+                blockCache_.put(location.block, block);
+            }
+            pin.block = location.block;
+            pin.data = std::move(block);
+            records = *pin.data;
+        }
+    }
+    
+    if (location.offset > records.size() || records.size() - location.offset < location.size ||
+        !record.parse(records.substr(location.offset, location.size)))
+        throw std::runtime_error("Corrupt document record");
     return true;
 }
 
-std::string DocDatabase::serializeDoc(const std::string& url, const std::string& title, const std::vector<std::string>& words) {
-    std::ostringstream oss;
-    oss << url << "\n" << title << "\n";
-    for (size_t i = 0; i < words.size(); i++) {
-        oss << words[i];
-        if (i != words.size()-1)
-            oss << ",";
+uint32_t DocDatabase::internTerm(MDB_txn* txn, const std::string& term) {
+    MDB_val key, data;
+    key.mv_size = term.size();
+    key.mv_data = (void*)term.data();
+    int rc = mdb_get(txn, dbi_terms_, &key, &data);
+    if (rc == MDB_SUCCESS) {
+        uint32_t termId;
+        std::memcpy(&termId, data.mv_data, sizeof(termId));
+        return termId;
+    }
+    
+    uint32_t termId = static_cast<uint32_t>(getMeta(txn, kNextTermIdKey));
+    data.mv_size = sizeof(termId);
+    data.mv_data = &termId;
+    rc = mdb_put(txn, dbi_terms_, &key, &data, 0);
+    if (rc != MDB_SUCCESS) {
+        mdb_txn_abort(txn);
+        throw std::runtime_error("Failed to put term");
+    }
+    
+    MDB_val idKey;
+    idKey.mv_size = sizeof(termId);
+    idKey.mv_data = &termId;
+    data.mv_size = term.size();
+    data.mv_data = (void*)term.data();
+    rc = mdb_put(txn, dbi_termstr_, &idKey, &data, 0);
+    if (rc != MDB_SUCCESS) {
+        mdb_txn_abort(txn);
+        throw std::runtime_error("Failed to put term id");
+    }
+    
+    putMeta(txn, kNextTermIdKey, termId + 1);
+    return termId;
+}
+
+uint64_t DocDatabase::getMeta(MDB_txn* txn, const char* name) const {
+    MDB_val key, data;
+    key.mv_size = std::strlen(name);
+    key.mv_data = (void*)name;
+    if (mdb_get(txn, dbi_meta_, &key, &data) != MDB_SUCCESS || data.mv_size != sizeof(uint64_t))
+        return 0;
+    uint64_t value;
+    std::memcpy(&value, data.mv_data, sizeof(value));
+    return value;
+}
+
+void DocDatabase::putMeta(MDB_txn* txn, const char* name, uint64_t value) {
+    MDB_val key, data;
+    key.mv_size = std::strlen(name);
+    key.mv_data = (void*)name;
+    data.mv_size = sizeof(value);
+    data.mv_data = &value;
+    int rc = mdb_put(txn, dbi_meta_, &key, &data, 0);
+    if (rc != MDB_SUCCESS) {
+        mdb_txn_abort(txn);
+        throw std::runtime_error(std::string("Failed to update ") + name);
     }
-    return oss.str();
 }
 
-void DocDatabase::deserializeDoc(const std::string& data, std::string& url, std::string& title, std::vector<std::string>& words) const {
-    std::istringstream iss(data);
-    std::getline(iss, url);
-    std::getline(iss, title);
-    std::string wordsStr;
-    std::getline(iss, wordsStr);
-    words.clear();
-    std::istringstream wss(wordsStr);
-    std::string word;
-    while (std::getline(wss, word, ',')) {
-        if (!word.empty())
-            words.push_back(word);
-    }
-}
\ No newline at end of file
+size_t DocDatabase::migrateLegacy(const std::string& legacyPath, const std::string& destPath) {
+    MDB_env* legacyEnv;
+    if (mdb_env_create(&legacyEnv) != MDB_SUCCESS)
+        throw std::runtime_error("Failed to create LMDB environment");
+    mdb_env_set_maxdbs(legacyEnv, 3);
+    if (mdb_env_open(legacyEnv, legacyPath.c_str(), MDB_RDONLY, 0664) != MDB_SUCCESS) {
+        mdb_env_close(legacyEnv);
+        throw std::runtime_error("Failed to open legacy document database");
+    }
+    
+    MDB_txn* readTxn;
+    MDB_dbi legacyMeta, legacyDocs;
+    if (mdb_txn_begin(legacyEnv, nullptr, MDB_RDONLY, &readTxn) != MDB_SUCCESS) {
+        mdb_env_close(legacyEnv);
+        throw std::runtime_error("Failed to begin legacy read transaction");
+    }
+    if (mdb_dbi_open(readTxn, "meta", 0, &legacyMeta) != MDB_SUCCESS ||
+        mdb_dbi_open(readTxn, "docs", 0, &legacyDocs) != MDB_SUCCESS) {
+        mdb_txn_abort(readTxn);
+        mdb_env_close(legacyEnv);
+        throw std::runtime_error("Legacy database is missing meta or docs");
+    }
+    
+    std::unique_ptr<DocDatabase> opened;
+    try {
+        opened = std::make_unique<DocDatabase>(destPath);
+    } catch (...) {
+        mdb_txn_abort(readTxn);
+        mdb_env_close(legacyEnv);
+        throw;
+    }
+    DocDatabase& dest = *opened;
+    MDB_txn* writeTxn;
+    if (mdb_txn_begin(dest.env_, nullptr, 0, &writeTxn) != MDB_SUCCESS) {
+        mdb_txn_abort(readTxn);
+        mdb_env_close(legacyEnv);
+        throw std::runtime_error("Failed to begin transaction in migrateLegacy");
+    }
+    
+    MDB_cursor* cursor;
+    if (mdb_cursor_open(readTxn, legacyDocs, &cursor) != MDB_SUCCESS) {
+        mdb_txn_abort(writeTxn);
+        mdb_txn_abort(readTxn);
+        mdb_env_close(legacyEnv);
+        throw std::runtime_error("Failed to open cursor in migrateLegacy");
+    }
+    auto closeLegacy = [&]() {
+        mdb_cursor_close(cursor);
+        mdb_txn_abort(readTxn);
+        mdb_env_close(legacyEnv);
+    };
+    
+    size_t migrated = 0;
+    uint64_t nextDocId = 1;
+    MDB_val key, data;
+    int rc = mdb_cursor_get(cursor, &key, &data, MDB_FIRST);
+    while (rc == MDB_SUCCESS) {
+        const char* idBegin = (const char*)key.mv_data;
+        const char* idEnd = idBegin + key.mv_size;
+        uint64_t parsedId;
+        auto [parsedEnd, parseError] = std::from_chars(idBegin, idEnd, parsedId);
+        if (parseError != std::errc() || parsedEnd != idEnd) {
+            mdb_txn_abort(writeTxn);
+            closeLegacy();
+            throw std::runtime_error("Malformed legacy document id: " + std::string(idBegin, idEnd));
+        }
+        SearchRPI::docid id = static_cast<SearchRPI::docid>(parsedId);
+        
+        // Legacy record: <url>\n<title>\n<word1,word2,...>
+        std::string_view record((const char*)data.mv_data, data.mv_size);
+        size_t urlEnd = std::min(record.find('\n'), record.size());
+        std::string url(record.substr(0, urlEnd));
+        record.remove_prefix(std::min(urlEnd + 1, record.size()));
+        size_t titleEnd = std::min(record.find('\n'), record.size());
+        std::string title(record.substr(0, titleEnd));
+        record.remove_prefix(std::min(titleEnd + 1, record.size()));
+        record = record.substr(0, record.find('\n'));
+        
+        std::vector<std::string> words;
+        while (!record.empty()) {
+            size_t comma = std::min(record.find(','), record.size());
+            if (comma > 0)
+                words.emplace_back(record.substr(0, comma));
+            record.remove_prefix(std::min(comma + 1, record.size()));
+        }
+        
+        // putDoc aborts writeTxn itself when it fails.
+        try {
+            dest.putDoc(writeTxn, id, url, title, std::string(), words);
+        } catch (...) {
+            closeLegacy();
+            throw;
+        }
+        nextDocId = std::max<uint64_t>(nextDocId, uint64_t(id) + 1);
+        migrated++;
+        rc = mdb_cursor_get(cursor, &key, &data, MDB_NEXT);
+    }
+    if (rc != MDB_NOTFOUND) {
+        mdb_txn_abort(writeTxn);
+        closeLegacy();
+        throw std::runtime_error("Failed to read legacy documents in migrateLegacy");
+    }
+    
+    // Keep the legacy counter if it is ahead (ids of removed documents are never reused).
+    const char* nextKey = kNextDocIdKey;
+    MDB_val metaKey, metaData;
+    metaKey.mv_size = std::strlen(nextKey);
+    metaKey.mv_data = (void*)nextKey;
+    if (mdb_get(readTxn, legacyMeta, &metaKey, &metaData) == MDB_SUCCESS && metaData.mv_size == sizeof(uint64_t)) {
+        uint64_t legacyNext;
+        std::memcpy(&legacyNext, metaData.mv_data, sizeof(legacyNext));
+        nextDocId = std::max(nextDocId, legacyNext);
+    }
+    closeLegacy();
+    
+    // putMeta, like putDoc, aborts writeTxn when it fails.
+    dest.putMeta(writeTxn, kNextDocIdKey, nextDocId);
+    
+    if (mdb_txn_commit(writeTxn) != MDB_SUCCESS)
+        throw std::runtime_error("Failed to commit migrated documents");
+    return migrated;
+}
@@ -0,0 +1,71 @@
+#include "index/DocRecord.h"
+#include "index/Lz4.h"
+
+std::string encodeDocRecord(std::string_view url, std::string_view title, std::string_view text) {
+    std::string out;
+    out.reserve(1 + 15 + url.size() + title.size() + text.size());
+    out.push_back(static_cast<char>(kDocRecordVersion));
+    coding::putLengthPrefixed(out, url);
+    coding::putLengthPrefixed(out, title);
+    coding::putLengthPrefixed(out, text);
+    return out;
+}
+
+bool DocRecordView::parse(std::string_view data) {
+    const char* p = data.data();
+    const char* limit = p + data.size();
+    if (p == limit || static_cast<uint8_t>(*p) != kDocRecordVersion)
+        return false;
+    p++;
+    return coding::getLengthPrefixed(p, limit, url_) &&
+           coding::getLengthPrefixed(p, limit, title_) &&
+           coding::getLengthPrefixed(p, limit, text_);
+}
+
+std::string encodeDocLocation(const DocLocation& location) {
+    std::string out;
+    coding::putVarint32(out, location.block);
+    coding::putVarint32(out, location.offset);
+    coding::putVarint32(out, location.size);
+    return out;
+}
+
+bool decodeDocLocation(std::string_view data, DocLocation& location) {
+    const char* p = data.data();
+    const char* limit = p + data.size();
+    return coding::getVarint32(p, limit, location.block) &&
+           coding::getVarint32(p, limit, location.offset) &&
+           coding::getVarint32(p, limit, location.size);
+}
+
+std::string encodeBlock(std::string_view payload, bool compress) {
+    std::string out;
+    if (compress) {
+        std::string compressed = lz4::compress(payload);
+        if (compressed.size() < payload.size()) {
+            out.reserve(6 + compressed.size());
+            out.push_back(static_cast<char>(BlockCodec::Lz4));
+            coding::putVarint32(out, static_cast<uint32_t>(payload.size()));
+            out.append(compressed);
+            return out;
+        }
+    }
+    out.reserve(6 + payload.size());
+    out.push_back(static_cast<char>(BlockCodec::None));
+    coding::putVarint32(out, static_cast<uint32_t>(payload.size()));
+    out.append(payload.data(), payload.size());
+    return out;
+}
+
+bool decodeBlockHeader(std::string_view data, BlockCodec& codec, uint32_t& size, std::string_view& payload) {
+    const char* p = data.data();
+    const char* limit = p + data.size();
+    if (p == limit)
+        return false;
+    uint8_t codecByte = static_cast<uint8_t>(*p++);
+    if (codecByte > static_cast<uint8_t>(BlockCodec::Lz4) || !coding::getVarint32(p, limit, size))
+        return false;
+    codec = static_cast<BlockCodec>(codecByte);
+    payload = std::string_view(p, limit - p);
+    return codec != BlockCodec::None || payload.size() == size;
+}
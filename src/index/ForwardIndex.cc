@@ -0,0 +1,162 @@
+#include "index/ForwardIndex.h"
+
+#include <algorithm>
+
+std::string TermVectorBuilder::finish() {
+    std::sort(occurrences_.begin(), occurrences_.end());
+
+    // Group occurrences into (term id, first occurrence, frequency).
+    struct Term { uint32_t id; size_t first; uint32_t freq; };
+    std::vector<Term> terms;
+    for (size_t i = 0; i < occurrences_.size(); i++) {
+        if (terms.empty() || terms.back().id != occurrences_[i].first)
+            terms.push_back({occurrences_[i].first, i, 0});
+        terms.back().freq++;
+    }
+
+    std::string out;
+    out.push_back(static_cast<char>(storePositions_ ? 1 : 0));
+    coding::putVarint32(out, static_cast<uint32_t>(terms.size()));
+    coding::putVarint32(out, static_cast<uint32_t>(occurrences_.size()));
+
+    std::string payload;
+    uint32_t prevId = 0;
+    for (size_t start = 0; start < terms.size(); start += kTermVectorBlockSize) {
+        size_t end = std::min(terms.size(), start + kTermVectorBlockSize);
+        payload.clear();
+        for (size_t i = start; i < end; i++) {
+            coding::putVarint32(payload, terms[i].id - prevId);
+            prevId = terms[i].id;
+        }
+        for (size_t i = start; i < end; i++)
+            coding::putVarint32(payload, terms[i].freq);
+        if (storePositions_) {
+            for (size_t i = start; i < end; i++) {
+                uint32_t prevPos = 0;
+                for (uint32_t j = 0; j < terms[i].freq; j++) {
+                    uint32_t pos = occurrences_[terms[i].first + j].second;
+                    coding::putVarint32(payload, pos - prevPos);
+                    prevPos = pos;
+                }
+            }
+        }
+        coding::putVarint32(out, static_cast<uint32_t>(end - start));
+        coding::putVarint32(out, terms[end - 1].id);
+        coding::putVarint32(out, static_cast<uint32_t>(payload.size()));
+        out += payload;
+    }
+
+    occurrences_.clear();
+    return out;
+}
+
+bool TermVectorView::parse(std::string_view data) {
+    const char* p = data.data();
+    const char* limit = p + data.size();
+    if (p == limit)
+        return false;
+    flags_ = static_cast<uint8_t>(*p++);
+    if (!coding::getVarint32(p, limit, termCount_) ||
+        !coding::getVarint32(p, limit, length_))
+        return false;
+    blocks_ = p;
+    end_ = limit;
+    return true;
+}
+
+bool TermVectorView::nextBlock(const char*& p, Block& block) const {
+    uint32_t len;
+    if (!coding::getVarint32(p, end_, block.count) ||
+        !coding::getVarint32(p, end_, block.lastId) ||
+        !coding::getVarint32(p, end_, len) ||
+        static_cast<size_t>(end_ - p) < len)
+        return false;
+    block.payload = p;
+    block.end = p + len;
+    p = block.end;
+    return true;
+}
+
+bool TermVectorView::find(uint32_t termId, Block& block, uint32_t& index, const char*& freqs) const {
+    const char* p = blocks_;
+    uint32_t baseId = 0;
+    uint32_t remaining = termCount_;
+    while (remaining > 0) {
+        if (!nextBlock(p, block) || block.count > remaining)
+            return false;
+        remaining -= block.count;
+        if (block.lastId < termId) {
+            baseId = block.lastId;
+            continue;
+        }
+
+        // The term can only be in this block.
+        const char* q = block.payload;
+        uint32_t id = baseId;
+        bool found = false;
+        for (uint32_t i = 0; i < block.count; i++) {
+            uint32_t gap;
+            if (!coding::getVarint32(q, block.end, gap))
+                return false;
+            id += gap;
+            if (id == termId) {
+                index = i;
+                found = true;
+            }
+        }
+        freqs = q;
+        return found;
+    }
+    return false;
+}
+
+uint32_t TermVectorView::freq(uint32_t termId) const {
+    Block block;
+    uint32_t index;
+    const char* p;
+    if (!find(termId, block, index, p))
+        return 0;
+    uint32_t freq = 0;
+    for (uint32_t i = 0; i <= index; i++) {
+        if (!coding::getVarint32(p, block.end, freq))
+            return 0;
+    }
+    return freq;
+}
+
+std::vector<uint32_t> TermVectorView::positions(uint32_t termId) const {
+    std::vector<uint32_t> result;
+    Block block;
+    uint32_t index;
+    const char* p;
+    if (!hasPositions() || !find(termId, block, index, p))
+        return result;
+
+    // Positions of earlier terms in the block come first; count how many to skip.
+    uint32_t skip = 0, freq = 0;
+    for (uint32_t i = 0; i < block.count; i++) {
+        uint32_t f;
+        if (!coding::getVarint32(p, block.end, f))
+            return result;
+        if (i < index)
+            skip += f;
+        else if (i == index)
+            freq = f;
+    }
+    for (uint32_t i = 0; i < skip; i++) {
+        uint32_t gap;
+        if (!coding::getVarint32(p, block.end, gap))
+            return result;
+    }
+
+    result.reserve(freq);
+    uint32_t pos = 0;
+    for (uint32_t i = 0; i < freq; i++) {
+        uint32_t gap;
+        if (!coding::getVarint32(p, block.end, gap))
+            return {};
+        pos += gap;
+        result.push_back(pos);
+    }
+    return result;
+}
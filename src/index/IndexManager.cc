@@ -0,0 +1,219 @@
+#include "index/IndexManager.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char* kCurrentFile = "CURRENT";
+const char* kGenerationPrefix = "gen-";
+
+std::string generationName(uint64_t generation) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%s%06llu", kGenerationPrefix,
+                  static_cast<unsigned long long>(generation));
+    return buf;
+}
+
+// Returns 0 if the name is not a generation directory.
+uint64_t parseGenerationName(const std::string& name) {
+    if (name.rfind(kGenerationPrefix, 0) != 0)
+        return 0;
+    try {
+        return std::stoull(name.substr(std::strlen(kGenerationPrefix)));
+    } catch (const std::exception&) {
+        return 0;
+    }
+}
+
+}
+
+IndexManager::IndexManager(const std::string& rootPath) : root_(rootPath) {
+    fs::create_directories(root_);
+
+    // Never reuse a generation number, even one that was never published.
+    for (const auto& entry : fs::directory_iterator(root_)) {
+        uint64_t generation = parseGenerationName(entry.path().filename().string());
+        if (generation >= nextGeneration_)
+            nextGeneration_ = generation + 1;
+    }
+
+    uint64_t generation = readCurrent();
+    if (generation == 0) {
+        publish(createGeneration());
+        return;
+    }
+
+    auto snapshot = open(generation);
+    warm(*snapshot);
+    std::atomic_store(&current_, snapshot);
+}
+
+IndexManager::~IndexManager() {
+    std::list<Worker> workers;
+    {
+        std::lock_guard<std::mutex> lock(publishMutex_);
+        workers.swap(workers_);
+    }
+    for (Worker& worker : workers)
+        worker.thread.join();
+}
+
+std::shared_ptr<const IndexSnapshot> IndexManager::acquire() const {
+    return std::atomic_load(&current_);
+}
+
+uint64_t IndexManager::createGeneration() {
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lock(publishMutex_);
+        generation = nextGeneration_++;
+    }
+    fs::path path = generationPath(generation);
+    fs::create_directories(path / "index");
+    fs::create_directories(path / "docdb");
+    return generation;
+}
+
+std::string IndexManager::generationPath(uint64_t generation) const {
+    return (fs::path(root_) / generationName(generation)).string();
+}
+
+void IndexManager::publish(uint64_t generation) {
+    auto snapshot = open(generation);
+    warm(*snapshot);
+    swap(std::move(snapshot));
+}
+
+std::future<void> IndexManager::publishAsync(uint64_t generation) {
+    auto done = std::make_shared<std::atomic<bool>>(false);
+    std::packaged_task<void()> task([this, generation]() { publish(generation); });
+    std::future<void> result = task.get_future();
+
+    std::lock_guard<std::mutex> lock(publishMutex_);
+    // Reap finished workers so a long-running server does not accumulate them.
+    for (auto it = workers_.begin(); it != workers_.end();) {
+        if (it->done->load()) {
+            it->thread.join();
+            it = workers_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    workers_.push_back({std::thread([task = std::move(task), done]() mutable {
+                            task();
+                            done->store(true);
+                        }),
+                        done});
+    return result;
+}
+
+uint64_t IndexManager::compact() {
+    auto snapshot = acquire();
+    uint64_t generation = createGeneration();
+    fs::path path = generationPath(generation);
+
+    snapshot->index->compactTo((path / "index").string());
+    snapshot->docs->compactTo((path / "docdb").string());
+    if (snapshot->lexicon)
+        fs::copy_file(fs::path(snapshot->path) / "lexicon", path / "lexicon");
+
+    publish(generation);
+    return generation;
+}
+
+void IndexManager::setWarmupTerms(std::vector<std::string> terms) {
+    std::lock_guard<std::mutex> lock(publishMutex_);
+    warmupTerms_ = std::move(terms);
+}
+
+size_t IndexManager::collectGarbage() {
+    std::lock_guard<std::mutex> lock(publishMutex_);
+    uint64_t published = std::atomic_load(&current_)->generation;
+
+    size_t removed = 0;
+    for (auto it = retired_.begin(); it != retired_.end();) {
+        if (!it->second.expired()) {
+            ++it;
+            continue;
+        }
+        if (it->first != published) {
+            fs::remove_all(generationPath(it->first));
+            ++removed;
+        }
+        it = retired_.erase(it);
+    }
+    return removed;
+}
+
+std::shared_ptr<const IndexSnapshot> IndexManager::open(uint64_t generation) const {
+    fs::path path = generationPath(generation);
+    if (!fs::is_directory(path))
+        throw std::runtime_error("Index generation not found: " + path.string());
+
+    auto snapshot = std::make_shared<IndexSnapshot>();
+    snapshot->generation = generation;
+    snapshot->path = path.string();
+    snapshot->index = std::make_shared<Database>((path / "index").string());
+    snapshot->docs = std::make_shared<DocDatabase>((path / "docdb").string());
+    if (fs::exists(path / "lexicon"))
+        snapshot->lexicon = std::make_shared<Lexicon>((path / "lexicon").string());
+    return snapshot;
+}
+
+void IndexManager::warm(const IndexSnapshot& snapshot) const {
+    std::vector<std::string> terms;
+    {
+        std::lock_guard<std::mutex> lock(publishMutex_);
+        terms = warmupTerms_;
+    }
+    for (const std::string& term : terms) {
+        if (snapshot.index->termDocCount(term) > 0)
+            snapshot.index->get(term);
+    }
+}
+
+void IndexManager::swap(std::shared_ptr<const IndexSnapshot> next) {
+    std::lock_guard<std::mutex> lock(publishMutex_);
+    auto published = std::atomic_load(&current_);
+    if (published && next->generation < published->generation) {
+        // A newer generation won the race; this one is retired unpublished.
+        retired_.emplace_back(next->generation, next);
+        return;
+    }
+    writeCurrent(next->generation);
+
+    auto previous = std::atomic_exchange(&current_, std::move(next));
+    if (previous)
+        retired_.emplace_back(previous->generation, previous);
+    // 'previous' is released here; the generation closes once in-flight
+    // queries drop their references.
+}
+
+void IndexManager::writeCurrent(uint64_t generation) const {
+    fs::path current = fs::path(root_) / kCurrentFile;
+    fs::path staged = fs::path(root_) / (std::string(kCurrentFile) + ".tmp");
+    {
+        std::ofstream out(staged, std::ios::trunc);
+        out << generationName(generation) << "\n";
+        if (!out)
+            throw std::runtime_error("Failed to write " + staged.string());
+    }
+    // rename() replaces the old pointer atomically, so a crash never leaves
+    // CURRENT half-written.
+    fs::rename(staged, current);
+}
+
+uint64_t IndexManager::readCurrent() const {
+    std::ifstream in(fs::path(root_) / kCurrentFile);
+    std::string name;
+    if (!in || !std::getline(in, name))
+        return 0;
+    return parseGenerationName(name);
+}
@@ -0,0 +1,318 @@
+#include "index/Lexicon.h"
+#include "index/Coding.h"
+#include "Database.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const uint32_t kLexiconMagic = 0x58454c53; // "SLEX"
+const uint32_t kLexiconVersion = 1;
+
+struct LexiconHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t termCount;
+    uint32_t blockSize;
+    uint64_t statsOffset;
+    uint64_t indexOffset;
+    uint64_t blocksOffset;
+    uint64_t fileSize;
+};
+
+// Size of one entry of the stats section: u32 df, f32 max score.
+const size_t kStatSize = 8;
+
+void putFixed32(std::string& dst, uint32_t value) {
+    dst.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+}
+
+Lexicon::Lexicon(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Failed to open lexicon: " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(LexiconHeader)) {
+        ::close(fd);
+        throw std::runtime_error("Corrupt lexicon: " + path);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED)
+        throw std::runtime_error("Failed to map lexicon: " + path);
+    data_ = static_cast<const char*>(mapped);
+
+    LexiconHeader header;
+    std::memcpy(&header, data_, sizeof(header));
+    uint64_t blockCount = (uint64_t(header.termCount) + kLexiconBlockSize - 1) / kLexiconBlockSize;
+    bool valid = header.magic == kLexiconMagic && header.version == kLexiconVersion &&
+                 header.blockSize == kLexiconBlockSize && header.fileSize == size_ &&
+                 header.statsOffset >= sizeof(header) &&
+                 header.indexOffset >= header.statsOffset + uint64_t(header.termCount) * kStatSize &&
+                 header.blocksOffset >= header.indexOffset + blockCount * sizeof(uint32_t) &&
+                 header.blocksOffset <= size_;
+    if (!valid) {
+        ::munmap(const_cast<char*>(data_), size_);
+        throw std::runtime_error("Corrupt lexicon: " + path);
+    }
+
+    termCount_ = header.termCount;
+    blockCount_ = static_cast<uint32_t>(blockCount);
+    stats_ = data_ + header.statsOffset;
+    blockIndex_ = data_ + header.indexOffset;
+    blocks_ = data_ + header.blocksOffset;
+    end_ = data_ + size_;
+}
+
+Lexicon::~Lexicon() {
+    if (data_)
+        ::munmap(const_cast<char*>(data_), size_);
+}
+
+std::optional<TermInfo> Lexicon::find(std::string_view term) const {
+    if (termCount_ == 0)
+        return std::nullopt;
+    uint32_t block = findBlock(term);
+    uint32_t blockEnd = std::min(termCount_, (block + 1) * kLexiconBlockSize);
+    for (Iterator it = iterate(block * kLexiconBlockSize); it.id() < blockEnd; it.next()) {
+        int cmp = it.term().compare(term);
+        if (cmp == 0)
+            return info(it.id());
+        if (cmp > 0)
+            break;
+    }
+    return std::nullopt;
+}
+
+TermInfo Lexicon::info(uint32_t id) const {
+    if (id >= termCount_)
+        throw std::out_of_range("Term id out of range");
+    TermInfo info;
+    info.id = id;
+    std::memcpy(&info.df, stats_ + size_t(id) * kStatSize, sizeof(info.df));
+    std::memcpy(&info.maxScore, stats_ + size_t(id) * kStatSize + 4, sizeof(info.maxScore));
+    return info;
+}
+
+std::string Lexicon::term(uint32_t id) const {
+    if (id >= termCount_)
+        throw std::out_of_range("Term id out of range");
+    return std::string(iterate(id).term());
+}
+
+uint32_t Lexicon::lowerBound(std::string_view term) const {
+    if (termCount_ == 0)
+        return 0;
+    uint32_t block = findBlock(term);
+    uint32_t blockEnd = std::min(termCount_, (block + 1) * kLexiconBlockSize);
+    Iterator it = iterate(block * kLexiconBlockSize);
+    while (it.id() < blockEnd && it.term() < term)
+        it.next();
+    return it.id();
+}
+
+std::pair<uint32_t, uint32_t> Lexicon::prefixRange(std::string_view prefix) const {
+    uint32_t begin = lowerBound(prefix);
+
+    // The first string after every string with this prefix: drop trailing
+    // 0xff bytes and increment the last remaining one.
+    std::string successor(prefix);
+    while (!successor.empty() && static_cast<unsigned char>(successor.back()) == 0xff)
+        successor.pop_back();
+    if (successor.empty())
+        return {begin, termCount_};
+    successor.back() = static_cast<char>(static_cast<unsigned char>(successor.back()) + 1);
+    return {begin, lowerBound(successor)};
+}
+
+const char* Lexicon::blockStart(uint32_t block) const {
+    uint32_t offset;
+    std::memcpy(&offset, blockIndex_ + size_t(block) * sizeof(uint32_t), sizeof(offset));
+    if (offset >= static_cast<size_t>(end_ - blocks_))
+        throw std::runtime_error("Corrupt lexicon block index");
+    return blocks_ + offset;
+}
+
+std::string_view Lexicon::blockFirstTerm(uint32_t block) const {
+    const char* p = blockStart(block);
+    std::string_view term;
+    if (!coding::getLengthPrefixed(p, end_, term))
+        throw std::runtime_error("Corrupt lexicon block");
+    return term;
+}
+
+uint32_t Lexicon::findBlock(std::string_view term, uint32_t lo, uint32_t hi) const {
+    // Binary search for the last block whose first term is <= term.
+    while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (blockFirstTerm(mid) <= term)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+Lexicon::Iterator::Iterator(const Lexicon* lexicon, uint32_t id) : lexicon_(lexicon), id_(id) {
+    if (id_ >= lexicon_->termCount_) {
+        id_ = lexicon_->termCount_;
+        return;
+    }
+    uint32_t block = id_ / kLexiconBlockSize;
+    loadBlockStart(block);
+    for (uint32_t i = block * kLexiconBlockSize; i < id_; i++)
+        decodeNext();
+    shared_ = 0;
+}
+
+void Lexicon::Iterator::next() {
+    if (!valid())
+        return;
+    id_++;
+    if (!valid())
+        return;
+    if (id_ % kLexiconBlockSize != 0) {
+        decodeNext();
+        return;
+    }
+
+    // A new block restarts front coding; work out the shared prefix directly.
+    std::string_view first = lexicon_->blockFirstTerm(id_ / kLexiconBlockSize);
+    size_t common = 0;
+    while (common < first.size() && common < term_.size() && first[common] == term_[common])
+        common++;
+    loadBlockStart(id_ / kLexiconBlockSize);
+    shared_ = common;
+}
+
+void Lexicon::Iterator::skipTo(std::string_view target) {
+    if (!valid() || term_ >= target)
+        return;
+
+    // Terms are sorted, so the prefix shared with the term before the skip is
+    // the smallest prefix shared by any two consecutive terms passed over.
+    size_t common = term_.size();
+    uint32_t nextBlock = id_ / kLexiconBlockSize + 1;
+    if (nextBlock < lexicon_->blockCount_ && lexicon_->blockFirstTerm(nextBlock) <= target) {
+        // Gallop to a block past the target, then binary search the last step.
+        uint32_t lo = nextBlock, step = 1;
+        while (step < lexicon_->blockCount_ - lo && lexicon_->blockFirstTerm(lo + step) <= target) {
+            lo += step;
+            step *= 2;
+        }
+        uint32_t block = lexicon_->findBlock(target, lo, std::min(lo + step, lexicon_->blockCount_));
+        std::string_view first = lexicon_->blockFirstTerm(block);
+        common = 0;
+        while (common < first.size() && common < term_.size() && first[common] == term_[common])
+            common++;
+        loadBlockStart(block);
+        id_ = block * kLexiconBlockSize;
+    }
+    while (valid() && term_ < target) {
+        next();
+        common = std::min(common, shared_);
+    }
+    shared_ = common;
+}
+
+void Lexicon::Iterator::loadBlockStart(uint32_t block) {
+    p_ = lexicon_->blockStart(block);
+    std::string_view first;
+    if (!coding::getLengthPrefixed(p_, lexicon_->end_, first))
+        throw std::runtime_error("Corrupt lexicon block");
+    term_.assign(first.data(), first.size());
+    shared_ = 0;
+}
+
+void Lexicon::Iterator::decodeNext() {
+    uint32_t shared;
+    std::string_view suffix;
+    if (!coding::getVarint32(p_, lexicon_->end_, shared) || shared > term_.size() ||
+        !coding::getLengthPrefixed(p_, lexicon_->end_, suffix))
+        throw std::runtime_error("Corrupt lexicon block");
+    term_.resize(shared);
+    term_.append(suffix.data(), suffix.size());
+    shared_ = shared;
+}
+
+void Lexicon::build(Database& db, const std::string& path,
+                    const std::function<float(uint32_t, int)>& maxScore) {
+    LexiconBuilder builder;
+    db.forEachKey([&](const std::string& key, unsigned int count, int maxPriority) {
+        float score = maxScore ? maxScore(count, maxPriority) : static_cast<float>(maxPriority);
+        builder.add(key, count, score);
+    });
+    builder.write(path);
+}
+
+void LexiconBuilder::add(std::string term, uint32_t df, float maxScore) {
+    entries_.push_back({std::move(term), df, maxScore});
+}
+
+void LexiconBuilder::write(const std::string& path) {
+    std::sort(entries_.begin(), entries_.end(),
+              [](const Entry& a, const Entry& b) { return a.term < b.term; });
+    for (size_t i = 1; i < entries_.size(); i++) {
+        if (entries_[i].term == entries_[i - 1].term)
+            throw std::runtime_error("Duplicate lexicon term: " + entries_[i].term);
+    }
+
+    uint32_t termCount = static_cast<uint32_t>(entries_.size());
+    uint32_t blockCount = (termCount + kLexiconBlockSize - 1) / kLexiconBlockSize;
+
+    std::string stats, index, blocks;
+    stats.reserve(size_t(termCount) * kStatSize);
+    index.reserve(size_t(blockCount) * sizeof(uint32_t));
+    for (uint32_t id = 0; id < termCount; id++) {
+        const Entry& entry = entries_[id];
+        putFixed32(stats, entry.df);
+        stats.append(reinterpret_cast<const char*>(&entry.maxScore), sizeof(entry.maxScore));
+
+        if (id % kLexiconBlockSize == 0) {
+            putFixed32(index, static_cast<uint32_t>(blocks.size()));
+            coding::putLengthPrefixed(blocks, entry.term);
+            continue;
+        }
+        const std::string& previous = entries_[id - 1].term;
+        size_t shared = 0;
+        while (shared < previous.size() && shared < entry.term.size() && previous[shared] == entry.term[shared])
+            shared++;
+        coding::putVarint32(blocks, static_cast<uint32_t>(shared));
+        coding::putLengthPrefixed(blocks, std::string_view(entry.term).substr(shared));
+    }
+
+    LexiconHeader header;
+    header.magic = kLexiconMagic;
+    header.version = kLexiconVersion;
+    header.termCount = termCount;
+    header.blockSize = kLexiconBlockSize;
+    header.statsOffset = sizeof(header);
+    header.indexOffset = header.statsOffset + stats.size();
+    header.blocksOffset = header.indexOffset + index.size();
+    header.fileSize = header.blocksOffset + blocks.size();
+
+    std::string staged = path + ".tmp";
+    {
+        std::ofstream out(staged, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(stats.data(), stats.size());
+        out.write(index.data(), index.size());
+        out.write(blocks.data(), blocks.size());
+        if (!out)
+            throw std::runtime_error("Failed to write lexicon: " + staged);
+    }
+    if (std::rename(staged.c_str(), path.c_str()) != 0)
+        throw std::runtime_error("Failed to replace lexicon: " + path);
+}
@@ -0,0 +1,161 @@
+#include "index/Lz4.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+const size_t kMinMatch = 4;
+const size_t kLastLiterals = 5;   // a block always ends with at least this many literals
+const size_t kMatchFindLimit = 12; // no match may start within this many bytes of the end
+const size_t kMaxOffset = 65535;
+const int kHashLog = 12;
+
+uint32_t read32(const char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t hash(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - kHashLog);
+}
+
+// Append a length that did not fit in its 4-bit token field.
+void putExtraLength(std::string& out, size_t length) {
+    while (length >= 255) {
+        out.push_back(static_cast<char>(255));
+        length -= 255;
+    }
+    out.push_back(static_cast<char>(length));
+}
+
+bool getExtraLength(const char*& p, const char* limit, size_t& length) {
+    unsigned char byte;
+    do {
+        if (p >= limit)
+            return false;
+        byte = static_cast<unsigned char>(*p++);
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+void putSequence(std::string& out, const char* literals, size_t literalLength,
+                 size_t offset, size_t matchLength) {
+    size_t matchCode = matchLength - kMinMatch;
+    char token = static_cast<char>(((literalLength < 15 ? literalLength : 15) << 4) |
+                                   (matchCode < 15 ? matchCode : 15));
+    out.push_back(token);
+    if (literalLength >= 15)
+        putExtraLength(out, literalLength - 15);
+    out.append(literals, literalLength);
+    out.push_back(static_cast<char>(offset & 0xff));
+    out.push_back(static_cast<char>(offset >> 8));
+    if (matchCode >= 15)
+        putExtraLength(out, matchCode - 15);
+}
+
+void putLastLiterals(std::string& out, const char* literals, size_t literalLength) {
+    out.push_back(static_cast<char>((literalLength < 15 ? literalLength : 15) << 4));
+    if (literalLength >= 15)
+        putExtraLength(out, literalLength - 15);
+    out.append(literals, literalLength);
+}
+
+}
+
+namespace lz4 {
+
+std::string compress(std::string_view input) {
+    const char* base = input.data();
+    const size_t n = input.size();
+    std::string out;
+    out.reserve(n + n / 255 + 16);
+
+    size_t anchor = 0;
+    if (n > kMatchFindLimit) {
+        // Most recent position of each hashed 4-byte sequence.
+        std::vector<uint32_t> table(size_t(1) << kHashLog, 0);
+        const size_t matchLimit = n - kLastLiterals;
+        size_t ip = 1;
+        while (ip < n - kMatchFindLimit) {
+            uint32_t sequence = read32(base + ip);
+            uint32_t h = hash(sequence);
+            size_t ref = table[h];
+            table[h] = static_cast<uint32_t>(ip);
+            if (ip - ref > kMaxOffset || read32(base + ref) != sequence) {
+                ip++;
+                continue;
+            }
+
+            // Extend backwards over literals, then forwards.
+            while (ip > anchor && ref > 0 && base[ip - 1] == base[ref - 1]) {
+                ip--;
+                ref--;
+            }
+            size_t length = kMinMatch;
+            while (ip + length < matchLimit && base[ip + length] == base[ref + length])
+                length++;
+
+            putSequence(out, base + anchor, ip - anchor, ip - ref, length);
+            ip += length;
+            anchor = ip;
+            if (ip < n - kMatchFindLimit)
+                table[hash(read32(base + ip - 2))] = static_cast<uint32_t>(ip - 2);
+        }
+    }
+    putLastLiterals(out, base + anchor, n - anchor);
+    return out;
+}
+
+bool decompress(std::string_view input, char* output, size_t outputSize) {
+    const char* p = input.data();
+    const char* limit = p + input.size();
+    size_t op = 0;
+
+    while (p < limit) {
+        unsigned char token = static_cast<unsigned char>(*p++);
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !getExtraLength(p, limit, literalLength))
+            return false;
+        if (static_cast<size_t>(limit - p) < literalLength || outputSize - op < literalLength)
+            return false;
+        std::memcpy(output + op, p, literalLength);
+        p += literalLength;
+        op += literalLength;
+
+        // The last sequence has literals only.
+        if (p == limit)
+            break;
+
+        if (limit - p < 2)
+            return false;
+        size_t offset = static_cast<unsigned char>(p[0]) | (static_cast<unsigned char>(p[1]) << 8);
+        p += 2;
+        if (offset == 0 || offset > op)
+            return false;
+
+        size_t matchLength = token & 0x0f;
+        if (matchLength == 15 && !getExtraLength(p, limit, matchLength))
+            return false;
+        matchLength += kMinMatch;
+        if (outputSize - op < matchLength)
+            return false;
+
+        // Matches may overlap their own output (runs), so copy forwards.
+        const char* match = output + op - offset;
+        if (offset >= matchLength) {
+            std::memcpy(output + op, match, matchLength);
+        } else {
+            for (size_t i = 0; i < matchLength; i++)
+                output[op + i] = match[i];
+        }
+        op += matchLength;
+    }
+    return op == outputSize;
+}
+
+} // namespace lz4
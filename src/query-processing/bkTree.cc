@@ -1,80 +1,165 @@
 #include "../../include/query-processing/bkTree.h"
+#include "../../include/query-processing/editDistance.h"
 #include <algorithm>
+#include <cstdlib>
 #include <limits>
 
 namespace bk {
 
-BKTree::BKTree() : root(nullptr) {}
+BKTree::BKTree() {}
 
-BKTree::BKTree(const Dictionary& dict) : root(nullptr) {
+BKTree::BKTree(const Dictionary& dict) {
     for (const auto& word : dict) {
         insert(word);
     }
+    compact();
 }
 
 void BKTree::insert(const std::string& word) {
-    if (!root) {
-        root = std::make_unique<Node>(word);
+    if (nodes.empty()) {
+        nodes.push_back({0, static_cast<uint32_t>(word.size()), 0, 0, 0});
+        words = word;
         return;
     }
-    Node* node = root.get();
+
+    spell::EditDistance metric(word);
+    uint32_t index = 0;
     while (true) {
-        int dist = editDistance(word, node->word);
-        if (node->children.find(dist) == node->children.end()) {
-            node->children[dist] = std::make_unique<Node>(word);
-            break;
+        int dist = metric.distance(this->word(nodes[index]), std::numeric_limits<int>::max() - 1);
+        if (dist == 0) return;  // already present
+
+        const Node& node = nodes[index];
+        auto begin = nodes.begin() + node.firstChild;
+        auto end = begin + node.childCount;
+        auto child = std::lower_bound(begin, end, static_cast<uint32_t>(dist),
+                                      [](const Node& n, uint32_t d) { return n.distance < d; });
+        if (child == end || child->distance != static_cast<uint32_t>(dist)) {
+            addChild(index, word, dist);
+            return;
         }
-        node = node->children[dist].get();
+        index = static_cast<uint32_t>(child - nodes.begin());
     }
 }
 
-std::string BKTree::findClosest(const std::string& query, int threshold) const {
-    if (!root || query.empty()) return query;
-
-    std::string bestMatch = query;
-    int bestDistance = threshold + 1;
-
-    search(root.get(), query, threshold, bestMatch, bestDistance);
-
-    // If no valid match was found within the threshold, return the original query
-    return (bestDistance <= threshold) ? bestMatch : query;
-}
+void BKTree::addChild(uint32_t parent, const std::string& word, int distance) {
+    // Spans cannot grow in place, so the parent's children move to the end of
+    // the array with the new node slotted in by distance. Their own child
+    // spans do not move.
+    uint32_t oldFirst = nodes[parent].firstChild;
+    uint32_t count = nodes[parent].childCount;
+    uint32_t newFirst = static_cast<uint32_t>(nodes.size());
+
+    Node added{static_cast<uint32_t>(words.size()), static_cast<uint32_t>(word.size()),
+               static_cast<uint32_t>(distance), 0, 0};
+    words += word;
+
+    bool placed = false;
+    for (uint32_t i = 0; i < count; ++i) {
+        Node moved = nodes[oldFirst + i];
+        if (!placed && added.distance < moved.distance) {
+            nodes.push_back(added);
+            placed = true;
+        }
+        nodes.push_back(moved);
+    }
+    if (!placed) nodes.push_back(added);
 
-void BKTree::search(const Node* node, const std::string& query, int threshold,
-                    std::string& bestMatch, int& bestDistance) const {
-    if (!node) return;
+    nodes[parent].firstChild = newFirst;
+    nodes[parent].childCount = count + 1;
+    unusedNodes += count;
 
-    int dist = editDistance(query, node->word);
-    if (dist < bestDistance) {
-        bestDistance = dist;
-        bestMatch = node->word;
+    if (unusedNodes > nodes.size() / 2) {
+        compact();
     }
+}
 
-    for (const auto& [d, child] : node->children) {
-        if (d >= dist - threshold && d <= dist + threshold) {
-            search(child.get(), query, threshold, bestMatch, bestDistance);
+void BKTree::compact() {
+    if (nodes.empty()) return;
+
+    std::vector<Node> laidOut;
+    std::string packed;
+    laidOut.reserve(nodes.size() - unusedNodes);
+    packed.reserve(words.size());
+
+    // Breadth-first: copy each node's children as one span, then fix the
+    // parent to point at it; the children are visited after their siblings.
+    auto copyWord = [&](Node& node) {
+        std::string_view w = word(node);
+        node.offset = static_cast<uint32_t>(packed.size());
+        packed.append(w.data(), w.size());
+    };
+    laidOut.push_back(nodes[0]);
+    copyWord(laidOut[0]);
+    for (size_t next = 0; next < laidOut.size(); ++next) {
+        uint32_t first = laidOut[next].firstChild;
+        uint32_t count = laidOut[next].childCount;
+        laidOut[next].firstChild = static_cast<uint32_t>(laidOut.size());
+        for (uint32_t i = 0; i < count; ++i) {
+            laidOut.push_back(nodes[first + i]);
+            copyWord(laidOut.back());
         }
     }
+
+    nodes.swap(laidOut);
+    words.swap(packed);
+    unusedNodes = 0;
 }
 
-int BKTree::editDistance(const std::string& a, const std::string& b) {
-    size_t n = a.size(), m = b.size();
-    std::vector<int> prev(m + 1, 0), curr(m + 1, 0);
+std::string BKTree::findClosest(const std::string& query, int threshold) const {
+    if (nodes.empty() || query.empty()) return query;
 
-    for (size_t j = 0; j <= m; ++j) prev[j] = j;
+    spell::EditDistance metric(query);
+    int bestDistance = threshold + 1;
+    uint32_t bestNode = 0;
+
+    // Pending nodes with |edge distance - parent's distance|: a node is only
+    // visited if that is still within the radius when it is popped.
+    std::vector<std::pair<uint32_t, int>> stack;
+    stack.emplace_back(0, 0);
+    while (!stack.empty()) {
+        auto [index, slack] = stack.back();
+        stack.pop_back();
+
+        // Only strictly closer words can change the answer.
+        int radius = std::min(threshold, bestDistance - 1);
+        if (slack > radius) continue;
+
+        // Distances past the farthest child plus the radius rule out the
+        // node and all of its children alike, so they need not be exact.
+        const Node& node = nodes[index];
+        uint32_t farthest = node.childCount ? nodes[node.firstChild + node.childCount - 1].distance : 0;
+        int dist = metric.distance(word(node), radius + static_cast<int>(farthest));
+        if (dist <= radius) {
+            bestDistance = dist;
+            bestNode = index;
+            radius = dist - 1;
+            if (radius < 0) break;
+        }
 
-    for (size_t i = 1; i <= n; ++i) {
-        curr[0] = i;
-        for (size_t j = 1; j <= m; ++j) {
-            if (a[i - 1] == b[j - 1]) {
-                curr[j] = prev[j - 1];
+        // Push the children in range so the one whose distance is closest to
+        // dist pops first: it is the likeliest to hold a close word, and a
+        // close word early shrinks the radius for everything else.
+        auto first = nodes.begin() + node.firstChild;
+        auto end = first + node.childCount;
+        auto low = std::lower_bound(first, end, static_cast<uint32_t>(std::max(dist - radius, 0)),
+                                    [](const Node& n, uint32_t d) { return n.distance < d; });
+        auto high = std::upper_bound(low, end, static_cast<uint32_t>(dist + radius),
+                                     [](uint32_t d, const Node& n) { return d < n.distance; });
+        while (low < high) {
+            int lowSlack = std::abs(static_cast<int>(low->distance) - dist);
+            int highSlack = std::abs(static_cast<int>((high - 1)->distance) - dist);
+            if (lowSlack >= highSlack) {
+                stack.emplace_back(static_cast<uint32_t>(low - nodes.begin()), lowSlack);
+                ++low;
             } else {
-                curr[j] = 1 + std::min({prev[j], curr[j - 1], prev[j - 1]});
+                --high;
+                stack.emplace_back(static_cast<uint32_t>(high - nodes.begin()), highSlack);
             }
         }
-        std::swap(prev, curr);
     }
-    return prev[m];
+
+    // If no valid match was found within the threshold, return the original query
+    return (bestDistance <= threshold) ? std::string(word(nodes[bestNode])) : query;
 }
 
 
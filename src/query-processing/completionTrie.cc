@@ -0,0 +1,340 @@
+#include "../../include/query-processing/completionTrie.h"
+#include "../../include/query-processing/tokenizer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace completion {
+
+namespace {
+
+const uint32_t COMPLETION_TRIE_MAGIC = 0x4c504d43;  // "CMPL"
+const uint32_t NO_NODE = UINT32_MAX;
+
+// Fields of a node record, each a u32.
+enum NodeField { LABEL_OFFSET, LABEL_LENGTH, FIRST_CHILD, CHILD_COUNT, FIRST_TOP, TOP_COUNT, NODE_FIELDS };
+const size_t NODE_SIZE = NODE_FIELDS * sizeof(uint32_t);
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t topK;
+    uint32_t nodeCount;
+    uint32_t completionCount;
+    uint32_t topCount;
+    uint32_t textSize;
+    uint32_t reserved;
+    uint64_t fileSize;
+};
+
+uint32_t readU32(const char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint64_t readU64(const char* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+void appendU32(std::string& out, uint32_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendU64(std::string& out, uint64_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/**
+ * @brief A node under construction: the completions [lo, hi) pass through
+ *        it, its label is their bytes [depth, end).
+ */
+struct BuildNode {
+    uint32_t lo, hi;
+    uint32_t depth, end;
+    uint32_t firstChild = 0, childCount = 0;
+};
+
+} // namespace
+
+CompletionTrie::CompletionTrie(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open completion trie: " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        ::close(fd);
+        throw std::runtime_error("Corrupt completion trie: " + path);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    void* region = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (region == MAP_FAILED) {
+        throw std::runtime_error("Failed to map completion trie: " + path);
+    }
+    data = static_cast<const char*>(region);
+
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    std::string error;
+    if (header.magic != COMPLETION_TRIE_MAGIC) {
+        error = "Not a completion trie: " + path;
+    } else if (header.version != COMPLETION_TRIE_VERSION) {
+        error = "Unsupported completion trie version " + std::to_string(header.version) + ": " + path;
+    } else if (!attach()) {
+        error = "Corrupt completion trie: " + path;
+    }
+    if (!error.empty()) {
+        ::munmap(const_cast<char*>(data), size_);
+        throw std::runtime_error(error);
+    }
+}
+
+CompletionTrie::~CompletionTrie() {
+    ::munmap(const_cast<char*>(data), size_);
+}
+
+bool CompletionTrie::attach() {
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    uint64_t expected = sizeof(header) + uint64_t(header.nodeCount) * NODE_SIZE +
+                        uint64_t(header.topCount) * sizeof(uint32_t) +
+                        uint64_t(header.completionCount) * sizeof(uint64_t) +
+                        (uint64_t(header.completionCount) + 1) * sizeof(uint32_t) + header.textSize;
+    if (header.fileSize != size_ || expected != size_ || header.nodeCount == 0) {
+        return false;
+    }
+    k = header.topK;
+    nodeCount = header.nodeCount;
+    completionCount = header.completionCount;
+    textSize = header.textSize;
+    nodes = data + sizeof(header);
+    tops = nodes + size_t(nodeCount) * NODE_SIZE;
+    weights = tops + size_t(header.topCount) * sizeof(uint32_t);
+    offsets = weights + size_t(completionCount) * sizeof(uint64_t);
+    text = offsets + (size_t(completionCount) + 1) * sizeof(uint32_t);
+
+    // Check every reference once, so lookups need no bounds checks.
+    uint32_t previous = 0;
+    for (uint32_t id = 0; id <= completionCount; ++id) {
+        uint32_t offset = readU32(offsets + size_t(id) * sizeof(uint32_t));
+        if (offset < previous || offset > textSize) return false;
+        previous = offset;
+    }
+    for (uint32_t node = 0; node < nodeCount; ++node) {
+        const char* record = nodes + size_t(node) * NODE_SIZE;
+        uint64_t labelEnd = uint64_t(readU32(record + LABEL_OFFSET * 4)) + readU32(record + LABEL_LENGTH * 4);
+        uint64_t childEnd = uint64_t(readU32(record + FIRST_CHILD * 4)) + readU32(record + CHILD_COUNT * 4);
+        uint64_t topEnd = uint64_t(readU32(record + FIRST_TOP * 4)) + readU32(record + TOP_COUNT * 4);
+        if (labelEnd > textSize || childEnd > nodeCount || topEnd > header.topCount) return false;
+        if (node > 0 && readU32(record + LABEL_LENGTH * 4) == 0) return false;
+        if (readU32(record + CHILD_COUNT * 4) > 0 && readU32(record + FIRST_CHILD * 4) <= node) return false;
+    }
+    for (uint32_t i = 0; i < header.topCount; ++i) {
+        if (readU32(tops + size_t(i) * sizeof(uint32_t)) >= completionCount) return false;
+    }
+    return true;
+}
+
+std::string_view CompletionTrie::label(uint32_t node) const {
+    const char* record = nodes + size_t(node) * NODE_SIZE;
+    return std::string_view(text + readU32(record + LABEL_OFFSET * 4), readU32(record + LABEL_LENGTH * 4));
+}
+
+uint32_t CompletionTrie::child(uint32_t node, char c) const {
+    const char* record = nodes + size_t(node) * NODE_SIZE;
+    uint32_t lo = readU32(record + FIRST_CHILD * 4);
+    uint32_t hi = lo + readU32(record + CHILD_COUNT * 4);
+    // Binary search the children by the first byte of their label.
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        unsigned char first = static_cast<unsigned char>(label(mid)[0]);
+        if (first == static_cast<unsigned char>(c)) return mid;
+        if (first < static_cast<unsigned char>(c)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return NO_NODE;
+}
+
+std::string_view CompletionTrie::completionText(uint32_t id) const {
+    uint32_t start = readU32(offsets + size_t(id) * sizeof(uint32_t));
+    uint32_t end = readU32(offsets + (size_t(id) + 1) * sizeof(uint32_t));
+    return std::string_view(text + start, end - start);
+}
+
+std::vector<Suggestion> CompletionTrie::complete(std::string_view prefix, size_t limit) const {
+    std::vector<Suggestion> suggestions;
+    uint32_t node = 0;
+    size_t matched = 0;
+    while (matched < prefix.size()) {
+        node = child(node, prefix[matched]);
+        if (node == NO_NODE) {
+            return suggestions;
+        }
+        // The prefix may end inside the label.
+        std::string_view edge = label(node);
+        size_t n = std::min(edge.size(), prefix.size() - matched);
+        if (edge.compare(0, n, prefix.substr(matched, n)) != 0) {
+            return suggestions;
+        }
+        matched += n;
+    }
+
+    const char* record = nodes + size_t(node) * NODE_SIZE;
+    const char* top = tops + size_t(readU32(record + FIRST_TOP * 4)) * sizeof(uint32_t);
+    size_t count = std::min<size_t>(readU32(record + TOP_COUNT * 4), limit);
+    suggestions.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t id = readU32(top + i * sizeof(uint32_t));
+        suggestions.push_back({completionText(id), readU64(weights + size_t(id) * sizeof(uint64_t))});
+    }
+    return suggestions;
+}
+
+std::vector<Suggestion> CompletionTrie::suggest(std::string_view typed, size_t limit) const {
+    std::string prefix = normalize(typed);
+    if (!prefix.empty() && std::string_view(" \t\n\v\f\r").find(typed.back()) != std::string_view::npos) {
+        prefix.push_back(' ');
+    }
+    return complete(prefix, limit);
+}
+
+std::string CompletionTrie::normalize(std::string_view text) {
+    thread_local tokenizer::TokenBuffer buffer;
+    tokenizer::tokenize(text, buffer);
+    std::string normalized;
+    for (std::string_view token : buffer) {
+        if (!normalized.empty()) normalized.push_back(' ');
+        normalized.append(token);
+    }
+    return normalized;
+}
+
+void CompletionTrie::build(const Completions& completions, const std::string& path, uint32_t topK) {
+    std::vector<std::pair<std::string_view, uint64_t>> sorted;
+    sorted.reserve(completions.size());
+    for (const auto& [completion, weight] : completions) {
+        if (!completion.empty()) sorted.emplace_back(completion, weight);
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    std::string textSection;
+    std::string offsetSection;
+    std::string weightSection;
+    std::vector<uint32_t> textOffset;
+    for (const auto& [completion, weight] : sorted) {
+        textOffset.push_back(static_cast<uint32_t>(textSection.size()));
+        appendU32(offsetSection, textOffset.back());
+        appendU64(weightSection, weight);
+        textSection.append(completion);
+    }
+    appendU32(offsetSection, static_cast<uint32_t>(textSection.size()));
+
+    // Nodes are created breadth first, so the children of a node are
+    // contiguous and come after it. A node's completions share the bytes
+    // up to its end; its children split them by the next byte.
+    std::vector<BuildNode> trie;
+    trie.push_back({0, static_cast<uint32_t>(sorted.size()), 0, 0});
+    for (size_t i = 0; i < trie.size(); ++i) {
+        BuildNode node = trie[i];
+        uint32_t j = node.lo;
+        if (j < node.hi && sorted[j].first.size() == node.end) {
+            ++j;  // the completion ending here sorts first
+        }
+        trie[i].firstChild = static_cast<uint32_t>(trie.size());
+        while (j < node.hi) {
+            char c = sorted[j].first[node.end];
+            uint32_t k = j;
+            while (k < node.hi && sorted[k].first[node.end] == c) ++k;
+            std::string_view first = sorted[j].first, last = sorted[k - 1].first;
+            uint32_t end = node.end + 1;
+            while (end < first.size() && end < last.size() && first[end] == last[end]) ++end;
+            trie.push_back({j, k, node.end, end});
+            j = k;
+        }
+        trie[i].childCount = static_cast<uint32_t>(trie.size()) - trie[i].firstChild;
+    }
+
+    // Best completions bottom-up: a node's are the best of its own
+    // completion and its children's.
+    auto better = [&](uint32_t a, uint32_t b) {
+        return sorted[a].second != sorted[b].second ? sorted[a].second > sorted[b].second : a < b;
+    };
+    std::vector<std::vector<uint32_t>> best(trie.size());
+    for (size_t i = trie.size(); i-- > 0;) {
+        const BuildNode& node = trie[i];
+        std::vector<uint32_t>& candidates = best[i];
+        if (node.lo < node.hi && sorted[node.lo].first.size() == node.end) {
+            candidates.push_back(node.lo);
+        }
+        for (uint32_t c = node.firstChild; c < node.firstChild + node.childCount; ++c) {
+            candidates.insert(candidates.end(), best[c].begin(), best[c].end());
+        }
+        size_t keep = std::min<size_t>(candidates.size(), topK);
+        std::partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end(), better);
+        candidates.resize(keep);
+    }
+
+    std::string nodeSection;
+    std::string topSection;
+    uint32_t topCount = 0;
+    for (size_t i = 0; i < trie.size(); ++i) {
+        const BuildNode& node = trie[i];
+        uint32_t labelOffset = node.lo < node.hi ? textOffset[node.lo] + node.depth : 0;
+        appendU32(nodeSection, labelOffset);
+        appendU32(nodeSection, node.end - node.depth);
+        appendU32(nodeSection, node.firstChild);
+        appendU32(nodeSection, node.childCount);
+        appendU32(nodeSection, topCount);
+        appendU32(nodeSection, static_cast<uint32_t>(best[i].size()));
+        for (uint32_t id : best[i]) {
+            appendU32(topSection, id);
+        }
+        topCount += static_cast<uint32_t>(best[i].size());
+    }
+
+    Header header{};
+    header.magic = COMPLETION_TRIE_MAGIC;
+    header.version = COMPLETION_TRIE_VERSION;
+    header.topK = topK;
+    header.nodeCount = static_cast<uint32_t>(trie.size());
+    header.completionCount = static_cast<uint32_t>(sorted.size());
+    header.topCount = topCount;
+    header.textSize = static_cast<uint32_t>(textSection.size());
+    header.fileSize = sizeof(header) + nodeSection.size() + topSection.size() + weightSection.size() +
+                      offsetSection.size() + textSection.size();
+
+    std::string staged = path + ".tmp";
+    {
+        std::ofstream out(staged, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(nodeSection.data(), nodeSection.size());
+        out.write(topSection.data(), topSection.size());
+        out.write(weightSection.data(), weightSection.size());
+        out.write(offsetSection.data(), offsetSection.size());
+        out.write(textSection.data(), textSection.size());
+        if (!out) {
+            throw std::runtime_error("Failed to write completion trie: " + staged);
+        }
+    }
+    if (std::rename(staged.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("Failed to replace completion trie: " + path);
+    }
+}
+
+} // namespace completion
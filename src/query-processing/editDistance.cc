@@ -0,0 +1,72 @@
+#include "../../include/query-processing/editDistance.h"
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+namespace spell {
+
+EditDistance::EditDistance(std::string_view pattern) : pattern(pattern) {
+    if (pattern.size() <= 64) {
+        peq.fill(0);
+        for (size_t i = 0; i < pattern.size(); ++i) {
+            peq[static_cast<unsigned char>(pattern[i])] |= uint64_t(1) << i;
+        }
+    }
+}
+
+int EditDistance::distance(std::string_view text, int cutoff) const {
+    int m = static_cast<int>(pattern.size());
+    int n = static_cast<int>(text.size());
+    if (std::abs(m - n) > cutoff) return cutoff + 1;
+    if (m == 0) return n;
+    if (m > 64) return scalarDistance(text, cutoff);
+
+    uint64_t pv = ~uint64_t(0), mv = 0;
+    const uint64_t last = uint64_t(1) << (m - 1);
+    int score = m;
+    for (int j = 0; j < n; ++j) {
+        uint64_t eq = peq[static_cast<unsigned char>(text[j])];
+        uint64_t xv = eq | mv;
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+        if (ph & last) {
+            ++score;
+        } else if (mh & last) {
+            --score;
+        }
+        // Row 0 of the table is 0, 1, 2, ...: every step adds one there.
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+
+        // Each remaining character can lower the score by at most one.
+        if (score - (n - 1 - j) > cutoff) return cutoff + 1;
+    }
+    return std::min(score, cutoff + 1);
+}
+
+int EditDistance::scalarDistance(std::string_view text, int cutoff) const {
+    size_t m = pattern.size();
+    std::vector<int> prev(m + 1), curr(m + 1);
+    for (size_t i = 0; i <= m; ++i) prev[i] = static_cast<int>(i);
+
+    for (size_t j = 1; j <= text.size(); ++j) {
+        curr[0] = static_cast<int>(j);
+        int rowMin = curr[0];
+        for (size_t i = 1; i <= m; ++i) {
+            if (pattern[i - 1] == text[j - 1]) {
+                curr[i] = prev[i - 1];
+            } else {
+                curr[i] = 1 + std::min({prev[i], curr[i - 1], prev[i - 1]});
+            }
+            rowMin = std::min(rowMin, curr[i]);
+        }
+        if (rowMin > cutoff) return cutoff + 1;
+        std::swap(prev, curr);
+    }
+    return std::min(prev[m], cutoff + 1);
+}
+
+} // namespace spell
@@ -0,0 +1,297 @@
+#include "../../include/query-processing/phraseMatcher.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace queryTree {
+
+namespace {
+
+const uint32_t PHRASE_MATCHER_MAGIC = 0x4d524850;  // "PHRM"
+const uint32_t PHRASE_MATCHER_VERSION = 1;
+const uint32_t NO_WORD = UINT32_MAX;
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t wordCount;
+    uint32_t slotCount;
+    uint32_t stateCount;
+    uint32_t edgeCount;
+    uint32_t phraseCount;
+    uint32_t textSize;
+};
+
+uint32_t readU32(const char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+void appendU32(std::string& out, uint32_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+uint64_t hashWord(std::string_view word) {
+    uint64_t h = 1469598103934665603ULL;
+    for (unsigned char c : word) {
+        h = (h ^ c) * 1099511628211ULL;
+    }
+    h ^= h >> 33;
+    return h;
+}
+
+/**
+ * @brief Splits a dictionary key into its words.
+ */
+std::vector<std::string_view> splitWords(std::string_view phrase) {
+    std::vector<std::string_view> words;
+    size_t start = 0;
+    while (start < phrase.size()) {
+        size_t end = phrase.find(' ', start);
+        if (end == std::string_view::npos) end = phrase.size();
+        if (end > start) words.push_back(phrase.substr(start, end - start));
+        start = end + 1;
+    }
+    return words;
+}
+
+} // namespace
+
+PhraseMatcher::PhraseMatcher() : PhraseMatcher(TermDictionary{}) {}
+
+PhraseMatcher::PhraseMatcher(const TermDictionary& dict) : owned(serialize(dict)) {
+    data = owned.data();
+    size_ = owned.size();
+    if (!attach()) {
+        throw std::runtime_error("Corrupt phrase matcher");
+    }
+}
+
+PhraseMatcher::PhraseMatcher(const char* image, size_t size) : data(image), size_(size) {
+    if (!attach()) {
+        throw std::runtime_error("Corrupt phrase matcher");
+    }
+}
+
+bool PhraseMatcher::attach() {
+    if (size_ < sizeof(Header)) return false;
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != PHRASE_MATCHER_MAGIC || header.version != PHRASE_MATCHER_VERSION) return false;
+    if (header.stateCount == 0 || header.slotCount == 0 ||
+        (header.slotCount & (header.slotCount - 1)) != 0 || header.slotCount <= header.wordCount) {
+        return false;
+    }
+
+    uint64_t u32s = uint64_t(header.slotCount) + (header.wordCount + 1) + header.wordCount +
+                    (header.stateCount + 1) + 2 * uint64_t(header.edgeCount) + 3 * uint64_t(header.stateCount);
+    if (sizeof(Header) + u32s * sizeof(uint32_t) + header.textSize != size_) return false;
+
+    wordCount = header.wordCount;
+    slotCount = header.slotCount;
+    stateCount = header.stateCount;
+    phraseCount = header.phraseCount;
+    slots = data + sizeof(Header);
+    words = slots + size_t(slotCount) * sizeof(uint32_t);
+    root = words + size_t(wordCount + 1) * sizeof(uint32_t);
+    states = root + size_t(wordCount) * sizeof(uint32_t);
+    edges = states + size_t(stateCount + 1) * sizeof(uint32_t);
+    fail = edges + size_t(header.edgeCount) * 2 * sizeof(uint32_t);
+    output = fail + size_t(stateCount) * sizeof(uint32_t);
+    lengths = output + size_t(stateCount) * sizeof(uint32_t);
+    text = lengths + size_t(stateCount) * sizeof(uint32_t);
+    return readU32(words + size_t(wordCount) * sizeof(uint32_t)) == header.textSize &&
+           readU32(states + size_t(stateCount) * sizeof(uint32_t)) == header.edgeCount;
+}
+
+uint32_t PhraseMatcher::wordId(std::string_view word) const {
+    for (uint32_t slot = hashWord(word) & (slotCount - 1);; slot = (slot + 1) & (slotCount - 1)) {
+        uint32_t entry = readU32(slots + size_t(slot) * sizeof(uint32_t));
+        if (entry == 0) return NO_WORD;
+        uint32_t id = entry - 1;
+        uint32_t begin = readU32(words + size_t(id) * sizeof(uint32_t));
+        uint32_t end = readU32(words + size_t(id + 1) * sizeof(uint32_t));
+        if (std::string_view(text + begin, end - begin) == word) return id;
+    }
+}
+
+uint32_t PhraseMatcher::next(uint32_t state, uint32_t word) const {
+    if (state == 0) {
+        return readU32(root + size_t(word) * sizeof(uint32_t));
+    }
+    // Binary search the state's edges, which are sorted by word id.
+    uint32_t lo = readU32(states + size_t(state) * sizeof(uint32_t));
+    uint32_t hi = readU32(states + size_t(state + 1) * sizeof(uint32_t));
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        uint32_t edgeWord = readU32(edges + size_t(mid) * 2 * sizeof(uint32_t));
+        if (edgeWord == word) return readU32(edges + (size_t(mid) * 2 + 1) * sizeof(uint32_t));
+        if (edgeWord < word) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return 0;
+}
+
+void PhraseMatcher::findPhrases(const TokenList& tokens, std::pmr::vector<PhraseMatch>& matches) const {
+    matches.clear();
+    if (tokens.size() < 2 || phraseCount == 0) return;
+
+    // longest[i]: words in the longest phrase starting at token i. Every
+    // phrase ending at a token is reported by the state reached there or by
+    // its output chain.
+    std::pmr::vector<uint32_t> longest(tokens.size(), 0, matches.get_allocator().resource());
+    uint32_t state = 0;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        uint32_t word = wordId(tokens[i]);
+        if (word == NO_WORD) {
+            state = 0;
+            continue;
+        }
+
+        uint32_t target = next(state, word);
+        while (target == 0 && state != 0) {
+            state = readU32(fail + size_t(state) * sizeof(uint32_t));
+            target = next(state, word);
+        }
+        state = target;
+
+        uint32_t found = readU32(lengths + size_t(state) * sizeof(uint32_t)) ? state
+                         : readU32(output + size_t(state) * sizeof(uint32_t));
+        for (; found != 0; found = readU32(output + size_t(found) * sizeof(uint32_t))) {
+            uint32_t length = readU32(lengths + size_t(found) * sizeof(uint32_t));
+            size_t start = i + 1 - length;
+            longest[start] = std::max(longest[start], length);
+        }
+    }
+
+    for (size_t i = 0; i < tokens.size();) {
+        if (longest[i] != 0) {
+            matches.push_back({static_cast<uint32_t>(i), longest[i]});
+            i += longest[i];
+        } else {
+            ++i;
+        }
+    }
+}
+
+std::string PhraseMatcher::serialize(const TermDictionary& dict) {
+    // Sorted so that equal dictionaries give equal images.
+    std::vector<std::vector<std::string_view>> phrases;
+    for (const auto& entry : dict) {
+        std::vector<std::string_view> phrase = splitWords(entry.first);
+        if (phrase.size() >= 2) phrases.push_back(std::move(phrase));
+    }
+    std::sort(phrases.begin(), phrases.end());
+    phrases.erase(std::unique(phrases.begin(), phrases.end()), phrases.end());
+
+    // Words get ids in order of first appearance.
+    std::unordered_map<std::string_view, uint32_t> ids;
+    std::vector<std::string_view> vocabulary;
+    for (const auto& phrase : phrases) {
+        for (std::string_view word : phrase) {
+            if (ids.emplace(word, static_cast<uint32_t>(vocabulary.size())).second) {
+                vocabulary.push_back(word);
+            }
+        }
+    }
+
+    // Trie over word ids; state 0 is the root.
+    std::vector<std::map<uint32_t, uint32_t>> children(1);
+    std::vector<uint32_t> lengths(1, 0);
+    for (const auto& phrase : phrases) {
+        uint32_t state = 0;
+        for (std::string_view word : phrase) {
+            auto [it, added] = children[state].emplace(ids[word], static_cast<uint32_t>(children.size()));
+            if (added) {
+                children.emplace_back();
+                lengths.push_back(0);
+            }
+            state = it->second;
+        }
+        lengths[state] = static_cast<uint32_t>(phrase.size());
+    }
+
+    // Failure and output links, breadth first so shallower states are done first.
+    uint32_t stateCount = static_cast<uint32_t>(children.size());
+    std::vector<uint32_t> fail(stateCount, 0), output(stateCount, 0);
+    std::deque<uint32_t> queue;
+    for (const auto& [word, child] : children[0]) queue.push_back(child);
+    while (!queue.empty()) {
+        uint32_t state = queue.front();
+        queue.pop_front();
+        for (const auto& [word, child] : children[state]) {
+            uint32_t f = fail[state];
+            while (f != 0 && children[f].count(word) == 0) f = fail[f];
+            auto it = children[f].find(word);
+            fail[child] = it != children[f].end() ? it->second : 0;
+            output[child] = lengths[fail[child]] ? fail[child] : output[fail[child]];
+            queue.push_back(child);
+        }
+    }
+
+    uint32_t wordCount = static_cast<uint32_t>(vocabulary.size());
+    uint32_t slotCount = 1;
+    while (slotCount < 2 * uint64_t(wordCount) + 1) slotCount <<= 1;
+    std::vector<uint32_t> slots(slotCount, 0);
+    for (uint32_t id = 0; id < wordCount; ++id) {
+        uint32_t slot = hashWord(vocabulary[id]) & (slotCount - 1);
+        while (slots[slot] != 0) slot = (slot + 1) & (slotCount - 1);
+        slots[slot] = id + 1;
+    }
+
+    std::string out;
+    Header header{};
+    header.magic = PHRASE_MATCHER_MAGIC;
+    header.version = PHRASE_MATCHER_VERSION;
+    header.wordCount = wordCount;
+    header.slotCount = slotCount;
+    header.stateCount = stateCount;
+    header.phraseCount = static_cast<uint32_t>(phrases.size());
+    for (uint32_t state = 1; state < stateCount; ++state) header.edgeCount += children[state].size();
+    for (std::string_view word : vocabulary) header.textSize += word.size();
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (uint32_t slot : slots) appendU32(out, slot);
+    uint32_t offset = 0;
+    for (std::string_view word : vocabulary) {
+        appendU32(out, offset);
+        offset += word.size();
+    }
+    appendU32(out, offset);
+
+    std::vector<uint32_t> rootNext(wordCount, 0);
+    for (const auto& [word, child] : children[0]) rootNext[word] = child;
+    for (uint32_t state : rootNext) appendU32(out, state);
+
+    // The root's edges live in the table above, not in the edge list.
+    uint32_t edge = 0;
+    appendU32(out, edge);
+    for (uint32_t state = 1; state < stateCount; ++state) {
+        appendU32(out, edge);
+        edge += children[state].size();
+    }
+    appendU32(out, edge);
+    for (uint32_t state = 1; state < stateCount; ++state) {
+        for (const auto& [word, child] : children[state]) {
+            appendU32(out, word);
+            appendU32(out, child);
+        }
+    }
+
+    for (uint32_t f : fail) appendU32(out, f);
+    for (uint32_t o : output) appendU32(out, o);
+    for (uint32_t length : lengths) appendU32(out, length);
+    for (std::string_view word : vocabulary) out.append(word);
+    return out;
+}
+
+} // namespace queryTree
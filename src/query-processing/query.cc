@@ -1,118 +1,46 @@
 #include "../../include/query-processing/query.h"
-#include "../../include/query-processing/stemmer.h"
+#include "../../include/query-processing/analyzer.h"
+#include "../../include/query-processing/tokenizer.h"
 
 #include <iostream>
 #include <sstream>
 #include <fstream>
 #include <algorithm>
 #include <climits>
+#include <functional>
 
 // Use definitions from the query namespace
 using query::Dictionary;
 using query::TokenList;
 
 /**
- * @brief Checks if a given word is a stop word.
+ * @brief Runs the query pipeline over any dictionary representation.
  *
- * @param word The word to check.
- * @return True if the word is a stop word, false otherwise.
+ * @param rawQuery The raw query string to process.
+ * @param isWord Returns whether a token is a dictionary word.
+ * @param corrector The spelling corrector over dictionary words.
+ * @param phrases The compiled phrase dictionary.
+ * @param resource Memory for the tokens and the tree.
+ * @return The queryTree structure created from the processed query.
  */
-// TODO: UPDATE TO READ FROM STOPWORDS.TXT
-bool isStopWord(const std::string& word) {
-    static const Dictionary stopWords = {
-        "the", "of", "to", "a", "and", "in", "said", "for", "that", "was", "on",
-        "he", "is", "with", "at", "by", "it", "from", "as", "be", "were", "an",
-        "have", "his", "but", "has", "are", "not", "who", "they", "its", "had",
-        "will", "would", "about", "i", "been", "this", "their", "new", "or",
-        "which", "we", "more", "after", "us", "percent", "up", "one", "people",
-        "what"
-    };
-    return stopWords.find(word) != stopWords.end();
-}
-
-/**
- * @brief Converts a word to lowercase.
- *
- * @param word The word to convert.
- * @return The lowercase version of the word.
- */
-std::string toLower(const std::string& word) {
-    std::string result = word;
-    std::transform(
-       result.begin(), result.end(), result.begin(), [](unsigned char c) {
-       return std::tolower(c);
-    });
-    return result;
-}
-
-/**
- * @brief Removes punctuation from a given word.
- *
- * @param word The word to process.
- * @return The word without punctuation.
- */
-std::string removePunctuation(std::string word) {
-    word.erase(std::remove_if(word.begin(), word.end(),
-              [](unsigned char c) { return !std::isalnum(c); }), word.end());
-    return word;
-}
-
-/**
- * @brief Tokenizes a raw query string into individual words.
- *
- * @param rawQuery The raw query string to tokenize.
- * @return A vector of tokens (words) from the query.
- */
-TokenList tokenize(const std::string& rawQuery) {
-    TokenList tokens;
-    std::istringstream stream(rawQuery);
-    std::string token;
-
-    while (stream >> token) {
-        token = toLower(token);
-        token = removePunctuation(token);
-        if (!isStopWord(token)) {
-            tokens.push_back(token);
-        }
-    }
-
-    return tokens;
-}
-
-/**
- * @brief Finds the closest word in the dictionary to a given word.
- *
- * @param word The word to find a match for.
- * @param tree The BK-Tree containing dictionary words.
- * @param dictionary The set of dictionary words.
- * @return The closest matching word from the dictionary.
- */
-std::string findClosestWord(const std::string& word, const bk::BKTree& tree) {
-    return tree.findClosest(word);
-}
-
-/**
- * @brief Finds typos in a list of tokens and suggests corrections.
- *
- * @param tokens The list of tokens to check.
- * @param tree The BK-Tree containing dictionary words.
- * @param dictionary The dictionary for typo detection.
- * @return A vector of corrected words.
- */
-TokenList findSuggestion(const TokenList& tokens,
-                         const bk::BKTree& tree,
-                         const Dictionary& dictionary) {
-    TokenList suggestions;
-
-    for (const std::string& token : tokens) {
-        if (dictionary.find(token) == dictionary.end()) {
-            suggestions.emplace_back(tree.findClosest(token));
-        } else {
-            suggestions.emplace_back(token);  // Keep correct words
-        }
-    }
+queryTree::QueryTree buildQueryTree(const std::string& rawQuery,
+                                    const std::function<bool(std::string_view)>& isWord,
+                                    const spell::SpellingCorrector& corrector,
+                                    const queryTree::PhraseMatcher& phrases,
+                                    std::pmr::memory_resource* resource) {
+    // Reused across queries so analyzing does not allocate. Documents go
+    // through the same stages (analyzer::DocumentAnalyzer), minus correction.
+    thread_local analyzer::QueryAnalyzer analyzer;
+    analyzer.setKeepOperators(true);
+    analyzer.stage<analyzer::SpellingCorrection>() = analyzer::SpellingCorrection(corrector, isWord);
+
+    // Tokenization, stop words, spelling correction and stemming
+    TokenList tokens(resource);
+    analyzer.analyze(rawQuery, [&tokens](const analyzer::Token& token) { tokens.emplace_back(token.text); });
+    analyzer.stage<analyzer::SpellingCorrection>() = analyzer::SpellingCorrection();
 
-    return suggestions;
+    // Build and return the query tree
+    return queryTree::QueryTree(tokens, phrases, resource);
 }
 
 namespace query {
@@ -120,42 +48,45 @@ namespace query {
 queryTree::QueryTree processQuery(
     const std::string& rawQuery,
     const Dictionary& dictionary,
-    const bk::BKTree& tree,
-    const queryTree::TermDictionary& termDictionary
+    const spell::SpellingCorrector& corrector,
+    const queryTree::PhraseMatcher& phrases,
+    std::pmr::memory_resource* resource
 ) {
-    // Tokenization
-    TokenList tokens = tokenize(rawQuery);
-
-    // Spelling correction
-    TokenList correctedTokens = findSuggestion(tokens, tree, dictionary);
-
-    // Normalization: punctuation removal & stemming
-    TokenList processedTokens;
-    for (std::string& token : correctedTokens) {
-        token = removePunctuation(token);
-        processedTokens.push_back(stemmer::stem(token));
-    }
+    return buildQueryTree(
+        rawQuery,
+        [&dictionary](std::string_view word) { return dictionary.find(std::string(word)) != dictionary.end(); },
+        corrector,
+        phrases,
+        resource);
+}
 
-    // Build and return the query tree
-    return queryTree::QueryTree(processedTokens, termDictionary);
+queryTree::QueryTree processQuery(const std::string& rawQuery, const QueryResources& resources,
+                                  std::pmr::memory_resource* resource) {
+    return buildQueryTree(
+        rawQuery,
+        [&resources](std::string_view word) { return resources.isWord(word); },
+        resources.corrector(),
+        resources.phraseMatcher(),
+        resource);
 }
 
 // NOTE: This function might fit better elsewhere
 Dictionary loadDictionary(const std::string& filepath) {
     Dictionary dictionary;
     std::ifstream file(filepath);
-    std::string word;
+    std::string line;
+    tokenizer::TokenBuffer words;
 
     if (!file) {
         std::cerr << "Error: Unable to open file " << filepath << std::endl;
         return dictionary;
     }
 
-    while (std::getline(file, word)) {
-        word.erase(0, word.find_first_not_of(" \t\r\n"));
-        word.erase(word.find_last_not_of(" \t\r\n") + 1);
-        if (!word.empty()) {
-            dictionary.insert(toLower(word));
+    // Words are normalized like query tokens, so corrections need no cleanup.
+    while (std::getline(file, line)) {
+        tokenizer::tokenize(line, words);
+        for (std::string_view word : words) {
+            dictionary.emplace(word);
         }
     }
 
@@ -163,4 +94,38 @@ Dictionary loadDictionary(const std::string& filepath) {
     return dictionary;
 }
 
+queryTree::TermDictionary loadTermDictionary(const std::string& filepath) {
+    queryTree::TermDictionary termDictionary;
+    std::ifstream file(filepath);
+    std::string line;
+    tokenizer::TokenBuffer words;
+
+    if (!file) {
+        std::cerr << "Error: Unable to open file " << filepath << std::endl;
+        return termDictionary;
+    }
+
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t tab = line.find('\t');
+        tokenizer::tokenize(std::string_view(line).substr(0, tab), words);
+        if (words.empty()) continue;
+
+        std::string phrase(words[0]);
+        for (size_t i = 1; i < words.size(); ++i) {
+            phrase.append(" ").append(words[i]);
+        }
+
+        std::vector<std::string>& values = termDictionary[phrase];
+        if (tab == std::string::npos) continue;
+        std::istringstream stream(line.substr(tab + 1));
+        std::string value;
+        while (std::getline(stream, value, ',')) {
+            if (!value.empty()) values.push_back(value);
+        }
+    }
+
+    return termDictionary;
+}
+
 } // namespace query
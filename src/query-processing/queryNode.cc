@@ -4,10 +4,20 @@
 namespace queryTree {
 
 QueryNode::QueryNode(int nodeIndex, QueryOperator operation,
-    const std::string& value, int childStart, int childCount)
-    : nodeIndex(nodeIndex), operation(operation), value(value),
+    std::string_view value, int childStart, int childCount, const allocator_type& alloc)
+    : nodeIndex(nodeIndex), operation(operation), value(value, alloc),
     childStart(childStart), childCount(childCount) {}
 
+QueryNode::QueryNode(const QueryNode& other, const allocator_type& alloc)
+    : nodeIndex(other.nodeIndex), operation(other.operation), value(other.value, alloc),
+    childStart(other.childStart), childCount(other.childCount),
+    parentIndex(other.parentIndex), depth(other.depth), termId(other.termId), docFrequency(other.docFrequency) {}
+
+QueryNode::QueryNode(QueryNode&& other, const allocator_type& alloc)
+    : nodeIndex(other.nodeIndex), operation(other.operation), value(std::move(other.value), alloc),
+    childStart(other.childStart), childCount(other.childCount),
+    parentIndex(other.parentIndex), depth(other.depth), termId(other.termId), docFrequency(other.docFrequency) {}
+
 
 
 bool QueryNode::isOperation() const {
@@ -18,10 +28,18 @@ QueryOperator QueryNode::getOperation() const {
     return operation;
 }
 
-const std::string& QueryNode::getValue() const {
+const std::pmr::string& QueryNode::getValue() const {
     return value;
 }
 
+uint32_t QueryNode::getTermId() const {
+    return termId;
+}
+
+uint32_t QueryNode::getDocFrequency() const {
+    return docFrequency;
+}
+
 int QueryNode::getChildStart() const {
     return childStart;
 }
@@ -34,6 +52,19 @@ int QueryNode::getNodeIndex() const {
     return nodeIndex;
 }
 
+int QueryNode::getParentIndex() const {
+    return parentIndex;
+}
+
+int QueryNode::getDepth() const {
+    return depth;
+}
+
+void QueryNode::setTerm(uint32_t id, uint32_t df) {
+    termId = id;
+    docFrequency = df;
+}
+
 void QueryNode::setChildStart(int start) {
     childStart = start;
 }
@@ -42,5 +73,10 @@ void QueryNode::incrementChildCount() {
     childCount++;
 }
 
+void QueryNode::setParent(int parent, int nodeDepth) {
+    parentIndex = parent;
+    depth = nodeDepth;
+}
+
 
 } // namespace queryTree
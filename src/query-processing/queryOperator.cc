@@ -24,6 +24,7 @@ const std::unordered_map<std::string, QueryOperator> OPERATOR_MAP = {
     {"#sdm", QueryOperator::SDM},
     {"#seqdep", QueryOperator::SEQDEP},
     {"#wsum", QueryOperator::WSUM},
+    {"#syn", QueryOperator::SYNONYM},
     {"#require", QueryOperator::REQUIRE},
     {"#reject", QueryOperator::REJECT},
     {"#inside", QueryOperator::INSIDE},
@@ -40,7 +41,9 @@ const std::unordered_map<std::string, QueryOperator> OPERATOR_MAP = {
     {"#lengths", QueryOperator::LENGTHS},
     {"#names", QueryOperator::NAMES},
     {"#prior", QueryOperator::PRIOR},
-    {"#scores", QueryOperator::SCORES}
+    {"#scores", QueryOperator::SCORES},
+    {"#wildcard", QueryOperator::WILDCARD},
+    {"#fuzzy", QueryOperator::FUZZY}
 };
 
 // Define the `toString` function in this `.cc` file
@@ -66,6 +69,7 @@ std::string toString(QueryOperator op) {
         case QueryOperator::SDM: return "#sdm";
         case QueryOperator::SEQDEP: return "#seqdep";
         case QueryOperator::WSUM: return "#wsum";
+        case QueryOperator::SYNONYM: return "#syn";
         case QueryOperator::REQUIRE: return "#require";
         case QueryOperator::REJECT: return "#reject";
         case QueryOperator::INSIDE: return "#inside";
@@ -83,6 +87,8 @@ std::string toString(QueryOperator op) {
         case QueryOperator::NAMES: return "#names";
         case QueryOperator::PRIOR: return "#prior";
         case QueryOperator::SCORES: return "#scores";
+        case QueryOperator::WILDCARD: return "#wildcard";
+        case QueryOperator::FUZZY: return "#fuzzy";
         case QueryOperator::UNKNOWN: return "UNKNOWN";
     }
     return "UNKNOWN";  // Fallback case
@@ -0,0 +1,114 @@
+#include "../../include/query-processing/queryResources.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace query {
+
+namespace {
+
+const uint32_t QUERY_RESOURCES_MAGIC = 0x53455251;  // "QRES"
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t spellingOffset;
+    uint64_t spellingSize;
+    uint64_t matcherOffset;
+    uint64_t matcherSize;
+    uint64_t fileSize;
+};
+
+} // namespace
+
+QueryResources::QueryResources(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open query resources: " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        ::close(fd);
+        throw std::runtime_error("Corrupt query resources: " + path);
+    }
+    size = static_cast<size_t>(st.st_size);
+    void* region = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (region == MAP_FAILED) {
+        throw std::runtime_error("Failed to map query resources: " + path);
+    }
+    data = static_cast<const char*>(region);
+
+    try {
+        Header header;
+        std::memcpy(&header, data, sizeof(header));
+        if (header.magic != QUERY_RESOURCES_MAGIC) {
+            throw std::runtime_error("Not a query resources image: " + path);
+        }
+        if (header.version != QUERY_RESOURCES_VERSION) {
+            throw std::runtime_error("Unsupported query resources version " +
+                                     std::to_string(header.version) + ": " + path);
+        }
+        bool valid = header.fileSize == size &&
+                     header.spellingOffset >= sizeof(header) &&
+                     header.spellingOffset + header.spellingSize <= header.matcherOffset &&
+                     header.matcherOffset + header.matcherSize <= size;
+        if (!valid) {
+            throw std::runtime_error("Corrupt query resources: " + path);
+        }
+        spelling = std::make_unique<spell::SymSpell>(data + header.spellingOffset, header.spellingSize);
+        matcher = std::make_unique<queryTree::PhraseMatcher>(data + header.matcherOffset, header.matcherSize);
+    } catch (...) {
+        ::munmap(const_cast<char*>(data), size);
+        throw;
+    }
+}
+
+QueryResources::~QueryResources() {
+    spelling.reset();
+    matcher.reset();
+    ::munmap(const_cast<char*>(data), size);
+}
+
+void QueryResources::build(const std::unordered_set<std::string>& dictionary,
+                           const queryTree::TermDictionary& termDictionary,
+                           const std::string& path, int maxDistance) {
+    spell::SymSpell::Frequencies frequencies;
+    for (const std::string& word : dictionary) {
+        frequencies[word] = 1;
+    }
+    std::string spellingSection = spell::SymSpell::serialize(frequencies, maxDistance);
+    std::string matcherSection = queryTree::PhraseMatcher::serialize(termDictionary);
+
+    Header header{};
+    header.magic = QUERY_RESOURCES_MAGIC;
+    header.version = QUERY_RESOURCES_VERSION;
+    header.spellingOffset = sizeof(header);
+    header.spellingSize = spellingSection.size();
+    header.matcherOffset = header.spellingOffset + header.spellingSize;
+    header.matcherSize = matcherSection.size();
+    header.fileSize = header.matcherOffset + header.matcherSize;
+
+    std::string staged = path + ".tmp";
+    {
+        std::ofstream out(staged, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(spellingSection.data(), spellingSection.size());
+        out.write(matcherSection.data(), matcherSection.size());
+        if (!out) {
+            throw std::runtime_error("Failed to write query resources: " + staged);
+        }
+    }
+    if (std::rename(staged.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("Failed to replace query resources: " + path);
+    }
+}
+
+} // namespace query
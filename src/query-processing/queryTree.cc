@@ -1,7 +1,8 @@
 #include "../../include/query-processing/queryTree.h"
 #include "../../include/query-processing/queryOperator.h"
-#include <unordered_set>
-#include <map>
+#include "../../include/query-processing/phraseMatcher.h"
+#include "../../include/query-processing/synonyms.h"
+#include "../../include/index/Lexicon.h"
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -11,8 +12,13 @@
 * @param token The operator string.
 * @return The corresponding QueryOperator value.
 */
-queryTree::QueryOperator getOperatorType(const std::string& token) {
-    auto it = queryTree::OPERATOR_MAP.find(token);
+queryTree::QueryOperator getOperatorType(std::string_view token) {
+    // Every operator starts with '#', which the tokenizer never leaves in a term.
+    if (token.empty() || token[0] != '#') {
+        return queryTree::QueryOperator::TEXT;
+    }
+
+    auto it = queryTree::OPERATOR_MAP.find(std::string(token));
 
     if (it ==  queryTree::OPERATOR_MAP.end()) {
         return queryTree::QueryOperator::TEXT;
@@ -31,97 +37,216 @@ std::string extractParameter(const std::string& token) {
     return (paramPos != std::string::npos) ? token.substr(paramPos + 1) : "";
 }
 
+/** Odd 64-bit multiplier for combining hashes. */
+constexpr uint64_t HASH_MULTIPLIER = 0x9e3779b97f4a7c15ULL;
+
 /**
- * @brief Finds bi-word phrases in the token list based on a dictionary.
- * @param tokens The list of query tokens.
- * @param dict The dictionary containing valid phrases.
- * @return map<int, pair<string,vector<int>>> A set of recognized phrases.
+ * @brief Spreads every input bit over the whole hash (MurmurHash3 finalizer).
+ * @param h The value to mix.
+ * @return The mixed value.
  */
-std::map<int, std::pair<std::string, std::vector<int>>> findPhrases(
-    const queryTree::TokenList& tokens,
-    const queryTree::TermDictionary& dict) {
-    std::map<int, std::pair<std::string, std::vector<int>>> phraseMap;
-
-    for (size_t i = 0; i < tokens.size() - 1; ++i) {
-        std::string phrase = tokens[i] + " " + tokens[i + 1];
+uint64_t mixHash(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
 
-        if (dict.find(phrase) != dict.end()) {
-            phraseMap[i] = {phrase, {static_cast<int>(i), static_cast<int>(i + 1)}};
-            ++i;  // Skip the next token as it's part of a phrase
-        }
+/**
+ * @brief Hashes a node value with 64-bit FNV-1a.
+ * @param value The text to hash.
+ * @return The hash.
+ */
+uint64_t hashString(std::string_view value) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : value) {
+        h = (h ^ c) * 0x100000001b3ULL;
     }
+    return h;
+}
 
-    return phraseMap;
+/**
+ * @brief Checks whether the order of an operator's children is irrelevant.
+ * @param op The operator.
+ * @return True if reordering the children does not change the query.
+ */
+bool isUnordered(queryTree::QueryOperator op) {
+    return op == queryTree::QueryOperator::COMBINE || op == queryTree::QueryOperator::SYNONYM;
 }
 
 
 namespace queryTree {
 
 void QueryTree::addPhraseNodes(const queryTree::TokenList& tokens,
-    const std::map<int, std::pair<std::string, std::vector<int>>>& phraseMap,
-    std::unordered_set<int>& usedTokens, int& nodeIndex) {
-
-    for (const auto& [startIndex, phraseData] : phraseMap) {
-        const std::string& phrase = phraseData.first;
-        const std::vector<int>& tokenIndexes = phraseData.second;
+    const std::pmr::vector<PhraseMatch>& phrases,
+    std::pmr::vector<bool>& usedTokens, int& nodeIndex) {
+    std::pmr::string phrase(nodes.get_allocator().resource());
+
+    for (const PhraseMatch& match : phrases) {
+        int startIndex = static_cast<int>(match.start);
+        int endIndex = startIndex + static_cast<int>(match.length);
+        phrase.assign(tokens[startIndex]);
+        for (int idx = startIndex + 1; idx < endIndex; ++idx) {
+            phrase.append(1, ' ').append(tokens[idx]);
+        }
 
         int phraseNodeIndex = nodeIndex++;
 
         // Attach OD node to root
         nodes.emplace_back(phraseNodeIndex, QueryOperator::OD, phrase,
-            nodeIndex, tokenIndexes.size());
+            nodeIndex, static_cast<int>(match.length));
+        nodes.back().setParent(0, 1);
 
         // Update root to point to this Phrase node
         if (nodes[0].getChildStart() == -1) nodes[0].setChildStart(phraseNodeIndex);
         nodes[0].incrementChildCount();
 
         // Add child term nodes under OD
-        for (int idx : tokenIndexes) {
-            usedTokens.insert(idx);
+        for (int idx = startIndex; idx < endIndex; ++idx) {
+            usedTokens[idx] = true;
             nodes.emplace_back(nodeIndex++, QueryOperator::TEXT, tokens[idx], -1, 0);
+            nodes.back().setParent(phraseNodeIndex, 2);
         }
     }
 }
 
 void QueryTree::addTermNodes(const queryTree::TokenList& tokens,
-                             const std::unordered_set<int>& usedTokens,
+                             const std::pmr::vector<bool>& usedTokens,
                              int& nodeIndex) {
     for (size_t i = 0; i < tokens.size(); ++i) {
-        if (usedTokens.find(i) != usedTokens.end() || tokens[i].empty()) continue;
+        if (usedTokens[i] || tokens[i].empty()) continue;
 
-        QueryOperator opType = getOperatorType(tokens[i]);
+        QueryOperator opType = isWildcard(tokens[i]) ? QueryOperator::WILDCARD
+                             : isFuzzy(tokens[i])    ? QueryOperator::FUZZY
+                                                     : getOperatorType(tokens[i]);
         int termNodeIndex = nodeIndex++;
         nodes.emplace_back(termNodeIndex, opType, tokens[i], -1, 0);
+        nodes.back().setParent(0, 1);
 
-        // Attach term to root, but only if not already used by a phrase
-        if (usedTokens.find(i) == usedTokens.end()) {
-            if (nodes[0].getChildStart() == -1) nodes[0].setChildStart(termNodeIndex);
-            nodes[0].incrementChildCount();
-        }
-
+        // Attach term to root
+        if (nodes[0].getChildStart() == -1) nodes[0].setChildStart(termNodeIndex);
+        nodes[0].incrementChildCount();
     }
 }
 
 QueryTree::QueryTree(const queryTree::TokenList& tokens,
-                     const queryTree::TermDictionary& dict) {
+                     const queryTree::PhraseMatcher& phrases,
+                     std::pmr::memory_resource* resource)
+    : nodes(resource) {
     if (tokens.empty()) return;
 
-    nodes.reserve(tokens.size()); // Preallocate for efficiency
+    // Root, every token, and one OD node per phrase of at least two tokens
+    nodes.reserve(1 + tokens.size() + tokens.size() / 2);
 
     int nodeIndex = 0;
     nodes.emplace_back(nodeIndex++, QueryOperator::COMBINE, "", -1, 0);
 
     // Find phrases and their positions
-    auto phraseMap = findPhrases(tokens, dict);
-    std::unordered_set<int> usedTokens;
+    std::pmr::vector<PhraseMatch> phraseMatches(resource);
+    phrases.findPhrases(tokens, phraseMatches);
+    std::pmr::vector<bool> usedTokens(tokens.size(), false, resource);
 
     // add phrase nodes
-    addPhraseNodes(tokens, phraseMap, usedTokens, nodeIndex);
+    addPhraseNodes(tokens, phraseMatches, usedTokens, nodeIndex);
 
     // Add individual term nodes
     addTermNodes(tokens, usedTokens, nodeIndex);
 }
 
+size_t QueryTree::resolveTerms(const Lexicon& lexicon) {
+    size_t unknown = 0;
+    for (QueryNode& node : nodes) {
+        if (node.getOperation() == QueryOperator::SYNONYM) {
+            // Groups without a merged list are read term by term; not an unknown term.
+            auto info = lexicon.find(node.getValue());
+            node.setTerm(info ? info->id : UNKNOWN_TERM, info ? info->df : 0);
+            continue;
+        }
+        if (node.getOperation() != QueryOperator::TEXT) continue;
+        if (auto info = lexicon.find(node.getValue())) {
+            node.setTerm(info->id, info->df);
+        } else {
+            node.setTerm(UNKNOWN_TERM, 0);
+            // A missing synonym is only one alternative; its group is counted below.
+            bool member = node.getParentIndex() >= 0 &&
+                          nodes[node.getParentIndex()].getOperation() == QueryOperator::SYNONYM;
+            if (!member) ++unknown;
+        }
+    }
+
+    // A group is unknown only when neither its merged list nor any member is indexed.
+    for (const QueryNode& node : nodes) {
+        if (node.getOperation() != QueryOperator::SYNONYM || node.getTermId() != UNKNOWN_TERM) continue;
+        bool indexed = false;
+        for (int i = 0; i < node.getChildCount(); ++i) {
+            indexed |= nodes[node.getChildStart() + i].getTermId() != UNKNOWN_TERM;
+        }
+        if (!indexed) ++unknown;
+    }
+    return unknown;
+}
+
+size_t QueryTree::expandSynonyms(const synonyms::SynonymDictionary& dictionary) {
+    auto groupOf = [&](const QueryNode& node) {
+        bool topLevel = node.getOperation() == QueryOperator::TEXT && node.getParentIndex() == 0;
+        return topLevel ? dictionary.groupOf(node.getValue()) : synonyms::NO_GROUP;
+    };
+
+    size_t expanded = 0;
+    size_t added = 0;
+    for (const QueryNode& node : nodes) {
+        uint32_t group = groupOf(node);
+        if (group != synonyms::NO_GROUP) {
+            ++expanded;
+            added += dictionary.members(group).size();
+        }
+    }
+    if (expanded == 0) return 0;
+
+    // Rebuild in pre-order: each expanded term is followed by its children,
+    // which shifts every later node.
+    std::pmr::memory_resource* resource = nodes.get_allocator().resource();
+    std::pmr::vector<QueryNode> rebuilt(resource);
+    rebuilt.reserve(nodes.size() + added);
+    std::pmr::vector<int> newIndex(nodes.size(), -1, resource);
+
+    auto append = [&](QueryOperator op, std::string_view value, int parent) -> QueryNode& {
+        int index = static_cast<int>(rebuilt.size());
+        rebuilt.emplace_back(index, op, value, -1, 0);
+        if (parent >= 0) {
+            rebuilt.back().setParent(parent, rebuilt[parent].getDepth() + 1);
+            if (rebuilt[parent].getChildStart() == -1) rebuilt[parent].setChildStart(index);
+            rebuilt[parent].incrementChildCount();
+        }
+        return rebuilt.back();
+    };
+
+    for (const QueryNode& node : nodes) {
+        int parent = node.getParentIndex() < 0 ? -1 : newIndex[node.getParentIndex()];
+        uint32_t group = groupOf(node);
+        newIndex[node.getNodeIndex()] = static_cast<int>(rebuilt.size());
+        if (group == synonyms::NO_GROUP) {
+            append(node.getOperation(), node.getValue(), parent)
+                .setTerm(node.getTermId(), node.getDocFrequency());
+            continue;
+        }
+
+        int synonymIndex = static_cast<int>(rebuilt.size());
+        append(QueryOperator::SYNONYM, dictionary.mergedTerm(group), parent);
+        append(QueryOperator::TEXT, node.getValue(), synonymIndex);
+        for (const std::string& member : dictionary.members(group)) {
+            if (std::string_view(member) != std::string_view(node.getValue())) {
+                append(QueryOperator::TEXT, member, synonymIndex);
+            }
+        }
+    }
+
+    nodes = std::move(rebuilt);
+    return expanded;
+}
+
 const QueryNode* QueryTree::getNode(int index) const {
     if (index < 0 || static_cast<size_t>(index) >= nodes.size()) {
         return nullptr;
@@ -131,25 +256,56 @@ const QueryNode* QueryTree::getNode(int index) const {
 
 void queryTree::QueryTree::forEachNodeWithDepth(const std::function<void(
     const QueryNode&, int depth)>& callback) const {
-    if (nodes.empty()) return;
-
-    std::vector<int> depth(nodes.size(), 0);
-
-    for (size_t i = 1; i < nodes.size(); ++i) {
-        for (size_t j = 0; j < nodes.size(); ++j) {
-            int start = nodes[j].getChildStart();
-            int count = nodes[j].getChildCount();
-            if (count == 0 || start == -1) continue;
-            if ((int)i >= start && (int)i < start + count) {
-                depth[i] = depth[j] + 1;
-                break;
-            }
+    for (const QueryNode& node : nodes) {
+        callback(node, node.getDepth());
+    }
+}
+
+void QueryTree::forEachPreOrder(const std::function<void(const QueryNode&)>& callback) const {
+    for (const QueryNode& node : nodes) {
+        callback(node);
+    }
+}
+
+void QueryTree::forEachPostOrder(const std::function<void(const QueryNode&)>& callback) const {
+    // Ancestors of the current node whose subtrees are not finished yet. In
+    // pre-order, a subtree ends at the first node that is no deeper than it.
+    std::pmr::vector<int> open(nodes.get_allocator().resource());
+    for (const QueryNode& node : nodes) {
+        while (!open.empty() && nodes[open.back()].getDepth() >= node.getDepth()) {
+            callback(nodes[open.back()]);
+            open.pop_back();
         }
+        open.push_back(node.getNodeIndex());
+    }
+    while (!open.empty()) {
+        callback(nodes[open.back()]);
+        open.pop_back();
     }
+}
 
-    for (size_t i = 0; i < nodes.size(); ++i) {
-        callback(nodes[i], depth[i]);
+uint64_t QueryTree::structuralHash() const {
+    if (nodes.empty()) return 0;
+
+    // children[i] accumulates the hashes of node i's children. Walking the
+    // array backwards finishes every node before its parent.
+    std::pmr::vector<uint64_t> children(nodes.size(), 0, nodes.get_allocator().resource());
+    uint64_t hash = 0;
+    for (size_t i = nodes.size(); i-- > 0;) {
+        const QueryNode& node = nodes[i];
+        uint64_t own = hashString(node.getValue())
+                       ^ (static_cast<uint64_t>(node.getOperation()) + 1) * HASH_MULTIPLIER;
+        hash = mixHash(own ^ mixHash(children[i] + static_cast<uint64_t>(node.getChildCount())));
+
+        int parent = node.getParentIndex();
+        if (parent < 0) continue;
+        if (isUnordered(nodes[parent].getOperation())) {
+            children[parent] += mixHash(hash);  // commutative
+        } else {
+            children[parent] = children[parent] * HASH_MULTIPLIER + hash;
+        }
     }
+    return hash;  // the root's
 }
 
 std::ostream& operator<<(std::ostream& os, const queryTree::QueryTree& tree) {
@@ -159,8 +315,10 @@ std::ostream& operator<<(std::ostream& os, const queryTree::QueryTree& tree) {
 
         os << toString(node.getOperation());
 
-        // Show value only for TEXT nodes
-        if (node.getOperation() == queryTree::QueryOperator::TEXT) {
+        // Show value only for TEXT, WILDCARD and FUZZY nodes
+        if (node.getOperation() == queryTree::QueryOperator::TEXT ||
+            node.getOperation() == queryTree::QueryOperator::WILDCARD ||
+            node.getOperation() == queryTree::QueryOperator::FUZZY) {
             os << ":" << node.getValue();
         }
 
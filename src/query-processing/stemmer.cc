@@ -1,228 +1,318 @@
 #include "../../include/query-processing/stemmer.h"
-#include <string>
-#include <cctype>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <vector>
 
+namespace {
 
-bool is_vowel(char ch) {
-    ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
-    return (ch == 'a' || ch == 'e' || ch == 'i' || ch == 'o' || ch == 'u');
+/** Words up to this length keep their consonant flags on the stack. */
+constexpr size_t STACK_WORD_LENGTH = 64;
+
+struct SuffixRule {
+    const char* suffix;
+    int length;
+    const char* replacement;
+    int replacementLength;
+};
+
+#define RULE(suffix, replacement) {suffix, sizeof(suffix) - 1, replacement, sizeof(replacement) - 1}
+
+// Rules grouped by the last character of their suffix. Within a group they
+// keep the order of the full list, so the first match is the same one.
+constexpr SuffixRule STEP2_L[] = {RULE("ational", "ate"), RULE("tional", "tion")};
+constexpr SuffixRule STEP2_I[] = {
+    RULE("enci", "ence"), RULE("anci", "ance"), RULE("abli", "able"), RULE("alli", "al"),
+    RULE("entli", "ent"), RULE("eli", "e"), RULE("ousli", "ous"), RULE("aliti", "al"),
+    RULE("iviti", "ive"), RULE("biliti", "ble")};
+constexpr SuffixRule STEP2_R[] = {RULE("izer", "ize"), RULE("ator", "ate")};
+constexpr SuffixRule STEP2_N[] = {RULE("ization", "ize"), RULE("ation", "ate")};
+constexpr SuffixRule STEP2_M[] = {RULE("alism", "al")};
+constexpr SuffixRule STEP2_S[] = {RULE("iveness", "ive"), RULE("fulness", "ful"), RULE("ousness", "ous")};
+
+constexpr SuffixRule STEP3_E[] = {RULE("icate", "ic"), RULE("ative", ""), RULE("alize", "al")};
+constexpr SuffixRule STEP3_I[] = {RULE("iciti", "ic")};
+constexpr SuffixRule STEP3_L[] = {RULE("ical", "ic"), RULE("ful", "")};
+constexpr SuffixRule STEP3_S[] = {RULE("ness", "")};
+
+constexpr SuffixRule STEP4_L[] = {RULE("al", "")};
+constexpr SuffixRule STEP4_E[] = {
+    RULE("ance", ""), RULE("ence", ""), RULE("able", ""), RULE("ible", ""), RULE("ate", ""),
+    RULE("ive", ""), RULE("ize", "")};
+constexpr SuffixRule STEP4_R[] = {RULE("er", "")};
+constexpr SuffixRule STEP4_C[] = {RULE("ic", "")};
+constexpr SuffixRule STEP4_T[] = {RULE("ant", ""), RULE("ement", ""), RULE("ment", ""), RULE("ent", "")};
+constexpr SuffixRule STEP4_N[] = {RULE("ion", "")};
+constexpr SuffixRule STEP4_U[] = {RULE("ou", "")};
+constexpr SuffixRule STEP4_M[] = {RULE("ism", "")};
+constexpr SuffixRule STEP4_I[] = {RULE("iti", "")};
+constexpr SuffixRule STEP4_S[] = {RULE("ous", "")};
+
+#undef RULE
+
+struct RuleGroup {
+    const SuffixRule* rules;
+    size_t count;
+};
+
+template <size_t N>
+constexpr RuleGroup group(const SuffixRule (&rules)[N]) {
+    return {rules, N};
 }
 
-bool isConsonant(const std::string &word, int i) {
-    char ch = word[i];
-    switch (ch) {
-        case 'a': case 'e': case 'i': case 'o': case 'u':
-            return false;
-        case 'y':
-            return (i == 0) ? true : !isConsonant(word, i - 1);
-        default:
-            return true;
+RuleGroup step2Rules(char last) {
+    switch (last) {
+        case 'l': return group(STEP2_L);
+        case 'i': return group(STEP2_I);
+        case 'r': return group(STEP2_R);
+        case 'n': return group(STEP2_N);
+        case 'm': return group(STEP2_M);
+        case 's': return group(STEP2_S);
+        default: return {nullptr, 0};
     }
 }
 
-int measure(const std::string &word) {
-    int count = 0;
-    int i = 0;
-    int n = word.size();
-    // Skip initial consonants.
-    while (i < n && isConsonant(word, i))
-        i++;
-    while (i < n) {
-        // Skip a sequence of vowels.
-        while (i < n && !isConsonant(word, i))
-            i++;
-        count++;
-        // Skip a sequence of consonants.
-        while (i < n && isConsonant(word, i))
-            i++;
-    }
-    return count;
+RuleGroup step3Rules(char last) {
+    switch (last) {
+        case 'e': return group(STEP3_E);
+        case 'i': return group(STEP3_I);
+        case 'l': return group(STEP3_L);
+        case 's': return group(STEP3_S);
+        default: return {nullptr, 0};
+    }
 }
 
-bool containsVowel(const std::string &word) {
-    for (size_t i = 0; i < word.size(); ++i) {
-        if (!isConsonant(word, i))
-            return true;
+RuleGroup step4Rules(char last) {
+    switch (last) {
+        case 'l': return group(STEP4_L);
+        case 'e': return group(STEP4_E);
+        case 'r': return group(STEP4_R);
+        case 'c': return group(STEP4_C);
+        case 't': return group(STEP4_T);
+        case 'n': return group(STEP4_N);
+        case 'u': return group(STEP4_U);
+        case 'm': return group(STEP4_M);
+        case 'i': return group(STEP4_I);
+        case 's': return group(STEP4_S);
+        default: return {nullptr, 0};
     }
-    return false;
 }
 
-bool endsWith(const std::string &word, const std::string &suffix) {
-    if (word.size() < suffix.size())
-        return false;
-    return word.compare(
-        word.size() - suffix.size(), suffix.size(), suffix
-    ) == 0;
-}
+/**
+ * @brief A word being stemmed in place.
+ *
+ * consonant[i] holds whether b[i] is a consonant. It depends only on b[0..i],
+ * so the flags of a prefix stay valid when the end of the word changes and
+ * only rewritten positions are recomputed.
+ */
+class Word {
+public:
+    Word(char* b, int k, uint8_t* consonant) : b(b), k(k), consonant(consonant) { refresh(0); }
 
-bool cvc(const std::string &word) {
-    int n = word.size();
-    if (n < 3)
-        return false;
-    if (!isConsonant(word, n - 3) || !(!isConsonant(word, n - 2))
-        || !isConsonant(word, n - 1))
-        return false;
-    char ch = word[n - 1];
-    if (ch == 'w' || ch == 'x' || ch == 'y')
-        return false;
-    return true;
-}
+    int length() const { return k; }
 
-void step1a(std::string &word) {
-    if (endsWith(word, "sses")) {
-        word.replace(word.size() - 4, 4, "ss");
-    } else if (endsWith(word, "ies")) {
-        word.replace(word.size() - 3, 3, "i");
-    } else if (endsWith(word, "ss")) {
-        // do nothing
-    } else if (endsWith(word, "s")) {
-        word.erase(word.size() - 1);
+    void step1a() {
+        if (endsWith("sses", 4) || endsWith("ies", 3)) {
+            k -= 2;  // "sses" -> "ss", "ies" -> "i"
+        } else if (endsWith("ss", 2)) {
+            // do nothing
+        } else if (endsWith("s", 1)) {
+            k -= 1;
+        }
     }
-}
 
-void step1b(std::string &word) {
-    bool flag = false;
-    if (endsWith(word, "eed")) {
-        std::string stem = word.substr(0, word.size() - 3);
-        if (measure(stem) > 0) {
-            word.replace(word.size() - 3, 3, "ee");
+    void step1b() {
+        if (endsWith("eed", 3)) {
+            if (measure(k - 3) > 0) k -= 1;  // "eed" -> "ee"
+            return;
+        }
+        if (endsWith("ed", 2) && containsVowel(k - 2)) {
+            k -= 2;
+        } else if (endsWith("ing", 3) && containsVowel(k - 3)) {
+            k -= 3;
+        } else {
+            return;
         }
-    } else if ((endsWith(word, "ed") && 
-                containsVowel(word.substr(0, word.size() - 2))) ||
-               (endsWith(word, "ing") && 
-                containsVowel(word.substr(0, word.size() - 3)))) {
-        if (endsWith(word, "ed"))
-            word.erase(word.size() - 2);
-        else
-            word.erase(word.size() - 3);
-        flag = true;
-    }
-    if (flag) {
-        if (endsWith(word, "at") || endsWith(word, "bl")
-            || endsWith(word, "iz")) {
-            word.push_back('e');
-        } else if (word.size() >= 2 &&
-                   word[word.size() - 1] == word[word.size() - 2] &&
-                   word[word.size() - 1] != 'l' &&
-                   word[word.size() - 1] != 's' &&
-                   word[word.size() - 1] != 'z') {
-            word.erase(word.size() - 1);
-        } else if (measure(word) == 1 && cvc(word)) {
-            word.push_back('e');
+
+        if (endsWith("at", 2) || endsWith("bl", 2) || endsWith("iz", 2)) {
+            append('e');
+        } else if (k >= 2 && b[k - 1] == b[k - 2] && b[k - 1] != 'l' && b[k - 1] != 's' && b[k - 1] != 'z') {
+            k -= 1;
+        } else if (measure(k) == 1 && cvc(k)) {
+            append('e');
         }
     }
-}
 
-void step1c(std::string &word) {
-    if (endsWith(word, "y") && word.size() > 1 && isConsonant(word, word.size() - 2)) {
-        word[word.size() - 1] = 'i';
+    void step1c() {
+        if (k > 1 && b[k - 1] == 'y' && consonant[k - 2]) {
+            b[k - 1] = 'i';
+            refresh(k - 1);
+        }
     }
-}
 
-void step2(std::string &word) {
-    struct SuffixRule {
-        const char *suffix;
-        const char *replacement;
-    };
-    SuffixRule rules[] = {
-        {"ational", "ate"}, {"tional", "tion"}, {"enci", "ence"},
-        {"anci", "ance"},   {"izer", "ize"},   {"abli", "able"},
-        {"alli", "al"},     {"entli", "ent"},  {"eli", "e"},
-        {"ousli", "ous"},   {"ization", "ize"},{"ation", "ate"},
-        {"ator", "ate"},    {"alism", "al"},   {"iveness", "ive"},
-        {"fulness", "ful"}, {"ousness", "ous"},{"aliti", "al"},
-        {"iviti", "ive"},   {"biliti", "ble"}
-    };
-    for (auto &rule : rules) {
-        std::string suffix(rule.suffix);
-        if (endsWith(word, suffix)) {
-            std::string stem = word.substr(0, word.size() - suffix.size());
-            if (measure(stem) > 0) {
-                word.replace(
-                    word.size() - suffix.size(), suffix.size(), rule.replacement
-                );
+    void step2() { replaceSuffix(step2Rules(b[k - 1])); }
+
+    void step3() { replaceSuffix(step3Rules(b[k - 1])); }
+
+    void step4() {
+        RuleGroup group = step4Rules(b[k - 1]);
+        for (size_t r = 0; r < group.count; ++r) {
+            const SuffixRule& rule = group.rules[r];
+            if (!endsWith(rule.suffix, rule.length)) continue;
+            int stem = k - rule.length;
+            if (measure(stem) <= 1) continue;  // a later suffix may still apply
+            // "ion" only goes after 's' or 't'.
+            if (std::strcmp(rule.suffix, "ion") != 0 || (stem > 0 && (b[stem - 1] == 's' || b[stem - 1] == 't'))) {
+                k = stem;
             }
-            break;
+            return;
         }
     }
-}
 
-void step3(std::string &word) {
-    struct SuffixRule {
-        const char *suffix;
-        const char *replacement;
-    };
-    SuffixRule rules[] = {
-        {"icate", "ic"}, {"ative", ""}, {"alize", "al"},
-        {"iciti", "ic"}, {"ical", "ic"}, {"ful", ""},
-        {"ness", ""}
-    };
-    for (auto &rule : rules) {
-        std::string suffix(rule.suffix);
-        if (endsWith(word, suffix)) {
-            std::string stem = word.substr(0, word.size() - suffix.size());
-            if (measure(stem) > 0) {
-                word.replace(
-                    word.size() - suffix.size(), suffix.size(), rule.replacement
-                );
-            }
-            break;
+    void step5() {
+        if (k > 0 && b[k - 1] == 'e') {
+            int m = measure(k - 1);
+            if (m > 1 || (m == 1 && !cvc(k - 1))) k -= 1;
+        }
+        if (k >= 2 && b[k - 1] == 'l' && b[k - 2] == 'l' && measure(k) > 1) {
+            k -= 1;
         }
     }
-}
 
-void step4(std::string &word) {
-    const char* suffixes[] = {
-        "al", "ance", "ence", "er", "ic", "able", "ible",
-        "ant", "ement", "ment", "ent", "ion", "ou", "ism",
-        "ate", "iti", "ous", "ive", "ize"
-    };
-    for (auto s : suffixes) {
-        std::string suffix(s);
-        if (endsWith(word, suffix)) {
-            std::string stem = word.substr(0, word.size() - suffix.size());
-            if (measure(stem) > 1) {
-                if (std::string(s) == "ion") {
-                    if (!stem.empty() && (stem.back() == 's' || stem.back() == 't'))
-                        word.erase(word.size() - suffix.size());
-                } else {
-                    word.erase(word.size() - suffix.size());
-                }
-                break;
+private:
+    char* b;
+    int k;
+    uint8_t* consonant;
+
+    void refresh(int from) {
+        for (int i = from; i < k; ++i) {
+            switch (b[i]) {
+                case 'a': case 'e': case 'i': case 'o': case 'u':
+                    consonant[i] = 0;
+                    break;
+                case 'y':
+                    consonant[i] = i == 0 || !consonant[i - 1];
+                    break;
+                default:
+                    consonant[i] = 1;
             }
         }
     }
-}
 
-void step5(std::string &word) {
-    // Step 5a: Remove trailing 'e'
-    if (endsWith(word, "e")) {
-        std::string stem = word.substr(0, word.size() - 1);
-        int m = measure(stem);
-        if (m > 1 || (m == 1 && !cvc(stem)))
-            word.erase(word.size() - 1);
+    void append(char c) {
+        b[k++] = c;
+        refresh(k - 1);
     }
-    // Step 5b: Remove double 'l' if measure > 1.
-    if (measure(word) > 1 && word.size() >= 2 &&
-        word[word.size() - 1] == 'l' && word[word.size() - 2] == 'l') {
-        word.erase(word.size() - 1);
+
+    bool endsWith(const char* suffix, int n) const {
+        return k >= n && std::memcmp(b + k - n, suffix, n) == 0;
     }
-}
+
+    // Number of vowel-consonant sequences in b[0, n).
+    int measure(int n) const {
+        int count = 0;
+        int i = 0;
+        while (i < n && consonant[i]) i++;
+        while (i < n) {
+            while (i < n && !consonant[i]) i++;
+            count++;
+            while (i < n && consonant[i]) i++;
+        }
+        return count;
+    }
+
+    bool containsVowel(int n) const {
+        for (int i = 0; i < n; ++i) {
+            if (!consonant[i]) return true;
+        }
+        return false;
+    }
+
+    // Whether b[0, n) ends consonant-vowel-consonant, the last not w, x or y.
+    bool cvc(int n) const {
+        if (n < 3 || !consonant[n - 3] || consonant[n - 2] || !consonant[n - 1]) return false;
+        return b[n - 1] != 'w' && b[n - 1] != 'x' && b[n - 1] != 'y';
+    }
+
+    void replaceSuffix(RuleGroup group) {
+        for (size_t r = 0; r < group.count; ++r) {
+            const SuffixRule& rule = group.rules[r];
+            if (!endsWith(rule.suffix, rule.length)) continue;
+            int stem = k - rule.length;
+            if (measure(stem) > 0) {
+                std::memcpy(b + stem, rule.replacement, rule.replacementLength);
+                k = stem + rule.replacementLength;
+                refresh(stem);
+            }
+            return;
+        }
+    }
+};
+
+} // namespace
 
 namespace stemmer {
 
+size_t stemInPlace(char* word, size_t length) {
+    if (length <= 2)
+        return length; // Too short to stem reliably.
+
+    uint8_t stackFlags[STACK_WORD_LENGTH];
+    std::vector<uint8_t> heapFlags;
+    uint8_t* consonant = stackFlags;
+    if (length > STACK_WORD_LENGTH) {
+        heapFlags.resize(length);
+        consonant = heapFlags.data();
+    }
+
+    Word w(word, static_cast<int>(length), consonant);
+    w.step1a();
+    w.step1b();
+    w.step1c();
+    w.step2();
+    w.step3();
+    w.step4();
+    w.step5();
+    return static_cast<size_t>(w.length());
+}
+
 std::string stem(const std::string &input) {
     std::string word = input;
-    if (word.size() <= 2)
-        return word; // Too short to stem reliably.
-    step1a(word);
-    step1b(word);
-    step1c(word);
-    step2(word);
-    step3(word);
-    step4(word);
-    step5(word);
+    word.resize(stemInPlace(word.data(), word.size()));
     return word;
 }
 
-} // namespace porter_stemmer
+StemCache::StemCache(size_t capacity, size_t shardCount)
+    : shards(shardCount == 0 ? 1 : shardCount),
+      shardCapacity(capacity / shards.size()) {}
+
+std::string StemCache::stem(std::string_view word) {
+    Shard& shard = shards[std::hash<std::string_view>()(word) % shards.size()];
+    std::string key(word);
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.stems.find(key);
+        if (it != shard.stems.end()) return it->second;
+    }
+
+    std::string result = key;
+    result.resize(stemInPlace(result.data(), result.size()));
+
+    if (shardCapacity > 0) {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        if (shard.stems.size() >= shardCapacity) shard.stems.clear();
+        shard.stems.emplace(std::move(key), result);
+    }
+    return result;
+}
+
+size_t StemCache::size() const {
+    size_t total = 0;
+    for (const Shard& shard : shards) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        total += shard.stems.size();
+    }
+    return total;
+}
+
+} // namespace stemmer
@@ -0,0 +1,278 @@
+#include "../../include/query-processing/stopwords.h"
+#include "../../include/query-processing/tokenizer.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+namespace stopwords {
+
+namespace {
+
+/** Largest bucket the table builder accepts. */
+constexpr uint32_t MAX_BUCKET_SIZE = 32;
+
+/** Seeds tried per bucket before giving up. */
+constexpr uint32_t MAX_SEED = 1 << 20;
+
+constexpr uint32_t hashWord(std::string_view word, uint32_t seed) {
+    // FNV-1a with the seed folded into the offset basis, then a finalizer so
+    // the high bits used by reduce() depend on every input bit.
+    uint32_t h = 2166136261u ^ (seed * 0x9e3779b9u);
+    for (char c : word) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+// Maps a hash onto [0, n) without a division.
+constexpr uint32_t reduce(uint32_t h, uint32_t n) {
+    return static_cast<uint32_t>((uint64_t(h) * n) >> 32);
+}
+
+/**
+ * @brief Builds a minimal perfect hash table over distinct keys.
+ *
+ * Hash and displace: a first hash groups the keys into n buckets. Buckets
+ * are placed largest first, each taking the first seed whose second hash
+ * sends all of its keys to free slots. Single-key buckets then take the
+ * remaining free slots directly, recorded as -(slot + 1).
+ *
+ * @param keys n distinct keys.
+ * @param n Number of keys.
+ * @param seeds Receives n bucket entries.
+ * @param slots Receives the key index stored in each of the n slots.
+ * @param scratch 4n + 1 entries of working space.
+ * @return False if no table was found.
+ */
+constexpr bool buildPerfectHash(const std::string_view* keys, uint32_t n,
+                                int32_t* seeds, uint32_t* slots, uint32_t* scratch) {
+    uint32_t* bucketOf = scratch;
+    uint32_t* start = scratch + n;             // n + 1 entries
+    uint32_t* members = scratch + 2 * n + 1;
+    uint32_t* order = scratch + 3 * n + 1;
+
+    // Group key indexes by bucket.
+    for (uint32_t b = 0; b <= n; ++b) start[b] = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+        bucketOf[i] = reduce(hashWord(keys[i], 0), n);
+        start[bucketOf[i] + 1]++;
+    }
+    std::array<uint32_t, MAX_BUCKET_SIZE + 2> largerThan{};
+    for (uint32_t b = 0; b < n; ++b) {
+        uint32_t size = start[b + 1];
+        if (size > MAX_BUCKET_SIZE) return false;
+        largerThan[size]++;
+        start[b + 1] += start[b];
+    }
+    for (uint32_t b = 0; b < n; ++b) order[b] = start[b];
+    for (uint32_t i = 0; i < n; ++i) members[order[bucketOf[i]]++] = i;
+
+    // Order buckets by size, largest first.
+    for (uint32_t size = MAX_BUCKET_SIZE, total = 0; size + 1 > 0; --size) {
+        uint32_t count = largerThan[size];
+        largerThan[size] = total;
+        total += count;
+    }
+    for (uint32_t b = 0; b < n; ++b) order[largerThan[start[b + 1] - start[b]]++] = b;
+
+    for (uint32_t s = 0; s < n; ++s) slots[s] = n;  // free
+    uint32_t k = 0;
+    for (; k < n; ++k) {
+        uint32_t b = order[k];
+        uint32_t size = start[b + 1] - start[b];
+        if (size < 2) break;
+
+        std::array<uint32_t, MAX_BUCKET_SIZE> taken{};
+        uint32_t seed = 1;
+        for (;; ++seed) {
+            if (seed > MAX_SEED) return false;
+            uint32_t placed = 0;
+            for (; placed < size; ++placed) {
+                uint32_t s = reduce(hashWord(keys[members[start[b] + placed]], seed), n);
+                bool clash = slots[s] != n;
+                for (uint32_t j = 0; j < placed && !clash; ++j) clash = taken[j] == s;
+                if (clash) break;
+                taken[placed] = s;
+            }
+            if (placed == size) break;
+        }
+        for (uint32_t j = 0; j < size; ++j) slots[taken[j]] = members[start[b] + j];
+        seeds[b] = static_cast<int32_t>(seed);
+    }
+
+    for (uint32_t free = 0; k < n; ++k) {
+        uint32_t b = order[k];
+        if (start[b + 1] == start[b]) {
+            seeds[b] = 0;
+            continue;
+        }
+        while (slots[free] != n) ++free;
+        slots[free] = members[start[b]];
+        seeds[b] = -static_cast<int32_t>(free + 1);
+    }
+    return true;
+}
+
+/**
+ * @brief Looks a word up in a table from buildPerfectHash.
+ * @param offsets n + 1 offsets of the slot words in 'chars'.
+ */
+constexpr bool perfectHashContains(std::string_view word, const int32_t* seeds,
+                                   const uint32_t* offsets, const char* chars, uint32_t n) {
+    if (n == 0) return false;
+    int32_t g = seeds[reduce(hashWord(word, 0), n)];
+    uint32_t s = g < 0 ? static_cast<uint32_t>(-g - 1) : reduce(hashWord(word, static_cast<uint32_t>(g)), n);
+    return word == std::string_view(chars + offsets[s], offsets[s + 1] - offsets[s]);
+}
+
+// Built-in list; stopwords.txt is a comma-separated list of string literals.
+constexpr std::string_view STOPWORD_LIST[] = {
+#include "stopwords.txt"
+};
+constexpr size_t LIST_SIZE = std::size(STOPWORD_LIST);
+
+constexpr size_t listChars() {
+    size_t total = 0;
+    for (std::string_view word : STOPWORD_LIST) total += word.size();
+    return total;
+}
+constexpr size_t LIST_CHARS = listChars();
+
+using ListChars = std::array<char, LIST_CHARS>;
+using ListWords = std::array<std::string_view, LIST_SIZE>;
+
+/**
+ * @brief Normalizes the built-in list like tokenizer output and removes duplicates.
+ * @return Number of distinct words, at the front of 'words'.
+ */
+constexpr size_t normalizeList(ListChars& chars, ListWords& words) {
+    // Open addressing over word indexes (LIST_SIZE means empty) spots
+    // duplicates without sorting, which is costly to evaluate at compile time.
+    std::array<uint32_t, 2 * LIST_SIZE> seen{};
+    for (uint32_t& entry : seen) entry = LIST_SIZE;
+
+    size_t used = 0, count = 0;
+    for (std::string_view raw : STOPWORD_LIST) {
+        size_t begin = used;
+        for (char c : raw) {
+            if (c >= 'A' && c <= 'Z') {
+                chars[used++] = static_cast<char>(c - 'A' + 'a');
+            } else if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) {
+                chars[used++] = c;
+            }
+        }
+        if (used == begin) continue;
+
+        std::string_view word(chars.data() + begin, used - begin);
+        size_t probe = reduce(hashWord(word, 0), static_cast<uint32_t>(seen.size()));
+        while (seen[probe] != LIST_SIZE && words[seen[probe]] != word) {
+            probe = probe + 1 == seen.size() ? 0 : probe + 1;
+        }
+        if (seen[probe] == LIST_SIZE) {
+            seen[probe] = static_cast<uint32_t>(count);
+            words[count++] = word;
+        } else {
+            used = begin;  // duplicate
+        }
+    }
+    return count;
+}
+
+constexpr size_t countStopwords() {
+    ListChars chars{};
+    ListWords words{};
+    return normalizeList(chars, words);
+}
+constexpr uint32_t STOPWORD_COUNT = static_cast<uint32_t>(countStopwords());
+
+struct StaticTable {
+    std::array<int32_t, STOPWORD_COUNT> seeds{};
+    std::array<uint32_t, STOPWORD_COUNT + 1> offsets{};
+    std::array<char, LIST_CHARS> chars{};
+};
+
+constexpr StaticTable buildStaticTable() {
+    ListChars chars{};
+    ListWords words{};
+    normalizeList(chars, words);
+
+    StaticTable table{};
+    std::array<uint32_t, STOPWORD_COUNT> slots{};
+    std::array<uint32_t, 4 * STOPWORD_COUNT + 1> scratch{};
+    if (!buildPerfectHash(words.data(), STOPWORD_COUNT, table.seeds.data(), slots.data(), scratch.data())) {
+        throw std::logic_error("No perfect hash table for the stop word list");
+    }
+    uint32_t used = 0;
+    for (uint32_t s = 0; s < STOPWORD_COUNT; ++s) {
+        table.offsets[s] = used;
+        for (char c : words[slots[s]]) table.chars[used++] = c;
+    }
+    table.offsets[STOPWORD_COUNT] = used;
+    return table;
+}
+
+constexpr StaticTable STOPWORDS = buildStaticTable();
+
+} // namespace
+
+bool isStopWord(std::string_view word) {
+    return perfectHashContains(word, STOPWORDS.seeds.data(), STOPWORDS.offsets.data(),
+                               STOPWORDS.chars.data(), STOPWORD_COUNT);
+}
+
+StopwordSet::StopwordSet(const std::vector<std::string>& words) {
+    std::vector<std::string> normalized;
+    tokenizer::TokenBuffer tokens;
+    for (const std::string& word : words) {
+        tokenizer::tokenize(word, tokens);
+        normalized.insert(normalized.end(), tokens.begin(), tokens.end());
+    }
+    std::sort(normalized.begin(), normalized.end());
+    normalized.erase(std::unique(normalized.begin(), normalized.end()), normalized.end());
+
+    uint32_t n = static_cast<uint32_t>(normalized.size());
+    std::vector<std::string_view> keys(normalized.begin(), normalized.end());
+    std::vector<uint32_t> slots(n), scratch(4 * size_t(n) + 1);
+    seeds.resize(n);
+    if (!buildPerfectHash(keys.data(), n, seeds.data(), slots.data(), scratch.data())) {
+        throw std::runtime_error("Failed to build stop word table");
+    }
+
+    offsets.reserve(n + 1);
+    for (uint32_t s = 0; s < n; ++s) {
+        offsets.push_back(static_cast<uint32_t>(chars.size()));
+        chars += keys[slots[s]];
+    }
+    offsets.push_back(static_cast<uint32_t>(chars.size()));
+}
+
+StopwordSet StopwordSet::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Failed to open stop word list: " + path);
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+
+    // Commas separate entries too; the tokenizer would otherwise join "a,b".
+    std::string text = contents.str();
+    std::replace(text.begin(), text.end(), ',', ' ');
+    return StopwordSet({text});
+}
+
+bool StopwordSet::contains(std::string_view word) const {
+    return perfectHashContains(word, seeds.data(), offsets.data(), chars.data(),
+                               static_cast<uint32_t>(seeds.size()));
+}
+
+} // namespace stopwords
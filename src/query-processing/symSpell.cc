@@ -0,0 +1,330 @@
+#include "../../include/query-processing/symSpell.h"
+#include "../../include/query-processing/editDistance.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace spell {
+
+namespace {
+
+const uint32_t SYMSPELL_MAGIC = 0x4d594453;  // "SDYM"
+const uint32_t SYMSPELL_VERSION = 1;
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t maxDistance;
+    uint32_t wordCount;
+    uint32_t bucketCount;
+    uint32_t reserved;
+    uint64_t postingsOffset;
+    uint64_t wordsOffset;
+    uint64_t stringsOffset;
+    uint64_t fileSize;
+};
+
+const size_t BUCKET_SIZE = 12;  // u32 fingerprint, u32 word id or first posting, u32 count
+const size_t WORD_SIZE = 12;    // u32 offset, u32 length, u32 frequency
+
+uint32_t readU32(const char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+void appendU32(std::string& out, uint32_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/**
+ * @brief FNV-1a with a final avalanche, folded to 32 bits.
+ */
+uint32_t fingerprint(std::string_view s) {
+    uint64_t h = 1469598103934665603ULL;
+    for (unsigned char c : s) {
+        h = (h ^ c) * 1099511628211ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return static_cast<uint32_t>(h >> 32);
+}
+
+/**
+ * @brief Home bucket of a fingerprint: maps it onto [0, bucketCount) without division.
+ */
+uint32_t homeBucket(uint32_t fingerprint, uint32_t bucketCount) {
+    return static_cast<uint32_t>((uint64_t(fingerprint) * bucketCount) >> 32);
+}
+
+/**
+ * @brief Adds the fingerprint of every string obtained by deleting up to
+ *        'distance' characters at positions >= start. Deleting the same set
+ *        of positions in a different order is not repeated; equal strings from
+ *        different positions are, and are deduplicated by the caller.
+ */
+void addDeletions(std::string& word, size_t start, int distance, uint32_t id,
+                  std::vector<std::pair<uint32_t, uint32_t>>& keys) {
+    keys.emplace_back(fingerprint(word), id);
+    if (distance == 0) return;
+    for (size_t i = start; i < word.size(); ++i) {
+        char removed = word[i];
+        word.erase(i, 1);
+        addDeletions(word, i, distance - 1, id, keys);
+        word.insert(word.begin() + i, removed);
+    }
+}
+
+} // namespace
+
+SymSpell::SymSpell(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open spelling index: " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        ::close(fd);
+        throw std::runtime_error("Corrupt spelling index: " + path);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    void* region = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (region == MAP_FAILED) {
+        throw std::runtime_error("Failed to map spelling index: " + path);
+    }
+    data = static_cast<const char*>(region);
+    mapped = true;
+
+    if (!attach()) {
+        ::munmap(const_cast<char*>(data), size_);
+        throw std::runtime_error("Corrupt spelling index: " + path);
+    }
+}
+
+SymSpell::SymSpell(const char* image, size_t size) : data(image), size_(size) {
+    if (!attach()) {
+        throw std::runtime_error("Corrupt spelling index");
+    }
+}
+
+SymSpell::~SymSpell() {
+    if (mapped) {
+        ::munmap(const_cast<char*>(data), size_);
+    }
+}
+
+bool SymSpell::attach() {
+    if (size_ < sizeof(Header)) return false;
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    uint64_t bucketsEnd = sizeof(header) + uint64_t(header.bucketCount) * BUCKET_SIZE;
+    bool valid = header.magic == SYMSPELL_MAGIC && header.version == SYMSPELL_VERSION &&
+                 header.fileSize == size_ && header.bucketCount > 0 &&
+                 header.postingsOffset >= bucketsEnd &&
+                 header.wordsOffset >= header.postingsOffset &&
+                 header.stringsOffset >= header.wordsOffset + uint64_t(header.wordCount) * WORD_SIZE &&
+                 header.stringsOffset <= size_;
+    if (!valid) return false;
+
+    maxDistance_ = static_cast<int>(header.maxDistance);
+    wordCount = header.wordCount;
+    bucketCount = header.bucketCount;
+    buckets = data + sizeof(header);
+    postings = data + header.postingsOffset;
+    words = data + header.wordsOffset;
+    strings = data + header.stringsOffset;
+    stringsSize = size_ - header.stringsOffset;
+    return true;
+}
+
+std::string_view SymSpell::word(uint32_t id) const {
+    const char* entry = words + size_t(id) * WORD_SIZE;
+    uint32_t offset = readU32(entry);
+    uint32_t length = readU32(entry + 4);
+    if (uint64_t(offset) + length > stringsSize) {
+        throw std::runtime_error("Corrupt spelling index word");
+    }
+    return std::string_view(strings + offset, length);
+}
+
+const char* SymSpell::lookup(uint32_t fingerprint, uint32_t& count) const {
+    for (uint32_t i = homeBucket(fingerprint, bucketCount);; i = (i + 1 == bucketCount) ? 0 : i + 1) {
+        const char* bucket = buckets + size_t(i) * BUCKET_SIZE;
+        count = readU32(bucket + 8);
+        if (count == 0) return nullptr;
+        if (readU32(bucket) == fingerprint) {
+            // A single word id is stored in the bucket itself.
+            return count == 1 ? bucket + 4 : postings + size_t(readU32(bucket + 4)) * sizeof(uint32_t);
+        }
+    }
+}
+
+bool SymSpell::contains(std::string_view word) const {
+    uint32_t count;
+    const char* ids = lookup(fingerprint(word), count);
+    for (uint32_t i = 0; i < count; ++i) {
+        if (this->word(readU32(ids + size_t(i) * sizeof(uint32_t))) == word) return true;
+    }
+    return false;
+}
+
+std::string SymSpell::findClosest(const std::string& query, int threshold) const {
+    if (query.empty() || wordCount == 0) return query;
+    threshold = std::min(threshold, maxDistance_);
+    if (threshold < 0) return query;
+
+    EditDistance metric(query);
+    int bestDistance = threshold + 1;
+    uint32_t bestId = 0;
+
+    std::unordered_set<uint32_t> checked;
+    std::unordered_set<std::string> seen{query};
+    std::vector<std::string> level{query}, nextLevel;
+
+    // A word at distance d shares a deletion of at most d characters with the
+    // query, so deletion levels past the best distance cannot improve on it.
+    for (int deleted = 0; deleted <= threshold && deleted <= bestDistance; ++deleted) {
+        for (const std::string& deletion : level) {
+            uint32_t count;
+            const char* ids = lookup(fingerprint(deletion), count);
+            for (uint32_t i = 0; i < count; ++i) {
+                uint32_t id = readU32(ids + size_t(i) * sizeof(uint32_t));
+                if (!checked.insert(id).second) continue;
+
+                // Lower ids are more frequent, so they win ties.
+                int dist = metric.distance(word(id), bestDistance);
+                if (dist < bestDistance || (dist == bestDistance && dist <= threshold && id < bestId)) {
+                    bestDistance = dist;
+                    bestId = id;
+                }
+            }
+            if (bestDistance == 0) return query;
+        }
+
+        if (deleted == threshold) break;
+        nextLevel.clear();
+        for (const std::string& deletion : level) {
+            for (size_t i = 0; i < deletion.size(); ++i) {
+                std::string shorter = deletion.substr(0, i) + deletion.substr(i + 1);
+                if (seen.insert(shorter).second) {
+                    nextLevel.push_back(std::move(shorter));
+                }
+            }
+        }
+        level.swap(nextLevel);
+    }
+
+    // If no valid match was found within the threshold, return the original query
+    return (bestDistance <= threshold) ? std::string(word(bestId)) : query;
+}
+
+void SymSpell::build(const Frequencies& frequencies, const std::string& path, int maxDistance) {
+    std::string image = serialize(frequencies, maxDistance);
+
+    std::string staged = path + ".tmp";
+    {
+        std::ofstream out(staged, std::ios::binary | std::ios::trunc);
+        out.write(image.data(), image.size());
+        if (!out) {
+            throw std::runtime_error("Failed to write spelling index: " + staged);
+        }
+    }
+    if (std::rename(staged.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("Failed to replace spelling index: " + path);
+    }
+}
+
+std::string SymSpell::serialize(const Frequencies& frequencies, int maxDistance) {
+    if (maxDistance < 0) {
+        throw std::invalid_argument("Spelling index distance must not be negative");
+    }
+
+    // Most frequent words get the lowest ids.
+    std::vector<std::pair<std::string, uint32_t>> entries(frequencies.begin(), frequencies.end());
+    std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+
+    // (deletion fingerprint, word id) for every word and each of its deletions.
+    std::vector<std::pair<uint32_t, uint32_t>> keys;
+    for (uint32_t id = 0; id < entries.size(); ++id) {
+        std::string word = entries[id].first;
+        addDeletions(word, 0, maxDistance, id, keys);
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    size_t distinct = 0;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        distinct += i == 0 || keys[i].first != keys[i - 1].first;
+    }
+    // Load factor 0.8 keeps linear probe chains short.
+    uint32_t bucketCount = static_cast<uint32_t>(distinct + distinct / 4 + 1);
+
+    std::string table(size_t(bucketCount) * BUCKET_SIZE, '\0');
+    std::string postingList;
+    for (size_t i = 0; i < keys.size();) {
+        uint32_t key = keys[i].first;
+        size_t end = i;
+        while (end < keys.size() && keys[end].first == key) ++end;
+        uint32_t count = static_cast<uint32_t>(end - i);
+        uint32_t value = keys[i].second;
+        if (count > 1) {
+            value = static_cast<uint32_t>(postingList.size() / sizeof(uint32_t));
+            for (size_t k = i; k < end; ++k) appendU32(postingList, keys[k].second);
+        }
+        i = end;
+
+        uint32_t slot = homeBucket(key, bucketCount);
+        while (readU32(&table[size_t(slot) * BUCKET_SIZE + 8]) != 0) {
+            slot = (slot + 1 == bucketCount) ? 0 : slot + 1;
+        }
+        char* bucket = &table[size_t(slot) * BUCKET_SIZE];
+        std::memcpy(bucket, &key, sizeof(key));
+        std::memcpy(bucket + 4, &value, sizeof(value));
+        std::memcpy(bucket + 8, &count, sizeof(count));
+    }
+
+    std::string wordTable, wordBytes;
+    for (const auto& [word, frequency] : entries) {
+        appendU32(wordTable, static_cast<uint32_t>(wordBytes.size()));
+        appendU32(wordTable, static_cast<uint32_t>(word.size()));
+        appendU32(wordTable, frequency);
+        wordBytes += word;
+    }
+
+    Header header{};
+    header.magic = SYMSPELL_MAGIC;
+    header.version = SYMSPELL_VERSION;
+    header.maxDistance = static_cast<uint32_t>(maxDistance);
+    header.wordCount = static_cast<uint32_t>(entries.size());
+    header.bucketCount = bucketCount;
+    header.postingsOffset = sizeof(header) + table.size();
+    header.wordsOffset = header.postingsOffset + postingList.size();
+    header.stringsOffset = header.wordsOffset + wordTable.size();
+    header.fileSize = header.stringsOffset + wordBytes.size();
+
+    std::string image;
+    image.reserve(header.fileSize);
+    image.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    image += table;
+    image += postingList;
+    image += wordTable;
+    image += wordBytes;
+    return image;
+}
+
+} // namespace spell
@@ -0,0 +1,96 @@
+#include "../../include/query-processing/synonyms.h"
+#include "../../include/query-processing/stemmer.h"
+#include "../../include/query-processing/tokenizer.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+namespace synonyms {
+
+void SynonymDictionary::addGroup(const std::vector<std::string>& terms) {
+    std::vector<std::string> members;
+    for (const std::string& term : terms) {
+        if (!term.empty() && index.find(term) == index.end()) {
+            members.push_back(term);
+        }
+    }
+    std::sort(members.begin(), members.end());
+    members.erase(std::unique(members.begin(), members.end()), members.end());
+    if (members.size() < 2) return;
+
+    uint32_t group = static_cast<uint32_t>(groups.size());
+    for (const std::string& member : members) {
+        index.emplace(member, group);
+    }
+    groups.push_back(std::move(members));
+}
+
+SynonymDictionary SynonymDictionary::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Unable to open synonyms file " + path);
+    }
+
+    SynonymDictionary dictionary;
+    tokenizer::TokenBuffer words;
+    std::string line;
+    std::vector<std::string> terms;
+    while (std::getline(file, line)) {
+        terms.clear();
+        size_t start = 0;
+        while (start <= line.size()) {
+            size_t end = std::min(line.find(',', start), line.size());
+            tokenizer::tokenize(std::string_view(line).substr(start, end - start), words);
+            if (words.size() == 1) {
+                terms.push_back(stemmer::stem(std::string(words[0])));
+            }
+            start = end + 1;
+        }
+        dictionary.addGroup(terms);
+    }
+    return dictionary;
+}
+
+uint32_t SynonymDictionary::groupOf(std::string_view term) const {
+    auto it = index.find(std::string(term));
+    return it == index.end() ? NO_GROUP : it->second;
+}
+
+std::string SynonymDictionary::mergedTerm(uint32_t group) const {
+    std::string key(MERGED_TERM_PREFIX);
+    for (size_t i = 0; i < groups[group].size(); ++i) {
+        if (i) key.push_back(',');
+        key.append(groups[group][i]);
+    }
+    return key;
+}
+
+std::vector<uint32_t> SynonymDictionary::mostQueried(const std::vector<std::string>& queries,
+                                                     size_t limit) const {
+    std::vector<uint32_t> counts(groups.size(), 0);
+    std::vector<uint32_t> seen;  // groups counted for the current query
+    tokenizer::TokenBuffer words;
+    for (const std::string& query : queries) {
+        seen.clear();
+        tokenizer::tokenize(query, words);
+        for (std::string_view word : words) {
+            uint32_t group = groupOf(stemmer::stem(std::string(word)));
+            if (group != NO_GROUP && std::find(seen.begin(), seen.end(), group) == seen.end()) {
+                seen.push_back(group);
+                ++counts[group];
+            }
+        }
+    }
+
+    std::vector<uint32_t> ranked;
+    for (uint32_t group = 0; group < groups.size(); ++group) {
+        if (counts[group] > 0) ranked.push_back(group);
+    }
+    std::stable_sort(ranked.begin(), ranked.end(),
+                     [&](uint32_t a, uint32_t b) { return counts[a] > counts[b]; });
+    if (ranked.size() > limit) ranked.resize(limit);
+    return ranked;
+}
+
+} // namespace synonyms
@@ -0,0 +1,263 @@
+#include "../../include/query-processing/tokenizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace tokenizer {
+
+namespace {
+
+enum CharClass : uint8_t { DROP, WORD, SPACE, OPERATOR };
+
+constexpr std::array<uint8_t, 128> makeAsciiClasses() {
+    std::array<uint8_t, 128> classes{};
+    for (int c = 0; c < 128; ++c) {
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) {
+            classes[c] = WORD;
+        } else if (c == ' ' || (c >= '\t' && c <= '\r')) {
+            classes[c] = SPACE;
+        } else if (c == '*' || c == '~') {
+            classes[c] = OPERATOR;
+        } else {
+            classes[c] = DROP;
+        }
+    }
+    return classes;
+}
+
+constexpr std::array<uint8_t, 128> ASCII_CLASSES = makeAsciiClasses();
+
+/**
+ * @brief Classifies a non-ASCII code point.
+ */
+CharClass classifyCodePoint(uint32_t cp) {
+    if (cp == 0xa0 || (cp >= 0x2000 && cp <= 0x200a) || cp == 0x2028 || cp == 0x2029 ||
+        cp == 0x202f || cp == 0x205f || cp == 0x3000) {
+        return SPACE;
+    }
+    if ((cp >= 0xa1 && cp <= 0xbf) || cp == 0xd7 || cp == 0xf7 ||
+        (cp >= 0x200b && cp <= 0x2027) || (cp >= 0x2030 && cp <= 0x205e) ||
+        (cp >= 0x3001 && cp <= 0x3003) || cp == 0xfeff) {
+        return DROP;
+    }
+    return WORD;
+}
+
+/**
+ * @brief Decodes one UTF-8 sequence.
+ * @return Its length in bytes, or 0 if the sequence is malformed.
+ */
+size_t decodeUtf8(const unsigned char* p, size_t remaining, uint32_t& cp) {
+    unsigned char lead = p[0];
+    size_t length;
+    unsigned char min = 0x80, max = 0xbf;  // valid range of the second byte
+    if (lead >= 0xc2 && lead <= 0xdf) {
+        length = 2;
+        cp = lead & 0x1f;
+    } else if (lead >= 0xe0 && lead <= 0xef) {
+        length = 3;
+        cp = lead & 0x0f;
+        if (lead == 0xe0) min = 0xa0;       // overlong
+        if (lead == 0xed) max = 0x9f;       // surrogates
+    } else if (lead >= 0xf0 && lead <= 0xf4) {
+        length = 4;
+        cp = lead & 0x07;
+        if (lead == 0xf0) min = 0x90;       // overlong
+        if (lead == 0xf4) max = 0x8f;       // above U+10FFFF
+    } else {
+        return 0;
+    }
+    if (remaining < length || p[1] < min || p[1] > max) return 0;
+    for (size_t k = 1; k < length; ++k) {
+        if ((p[k] & 0xc0) != 0x80) return 0;
+        cp = (cp << 6) | (p[k] & 0x3f);
+    }
+    return length;
+}
+
+/**
+ * @brief Appends normalized characters and cuts them into tokens.
+ */
+struct TokenWriter {
+    char* out;
+    std::vector<std::string_view>& views;
+    size_t length = 0;
+    size_t tokenStart = 0;
+    bool hasWord = false;   // the current token has a character other than '*' or '~'
+    bool hasTilde = false;  // the current token has a '~'
+
+    void put(char c, bool word) {
+        out[length++] = c;
+        hasWord |= word;
+    }
+
+    void putOperator(char c) {
+        out[length++] = c;
+        hasTilde |= c == '~';
+    }
+
+    // Keeps '~' only as a fuzzy suffix, "term~N": after letters and digits,
+    // followed by the single digit that ends the token.
+    void dropStrayTildes() {
+        char* begin = out + tokenStart;
+        size_t n = length - tokenStart;
+        bool fuzzy = n >= 3 && begin[n - 2] == '~' && begin[n - 1] >= '0' && begin[n - 1] <= '9' &&
+                     std::none_of(begin, begin + n - 2, [](char c) { return c == '~' || c == '*'; });
+        if (!fuzzy) {
+            length = tokenStart + static_cast<size_t>(std::remove(begin, begin + n, '~') - begin);
+        }
+        hasTilde = false;
+    }
+
+    void endToken() {
+        if (hasTilde) dropStrayTildes();
+        if (hasWord) {
+            views.emplace_back(out + tokenStart, length - tokenStart);
+        } else {
+            length = tokenStart;
+        }
+        tokenStart = length;
+        hasWord = false;
+    }
+};
+
+/**
+ * @brief Normalizes one character, ASCII or UTF-8.
+ * @return Number of input bytes consumed.
+ */
+size_t scalarStep(const unsigned char* p, size_t remaining, TokenWriter& writer, bool keepOperators) {
+    unsigned char c = p[0];
+    if (c < 0x80) {
+        switch (ASCII_CLASSES[c]) {
+        case WORD:
+            writer.put(static_cast<char>(c >= 'A' && c <= 'Z' ? c | 0x20 : c), true);
+            break;
+        case SPACE:
+            writer.endToken();
+            break;
+        case OPERATOR:
+            if (keepOperators) writer.putOperator(static_cast<char>(c));
+            break;
+        default:
+            break;
+        }
+        return 1;
+    }
+
+    uint32_t cp;
+    size_t length = decodeUtf8(p, remaining, cp);
+    if (length == 0) return 1;  // drop the malformed byte
+
+    switch (classifyCodePoint(cp)) {
+    case SPACE:
+        writer.endToken();
+        break;
+    case WORD:
+        if (cp >= 0xc0 && cp <= 0xde) {
+            // Latin-1 capitals sit 0x20 below their lowercase forms.
+            writer.put(static_cast<char>(p[0]), true);
+            writer.put(static_cast<char>(p[1] + 0x20), true);
+        } else {
+            for (size_t k = 0; k < length; ++k) writer.put(static_cast<char>(p[k]), true);
+        }
+        break;
+    default:
+        break;
+    }
+    return length;
+}
+
+#if defined(__SSE2__)
+/**
+ * @brief Normalizes 16 ASCII bytes.
+ */
+void asciiBlock(__m128i v, TokenWriter& writer, bool keepOperators) {
+    auto inRange = [](__m128i x, char lo, char hi) {
+        return _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8(lo - 1)),
+                             _mm_cmplt_epi8(x, _mm_set1_epi8(hi + 1)));
+    };
+    __m128i upper = inRange(v, 'A', 'Z');
+    __m128i lower = _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+    __m128i word = _mm_or_si128(inRange(lower, 'a', 'z'), inRange(v, '0', '9'));
+    __m128i space = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), inRange(v, '\t', '\r'));
+
+    unsigned wordBits = static_cast<unsigned>(_mm_movemask_epi8(word));
+    unsigned spaceBits = static_cast<unsigned>(_mm_movemask_epi8(space));
+    unsigned operatorBits = keepOperators
+        ? static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('*')),
+                                                               _mm_cmpeq_epi8(v, _mm_set1_epi8('~')))))
+        : 0;
+
+    // Only letters, digits and spaces: copy the block as is and cut tokens
+    // at the spaces. The spaces stay behind in the output, between tokens.
+    if ((wordBits | spaceBits) == 0xffff) {
+        size_t base = writer.length;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(writer.out + base), lower);
+        for (unsigned bits = spaceBits; bits != 0; bits &= bits - 1) {
+            size_t space = base + static_cast<size_t>(__builtin_ctz(bits));
+            writer.length = space;
+            // Only this block's bytes are known to be letters or digits; a
+            // token carried over from the previous block may be just stars.
+            writer.hasWord |= space > std::max(base, writer.tokenStart);
+            writer.endToken();
+            writer.tokenStart = writer.length = space + 1;
+        }
+        writer.length = base + 16;
+        writer.hasWord |= writer.length > writer.tokenStart;
+        return;
+    }
+
+    alignas(16) char bytes[16];
+    _mm_store_si128(reinterpret_cast<__m128i*>(bytes), lower);
+    // Visit only the bytes that are kept or end a token.
+    for (unsigned bits = wordBits | spaceBits | operatorBits; bits != 0; bits &= bits - 1) {
+        unsigned j = static_cast<unsigned>(__builtin_ctz(bits));
+        if (spaceBits & (1u << j)) {
+            writer.endToken();
+        } else if (wordBits & (1u << j)) {
+            writer.put(bytes[j], true);
+        } else {
+            writer.putOperator(bytes[j]);
+        }
+    }
+}
+#endif
+
+} // namespace
+
+void tokenize(std::string_view text, TokenBuffer& buffer, bool keepOperators) {
+    // Output never outgrows the input, so views into 'text' stay valid.
+    if (buffer.text.size() < text.size()) buffer.text.resize(text.size());
+    buffer.views.clear();
+
+    TokenWriter writer{buffer.text.data(), buffer.views};
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(text.data());
+    const size_t n = text.size();
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    while (i + 16 <= n) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        if (_mm_movemask_epi8(v) == 0) {
+            asciiBlock(v, writer, keepOperators);
+            i += 16;
+            continue;
+        }
+        // The block has UTF-8; a sequence may run past it.
+        for (size_t blockEnd = i + 16; i < blockEnd;) {
+            i += scalarStep(p + i, n - i, writer, keepOperators);
+        }
+    }
+#endif
+    while (i < n) {
+        i += scalarStep(p + i, n - i, writer, keepOperators);
+    }
+    writer.endToken();
+}
+
+} // namespace tokenizer
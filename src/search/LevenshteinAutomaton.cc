@@ -0,0 +1,48 @@
+#include "search/LevenshteinAutomaton.h"
+
+#include <algorithm>
+
+namespace Ranking {
+
+LevenshteinAutomaton::LevenshteinAutomaton(std::string_view term, int max_distance)
+        : term(term), k(max_distance) {}
+
+void LevenshteinAutomaton::start(uint8_t* row) const {
+    const uint8_t cap = static_cast<uint8_t>(k + 1);
+    for (size_t j = 0; j < row_size(); j++) {
+        row[j] = static_cast<uint8_t>(std::min<size_t>(j, cap));
+    }
+}
+
+int LevenshteinAutomaton::next_live_char(const uint8_t* row, unsigned char after) const {
+    // A mismatching character raises the row's minimum by exactly one, so if
+    // the minimum is below k every character keeps the state alive.
+    if (*std::min_element(row, row + row_size()) < k) {
+        return after < 0xff ? after + 1 : -1;
+    }
+    // Otherwise only matching term[j] where row[j] == k stays within k.
+    int best = -1;
+    for (size_t j = 0; j < term.size(); j++) {
+        unsigned char c = static_cast<unsigned char>(term[j]);
+        if (row[j] <= k && c > after && (best < 0 || c < best)) {
+            best = c;
+        }
+    }
+    return best;
+}
+
+bool LevenshteinAutomaton::step(const uint8_t* from, char c, uint8_t* to) const {
+    const uint8_t cap = static_cast<uint8_t>(k + 1);
+    to[0] = std::min<uint8_t>(from[0] + 1, cap);
+    bool alive = to[0] < cap;
+    for (size_t j = 1; j < row_size(); j++) {
+        int substitute = from[j - 1] + (term[j - 1] == c ? 0 : 1);
+        int insert = from[j] + 1;
+        int remove = to[j - 1] + 1;
+        to[j] = static_cast<uint8_t>(std::min({substitute, insert, remove, static_cast<int>(cap)}));
+        alive |= to[j] < cap;
+    }
+    return alive;
+}
+
+}
@@ -0,0 +1,116 @@
+#include "search/PostingUnion.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <queue>
+#include <tuple>
+
+namespace Ranking {
+
+namespace {
+
+using ListRefs = std::vector<const std::vector<Data>*>;
+
+bool by_doc(const Data& a, const Data& b) {
+    return a.docId < b.docId;
+}
+
+// k-way merge of lists ordered by docId; cheap when there are few lists.
+std::vector<Data> heap_union(const ListRefs& lists) {
+    using Cursor = std::tuple<int, size_t, size_t>; // (docId, list, position)
+    std::priority_queue<Cursor, std::vector<Cursor>, std::greater<Cursor>> heap;
+    size_t total = 0;
+    for (size_t i = 0; i < lists.size(); i++) {
+        if (!lists[i]->empty()) {
+            heap.emplace((*lists[i])[0].docId, i, 0);
+        }
+        total += lists[i]->size();
+    }
+
+    std::vector<Data> merged;
+    merged.reserve(total);
+    while (!heap.empty()) {
+        auto [doc, list, pos] = heap.top();
+        heap.pop();
+        const Data& posting = (*lists[list])[pos];
+        if (!merged.empty() && merged.back().docId == doc) {
+            merged.back().priority += posting.priority;
+        } else {
+            merged.push_back(posting);
+        }
+        if (pos + 1 < lists[list]->size()) {
+            heap.emplace((*lists[list])[pos + 1].docId, list, pos + 1);
+        }
+    }
+    return merged;
+}
+
+// Accumulate into an array indexed by docId and read the documents back in
+// order from a bitmap; cost does not grow with the number of lists.
+std::vector<Data> accumulator_union(const ListRefs& lists, int max_doc) {
+    std::vector<int> priorities(static_cast<size_t>(max_doc) + 1, 0);
+    std::vector<uint64_t> seen(static_cast<size_t>(max_doc) / 64 + 1, 0);
+    for (const std::vector<Data>* list : lists) {
+        for (const Data& d : *list) {
+            if (d.docId < 0) {
+                continue;
+            }
+            priorities[d.docId] += d.priority;
+            seen[d.docId / 64] |= uint64_t(1) << (d.docId % 64);
+        }
+    }
+
+    std::vector<Data> merged;
+    for (size_t word = 0; word < seen.size(); word++) {
+        for (uint64_t bits = seen[word]; bits; bits &= bits - 1) {
+            int doc = static_cast<int>(word * 64 + __builtin_ctzll(bits));
+            merged.push_back({priorities[doc], doc});
+        }
+    }
+    return merged;
+}
+
+// Whether to use the accumulator, and the largest docId it is sized by. It
+// only pays off for many lists that cover that range densely.
+bool use_accumulator(const ListRefs& lists, int& max_doc) {
+    if (lists.size() <= HEAP_UNION_MAX_LISTS) {
+        return false;
+    }
+    max_doc = -1;
+    size_t total = 0;
+    for (const std::vector<Data>* list : lists) {
+        for (const Data& d : *list) {
+            max_doc = std::max(max_doc, d.docId);
+        }
+        total += list->size();
+    }
+    return max_doc >= 0 && static_cast<size_t>(max_doc) / ACCUMULATOR_MAX_SPREAD < total;
+}
+
+}
+
+std::vector<Data> union_postings(std::vector<std::vector<Data>>& lists) {
+    ListRefs refs;
+    refs.reserve(lists.size());
+    for (const std::vector<Data>& list : lists) {
+        refs.push_back(&list);
+    }
+    int max_doc;
+    if (use_accumulator(refs, max_doc)) {
+        return accumulator_union(refs, max_doc);
+    }
+    for (std::vector<Data>& list : lists) {
+        std::sort(list.begin(), list.end(), by_doc);
+    }
+    return heap_union(refs);
+}
+
+std::vector<Data> union_sorted_postings(const std::vector<const std::vector<Data>*>& lists) {
+    int max_doc;
+    if (use_accumulator(lists, max_doc)) {
+        return accumulator_union(lists, max_doc);
+    }
+    return heap_union(lists);
+}
+
+}
@@ -0,0 +1,64 @@
+#include "search/QueryArena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace Ranking {
+
+QueryArena::QueryArena(size_t block_size, size_t retained_size)
+        : block_size(std::max<size_t>(block_size, 64)), retained_size(retained_size) {}
+
+QueryArena::~QueryArena() {
+    for (const Block& block : blocks) {
+        ::operator delete(block.data);
+    }
+}
+
+void QueryArena::reset() {
+    // Keep the oldest blocks up to the retained size; a single oversized
+    // request should not pin its memory to the worker forever.
+    size_t kept = 0;
+    size_t keep = 0;
+    while (keep < blocks.size() && kept + blocks[keep].size <= retained_size) {
+        kept += blocks[keep++].size;
+    }
+    for (size_t i = keep; i < blocks.size(); i++) {
+        ::operator delete(blocks[i].data);
+    }
+    blocks.resize(keep);
+
+    capacity_bytes = kept;
+    current = 0;
+    offset = 0;
+    used_bytes = 0;
+}
+
+void* QueryArena::do_allocate(size_t bytes, size_t alignment) {
+    for (; current < blocks.size(); current++, offset = 0) {
+        const Block& block = blocks[current];
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.data);
+        size_t start = ((base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+        if (start + bytes <= block.size) {
+            used_bytes += start + bytes - offset;
+            offset = start + bytes;
+            return block.data + start;
+        }
+    }
+
+    // Out of blocks: each new block is at least twice the last one.
+    size_t size = blocks.empty() ? block_size : blocks.back().size * 2;
+    size = std::max(size, bytes + alignment);
+    blocks.push_back({static_cast<char*>(::operator new(size)), size});
+    capacity_bytes += size;
+    current = blocks.size() - 1;
+    offset = 0;
+    return do_allocate(bytes, alignment);
+}
+
+QueryArena& QueryArena::for_thread() {
+    thread_local QueryArena arena;
+    return arena;
+}
+
+}
@@ -0,0 +1,93 @@
+#include "search/QueryOptimizer.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace Ranking {
+
+namespace {
+
+uint64_t total_df(const std::pmr::vector<PlannedTerm>& terms) {
+    uint64_t total = 0;
+    for (const PlannedTerm& term : terms) {
+        total += term.df;
+    }
+    return total;
+}
+
+void describe_terms(std::ostringstream& out, const std::pmr::vector<PlannedTerm>& terms) {
+    out << '[';
+    for (size_t i = 0; i < terms.size(); i++) {
+        out << (i ? " " : "") << terms[i].id << ':' << terms[i].df;
+        if (terms[i].weight != 1.0 && terms[i].weight != 0.0) {
+            out << 'x' << terms[i].weight;
+        }
+    }
+    out << ']';
+}
+
+}
+
+QueryPlan::QueryPlan(const Query& query, std::pmr::memory_resource* resource) : QueryPlan(resource) {
+    scanned.reserve(query.term_ids().size());
+    for (const QueryTerm& term : query.term_ids()) {
+        scanned.push_back({term.id, term.df, 1.0});
+    }
+}
+
+uint64_t QueryPlan::estimated_cost() const {
+    return total_df(scanned);
+}
+
+uint64_t QueryPlan::unoptimized_cost() const {
+    return total_df(scanned) + total_df(skipped);
+}
+
+std::string QueryPlan::describe() const {
+    std::ostringstream out;
+    out << "terms=";
+    describe_terms(out, scanned);
+    out << " dropped=";
+    describe_terms(out, skipped);
+    out << " cost=" << estimated_cost() << '/' << unoptimized_cost();
+    return out.str();
+}
+
+QueryPlan QueryOptimizer::optimize(const Query& query, std::pmr::memory_resource* resource) const {
+    QueryPlan plan(resource);
+    std::pmr::vector<PlannedTerm>& terms = plan.scanned;
+
+    // A repeated term is fetched once and counted once per occurrence.
+    for (const QueryTerm& term : query.term_ids()) {
+        auto same = std::find_if(terms.begin(), terms.end(),
+                                 [&](const PlannedTerm& planned) { return planned.id == term.id; });
+        if (same != terms.end()) {
+            same->weight += 1.0;
+        } else {
+            terms.push_back({term.id, term.df, 1.0});
+        }
+    }
+
+    // Rarest first, so the most selective lists are fetched and scored first.
+    std::stable_sort(terms.begin(), terms.end(),
+                     [](const PlannedTerm& a, const PlannedTerm& b) { return a.df < b.df; });
+
+    // Common terms barely change the ranking but cost the most to scan. A
+    // query made only of common terms keeps them all, since nothing else
+    // could rank its results.
+    double common_df = common_term_ratio * collection_size;
+    auto first_common = std::find_if(terms.begin(), terms.end(),
+                                     [&](const PlannedTerm& term) { return term.df > common_df; });
+    if (first_common != terms.begin()) {
+        for (auto it = first_common; it != terms.end(); ++it) {
+            it->weight *= common_term_weight;
+        }
+        if (common_term_weight == 0.0) {
+            plan.skipped.assign(first_common, terms.end());
+            terms.erase(first_common, terms.end());
+        }
+    }
+    return plan;
+}
+
+}
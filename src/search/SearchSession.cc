@@ -0,0 +1,330 @@
+#include "search/SearchSession.h"
+#include "search/PostingUnion.h"
+#include "search/query.h"
+#include "search/searcher.h"
+#include "query-processing/query.h"
+#include "query-processing/queryTree.h"
+#include "query-processing/tokenizer.h"
+
+#include <algorithm>
+
+namespace Ranking {
+
+namespace {
+
+const char* const SPACES = " \t\n\v\f\r";
+
+bool by_doc_id(const Data& a, const Data& b) {
+    return a.docId < b.docId;
+}
+
+}
+
+void SearchSession::fetch(const std::vector<std::string>& keys) {
+    std::vector<std::string> missing;
+    for (const std::string& key : keys) {
+        if (lists.find(key) == lists.end()) {
+            missing.push_back(key);
+        }
+    }
+    if (missing.empty()) {
+        return;
+    }
+    std::sort(missing.begin(), missing.end());
+    missing.erase(std::unique(missing.begin(), missing.end()), missing.end());
+
+    // Terms missing from the index are remembered as empty lists.
+    std::vector<std::optional<std::vector<Data>>> results = db->getMany(missing, MAX_LIST_POSTINGS);
+    // Lists are kept ordered by docId so that unions merge them in place.
+    for (size_t i = 0; i < missing.size(); ++i) {
+        std::vector<Data>& list = lists[missing[i]];
+        list = results[i] ? std::move(*results[i]) : std::vector<Data>();
+        if (!std::is_sorted(list.begin(), list.end(), by_doc_id)) {
+            std::sort(list.begin(), list.end(), by_doc_id);
+        }
+    }
+    reads += missing.size();
+}
+
+void SearchSession::add_unit(const Unit& unit) {
+    for (const Data& doc : lists.at(unit.key)) {
+        complete_scores[doc.docId] += posting_score(*weight_scheme, doc.priority, unit.df);
+    }
+}
+
+void SearchSession::update_complete(const std::string& text) {
+    if (text == complete_text) {
+        return;
+    }
+    complete_text = text;
+
+    std::vector<Unit> next;
+    std::vector<std::string> terms;
+    if (!text.empty()) {
+        queryTree::QueryTree tree = query::processQuery(text, *resources);
+        tree.resolveTerms(*lexicon);
+        Query query = Query::from_tree(tree);
+        for (const QueryTerm& term : query.term_ids()) {
+            next.push_back({lexicon->term(term.id), term.df});
+            terms.push_back(next.back().key);
+        }
+        for (const std::pmr::string& pattern : query.wildcards()) {
+            next.push_back({std::string(pattern), 0});
+        }
+        for (const FuzzyTerm& fuzzy : query.fuzzy_terms()) {
+            next.push_back({std::string(fuzzy.term) + queryTree::FUZZY_CHAR + std::to_string(fuzzy.max_distance), 0});
+        }
+    }
+    fetch(terms);
+
+    // Wildcard and fuzzy terms are kept as their merged list (keyed by the
+    // pattern or "term~N"), scored as one pseudo-term.
+    for (Unit& unit : next) {
+        bool fuzzy = queryTree::isFuzzy(unit.key);
+        if (!fuzzy && !queryTree::isWildcard(unit.key)) {
+            continue;
+        }
+        auto it = lists.find(unit.key);
+        if (it == lists.end()) {
+            std::vector<std::string> matches;
+            if (fuzzy) {
+                auto [term, distance] = queryTree::splitFuzzy(unit.key);
+                for (FuzzyMatch& match : expand_fuzzy(*lexicon, term, distance, max_expansions)) {
+                    matches.push_back(std::move(match.term));
+                }
+            } else {
+                matches = expand_wildcard(*lexicon, unit.key, max_expansions);
+            }
+            fetch(matches);
+            std::vector<const std::vector<Data>*> parts;
+            for (const std::string& match : matches) {
+                parts.push_back(&lists.at(match));
+            }
+            it = lists.emplace(unit.key, union_sorted_postings(parts)).first;
+        }
+        unit.df = static_cast<uint32_t>(it->second.size());
+    }
+
+    // Scores are sums over units, so when the text only gained units their
+    // scores are added to the previous ones; otherwise all are rescored.
+    std::unordered_map<std::string, size_t> previous;
+    for (const Unit& unit : units) {
+        previous[unit.key]++;
+    }
+    std::vector<const Unit*> added;
+    for (const Unit& unit : next) {
+        auto it = previous.find(unit.key);
+        if (it != previous.end() && it->second > 0) {
+            it->second--;
+        } else {
+            added.push_back(&unit);
+        }
+    }
+    bool removed = std::any_of(previous.begin(), previous.end(), [](const auto& entry) { return entry.second > 0; });
+    if (removed) {
+        complete_scores.clear();
+        added.clear();
+        for (const Unit& unit : next) {
+            added.push_back(&unit);
+        }
+    }
+    for (const Unit* unit : added) {
+        add_unit(*unit);
+    }
+    units = std::move(next);
+}
+
+void SearchSession::update_prefix(const std::string& word) {
+    if (word == prefix) {
+        return;
+    }
+    if (!expansions_complete || prefix.empty() || word.compare(0, prefix.size(), prefix) != 0) {
+        expansions.clear();
+        if (!word.empty()) {
+            expansions = expand_wildcard(*lexicon, word + queryTree::WILDCARD_CHAR, max_expansions);
+        }
+        expansions_complete = expansions.size() < max_expansions;
+    } else {
+        // A longer prefix matches a subset of the terms the shorter one matched.
+        expansions.erase(std::remove_if(expansions.begin(), expansions.end(),
+                                        [&](const std::string& term) { return term.compare(0, word.size(), word) != 0; }),
+                         expansions.end());
+    }
+    prefix = word;
+
+    fetch(expansions);
+    std::vector<const std::vector<Data>*> parts;
+    for (const std::string& term : expansions) {
+        parts.push_back(&lists.at(term));
+    }
+    prefix_postings = union_sorted_postings(parts);
+}
+
+MatchingDocs SearchSession::update(const std::string& text, unsigned int max_items) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Everything up to the last space is complete; the word after it is
+    // being typed. A word normalizing to no token or to several (e.g.
+    // "ski." or "c++x") is not a prefix of one term, so it counts as complete.
+    size_t space = text.find_last_of(SPACES);
+    std::string complete = space == std::string::npos ? std::string() : text.substr(0, space);
+    std::string word = space == std::string::npos ? text : text.substr(space + 1);
+    tokenizer::TokenBuffer tokens;
+    tokenizer::tokenize(word, tokens);
+    if (tokens.size() == 1) {
+        word.assign(tokens[0]);
+    } else {
+        complete = text;
+        word.clear();
+    }
+
+    update_complete(complete);
+    update_prefix(word);
+
+    // Keep only the lists the next keystroke can reuse.
+    std::unordered_map<std::string, std::vector<Data>> kept;
+    for (const std::string& key : expansions) {
+        auto it = lists.find(key);
+        if (it != lists.end()) {
+            kept.insert(std::move(*it));
+        }
+    }
+    for (const Unit& unit : units) {
+        auto it = lists.find(unit.key);
+        if (it != lists.end()) {
+            kept.insert(std::move(*it));
+        }
+    }
+    lists.swap(kept);
+
+    // The prefix is one more pseudo-term; its merged list is ordered by
+    // docId, so documents of the complete text look it up by binary search.
+    unsigned int prefix_df = static_cast<unsigned int>(prefix_postings.size());
+    auto by_doc = [](const Data& doc, int doc_id) { return doc.docId < doc_id; };
+    std::vector<SearchResult> results;
+    results.reserve(complete_scores.size() + prefix_postings.size());
+    for (const auto& [doc_id, score] : complete_scores) {
+        double total = score;
+        auto it = std::lower_bound(prefix_postings.begin(), prefix_postings.end(), doc_id, by_doc);
+        if (it != prefix_postings.end() && it->docId == doc_id) {
+            total += posting_score(*weight_scheme, it->priority, prefix_df);
+        }
+        results.emplace_back(total, doc_id);
+    }
+    for (const Data& doc : prefix_postings) {
+        if (complete_scores.find(doc.docId) == complete_scores.end()) {
+            results.emplace_back(posting_score(*weight_scheme, doc.priority, prefix_df), doc.docId);
+        }
+    }
+
+    auto top = results.begin() + std::min<size_t>(results.size(), max_items);
+    std::partial_sort(results.begin(), top, results.end(), [](const SearchResult& a, const SearchResult& b) {
+         return a.get_weight() > b.get_weight();
+    });
+    MatchingDocs matching;
+    matching.reserve(top - results.begin());
+    for (auto it = results.begin(); it != top; ++it) {
+        matching.add_result(*it);
+    }
+    trim();
+    return matching;
+}
+
+size_t SearchSession::cached_postings() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return count_postings();
+}
+
+size_t SearchSession::count_postings() const {
+    size_t count = prefix_postings.size() + complete_scores.size();
+    for (const auto& [key, list] : lists) {
+        count += list.size();
+    }
+    return count;
+}
+
+void SearchSession::trim() {
+    // Cheapest to rebuild first: a term's list is one read, while the merged
+    // list and the scores need all of theirs.
+    if (count_postings() <= max_cached) {
+        return;
+    }
+    for (const std::string& key : expansions) {
+        lists.erase(key);
+    }
+    if (count_postings() <= max_cached) {
+        return;
+    }
+    lists.clear();
+    if (count_postings() <= max_cached) {
+        return;
+    }
+
+    // An empty prefix and complete text are what a new session starts from.
+    prefix.clear();
+    expansions.clear();
+    expansions_complete = false;
+    std::vector<Data>().swap(prefix_postings);
+    if (count_postings() <= max_cached) {
+        return;
+    }
+    complete_text.clear();
+    units.clear();
+    std::unordered_map<int, double>().swap(complete_scores);
+}
+
+MatchingDocs SessionManager::type(const std::string& client, const std::string& text, unsigned int max_items) {
+    std::shared_ptr<SearchSession> session;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(client);
+        if (it != index.end()) {
+            sessions.splice(sessions.begin(), sessions, it->second);
+            session = it->second->session;
+        } else {
+            session = std::make_shared<SearchSession>(db, weight_scheme, lexicon, resources);
+            session->set_max_cached_postings(std::min(DEFAULT_MAX_SESSION_POSTINGS, max_postings));
+            sessions.push_front({client, session, 0});
+            index[client] = sessions.begin();
+            evict();
+        }
+    }
+
+    MatchingDocs matching = session->update(text, max_items);
+    size_t cached = session->cached_postings();
+
+    // The session may have been ended or evicted while it was updated.
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(client);
+    if (it != index.end() && it->second->session == session) {
+        postings = postings - it->second->postings + cached;
+        it->second->postings = cached;
+        evict();
+    }
+    return matching;
+}
+
+void SessionManager::end(const std::string& client) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(client);
+    if (it != index.end()) {
+        postings -= it->second->postings;
+        sessions.erase(it->second);
+        index.erase(it);
+    }
+}
+
+size_t SessionManager::cached_postings() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return postings;
+}
+
+void SessionManager::evict() {
+    while (!sessions.empty() && (sessions.size() > max_sessions || (postings > max_postings && sessions.size() > 1))) {
+        postings -= sessions.back().postings;
+        index.erase(sessions.back().client);
+        sessions.pop_back();
+    }
+}
+
+}
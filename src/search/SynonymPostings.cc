@@ -0,0 +1,32 @@
+#include "search/SynonymPostings.h"
+#include "search/PostingUnion.h"
+#include "search/TermExpansion.h"
+
+#include <string>
+
+namespace Ranking {
+
+size_t merge_synonym_postings(IDatabase& db, const synonyms::SynonymDictionary& dictionary,
+                              const std::vector<uint32_t>& groups) {
+    size_t written = 0;
+    for (uint32_t group : groups) {
+        std::vector<std::vector<Data>> lists;
+        for (auto& docs : db.getMany(dictionary.members(group), MAX_LIST_POSTINGS)) {
+            if (docs) {
+                lists.push_back(std::move(*docs));
+            }
+        }
+
+        std::string key = dictionary.mergedTerm(group);
+        if (db.termDocCount(key) > 0) {
+            db.remove(key);
+        }
+        for (const Data& doc : union_postings(lists)) {
+            db.add(key, doc);
+            written++;
+        }
+    }
+    return written;
+}
+
+}
@@ -0,0 +1,172 @@
+#include "search/TermExpansion.h"
+#include "search/LevenshteinAutomaton.h"
+#include "query-processing/queryTree.h"
+
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+namespace Ranking {
+
+bool wildcard_match(std::string_view pattern, std::string_view term) {
+    // Greedy matching that backtracks only to the most recent '*'.
+    size_t p = 0, t = 0;
+    size_t star = std::string_view::npos, star_t = 0;
+    while (t < term.size()) {
+        if (p < pattern.size() && pattern[p] == queryTree::WILDCARD_CHAR) {
+            star = p++;
+            star_t = t;
+        } else if (p < pattern.size() && pattern[p] == term[t]) {
+            p++;
+            t++;
+        } else if (star != std::string_view::npos) {
+            p = star + 1;
+            t = ++star_t;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == queryTree::WILDCARD_CHAR) {
+        p++;
+    }
+    return p == pattern.size();
+}
+
+std::vector<std::string> expand_wildcard(const Lexicon& lexicon, std::string_view pattern,
+                                         size_t max_expansions) {
+    std::vector<std::string> expansions;
+    if (max_expansions == 0) {
+        return expansions;
+    }
+
+    size_t wildcard = pattern.find(queryTree::WILDCARD_CHAR);
+    std::string_view prefix = pattern.substr(0, wildcard);
+    auto [begin, end] = lexicon.prefixRange(prefix);
+
+    // "prefix*" matches the whole range; anything else is checked term by term.
+    bool prefix_only = wildcard != std::string_view::npos && wildcard + 1 == pattern.size();
+
+    // Min-heap on df holds the best max_expansions matches seen so far.
+    using Candidate = std::pair<uint32_t, uint32_t>; // (df, term id)
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> best;
+    for (auto it = lexicon.iterate(begin); it.id() < end; it.next()) {
+        // Keys starting with '#' are not words (e.g. merged synonym lists).
+        if (prefix.empty() && !it.term().empty() && it.term()[0] == '#') {
+            continue;
+        }
+        if (!prefix_only && !wildcard_match(pattern, it.term())) {
+            continue;
+        }
+        uint32_t df = lexicon.info(it.id()).df;
+        if (best.size() < max_expansions) {
+            best.emplace(df, it.id());
+        } else if (df > best.top().first) {
+            best.pop();
+            best.emplace(df, it.id());
+        }
+    }
+
+    std::vector<uint32_t> ids;
+    ids.reserve(best.size());
+    for (; !best.empty(); best.pop()) {
+        ids.push_back(best.top().second);
+    }
+    std::sort(ids.begin(), ids.end());
+
+    expansions.reserve(ids.size());
+    for (uint32_t id : ids) {
+        expansions.push_back(lexicon.term(id));
+    }
+    return expansions;
+}
+
+std::vector<FuzzyMatch> expand_fuzzy(const Lexicon& lexicon, std::string_view term, int max_distance,
+                                     size_t max_expansions) {
+    if (max_distance < 0 || max_distance > MAX_FUZZY_DISTANCE) {
+        throw std::invalid_argument("Fuzzy distance must be between 0 and " +
+                                    std::to_string(MAX_FUZZY_DISTANCE));
+    }
+
+    std::vector<FuzzyMatch> matches;
+    if (max_expansions == 0) {
+        return matches;
+    }
+
+    LevenshteinAutomaton automaton(term, max_distance);
+    const size_t row_size = automaton.row_size();
+
+    // rows[d] is the automaton state after the first d characters of the
+    // current dictionary term; the first 'valid' rows are up to date.
+    std::vector<uint8_t> rows(row_size * (term.size() + max_distance + 2));
+    automaton.start(rows.data());
+    size_t valid = 1;
+    std::string target;
+
+    auto it = lexicon.iterate(0);
+    while (it.valid()) {
+        std::string_view current = it.term();
+        if (rows.size() < row_size * (current.size() + 1)) {
+            rows.resize(row_size * (current.size() + 1));
+        }
+
+        size_t depth = valid - 1;
+        bool alive = true;
+        while (depth < current.size()) {
+            alive = automaton.step(&rows[depth * row_size], current[depth], &rows[(depth + 1) * row_size]);
+            depth++;
+            if (!alive) {
+                break;
+            }
+        }
+        valid = depth + 1;
+
+        if (alive) {
+            int distance = automaton.distance(&rows[depth * row_size]);
+            // Keys starting with '#' are not words (e.g. merged synonym lists).
+            if (distance <= max_distance && !current.empty() && current[0] != '#') {
+                matches.push_back({it.id(), distance, std::string(current)});
+            }
+            it.next();
+            valid = std::min(valid, it.shared() + 1);
+            continue;
+        }
+
+        // current[0, depth) cannot be extended to a match. The next candidate
+        // replaces its last character with the smallest larger one that keeps
+        // the automaton alive; if there is none, the parent prefix is exhausted.
+        size_t parent = depth - 1;
+        target.assign(current.substr(0, parent));
+        int c = automaton.next_live_char(&rows[parent * row_size], static_cast<unsigned char>(current[parent]));
+        if (c >= 0) {
+            target.push_back(static_cast<char>(c));
+        } else {
+            while (!target.empty() && static_cast<unsigned char>(target.back()) == 0xff) {
+                target.pop_back();
+            }
+            if (target.empty()) {
+                break;
+            }
+            target.back() = static_cast<char>(static_cast<unsigned char>(target.back()) + 1);
+        }
+
+        it.skipTo(target);
+        valid = std::min(valid, it.shared() + 1);
+    }
+
+    auto closer = [&](const FuzzyMatch& a, const FuzzyMatch& b) {
+        if (a.distance != b.distance) {
+            return a.distance < b.distance;
+        }
+        return lexicon.info(a.id).df > lexicon.info(b.id).df;
+    };
+    if (matches.size() > max_expansions) {
+        std::partial_sort(matches.begin(), matches.begin() + max_expansions, matches.end(), closer);
+        matches.resize(max_expansions);
+    } else {
+        std::sort(matches.begin(), matches.end(), closer);
+    }
+    return matches;
+}
+
+}
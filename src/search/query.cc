@@ -1 +1,47 @@
-// #include "query.h"
+#include "search/query.h"
+#include "query-processing/queryTree.h"
+
+namespace Ranking {
+
+Query Query::from_tree(const queryTree::QueryTree& tree, std::pmr::memory_resource* resource) {
+    Query query(resource);
+    const std::pmr::vector<queryTree::QueryNode>& nodes = *tree.getNodes();
+    for (const queryTree::QueryNode& node : nodes) {
+        switch (node.getOperation()) {
+        case queryTree::QueryOperator::SYNONYM:
+            if (node.getTermId() != queryTree::UNKNOWN_TERM) {
+                query.addTerm(node.getTermId(), node.getDocFrequency());
+            } else {
+                std::pmr::vector<std::pmr::string> terms(resource);
+                for (int i = 0; i < node.getChildCount(); i++) {
+                    terms.push_back(nodes[node.getChildStart() + i].getValue());
+                }
+                query.addSynonym(std::move(terms));
+            }
+            break;
+        case queryTree::QueryOperator::TEXT:
+            // Synonyms are read as their group, above.
+            if (node.getParentIndex() >= 0 &&
+                nodes[node.getParentIndex()].getOperation() == queryTree::QueryOperator::SYNONYM) {
+                break;
+            }
+            if (node.getTermId() != queryTree::UNKNOWN_TERM) {
+                query.addTerm(node.getTermId(), node.getDocFrequency());
+            }
+            break;
+        case queryTree::QueryOperator::WILDCARD:
+            query.addWildcard(node.getValue());
+            break;
+        case queryTree::QueryOperator::FUZZY: {
+            auto [term, distance] = queryTree::splitFuzzy(node.getValue());
+            query.addFuzzy(term, distance);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    return query;
+}
+
+}
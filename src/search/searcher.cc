@@ -1,50 +1,139 @@
 #include "search/searcher.h"
+#include "search/PostingUnion.h"
 #include "index/IDatabase.h"
 
+#include <algorithm>
+#include <optional>
+#include <memory_resource>
 #include <unordered_map>
 
 namespace Ranking {
 
-MatchingDocs Searcher::Search(const Query& query, unsigned int max_items) {
+std::vector<Data> Searcher::fetch_expansions(const std::vector<std::string>& expansions) {
+    std::vector<std::vector<Data>> lists;
+    for (auto& docs : db->getMany(expansions, MAX_LIST_POSTINGS)) {
+        if (docs) {
+            lists.push_back(std::move(*docs));
+        }
+    }
+    return union_postings(lists);
+}
 
+double posting_score(const Weight& weight, int term_freq, unsigned int doc_freq) {
     // NOTE: CURRENT IMPLEMENTATION IS TEMPORARY
-
-    std::vector<std::string> terms = query.terms();
-    std::unordered_map<int, double> mdocs; // mdocs[docid] = score;
-    
     int avg_doc_len = 1;
     int collection_size = 2;
+    int doc_len = 1;
+    return weight.get_score(doc_len, term_freq, avg_doc_len, collection_size, doc_freq);
+}
+
+namespace {
+
+// Sort results by score and keep the best max_items.
+MatchingDocs top_results(std::pmr::vector<SearchResult>& results, unsigned int max_items,
+                         std::pmr::memory_resource* resource) {
+    std::sort(results.begin(), results.end(), [](const SearchResult& a, const SearchResult& b) {
+         return a.get_weight() > b.get_weight();
+    });
+
+    MatchingDocs matching(resource);
+    matching.reserve(std::min((unsigned int) results.size(), max_items));
+    for (int i = 0; i < std::min((unsigned int) results.size(), max_items); i++) {
+        matching.add_result(results[i]);
+    }
+    return matching;
+}
+
+}
+
+MatchingDocs Searcher::Search(const Query& query, unsigned int max_items) {
+    return Search(query, max_items, std::pmr::get_default_resource());
+}
+
+MatchingDocs Searcher::Search(const Query& query, unsigned int max_items, std::pmr::memory_resource* resource) {
+    return Search(query, QueryPlan(query, resource), max_items, resource);
+}
 
-    for (const std::string& term : terms) {
-        std::vector<Data> docs = db->get(term, 100000);
+MatchingDocs Searcher::Search(const Query& query, const QueryPlan& plan, unsigned int max_items,
+                              std::pmr::memory_resource* resource) {
 
+    // NOTE: CURRENT IMPLEMENTATION IS TEMPORARY
+
+    std::pmr::unordered_map<int, double> mdocs(resource); // mdocs[docid] = score;
+    std::pmr::vector<std::pmr::vector<Data>> lists(resource);
+
+    auto accumulate = [&](const auto& docs, unsigned int doc_freq, double weight) {
         for (const Data& doc : docs) {
-            int freq = doc.priority;
-            int docid = doc.docId;
+            mdocs[doc.docId] += weight * posting_score(*weight_scheme, doc.priority, doc_freq);
+        }
+    };
 
-            int doc_len = 1;
-            int doc_freq = 1;
+    // Terms missing from the index come back empty and contribute nothing to the score.
+    if (!query.terms().empty()) {
+        db->getManyInto(query.terms(), MAX_LIST_POSTINGS, lists);
+        for (const auto& docs : lists) {
+            accumulate(docs, 1, 1.0);
+        }
+    }
 
-            double score = weight_scheme->get_score(doc_len, freq, avg_doc_len, collection_size, doc_freq);
-            mdocs[docid] += score;
+    // Resolved terms are fetched in one batch in plan order and scored with
+    // their document frequency; the index is keyed by text, so that is the
+    // only lookup by term.
+    if (lexicon && !plan.terms().empty()) {
+        std::pmr::vector<std::pmr::string> keys(resource);
+        keys.reserve(plan.terms().size());
+        for (const PlannedTerm& term : plan.terms()) {
+            keys.emplace_back(lexicon->term(term.id));
+        }
+        db->getManyInto(keys, MAX_LIST_POSTINGS, lists);
+        for (size_t i = 0; i < lists.size(); ++i) {
+            accumulate(lists[i], plan.terms()[i].df, plan.terms()[i].weight);
         }
     }
 
-    std::vector<SearchResult> results;
-    for (const auto& [doc_id, score] : mdocs) {
-        results.emplace_back(score, doc_id);
+    // Wildcard and fuzzy terms are scored as one pseudo-term each: their
+    // expansions are fetched in one batch and merged, so a document matching
+    // several expansions is counted once with their frequencies summed.
+    for (const std::pmr::string& pattern : query.wildcards()) {
+        if (!lexicon) {
+            continue;
+        }
+        std::vector<std::string> expansions = expand_wildcard(*lexicon, pattern, max_expansions);
+        if (expansions.empty()) {
+            continue;
+        }
+        std::vector<Data> merged = fetch_expansions(expansions);
+        accumulate(merged, static_cast<unsigned int>(merged.size()), 1.0);
     }
 
-    std::sort(results.begin(), results.end(), [](const SearchResult& a, const SearchResult& b) {
-         return a.get_weight() > b.get_weight();
-    });
+    // Synonym groups without a merged list are merged here, the same way.
+    for (const std::pmr::vector<std::pmr::string>& group : query.synonyms()) {
+        std::vector<std::string> terms(group.begin(), group.end());
+        std::vector<Data> merged = fetch_expansions(terms);
+        accumulate(merged, static_cast<unsigned int>(merged.size()), 1.0);
+    }
 
-    MatchingDocs matching;
-    for (int i = 0; i < std::min((unsigned int) results.size(), max_items); i++) {
-        matching.add_result(results[i]);
+    for (const FuzzyTerm& fuzzy : query.fuzzy_terms()) {
+        if (!lexicon) {
+            continue;
+        }
+        std::vector<std::string> expansions;
+        for (FuzzyMatch& match : expand_fuzzy(*lexicon, fuzzy.term, fuzzy.max_distance, max_expansions)) {
+            expansions.push_back(std::move(match.term));
+        }
+        if (expansions.empty()) {
+            continue;
+        }
+        std::vector<Data> merged = fetch_expansions(expansions);
+        accumulate(merged, static_cast<unsigned int>(merged.size()), 1.0);
     }
 
-    return matching;
+    std::pmr::vector<SearchResult> results(resource);
+    results.reserve(mdocs.size());
+    for (const auto& [doc_id, score] : mdocs) {
+        results.emplace_back(score, doc_id);
+    }
+    return top_results(results, max_items, resource);
 }
 
 }
@@ -3,6 +3,8 @@
 #include <filesystem>
 #include <unordered_map>
 #include <algorithm>
+#include <optional>
+#include <string>
 
 const std::string TEST_DB_PATH = "./testdb";
 
@@ -193,3 +195,54 @@ TEST_F(DatabaseTest, TermDocCountNonexistentKey) {
     unsigned int count = db->termDocCount("nonexistent");
     ASSERT_EQ(count, 0);
 }
+
+TEST_F(DatabaseTest, FindSuccess) {
+    db->add("key1", {10, 1});
+    db->add("key1", {20, 2});
+    auto results = db->find("key1", 10);
+    ASSERT_TRUE(results.has_value());
+    ASSERT_EQ(results->size(), 2);
+    ASSERT_EQ((*results)[0].docId, 2);
+}
+
+TEST_F(DatabaseTest, FindMissingKeyDoesNotThrow) {
+    db->add("present", {1, 1});
+    std::optional<std::vector<Data>> results;
+    ASSERT_NO_THROW(results = db->find("absent", 10));
+    ASSERT_FALSE(results.has_value());
+}
+
+TEST_F(DatabaseTest, FindAfterRemove) {
+    db->add("key1", {10, 1});
+    db->remove("key1");
+    ASSERT_FALSE(db->find("key1", 10).has_value());
+    db->add("key1", {5, 7});
+    ASSERT_EQ(db->find("key1", 10)->at(0).docId, 7);
+}
+
+TEST_F(DatabaseTest, GetManyMixedKeys) {
+    db->add("alpha", {1, 1});
+    db->add("beta", {2, 2});
+    db->add("beta", {3, 3});
+    auto results = db->getMany({"beta", "missing", "alpha"}, 10);
+    ASSERT_EQ(results.size(), 3);
+    ASSERT_TRUE(results[0].has_value());
+    ASSERT_EQ(results[0]->size(), 2);
+    ASSERT_FALSE(results[1].has_value());
+    ASSERT_EQ(results[2]->at(0).docId, 1);
+}
+
+TEST_F(DatabaseTest, FindAfterManyKeysAndReopen) {
+    // Enough distinct keys to outgrow the initial key filter.
+    for (int i = 0; i < 1500; i++) {
+        db->add("term" + std::to_string(i), {i, i});
+    }
+    for (int i = 0; i < 1500; i++) {
+        ASSERT_TRUE(db->find("term" + std::to_string(i), 1).has_value());
+    }
+
+    delete db;
+    db = new Database(TEST_DB_PATH);
+    ASSERT_EQ(db->find("term1499", 1)->at(0).docId, 1499);
+    ASSERT_FALSE(db->find("term1500", 1).has_value());
+}
@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+
+#include "index/BloomFilter.h"
+#include "index/LruCache.h"
+
+#include <string>
+
+// Test that added keys are always found.
+TEST(BloomFilterTest, TestNoFalseNegatives) {
+    BloomFilter filter(10000);
+    for (int i = 0; i < 10000; i++)
+        filter.add("example.com/page" + std::to_string(i));
+    for (int i = 0; i < 10000; i++)
+        EXPECT_TRUE(filter.mayContain("example.com/page" + std::to_string(i)));
+}
+
+// Test that the false positive rate stays near the 1% design point.
+TEST(BloomFilterTest, TestFalsePositiveRate) {
+    BloomFilter filter(10000);
+    for (int i = 0; i < 10000; i++)
+        filter.add("stored.com/" + std::to_string(i));
+
+    int falsePositives = 0;
+    for (int i = 0; i < 100000; i++)
+        falsePositives += filter.mayContain("unseen.com/" + std::to_string(i));
+    EXPECT_LT(falsePositives, 2500);
+}
+
+// Test that an empty filter rejects everything.
+TEST(BloomFilterTest, TestEmptyFilter) {
+    BloomFilter filter;
+    EXPECT_FALSE(filter.mayContain(""));
+    EXPECT_FALSE(filter.mayContain("rpi.edu"));
+}
+
+// Test LRU eviction and replacement.
+TEST(LruCacheTest, TestEvictsLeastRecentlyUsed) {
+    LruCache<std::string, int> cache(2);
+    cache.put("a", 1);
+    cache.put("b", 2);
+    EXPECT_EQ(cache.get("a"), 1); // b is now least recently used
+    cache.put("c", 3);
+    EXPECT_FALSE(cache.get("b").has_value());
+    EXPECT_EQ(cache.get("c"), 3);
+
+    cache.put("a", 10);
+    EXPECT_EQ(cache.get("a"), 10);
+    cache.erase("a");
+    EXPECT_FALSE(cache.get("a").has_value());
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include "index/BlockCache.h"
+#include "index/DocRecord.h"
+#include "index/Lz4.h"
+
+#include <memory>
+#include <random>
+#include <string>
+
+static std::string roundTrip(const std::string& input) {
+    std::string compressed = lz4::compress(input);
+    std::string output(input.size(), '\0');
+    EXPECT_TRUE(lz4::decompress(compressed, output.data(), output.size()));
+    return output;
+}
+
+// Test that inputs of every shape decode to the original bytes.
+TEST(Lz4Test, TestRoundTrip) {
+    EXPECT_EQ(roundTrip(""), "");
+    EXPECT_EQ(roundTrip("short"), "short");
+    EXPECT_EQ(roundTrip(std::string(100000, 'a')), std::string(100000, 'a'));
+
+    std::string text;
+    for (int i = 0; i < 500; i++)
+        text += "rensselaer.edu/page" + std::to_string(i) + "\nPage " + std::to_string(i) + "\n";
+    EXPECT_EQ(roundTrip(text), text);
+
+    std::mt19937 rng(42);
+    std::string noise(70000, '\0');
+    for (char& c : noise)
+        c = static_cast<char>(rng());
+    EXPECT_EQ(roundTrip(noise), noise);
+}
+
+// Test that repetitive text actually shrinks.
+TEST(Lz4Test, TestCompressesRepetitiveText) {
+    std::string text;
+    for (int i = 0; i < 1000; i++)
+        text += "the quick brown fox jumps over the lazy dog ";
+    EXPECT_LT(lz4::compress(text).size(), text.size() / 10);
+}
+
+// Test that truncated or mis-sized blocks are rejected.
+TEST(Lz4Test, TestRejectsCorruptInput) {
+    std::string text;
+    for (int i = 0; i < 100; i++)
+        text += "block " + std::to_string(i % 7) + " ";
+    std::string compressed = lz4::compress(text);
+    std::string output(text.size(), '\0');
+
+    EXPECT_FALSE(lz4::decompress(compressed.substr(0, compressed.size() / 2), output.data(), output.size()));
+    EXPECT_FALSE(lz4::decompress(compressed, output.data(), output.size() - 1));
+    EXPECT_FALSE(lz4::decompress("\x0f", output.data(), output.size()));
+}
+
+// Test that sealed blocks compress and tail blocks are stored as is.
+TEST(DocBlockTest, TestEncodeBlock) {
+    std::string payload;
+    for (int i = 0; i < 200; i++)
+        payload += encodeDocRecord("example.com/" + std::to_string(i), "Example");
+
+    BlockCodec codec;
+    uint32_t size;
+    std::string_view stored;
+    std::string sealed = encodeBlock(payload, true);
+    ASSERT_TRUE(decodeBlockHeader(sealed, codec, size, stored));
+    EXPECT_EQ(codec, BlockCodec::Lz4);
+    EXPECT_EQ(size, payload.size());
+    EXPECT_LT(sealed.size(), payload.size());
+
+    std::string tail = encodeBlock(payload, false);
+    ASSERT_TRUE(decodeBlockHeader(tail, codec, size, stored));
+    EXPECT_EQ(codec, BlockCodec::None);
+    EXPECT_EQ(stored, payload);
+
+    DocLocation location;
+    ASSERT_TRUE(decodeDocLocation(encodeDocLocation({7, 40000, 123}), location));
+    EXPECT_EQ(location.block, 7u);
+    EXPECT_EQ(location.offset, 40000u);
+    EXPECT_EQ(location.size, 123u);
+}
+
+// Test LRU eviction by decompressed size.
+TEST(BlockCacheTest, TestEvictsLeastRecentlyUsed) {
+    BlockCache cache(300);
+    auto held = std::make_shared<const std::string>(100, 'b');
+    cache.put(1, std::make_shared<const std::string>(100, 'a'));
+    cache.put(2, held);
+    cache.put(3, std::make_shared<const std::string>(100, 'c'));
+    ASSERT_NE(cache.get(1), nullptr); // 2 is now least recently used
+
+    cache.put(4, std::make_shared<const std::string>(100, 'd'));
+    EXPECT_EQ(cache.get(2), nullptr);
+    EXPECT_EQ(*held, std::string(100, 'b')); // evicted blocks stay valid for holders
+    EXPECT_NE(cache.get(1), nullptr);
+    EXPECT_NE(cache.get(3), nullptr);
+    EXPECT_EQ(cache.bytes(), 300u);
+}
@@ -1,10 +1,17 @@
 #include <gtest/gtest.h>
 
 #include "index/DocDatabase.h"
+#include "index/DocRecord.h"
+#include "query-processing/analyzer.h"
 
+#include <lmdb.h>
+
+#include <algorithm>
 #include <chrono>
 #include <filesystem>
+#include <map>
 #include <memory>
+#include <memory_resource>
 #include <set>
 #include <string>
 #include <vector>
@@ -32,7 +39,7 @@ protected:
 TEST_F(DocDBTest, TestAddAndRetrieveDocument) {
     std::string url = "example.com/page";
     std::string title = "Test Page";
-    std::vector<std::string> words = {"hello", "world", "test"};
+    std::vector<std::string> words = {"alpha", "beta", "test"};
 
     SearchRPI::docid docId = docdb->addDoc(url, title, words);
     SearchRPI::docid retrievedId = docdb->getDocId(url);
@@ -107,6 +114,266 @@ TEST_F(DocDBTest, TestAddMultipleDocuments) {
     EXPECT_EQ(uniqueIds.size(), static_cast<size_t>(numDocs));
 }
 
+// Test that words shared between documents decode correctly for each of them.
+TEST_F(DocDBTest, TestSharedWordsAcrossDocuments) {
+    SearchRPI::docid first = docdb->addDoc("example.com/a", "A", {"shared", "alpha", "shared"});
+    SearchRPI::docid second = docdb->addDoc("example.com/b", "B", {"beta", "shared"});
+
+    EXPECT_EQ(docdb->getWords(first), (std::set<std::string>{"alpha", "share"}));
+    EXPECT_EQ(docdb->getWords(second), (std::set<std::string>{"beta", "share"}));
+}
+
+// Test that page text and word lists are indexed as the query analyzer normalizes them.
+TEST_F(DocDBTest, TestIndexedTermsMatchQueryTerms) {
+    std::string text = "The Runners were running in their new Shoes.";
+    SearchRPI::docid fromText = docdb->addDoc("example.com/text", "Text", text);
+    SearchRPI::docid fromWords = docdb->addDoc("example.com/words", "Words",
+                                               {"The", "Runners", "were", "running", "in", "their", "new", "Shoes."});
+
+    std::set<std::string> queryTerms;
+    analyzer::QueryAnalyzer().analyze(text, [&](const analyzer::Token& token) { queryTerms.insert(token.text); });
+    EXPECT_EQ(queryTerms.count("run"), 1u);
+    EXPECT_EQ(queryTerms.count("the"), 0u);
+    EXPECT_EQ(docdb->getWords(fromText), queryTerms);
+    EXPECT_EQ(docdb->getWords(fromWords), queryTerms);
+    EXPECT_EQ(docdb->getText(fromText), text);
+}
+
+// Test batched hydration: request order, duplicates and missing ids.
+TEST_F(DocDBTest, TestGetDocsBatch) {
+    SearchRPI::docid a = docdb->addDoc("example.com/a", "Page A", {"alpha"});
+    SearchRPI::docid b = docdb->addDoc("example.com/b", "Page B", {"beta"});
+    SearchRPI::docid c = docdb->addDoc("example.com/c", "", {"gamma"});
+    SearchRPI::docid missing = c + 100;
+
+    std::pmr::monotonic_buffer_resource arena;
+    auto docs = docdb->getDocs({c, missing, a, b, a}, arena);
+
+    ASSERT_EQ(docs.size(), 5u);
+    EXPECT_EQ(docs[0].id, c);
+    EXPECT_EQ(docs[0].url, "example.com/c");
+    EXPECT_EQ(docs[0].title, "");
+    EXPECT_EQ(docs[1].id, 0u);
+    EXPECT_EQ(docs[2].url, "example.com/a");
+    EXPECT_EQ(docs[3].title, "Page B");
+    EXPECT_EQ(docs[4].id, a);
+    EXPECT_EQ(docs[4].title, "Page A");
+
+    // Results live in the arena, not in the database's pages.
+    docdb->remove(a);
+    EXPECT_EQ(docs[2].url, "example.com/a");
+    EXPECT_TRUE(docdb->getDocs({}, arena).empty());
+}
+
+// Test stored text and fields of documents spread over many sealed blocks.
+TEST_F(DocDBTest, TestStoredTextAcrossBlocks) {
+    const int numDocs = 300;
+    std::vector<SearchRPI::docid> docIds;
+    for (int i = 0; i < numDocs; i++) {
+        std::string text;
+        for (int j = 0; j < 20; j++)
+            text += "Page " + std::to_string(i) + " sentence " + std::to_string(j) + ". ";
+        docIds.push_back(docdb->addDoc("blocks.example.com/" + std::to_string(i), "Title " + std::to_string(i), text));
+    }
+
+    // Reopen so everything is read back from disk through the block cache.
+    docdb.reset();
+    docdb = std::make_unique<DocDatabase>(db_path);
+
+    EXPECT_EQ(docdb->getText(docIds[0]).substr(0, 20), "Page 0 sentence 0. P");
+    EXPECT_EQ(docdb->getText(docIds[numDocs - 1]).substr(0, 22), "Page 299 sentence 0. P");
+    EXPECT_EQ(docdb->getText(docdb->addDoc("blocks.example.com/plain", "Plain", {"plain"})), "plain");
+
+    std::pmr::monotonic_buffer_resource arena;
+    auto docs = docdb->getDocs(docIds, arena);
+    for (int i = 0; i < numDocs; i++) {
+        EXPECT_EQ(docs[i].url, "blocks.example.com/" + std::to_string(i));
+        EXPECT_EQ(docs[i].title, "Title " + std::to_string(i));
+        EXPECT_EQ(docs[i].text, "");
+    }
+    auto withText = docdb->getDocs({docIds[7], docIds[numDocs - 1]}, arena, true);
+    EXPECT_EQ(withText[0].title, "Title 7");
+    EXPECT_EQ(withText[0].text, docdb->getText(docIds[7]));
+    EXPECT_EQ(withText[1].text.substr(0, 22), "Page 299 sentence 0. P");
+
+    EXPECT_TRUE(docdb->remove(docIds[10]));
+    EXPECT_FALSE(docdb->contains("blocks.example.com/10"));
+    EXPECT_THROW(docdb->getText(docIds[10]), std::runtime_error);
+    EXPECT_EQ(docdb->getDocs({docIds[11]}, arena)[0].title, "Title 11");
+}
+
+// Test that documents removed while still in the tail stay removed once it is sealed.
+TEST_F(DocDBTest, TestRemoveBeforeTailIsSealed) {
+    std::string text(1000, 'x');
+    SearchRPI::docid first = docdb->addDoc("tail.example.com/first", "First", text);
+    SearchRPI::docid removed = docdb->addDoc("tail.example.com/removed", "Removed", text);
+    EXPECT_TRUE(docdb->remove(removed));
+
+    // Enough documents to seal the tail several times.
+    std::vector<SearchRPI::docid> docIds{first};
+    for (int i = 0; i < 100; i++)
+        docIds.push_back(docdb->addDoc("tail.example.com/" + std::to_string(i), "Title " + std::to_string(i),
+                                       text + std::to_string(i)));
+
+    EXPECT_THROW(docdb->getText(removed), std::runtime_error);
+    EXPECT_FALSE(docdb->contains("tail.example.com/removed"));
+    EXPECT_EQ(docdb->getText(first), text);
+    EXPECT_EQ(docdb->getText(docIds.back()), text + "99");
+
+    std::pmr::monotonic_buffer_resource arena;
+    auto docs = docdb->getDocs(docIds, arena);
+    EXPECT_EQ(docs[0].title, "First");
+    for (int i = 0; i < 100; i++)
+        EXPECT_EQ(docs[i + 1].title, "Title " + std::to_string(i));
+}
+
+// Test URL lookups through the filter and cache across adds, removes and reopening.
+TEST_F(DocDBTest, TestUrlLookupsStayConsistent) {
+    SearchRPI::docid id = docdb->addDoc("filter.example.com/a", "A", {"a"});
+    EXPECT_TRUE(docdb->contains("filter.example.com/a"));
+    EXPECT_EQ(docdb->getDocId("filter.example.com/a"), id);
+    EXPECT_FALSE(docdb->contains("filter.example.com/b"));
+    EXPECT_THROW(docdb->getDocId("filter.example.com/b"), std::runtime_error);
+
+    EXPECT_TRUE(docdb->remove(id));
+    EXPECT_FALSE(docdb->contains("filter.example.com/a"));
+    EXPECT_THROW(docdb->getDocId("filter.example.com/a"), std::runtime_error);
+
+    // Growing past the filter's initial capacity forces a rebuild.
+    for (int i = 0; i < 1500; i++)
+        docdb->addDoc("filter.example.com/grow" + std::to_string(i), "Grow", {"grow"});
+    SearchRPI::docid readded = docdb->addDoc("filter.example.com/a", "A", {"a"});
+    EXPECT_NE(readded, id);
+    EXPECT_EQ(docdb->getDocId("filter.example.com/a"), readded);
+
+    // Reopening rebuilds the filter from the urls database.
+    docdb.reset();
+    docdb = std::make_unique<DocDatabase>(db_path);
+    for (int i = 0; i < 1500; i++)
+        ASSERT_TRUE(docdb->contains("filter.example.com/grow" + std::to_string(i)));
+    EXPECT_EQ(docdb->getDocId("filter.example.com/a"), readded);
+}
+
+// Test that term vectors carry frequencies, positions and resolvable term ids.
+TEST(DocDBTermVectorTest, TestTermVectorWithPositions) {
+    std::string path = "./temp_docdb_positions";
+    std::filesystem::create_directory(path);
+    {
+        DocDatabase db(path, true);
+        SearchRPI::docid id = db.addDoc("example.com/tv", "TV", {"cat", "dog", "bird", "fish", "cat", "dog"});
+
+        TermVector vector = db.getTermVector(id);
+        TermVectorView view = vector.view();
+        EXPECT_EQ(view.termCount(), 4u);
+        EXPECT_EQ(view.length(), 6u);
+
+        std::map<std::string, uint32_t> freqs;
+        view.forEach([&](uint32_t termId, uint32_t freq) { freqs[db.getTerm(termId)] = freq; });
+        EXPECT_EQ(freqs, (std::map<std::string, uint32_t>{{"bird", 1}, {"cat", 2}, {"dog", 2}, {"fish", 1}}));
+
+        uint32_t dogId = 0;
+        view.forEach([&](uint32_t termId, uint32_t) { if (db.getTerm(termId) == "dog") dogId = termId; });
+        EXPECT_EQ(view.positions(dogId), (std::vector<uint32_t>{1, 5}));
+
+        EXPECT_TRUE(db.remove(id));
+        EXPECT_THROW(db.getTermVector(id), std::runtime_error);
+    }
+    std::filesystem::remove_all(path);
+}
+
+// Test that the binary record round-trips and rejects truncated input.
+TEST(DocRecordTest, TestEncodeAndParse) {
+    std::string record = encodeDocRecord("rpi.edu", "RPI");
+
+    DocRecordView view;
+    ASSERT_TRUE(view.parse(record));
+    EXPECT_EQ(view.url(), "rpi.edu");
+    EXPECT_EQ(view.title(), "RPI");
+    EXPECT_EQ(view.text(), "");
+
+    std::string withText = encodeDocRecord("rpi.edu", "RPI", "Rensselaer Polytechnic Institute");
+    ASSERT_TRUE(view.parse(withText));
+    EXPECT_EQ(view.text(), "Rensselaer Polytechnic Institute");
+
+    EXPECT_FALSE(view.parse(std::string_view(record).substr(0, 5)));
+    EXPECT_FALSE(view.parse(""));
+}
+
+// Write a database in the pre-binary text format, optionally with a non-numeric id.
+static void writeLegacyDocDB(const std::string& path, bool badId = false) {
+    MDB_env* env;
+    mdb_env_create(&env);
+    mdb_env_set_maxdbs(env, 3);
+    mdb_env_open(env, path.c_str(), 0, 0664);
+    MDB_txn* txn;
+    mdb_txn_begin(env, nullptr, 0, &txn);
+    MDB_dbi meta, docs, urls;
+    mdb_dbi_open(txn, "meta", MDB_CREATE, &meta);
+    mdb_dbi_open(txn, "docs", MDB_CREATE, &docs);
+    mdb_dbi_open(txn, "urls", MDB_CREATE, &urls);
+
+    auto put = [&](MDB_dbi dbi, const std::string& k, const std::string& v) {
+        MDB_val key{k.size(), (void*)k.data()}, val{v.size(), (void*)v.data()};
+        mdb_put(txn, dbi, &key, &val, 0);
+    };
+    put(docs, "1", "legacy.com/one\nOne\nfirst,page");
+    put(urls, "legacy.com/one", "1");
+    put(docs, "12", "legacy.com/twelve\nTwelve\npage");
+    put(urls, "legacy.com/twelve", "12");
+    if (badId)
+        put(docs, "x7", "legacy.com/bad\nBad\npage");
+
+    uint64_t next = 14;
+    const char* nextKey = "next_docid";
+    MDB_val key{std::strlen(nextKey), (void*)nextKey}, val{sizeof(next), &next};
+    mdb_put(txn, meta, &key, &val, 0);
+
+    mdb_txn_commit(txn);
+    mdb_env_close(env);
+}
+
+// Test that legacy databases are rejected and can be migrated with ids preserved.
+TEST(DocDBMigrationTest, TestMigrateLegacyDatabase) {
+    std::string legacyPath = "./temp_docdb_legacy";
+    std::string destPath = "./temp_docdb_migrated";
+    std::filesystem::create_directory(legacyPath);
+    std::filesystem::create_directory(destPath);
+    writeLegacyDocDB(legacyPath);
+
+    EXPECT_THROW(DocDatabase legacy(legacyPath), std::runtime_error);
+
+    EXPECT_EQ(DocDatabase::migrateLegacy(legacyPath, destPath), 2u);
+    {
+        DocDatabase migrated(destPath);
+        EXPECT_EQ(migrated.getDocId("legacy.com/twelve"), 12u);
+        EXPECT_EQ(migrated.getWords(1), (std::set<std::string>{"first", "page"}));
+        EXPECT_EQ(migrated.getWords(12), (std::set<std::string>{"page"}));
+        EXPECT_EQ(migrated.addDoc("new.com", "New", {"page"}), 14u);
+    }
+
+    std::filesystem::remove_all(legacyPath);
+    std::filesystem::remove_all(destPath);
+}
+
+// Test that a failed migration releases its transactions and leaves nothing behind.
+TEST(DocDBMigrationTest, TestMigrateLegacyFailureCleansUp) {
+    std::string legacyPath = "./temp_docdb_legacy_bad";
+    std::string destPath = "./temp_docdb_migrated_bad";
+    std::filesystem::create_directory(legacyPath);
+    std::filesystem::create_directory(destPath);
+    writeLegacyDocDB(legacyPath, true);
+
+    EXPECT_THROW(DocDatabase::migrateLegacy(legacyPath, destPath), std::runtime_error);
+    {
+        // The write transaction was released, so the destination is writable again.
+        DocDatabase migrated(destPath);
+        EXPECT_NO_THROW(migrated.addDoc("new.com", "New", {"page"}));
+    }
+
+    std::filesystem::remove_all(legacyPath);
+    std::filesystem::remove_all(destPath);
+}
+
 // Performance test: measure how long it takes to add a large number of documents.
 // Note: The performance threshold here (per document) might need adjustment
 TEST_F(DocDBTest, PerformanceTest_AddDocuments) {
@@ -163,3 +430,60 @@ TEST_F(DocDBTest, PerformanceTest_RetrieveDocuments) {
 
     EXPECT_LT(timePerDoc, 0.001);
 }
+
+// Performance test: hydrate a page of results with one batched call per page.
+TEST_F(DocDBTest, PerformanceTest_GetDocsBatch) {
+    const int numDocs = 1000;
+    const size_t pageSize = 50;
+    std::vector<SearchRPI::docid> docIds;
+    for (int i = 0; i < numDocs; i++) {
+        std::string url = "batch.example.com/page" + std::to_string(i);
+        std::string title = "Batch Page " + std::to_string(i);
+        docIds.push_back(docdb->addDoc(url, title, {"batch", std::to_string(i)}));
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    size_t hydrated = 0;
+    for (size_t i = 0; i < docIds.size(); i += pageSize) {
+        std::vector<SearchRPI::docid> page(docIds.begin() + i,
+                                           docIds.begin() + std::min(docIds.size(), i + pageSize));
+        std::pmr::monotonic_buffer_resource arena;
+        hydrated += docdb->getDocs(page, arena).size();
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+
+    std::cout << "PerformanceTest: Hydrated " << hydrated
+              << " documents in pages of " << pageSize << " in "
+              << elapsed.count() << " seconds" << std::endl;
+
+    EXPECT_EQ(hydrated, static_cast<size_t>(numDocs));
+}
+
+// Performance test: crawler-style lookups where most URLs are new.
+TEST_F(DocDBTest, PerformanceTest_UrlLookups) {
+    const int numDocs = 1000;
+    const int numLookups = 100000;
+    for (int i = 0; i < numDocs; i++)
+        docdb->addDoc("crawl.example.com/known" + std::to_string(i), "Known", {"known"});
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    int found = 0;
+    for (int i = 0; i < numLookups; i++) {
+        // One lookup in ten is for a stored URL.
+        std::string url = i % 10 == 0 ? "crawl.example.com/known" + std::to_string(i % numDocs)
+                                      : "crawl.example.com/new" + std::to_string(i);
+        found += docdb->contains(url);
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+
+    std::cout << "PerformanceTest: " << numLookups << " URL lookups in " << elapsed.count()
+              << " seconds (" << elapsed.count() / numLookups << " sec per lookup)" << std::endl;
+
+    EXPECT_EQ(found, numLookups / 10);
+}
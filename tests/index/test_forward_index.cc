@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include "index/ForwardIndex.h"
+
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Test that frequencies and document length survive encoding.
+TEST(ForwardIndexTest, TestFrequencies) {
+    TermVectorBuilder builder;
+    std::vector<uint32_t> tokens = {5, 3, 5, 9, 5, 3};
+    for (uint32_t i = 0; i < tokens.size(); i++)
+        builder.add(tokens[i], i);
+    std::string encoded = builder.finish();
+
+    TermVectorView view;
+    ASSERT_TRUE(view.parse(encoded));
+    EXPECT_EQ(view.termCount(), 3u);
+    EXPECT_EQ(view.length(), 6u);
+    EXPECT_FALSE(view.hasPositions());
+
+    std::map<uint32_t, uint32_t> decoded;
+    EXPECT_TRUE(view.forEach([&](uint32_t id, uint32_t freq) { decoded[id] = freq; }));
+    EXPECT_EQ(decoded, (std::map<uint32_t, uint32_t>{{3, 2}, {5, 3}, {9, 1}}));
+
+    EXPECT_EQ(view.freq(5), 3u);
+    EXPECT_EQ(view.freq(4), 0u);
+    EXPECT_TRUE(view.positions(5).empty());
+}
+
+// Test lookups across several blocks, with positions.
+TEST(ForwardIndexTest, TestMultipleBlocksWithPositions) {
+    TermVectorBuilder builder(true);
+    const uint32_t numTerms = kTermVectorBlockSize * 3 + 7;
+    uint32_t position = 0;
+    for (uint32_t id = 1; id <= numTerms; id++) {
+        builder.add(id * 10, position++);
+        if (id % 50 == 0)
+            builder.add(id * 10, position++);
+    }
+    std::string encoded = builder.finish();
+
+    TermVectorView view;
+    ASSERT_TRUE(view.parse(encoded));
+    EXPECT_EQ(view.termCount(), numTerms);
+    EXPECT_TRUE(view.hasPositions());
+
+    uint32_t seen = 0;
+    uint32_t last = 0;
+    EXPECT_TRUE(view.forEach([&](uint32_t id, uint32_t) {
+        EXPECT_GT(id, last);
+        last = id;
+        seen++;
+    }));
+    EXPECT_EQ(seen, numTerms);
+
+    EXPECT_EQ(view.freq(3000), 2u);
+    EXPECT_EQ(view.freq(3010), 1u);
+    EXPECT_EQ(view.freq(3005), 0u);
+    EXPECT_EQ(view.freq(numTerms * 10), 1u);
+    EXPECT_EQ(view.positions(1), std::vector<uint32_t>{});
+    EXPECT_EQ(view.positions(10), std::vector<uint32_t>{0});
+    EXPECT_EQ(view.positions(500), (std::vector<uint32_t>{49, 50}));
+}
+
+// Test that an empty document encodes and truncated input is rejected.
+TEST(ForwardIndexTest, TestEmptyAndTruncated) {
+    TermVectorBuilder builder;
+    std::string empty = builder.finish();
+    TermVectorView view;
+    ASSERT_TRUE(view.parse(empty));
+    EXPECT_EQ(view.termCount(), 0u);
+    EXPECT_TRUE(view.forEach([](uint32_t, uint32_t) { FAIL(); }));
+
+    TermVectorBuilder full;
+    for (uint32_t i = 0; i < 300; i++)
+        full.add(i, i);
+    std::string encoded = full.finish();
+    ASSERT_TRUE(view.parse(std::string_view(encoded).substr(0, encoded.size() / 2)));
+    EXPECT_FALSE(view.forEach([](uint32_t, uint32_t) {}));
+    EXPECT_FALSE(view.parse(""));
+}
+
+// Test that an owned vector refuses to give a view over a corrupt header.
+TEST(ForwardIndexTest, TestOwnedViewRejectsCorruptVector) {
+    TermVectorBuilder builder;
+    builder.add(3, 0);
+    TermVector vector(builder.finish());
+    EXPECT_EQ(vector.view().termCount(), 1u);
+
+    EXPECT_THROW(TermVector().view(), std::runtime_error);
+    EXPECT_THROW(TermVector(std::string(1, '\0')).view(), std::runtime_error);
+}
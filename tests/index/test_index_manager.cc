@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include "index/IndexManager.h"
+
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+class IndexManagerTest : public ::testing::Test {
+protected:
+    std::string root;
+
+    void SetUp() override {
+        root = "./temp_index_manager_test";
+        std::filesystem::remove_all(root);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(root);
+    }
+
+    // Fill a new generation with a single posting for 'term'.
+    uint64_t buildGeneration(IndexManager& manager, const std::string& term, int docId) {
+        uint64_t generation = manager.createGeneration();
+        std::string path = manager.generationPath(generation);
+        Database db(path + "/index");
+        db.add(term, Data{1, docId});
+        return generation;
+    }
+};
+
+// A fresh root gets an empty first generation.
+TEST_F(IndexManagerTest, TestCreatesInitialGeneration) {
+    IndexManager manager(root);
+    auto snapshot = manager.acquire();
+    ASSERT_NE(snapshot, nullptr);
+    EXPECT_EQ(snapshot->generation, 1u);
+    EXPECT_TRUE(std::filesystem::exists(root + "/CURRENT"));
+    EXPECT_EQ(snapshot->index->termDocCount("anything"), 0u);
+}
+
+// Publishing swaps what new queries see.
+TEST_F(IndexManagerTest, TestPublishSwapsSnapshot) {
+    IndexManager manager(root);
+    uint64_t generation = buildGeneration(manager, "rpi", 7);
+
+    manager.publish(generation);
+    auto snapshot = manager.acquire();
+    EXPECT_EQ(snapshot->generation, generation);
+    ASSERT_EQ(snapshot->index->termDocCount("rpi"), 1u);
+    EXPECT_EQ(snapshot->index->get("rpi")[0].docId, 7);
+}
+
+// A query holding the old snapshot keeps working across a swap, and the old
+// generation is only removed once it is released.
+TEST_F(IndexManagerTest, TestRetiredSnapshotOutlivesSwap) {
+    IndexManager manager(root);
+    uint64_t first = buildGeneration(manager, "old", 1);
+    manager.publish(first);
+
+    auto inFlight = manager.acquire();
+    manager.publish(buildGeneration(manager, "new", 2));
+
+    EXPECT_EQ(inFlight->index->get("old")[0].docId, 1);
+    EXPECT_EQ(manager.acquire()->index->get("new")[0].docId, 2);
+
+    manager.collectGarbage();
+    EXPECT_TRUE(std::filesystem::exists(manager.generationPath(first)));
+
+    inFlight.reset();
+    EXPECT_GE(manager.collectGarbage(), 1u);
+    EXPECT_FALSE(std::filesystem::exists(manager.generationPath(first)));
+}
+
+// Reopening the root picks up the generation named in CURRENT.
+TEST_F(IndexManagerTest, TestReopenUsesCurrent) {
+    uint64_t generation;
+    {
+        IndexManager manager(root);
+        generation = buildGeneration(manager, "persisted", 3);
+        manager.publish(generation);
+    }
+    IndexManager reopened(root);
+    EXPECT_EQ(reopened.acquire()->generation, generation);
+    EXPECT_GT(reopened.createGeneration(), generation);
+}
+
+// Compaction produces a new generation with the same contents.
+TEST_F(IndexManagerTest, TestCompactPreservesContents) {
+    IndexManager manager(root);
+    uint64_t built = buildGeneration(manager, "compact", 9);
+    {
+        DocDatabase docs(manager.generationPath(built) + "/docdb");
+        docs.addDoc("example.com", "Example", {"compact"});
+    }
+    manager.publish(built);
+
+    uint64_t generation = manager.compact();
+    auto snapshot = manager.acquire();
+    EXPECT_EQ(snapshot->generation, generation);
+    EXPECT_EQ(snapshot->index->get("compact")[0].docId, 9);
+    EXPECT_TRUE(snapshot->docs->contains("example.com"));
+}
+
+// A generation's lexicon is mapped with the snapshot and carried over by compaction.
+TEST_F(IndexManagerTest, TestLexiconLoadedWithSnapshot) {
+    IndexManager manager(root);
+    uint64_t generation = buildGeneration(manager, "lexicon", 4);
+    {
+        Database db(manager.generationPath(generation) + "/index");
+        Lexicon::build(db, manager.generationPath(generation) + "/lexicon");
+    }
+    manager.publish(generation);
+    ASSERT_NE(manager.acquire()->lexicon, nullptr);
+    EXPECT_TRUE(manager.acquire()->lexicon->find("lexicon").has_value());
+
+    manager.compact();
+    ASSERT_NE(manager.acquire()->lexicon, nullptr);
+    EXPECT_EQ(manager.acquire()->lexicon->size(), 1u);
+}
+
+// Readers never observe a missing snapshot while publishes run in the background.
+TEST_F(IndexManagerTest, TestReadersDuringAsyncPublish) {
+    IndexManager manager(root);
+    std::vector<uint64_t> generations;
+    for (int i = 0; i < 3; i++)
+        generations.push_back(buildGeneration(manager, "term" + std::to_string(i), i + 1));
+
+    std::atomic<bool> done{false};
+    std::atomic<int> failures{0};
+    std::thread reader([&]() {
+        while (!done) {
+            auto snapshot = manager.acquire();
+            if (!snapshot || !snapshot->index)
+                failures++;
+        }
+    });
+
+    for (uint64_t generation : generations)
+        manager.publishAsync(generation).get();
+
+    done = true;
+    reader.join();
+    EXPECT_EQ(failures, 0);
+    EXPECT_EQ(manager.acquire()->generation, generations.back());
+}
+
+// A publish that finishes after a newer one does not swap the older generation back in.
+TEST_F(IndexManagerTest, TestOlderGenerationNotRepublished) {
+    IndexManager manager(root);
+    uint64_t older = buildGeneration(manager, "old", 1);
+    uint64_t newer = buildGeneration(manager, "new", 2);
+
+    manager.publishAsync(newer).get();
+    manager.publishAsync(older).get();
+    EXPECT_EQ(manager.acquire()->generation, newer);
+    EXPECT_EQ(manager.acquire()->index->termDocCount("new"), 1u);
+
+    // The skipped generation is retired and collected like a replaced one.
+    EXPECT_GE(manager.collectGarbage(), 1u);
+    EXPECT_FALSE(std::filesystem::exists(manager.generationPath(older)));
+}
@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+
+#include "Database.h"
+#include "index/Lexicon.h"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+class LexiconTest : public ::testing::Test {
+protected:
+    std::string path;
+
+    void SetUp() override {
+        path = "./temp_lexicon_test";
+        std::filesystem::remove(path);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(path);
+    }
+
+    // Terms "t000" .. "t(n-1)" with df = index.
+    void writeNumbered(int n) {
+        LexiconBuilder builder;
+        for (int i = n - 1; i >= 0; i--) {
+            char term[16];
+            std::snprintf(term, sizeof(term), "t%03d", i);
+            builder.add(term, i, i * 0.5f);
+        }
+        builder.write(path);
+    }
+};
+
+// Test that every term maps to its sorted rank and metadata.
+TEST_F(LexiconTest, TestFindAndTerm) {
+    writeNumbered(100);
+    Lexicon lexicon(path);
+    ASSERT_EQ(lexicon.size(), 100u);
+
+    for (int i = 0; i < 100; i++) {
+        char term[16];
+        std::snprintf(term, sizeof(term), "t%03d", i);
+        auto info = lexicon.find(term);
+        ASSERT_TRUE(info.has_value()) << term;
+        EXPECT_EQ(info->id, static_cast<uint32_t>(i));
+        EXPECT_EQ(info->df, static_cast<uint32_t>(i));
+        EXPECT_FLOAT_EQ(info->maxScore, i * 0.5f);
+        EXPECT_EQ(lexicon.term(i), term);
+    }
+    EXPECT_FALSE(lexicon.find("t100").has_value());
+    EXPECT_FALSE(lexicon.find("a").has_value());
+    EXPECT_FALSE(lexicon.find("t0005").has_value());
+    EXPECT_FALSE(lexicon.find("").has_value());
+}
+
+// Test forward skips within a block and across many blocks.
+TEST_F(LexiconTest, TestSkipTo) {
+    writeNumbered(1000);
+    Lexicon lexicon(path);
+
+    auto it = lexicon.iterate(0);
+    it.skipTo("t005");
+    EXPECT_EQ(it.id(), 5u);
+    it.skipTo("t0055"); // between terms
+    EXPECT_EQ(it.term(), "t006");
+    it.skipTo("t001"); // never moves backwards
+    EXPECT_EQ(it.id(), 6u);
+    it.skipTo("t731");
+    EXPECT_EQ(it.id(), 731u);
+    EXPECT_EQ(it.shared(), 1u); // "t731" vs "t006"
+    it.skipTo("t999");
+    EXPECT_EQ(it.id(), 999u);
+    it.skipTo("u");
+    EXPECT_FALSE(it.valid());
+}
+
+// Test prefix ranges, including prefixes that match nothing.
+TEST_F(LexiconTest, TestPrefixRange) {
+    LexiconBuilder builder;
+    for (const char* term : {"comp", "compile", "computer", "computing", "con", "cat", "dog"})
+        builder.add(term, 1, 1.0f);
+    builder.write(path);
+    Lexicon lexicon(path);
+
+    auto range = lexicon.prefixRange("comput");
+    std::vector<std::string> matched;
+    for (auto it = lexicon.iterate(range.first); it.id() < range.second; it.next())
+        matched.emplace_back(it.term());
+    EXPECT_EQ(matched, (std::vector<std::string>{"computer", "computing"}));
+
+    range = lexicon.prefixRange("comp");
+    EXPECT_EQ(range.second - range.first, 4u);
+    range = lexicon.prefixRange("zebra");
+    EXPECT_EQ(range.first, range.second);
+    range = lexicon.prefixRange("");
+    EXPECT_EQ(range.second - range.first, 7u);
+    EXPECT_EQ(lexicon.lowerBound("d"), 6u);
+}
+
+// Test that the iterator decodes across block boundaries and reports shared prefixes.
+TEST_F(LexiconTest, TestIterator) {
+    writeNumbered(50);
+    Lexicon lexicon(path);
+
+    uint32_t count = 0;
+    std::string previous;
+    for (auto it = lexicon.iterate(); it.valid(); it.next()) {
+        std::string term(it.term());
+        if (count > 0) {
+            size_t shared = 0;
+            while (shared < term.size() && term[shared] == previous[shared])
+                shared++;
+            EXPECT_EQ(it.shared(), shared) << term;
+            EXPECT_LT(previous, term);
+        }
+        previous = term;
+        count++;
+    }
+    EXPECT_EQ(count, 50u);
+    EXPECT_EQ(lexicon.iterate(33).term(), "t033");
+}
+
+// Test empty lexicons and corrupt files.
+TEST_F(LexiconTest, TestEmptyAndCorrupt) {
+    LexiconBuilder().write(path);
+    {
+        Lexicon lexicon(path);
+        EXPECT_EQ(lexicon.size(), 0u);
+        EXPECT_FALSE(lexicon.find("anything").has_value());
+        EXPECT_FALSE(lexicon.iterate().valid());
+    }
+
+    std::ofstream(path, std::ios::trunc) << "not a lexicon file at all, just some text......";
+    EXPECT_THROW(Lexicon lexicon(path), std::runtime_error);
+    EXPECT_THROW(Lexicon lexicon("./does_not_exist.lex"), std::runtime_error);
+
+    LexiconBuilder duplicates;
+    duplicates.add("same", 1, 1.0f);
+    duplicates.add("same", 2, 2.0f);
+    EXPECT_THROW(duplicates.write(path), std::runtime_error);
+}
+
+// Test building from the keys of an inverted index.
+TEST_F(LexiconTest, TestBuildFromDatabase) {
+    std::string dbPath = "./temp_lexicon_db";
+    std::filesystem::create_directory(dbPath);
+    {
+        Database db(dbPath);
+        db.add("rpi", {3, 1});
+        db.add("rpi", {7, 2});
+        db.add("troy", {2, 1});
+
+        Lexicon::build(db, path, [](uint32_t df, int maxPriority) { return float(maxPriority * 10 + df); });
+    }
+    std::filesystem::remove_all(dbPath);
+
+    Lexicon lexicon(path);
+    ASSERT_EQ(lexicon.size(), 2u);
+    auto rpi = lexicon.find("rpi");
+    ASSERT_TRUE(rpi.has_value());
+    EXPECT_EQ(rpi->df, 2u);
+    EXPECT_FLOAT_EQ(rpi->maxScore, 72.0f);
+    EXPECT_EQ(lexicon.find("troy")->id, 1u);
+}
+
+// Performance test: point lookups in a 100k-term lexicon.
+TEST_F(LexiconTest, PerformanceTest_Lookups) {
+    const int numTerms = 100000;
+    LexiconBuilder builder;
+    std::vector<std::string> terms;
+    for (int i = 0; i < numTerms; i++) {
+        terms.push_back("term" + std::to_string(i * 7919 % 1000003));
+        builder.add(terms.back(), 1, 1.0f);
+    }
+    builder.write(path);
+    Lexicon lexicon(path);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    int found = 0;
+    for (const std::string& term : terms)
+        found += lexicon.find(term).has_value();
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+
+    std::cout << "PerformanceTest: " << numTerms << " lexicon lookups in " << elapsed.count()
+              << " seconds (" << elapsed.count() / numTerms << " sec per lookup, "
+              << std::filesystem::file_size(path) << " bytes on disk)" << std::endl;
+
+    EXPECT_EQ(found, numTerms);
+}
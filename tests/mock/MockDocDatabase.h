@@ -13,4 +13,6 @@ public:
     MOCK_METHOD(bool, remove, (SearchRPI::docid id), (override));
     MOCK_METHOD(SearchRPI::docid, addDoc, (const std::string& url, const std::string& title, std::vector<std::string> words), (override));
     MOCK_METHOD(std::set<std::string>, getWords, (SearchRPI::docid id), (override));
+    MOCK_METHOD(TermVector, getTermVector, (SearchRPI::docid id), (override));
+    MOCK_METHOD(std::pmr::vector<DocSummary>, getDocs, (const std::vector<SearchRPI::docid>& ids, std::pmr::memory_resource& arena, bool withText), (override));
 };
@@ -0,0 +1,128 @@
+#include "../include/query-processing/analyzer.h"
+#include "../include/query-processing/bkTree.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using analyzer::Analyzer;
+using analyzer::Token;
+
+namespace {
+
+template <typename A>
+std::vector<std::string> analyze(A& a, std::string_view text) {
+    std::vector<std::string> words;
+    a.analyze(text, [&](const Token& token) { words.push_back(token.text); });
+    return words;
+}
+
+// Custom stage: drops words shorter than three characters.
+struct MinLength {
+    bool operator()(Token& token) const { return token.text.size() >= 3; }
+};
+
+} // namespace
+
+// Test that documents drop stop words and are stemmed
+TEST(AnalyzerTest, AnalyzesDocuments) {
+    analyzer::DocumentAnalyzer documents;
+    EXPECT_EQ(analyze(documents, "The Running children, and their TOYS!"),
+              (std::vector<std::string>{"run", "children", "toy"}));
+    EXPECT_EQ(analyze(documents, "comput* the"), (std::vector<std::string>{"comput"}));
+    EXPECT_TRUE(analyze(documents, "").empty());
+
+    // Stages are fixed at compile time; an empty chain only tokenizes.
+    Analyzer<> tokens;
+    EXPECT_EQ(analyze(tokens, "The Running"), (std::vector<std::string>{"the", "running"}));
+    Analyzer<MinLength, analyzer::StopwordFilter> custom;
+    EXPECT_EQ(analyze(custom, "an ox and a yak"), (std::vector<std::string>{"yak"}));
+}
+
+// Test that queries are corrected before stemming and keep wildcards
+TEST(AnalyzerTest, AnalyzesQueries) {
+    std::unordered_set<std::string> dict = {"happy", "children", "toy", "run"};
+    bk::BKTree corrector(dict);
+    std::function<bool(std::string_view)> isWord = [&](std::string_view word) {
+        return dict.count(std::string(word)) > 0;
+    };
+
+    analyzer::QueryAnalyzer queries(analyzer::StopwordFilter(),
+                                    analyzer::SpellingCorrection(corrector, isWord),
+                                    analyzer::Stemming());
+    queries.setKeepOperators(true);
+    EXPECT_EQ(analyze(queries, "happyness for the childrns comput*"),
+              (std::vector<std::string>{"happy", "children", "comput*"}));
+    // Fuzzy terms are stemmed but not corrected, and keep their suffix.
+    EXPECT_EQ(analyze(queries, "runing~1 toys~2"), (std::vector<std::string>{"rune~1", "toy~2"}));
+
+    // A default SpellingCorrection corrects nothing.
+    queries.stage<analyzer::SpellingCorrection>() = analyzer::SpellingCorrection();
+    EXPECT_EQ(analyze(queries, "childrns"), (std::vector<std::string>{"childrn"}));
+}
+
+// Test that a shared stem cache and a custom stop word list can be plugged in
+TEST(AnalyzerTest, UsesConfiguredStages) {
+    stemmer::StemCache cache;
+    stopwords::StopwordSet stop({"snow"});
+    Analyzer<analyzer::StopwordFilter, analyzer::Stemming> a{analyzer::StopwordFilter(stop),
+                                                             analyzer::Stemming(cache)};
+    EXPECT_EQ(analyze(a, "the snow skiing"), (std::vector<std::string>{"the", "ski"}));
+    EXPECT_EQ(cache.size(), 2u);
+}
+
+// Test that text fed in chunks of any size gives the same tokens as a whole
+TEST(AnalyzerTest, StreamsChunks) {
+    std::string text = "  Café au lait　naïve résumé\tzoë's  co-op\n\nwell-known ÉCOLE  ";
+    for (int i = 0; i < 200; ++i) text += " word" + std::to_string(i % 17);
+    analyzer::DocumentAnalyzer a;
+    std::vector<std::string> expected = analyze(a, text);
+    ASSERT_GT(expected.size(), 200u);
+
+    for (size_t chunk = 1; chunk <= 40; ++chunk) {
+        std::vector<std::string> words;
+        auto sink = [&](const Token& token) { words.push_back(token.text); };
+        for (size_t start = 0; start < text.size(); start += chunk) {
+            a.feed(std::string_view(text).substr(start, chunk), sink);
+        }
+        a.finish(sink);
+        ASSERT_EQ(words, expected) << "chunk size " << chunk;
+    }
+}
+
+// Performance test: analyzing a large page body in network-sized chunks
+TEST(AnalyzerTest, PerformanceTest_StreamingIngest) {
+    std::mt19937 rng(9);
+    std::vector<std::string> vocabulary;
+    for (int i = 0; i < 5000; ++i) {
+        std::string word;
+        for (int n = 3 + rng() % 8; n > 0; --n) word.push_back(static_cast<char>('a' + rng() % 26));
+        vocabulary.push_back(word);
+    }
+    std::string body;
+    while (body.size() < (16u << 20)) {
+        body += vocabulary[rng() % vocabulary.size()];
+        body += (rng() % 10 == 0) ? ".\n" : " ";
+    }
+
+    analyzer::DocumentAnalyzer a;
+    size_t tokens = 0;
+    auto sink = [&](const Token&) { ++tokens; };
+    const size_t chunk = 64 * 1024;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t offset = 0; offset < body.size(); offset += chunk) {
+        a.feed(std::string_view(body).substr(offset, chunk), sink);
+    }
+    a.finish(sink);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double> elapsed = end - start;
+    std::cout << "PerformanceTest: analyzed " << body.size() / (1 << 20) << " MB (" << tokens << " tokens) in "
+              << elapsed.count() << " seconds (" << body.size() / (1 << 20) / elapsed.count() << " MB/s)"
+              << std::endl;
+    EXPECT_GT(tokens, 1000000u);
+}
@@ -1,6 +1,12 @@
 #include "../include/query-processing/bkTree.h"
 #include <gtest/gtest.h>
 #include <unordered_set>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
 
 class BKTreeTest : public ::testing::Test {
 protected:
@@ -57,3 +63,100 @@ TEST_F(BKTreeTest, FindClosestEmptyInput) {
 TEST_F(BKTreeTest, FindClosestLargeThreshold) {
     EXPECT_EQ(tree.findClosest("apxple", 5), "apple");
 }
+
+// Plain dynamic programming edit distance, for checking the tree's answers.
+static int referenceDistance(const std::string& a, const std::string& b) {
+    std::vector<int> prev(b.size() + 1), curr(b.size() + 1);
+    for (size_t j = 0; j <= b.size(); ++j) prev[j] = j;
+    for (size_t i = 1; i <= a.size(); ++i) {
+        curr[0] = i;
+        for (size_t j = 1; j <= b.size(); ++j) {
+            curr[j] = std::min({prev[j] + 1, curr[j - 1] + 1, prev[j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1)});
+        }
+        std::swap(prev, curr);
+    }
+    return prev[b.size()];
+}
+
+static std::vector<std::string> randomWords(size_t count, size_t minLen, size_t maxLen, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<size_t> len(minLen, maxLen);
+    std::uniform_int_distribution<int> letter('a', 'h');
+    std::vector<std::string> words;
+    for (size_t i = 0; i < count; ++i) {
+        std::string word(len(gen), ' ');
+        for (char& c : word) c = static_cast<char>(letter(gen));
+        words.push_back(word);
+    }
+    return words;
+}
+
+// Test that the closest word found is always at the minimum distance
+TEST(BKTreeSearchTest, FindClosestMatchesBruteForce) {
+    std::vector<std::string> words = randomWords(2000, 1, 10, 3);
+    bk::Dictionary dict(words.begin(), words.begin() + 1000);
+    bk::BKTree tree(dict);
+    // Later inserts move child spans and compact the node array.
+    for (size_t i = 1000; i < words.size(); ++i) tree.insert(words[i]);
+    bk::Dictionary all(words.begin(), words.end());
+    EXPECT_EQ(tree.size(), all.size());
+
+    std::vector<std::string> queries = randomWords(200, 1, 12, 5);
+    queries.push_back(std::string(70, 'a') + "b");  // longer than 64 characters
+    tree.insert(std::string(72, 'a'));
+    all.insert(std::string(72, 'a'));
+
+    for (int threshold = 0; threshold <= 3; ++threshold) {
+        for (const std::string& query : queries) {
+            int best = threshold + 1;
+            for (const std::string& word : all) best = std::min(best, referenceDistance(query, word));
+
+            std::string found = tree.findClosest(query, threshold);
+            if (best <= threshold) {
+                EXPECT_EQ(referenceDistance(query, found), best) << query << " -> " << found;
+                EXPECT_TRUE(all.count(found)) << found;
+            } else {
+                EXPECT_EQ(found, query);
+            }
+        }
+    }
+}
+
+// Performance test: typo correction against a large dictionary
+TEST(BKTreeSearchTest, PerformanceTest_FindClosest) {
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<size_t> len(4, 12);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    bk::Dictionary dict;
+    while (dict.size() < 200000) {
+        std::string word(len(gen), ' ');
+        for (char& c : word) c = static_cast<char>(letter(gen));
+        dict.insert(word);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    bk::BKTree tree(dict);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> buildTime = end - start;
+
+    std::vector<std::string> queries;
+    for (auto it = dict.begin(); queries.size() < 500; ++it) {
+        std::string query = *it;
+        query[query.size() / 2] = query[query.size() / 2] == 'z' ? 'a' : query[query.size() / 2] + 1;
+        if (!dict.count(query)) queries.push_back(query);
+    }
+
+    size_t corrected = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (const std::string& query : queries) {
+        corrected += tree.findClosest(query, 2) != query;
+    }
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::micro> searchTime = end - start;
+
+    std::cout << "PerformanceTest: Built a " << dict.size() << " word BK-tree in " << buildTime.count()
+              << " seconds; findClosest averaged " << searchTime.count() / queries.size()
+              << " microseconds" << std::endl;
+
+    EXPECT_EQ(corrected, queries.size());
+}
@@ -0,0 +1,184 @@
+#include "../include/query-processing/completionTrie.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using completion::Completions;
+using completion::CompletionTrie;
+using completion::Suggestion;
+
+class CompletionTrieTest : public ::testing::Test {
+protected:
+    std::string path = "./temp_completions.img";
+
+    void TearDown() override {
+        std::remove(path.c_str());
+        std::remove((path + ".tmp").c_str());
+    }
+};
+
+namespace {
+
+std::vector<std::string> texts(const std::vector<Suggestion>& suggestions) {
+    std::vector<std::string> result;
+    for (const Suggestion& suggestion : suggestions) result.emplace_back(suggestion.text);
+    return result;
+}
+
+using Texts = std::vector<std::string>;
+
+} // namespace
+
+// Test that completions of a prefix come best first, wherever the prefix ends
+TEST_F(CompletionTrieTest, CompletesPrefixes) {
+    CompletionTrie::build({{"ski", 50}, {"ski resort", 80}, {"ski resorts colorado", 30}, {"skiing", 40},
+                           {"skate", 10}, {"snow", 60}, {"snowboard", 60}},
+                          path);
+    CompletionTrie trie(path);
+    EXPECT_EQ(trie.size(), 7u);
+
+    EXPECT_EQ(texts(trie.complete("ski")), (Texts{"ski resort", "ski", "skiing", "ski resorts colorado"}));
+    EXPECT_EQ(texts(trie.complete("ski resort")), (Texts{"ski resort", "ski resorts colorado"}));
+    EXPECT_EQ(texts(trie.complete("ski reso")), (Texts{"ski resort", "ski resorts colorado"}));
+    EXPECT_EQ(texts(trie.complete("sk", 2)), (Texts{"ski resort", "ski"}));
+    EXPECT_EQ(texts(trie.complete("sn")), (Texts{"snow", "snowboard"}));  // equal weights in text order
+    EXPECT_EQ(texts(trie.complete("")), (Texts{"ski resort", "snow", "snowboard", "ski", "skiing",
+                                               "ski resorts colorado", "skate"}));
+    EXPECT_EQ(trie.complete("ski")[0].weight, 80u);
+
+    EXPECT_TRUE(trie.complete("skx").empty());
+    EXPECT_TRUE(trie.complete("ski resorts colorado springs").empty());
+    EXPECT_TRUE(trie.complete("x").empty());
+    EXPECT_TRUE(trie.complete("ski", 0).empty());
+}
+
+// Test that typed text is normalized and a trailing space asks for more words
+TEST_F(CompletionTrieTest, SuggestsForTypedText) {
+    CompletionTrie::build({{CompletionTrie::normalize("Ski  Resort!"), 5}, {"skiing", 9}}, path);
+    CompletionTrie trie(path);
+
+    EXPECT_EQ(CompletionTrie::normalize("  Good   SKI, resort "), "good ski resort");
+    EXPECT_EQ(texts(trie.suggest("SKI")), (Texts{"skiing", "ski resort"}));
+    EXPECT_EQ(texts(trie.suggest("Ski ")), (Texts{"ski resort"}));
+    EXPECT_EQ(texts(trie.suggest("ski  RE")), (Texts{"ski resort"}));
+}
+
+// Test that only the best topK completions are kept at each node
+TEST_F(CompletionTrieTest, KeepsTopK) {
+    Completions completions;
+    for (int i = 0; i < 30; ++i) completions["term" + std::to_string(i)] = i;
+    CompletionTrie::build(completions, path, 3);
+    CompletionTrie trie(path);
+
+    EXPECT_EQ(trie.topK(), 3u);
+    EXPECT_EQ(texts(trie.complete("term", 10)), (Texts{"term29", "term28", "term27"}));
+    EXPECT_EQ(texts(trie.complete("term1", 10)), (Texts{"term19", "term18", "term17"}));
+    EXPECT_EQ(texts(trie.complete("term5")), (Texts{"term5"}));
+}
+
+// Test that lookups match a brute-force scan of the completions
+TEST_F(CompletionTrieTest, MatchesBruteForce) {
+    std::mt19937 rng(3);
+    Completions completions;
+    while (completions.size() < 3000) {
+        std::string text;
+        for (int n = 1 + rng() % 12; n > 0; --n) text.push_back("abc d"[rng() % 5]);
+        completions[text] = rng() % 50;
+    }
+    completions.erase("");
+    CompletionTrie::build(completions, path);
+    CompletionTrie trie(path);
+
+    std::vector<std::pair<std::string, uint64_t>> all(completions.begin(), completions.end());
+    std::sort(all.begin(), all.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    for (int i = 0; i < 500; ++i) {
+        std::string prefix;
+        for (int n = rng() % 5; n > 0; --n) prefix.push_back("abc d"[rng() % 5]);
+        Texts expected;
+        for (const auto& [text, weight] : all) {
+            if (text.compare(0, prefix.size(), prefix) == 0 && expected.size() < 10) expected.push_back(text);
+        }
+        ASSERT_EQ(texts(trie.complete(prefix)), expected) << "'" << prefix << "'";
+    }
+}
+
+// Test that empty tries work and damaged images are rejected
+TEST_F(CompletionTrieTest, HandlesEmptyAndCorruptImages) {
+    CompletionTrie::build({{"", 3}}, path);
+    {
+        CompletionTrie empty(path);
+        EXPECT_EQ(empty.size(), 0u);
+        EXPECT_TRUE(empty.complete("").empty());
+        EXPECT_TRUE(empty.complete("a").empty());
+    }
+
+    CompletionTrie::build({{"ski", 1}, {"snow", 2}}, path);
+    std::string bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size() - 1);
+    EXPECT_THROW(CompletionTrie{path}, std::runtime_error);
+
+    bytes[0] = 'X';
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size());
+    EXPECT_THROW(CompletionTrie{path}, std::runtime_error);
+    EXPECT_THROW(CompletionTrie{"./no_such_completions.img"}, std::runtime_error);
+}
+
+// Performance test: ten suggestions per keystroke from a large query log
+TEST_F(CompletionTrieTest, PerformanceTest_Suggest) {
+    std::mt19937 rng(11);
+    std::vector<std::string> words;
+    for (int i = 0; i < 20000; ++i) {
+        std::string word;
+        for (int n = 3 + rng() % 7; n > 0; --n) word.push_back(static_cast<char>('a' + rng() % 26));
+        words.push_back(word);
+    }
+    Completions completions;
+    std::vector<std::string> queries;
+    while (completions.size() < 500000) {
+        std::string query = words[rng() % words.size()];
+        for (int n = rng() % 3; n > 0; --n) query += " " + words[rng() % words.size()];
+        completions[query] += 1 + rng() % 1000;
+        queries.push_back(query);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    CompletionTrie::build(completions, path);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> buildTime = end - start;
+    CompletionTrie trie(path);
+
+    // Every keystroke of queries from the log.
+    std::vector<std::string> typed;
+    for (int i = 0; i < 20000; ++i) {
+        const std::string& query = queries[rng() % queries.size()];
+        typed.push_back(query.substr(0, 1 + rng() % query.size()));
+    }
+    size_t found = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (const std::string& prefix : typed) {
+        found += trie.suggest(prefix, 10).size();
+    }
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> lookupTime = end - start;
+
+    double perLookup = lookupTime.count() / typed.size();
+    std::cout << "PerformanceTest: built " << completions.size() << " completions in " << buildTime.count()
+              << " seconds (" << trie.memoryUsage() / (1 << 20) << " MB); " << typed.size() << " lookups in "
+              << lookupTime.count() << " seconds (" << perLookup * 1e6 << " us per lookup)" << std::endl;
+    EXPECT_GE(found, typed.size());
+    EXPECT_LT(perLookup, 1e-3);
+}
@@ -0,0 +1,176 @@
+#include "../include/query-processing/phraseMatcher.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using queryTree::PhraseMatch;
+using queryTree::PhraseMatcher;
+using queryTree::TermDictionary;
+using queryTree::TokenList;
+
+namespace {
+
+std::vector<std::pair<uint32_t, uint32_t>> match(const PhraseMatcher& matcher, const TokenList& tokens) {
+    std::pmr::vector<PhraseMatch> matches;
+    matcher.findPhrases(tokens, matches);
+    std::vector<std::pair<uint32_t, uint32_t>> result;
+    for (const PhraseMatch& m : matches) result.emplace_back(m.start, m.length);
+    return result;
+}
+
+using Matches = std::vector<std::pair<uint32_t, uint32_t>>;
+
+} // namespace
+
+// Test that the longest phrase starting at the earliest token wins
+TEST(PhraseMatcherTest, FindsLeftmostLongestPhrases) {
+    PhraseMatcher matcher(TermDictionary{
+        {"new york", {}}, {"new york city", {}}, {"city hall", {}}, {"york city hall", {}}});
+    EXPECT_EQ(matcher.size(), 4u);
+
+    EXPECT_EQ(match(matcher, {"new", "york", "city", "hall"}), (Matches{{0, 3}}));
+    EXPECT_EQ(match(matcher, {"old", "york", "city", "hall"}), (Matches{{1, 3}}));
+    EXPECT_EQ(match(matcher, {"new", "york", "new", "york"}), (Matches{{0, 2}, {2, 2}}));
+    EXPECT_EQ(match(matcher, {"new", "jersey", "city", "hall"}), (Matches{{2, 2}}));
+    EXPECT_EQ(match(matcher, {"york", "new", "city"}), Matches{});
+}
+
+// Test phrases found only through failure links, after a longer partial match
+TEST(PhraseMatcherTest, FindsPhrasesInsideFailedMatches) {
+    PhraseMatcher matcher(TermDictionary{{"p q", {}}, {"q r s", {}}, {"r s", {}}, {"a b c d", {}}, {"b c", {}}});
+
+    EXPECT_EQ(match(matcher, {"p", "q", "r", "s"}), (Matches{{0, 2}, {2, 2}}));
+    EXPECT_EQ(match(matcher, {"x", "q", "r", "s"}), (Matches{{1, 3}}));
+    EXPECT_EQ(match(matcher, {"a", "b", "c", "x"}), (Matches{{1, 2}}));
+    EXPECT_EQ(match(matcher, {"a", "b", "c", "d"}), (Matches{{0, 4}}));
+}
+
+// Test that single words, empty dictionaries and unknown tokens are handled
+TEST(PhraseMatcherTest, HandlesDegenerateInput) {
+    PhraseMatcher empty;
+    EXPECT_EQ(empty.size(), 0u);
+    EXPECT_EQ(match(empty, {"good", "ski"}), Matches{});
+
+    PhraseMatcher matcher(TermDictionary{{"ski", {}}, {"good  ski", {}}, {"", {}}});
+    EXPECT_EQ(matcher.size(), 1u);  // only "good ski" is a phrase
+    EXPECT_EQ(match(matcher, {}), Matches{});
+    EXPECT_EQ(match(matcher, {"ski"}), Matches{});
+    EXPECT_EQ(match(matcher, {"good", "ski*", "good", "ski"}), (Matches{{2, 2}}));
+}
+
+// Test that a serialized matcher works in place and rejects corrupt bytes
+TEST(PhraseMatcherTest, WorksFromSerializedImage) {
+    TermDictionary dict = {{"ski resort", {}}, {"mountain peak", {}}, {"ski resort town", {}}};
+    std::string image = PhraseMatcher::serialize(dict);
+    EXPECT_EQ(image, PhraseMatcher::serialize(dict));
+
+    PhraseMatcher matcher(image.data(), image.size());
+    EXPECT_EQ(matcher.memoryUsage(), image.size());
+    EXPECT_EQ(match(matcher, {"ski", "resort", "town", "mountain", "peak"}), (Matches{{0, 3}, {3, 2}}));
+
+    EXPECT_THROW(PhraseMatcher(image.data(), image.size() - 1), std::runtime_error);
+    std::string corrupt = image;
+    corrupt[0] ^= 1;
+    EXPECT_THROW(PhraseMatcher(corrupt.data(), corrupt.size()), std::runtime_error);
+}
+
+// Test against a brute-force leftmost-longest matcher on random phrases and queries
+TEST(PhraseMatcherTest, MatchesBruteForce) {
+    std::mt19937 rng(7);
+    std::vector<std::string> words = {"a", "b", "c", "d", "e", "f"};
+    std::uniform_int_distribution<size_t> pickWord(0, words.size() - 1);
+
+    TermDictionary dict;
+    std::vector<std::vector<std::string>> phrases;
+    for (int i = 0; i < 60; ++i) {
+        std::vector<std::string> phrase(2 + rng() % 4);
+        std::string key;
+        for (std::string& word : phrase) {
+            word = words[pickWord(rng)];
+            key += (key.empty() ? "" : " ") + word;
+        }
+        if (dict.emplace(key, std::vector<std::string>{}).second) phrases.push_back(phrase);
+    }
+    PhraseMatcher matcher(dict);
+
+    for (int q = 0; q < 2000; ++q) {
+        TokenList tokens(rng() % 12);
+        for (auto& token : tokens) token = words[pickWord(rng)];
+
+        Matches expected;
+        for (size_t i = 0; i < tokens.size();) {
+            size_t best = 0;
+            for (const auto& phrase : phrases) {
+                if (phrase.size() <= best || i + phrase.size() > tokens.size()) continue;
+                bool same = true;
+                for (size_t k = 0; k < phrase.size() && same; ++k) same = std::string_view(tokens[i + k]) == phrase[k];
+                if (same) best = phrase.size();
+            }
+            if (best) {
+                expected.emplace_back(i, best);
+                i += best;
+            } else {
+                ++i;
+            }
+        }
+        ASSERT_EQ(match(matcher, tokens), expected) << "query " << q;
+    }
+}
+
+// Performance test: matching queries against a large phrase dictionary
+TEST(PhraseMatcherTest, PerformanceTest_LargeDictionary) {
+    const int numPhrases = 200000;
+    const int numQueries = 100000;
+    std::mt19937 rng(11);
+    auto word = [&]() { return "w" + std::to_string(rng() % 50000); };
+
+    TermDictionary dict;
+    for (int i = 0; i < numPhrases; ++i) {
+        std::string phrase = word();
+        for (int n = 1 + rng() % 4; n > 0; --n) phrase += " " + word();
+        dict.emplace(phrase, std::vector<std::string>{});
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    PhraseMatcher matcher(dict);
+    auto built = std::chrono::high_resolution_clock::now();
+
+    // Each query embeds a dictionary phrase among random words.
+    std::vector<TokenList> queries;
+    for (auto it = dict.begin(); queries.size() < 1000; ++it) {
+        TokenList tokens;
+        tokens.emplace_back(word());
+        size_t start = 0;
+        while (start <= it->first.size()) {
+            size_t end = std::min(it->first.find(' ', start), it->first.size());
+            tokens.emplace_back(it->first.substr(start, end - start));
+            start = end + 1;
+        }
+        while (tokens.size() < 8) tokens.emplace_back(word());
+        queries.push_back(std::move(tokens));
+    }
+    std::pmr::vector<PhraseMatch> matches;
+    size_t found = 0;
+    auto matchStart = std::chrono::high_resolution_clock::now();
+    for (int q = 0; q < numQueries; ++q) {
+        matcher.findPhrases(queries[q % queries.size()], matches);
+        found += matches.size();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double> buildTime = built - start;
+    std::chrono::duration<double> matchTime = end - matchStart;
+    std::cout << "PerformanceTest: compiled " << matcher.size() << " phrases in " << buildTime.count()
+              << " seconds (" << matcher.memoryUsage() << " bytes); " << numQueries << " 8-word queries in "
+              << matchTime.count() << " seconds (" << matchTime.count() / numQueries * 1e6
+              << " us per query, " << found << " phrases found)" << std::endl;
+
+    EXPECT_EQ(matcher.size(), dict.size());
+    EXPECT_GE(found, size_t(numQueries));
+}
@@ -0,0 +1,152 @@
+#include "../include/query-processing/query.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+class QueryResourcesTest : public ::testing::Test {
+protected:
+    std::string path = "./temp_query_resources.img";
+    query::Dictionary dict = {"hello", "world", "run", "happy", "children", "toy", "apple",
+                              "banana", "good", "ski"};
+    queryTree::TermDictionary termDictionary = {
+        {"good ski", {"ski", "skiing"}},
+        {"ski resort", {}},
+        {"fast runner", {"sprinter"}},
+        {"mountain peak", {}}
+    };
+
+    void TearDown() override {
+        std::remove(path.c_str());
+        std::remove((path + ".tmp").c_str());
+    }
+};
+
+// Test that the image answers dictionary, spelling and phrase lookups
+TEST_F(QueryResourcesTest, BuildAndLookup) {
+    query::QueryResources::build(dict, termDictionary, path);
+    query::QueryResources resources(path);
+
+    EXPECT_EQ(resources.wordCount(), dict.size());
+    EXPECT_EQ(resources.phraseCount(), termDictionary.size());
+    for (const std::string& word : dict) EXPECT_TRUE(resources.isWord(word)) << word;
+    EXPECT_FALSE(resources.isWord("skis"));
+    EXPECT_FALSE(resources.isWord(""));
+
+    EXPECT_EQ(resources.corrector().findClosest("childrns"), "children");
+    EXPECT_EQ(resources.corrector().findClosest("zzzzzz"), "zzzzzz");
+
+    std::pmr::vector<queryTree::PhraseMatch> matches;
+    resources.phraseMatcher().findPhrases({"good", "ski", "resort", "mountain", "peak"}, matches);
+    ASSERT_EQ(matches.size(), 2u);
+    EXPECT_EQ(matches[0].start, 0u);
+    EXPECT_EQ(matches[0].length, 2u);
+    EXPECT_EQ(matches[1].start, 3u);
+    resources.phraseMatcher().findPhrases({"zebra", "crossing", "ski"}, matches);
+    EXPECT_TRUE(matches.empty());
+}
+
+// Test that empty resources still produce a valid image
+TEST_F(QueryResourcesTest, EmptyImage) {
+    query::QueryResources::build({}, {}, path);
+    query::QueryResources resources(path);
+    EXPECT_EQ(resources.wordCount(), 0u);
+    EXPECT_EQ(resources.phraseCount(), 0u);
+    EXPECT_FALSE(resources.isWord("hello"));
+    std::pmr::vector<queryTree::PhraseMatch> matches;
+    resources.phraseMatcher().findPhrases({"good", "ski"}, matches);
+    EXPECT_TRUE(matches.empty());
+}
+
+// Test that processing through the image matches processing through in-memory resources
+TEST_F(QueryResourcesTest, ProcessQueryMatchesInMemoryResources) {
+    query::QueryResources::build(dict, termDictionary, path);
+    query::QueryResources resources(path);
+    bk::BKTree tree(dict);
+    queryTree::PhraseMatcher phrases(termDictionary);
+
+    for (const std::string query : {"Runnning happyness childrns toy", "What are good skis?",
+                                    "Comput* toys", "the and in", "bananna aple"}) {
+        queryTree::QueryTree expected = query::processQuery(query, dict, tree, phrases);
+        queryTree::QueryTree actual = query::processQuery(query, resources);
+        ASSERT_EQ(actual.getNodes()->size(), expected.getNodes()->size()) << query;
+        for (size_t i = 0; i < expected.getNodes()->size(); ++i) {
+            EXPECT_EQ(actual.getNode(i)->getOperation(), expected.getNode(i)->getOperation()) << query;
+            EXPECT_EQ(actual.getNode(i)->getValue(), expected.getNode(i)->getValue()) << query;
+        }
+    }
+}
+
+// Test that foreign, truncated and wrong-version images are rejected
+TEST_F(QueryResourcesTest, RejectsCorruptImage) {
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << std::string(200, 'x');
+    }
+    EXPECT_THROW(query::QueryResources resources(path), std::runtime_error);
+    EXPECT_THROW(query::QueryResources resources("./missing_query_resources.img"), std::runtime_error);
+
+    query::QueryResources::build(dict, termDictionary, path);
+    std::string image;
+    {
+        std::ifstream in(path, std::ios::binary);
+        image.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    std::string wrongVersion = image;
+    uint32_t version = query::QUERY_RESOURCES_VERSION + 1;
+    wrongVersion.replace(4, sizeof(version), reinterpret_cast<const char*>(&version), sizeof(version));
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << wrongVersion;
+    EXPECT_THROW(query::QueryResources resources(path), std::runtime_error);
+
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << image.substr(0, image.size() - 1);
+    EXPECT_THROW(query::QueryResources resources(path), std::runtime_error);
+}
+
+// Performance test: building the corrector at startup against mapping a prebuilt image
+TEST_F(QueryResourcesTest, PerformanceTest_Startup) {
+    std::mt19937 gen(17);
+    std::uniform_int_distribution<size_t> len(4, 12);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    query::Dictionary words;
+    while (words.size() < 100000) {
+        std::string word(len(gen), ' ');
+        for (char& c : word) c = static_cast<char>(letter(gen));
+        words.insert(word);
+    }
+    queryTree::TermDictionary phrases;
+    for (auto it = words.begin(); phrases.size() < 10000; ++it) {
+        phrases[*it + " " + *std::next(it)] = {};
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    query::QueryResources::build(words, phrases, path);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> offlineBuild = end - start;
+
+    start = std::chrono::high_resolution_clock::now();
+    bk::BKTree tree(words);
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> treeStartup = end - start;
+
+    start = std::chrono::high_resolution_clock::now();
+    query::QueryResources resources(path);
+    std::string corrected = resources.corrector().findClosest("xyzzyq");
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> imageStartup = end - start;
+
+    std::cout << "PerformanceTest: " << words.size() << " words, " << phrases.size() << " phrases" << std::endl;
+    std::cout << "  Image built offline in " << offlineBuild.count() << " s" << std::endl;
+    std::cout << "  Startup building the BK-tree: " << treeStartup.count() << " ms" << std::endl;
+    std::cout << "  Startup mapping the image and correcting one word: " << imageStartup.count() << " ms"
+              << std::endl;
+
+    EXPECT_EQ(resources.wordCount(), words.size());
+    EXPECT_EQ(resources.phraseCount(), phrases.size());
+}
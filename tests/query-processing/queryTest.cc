@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <cstdio>
 #include <string>
 #include <vector>
 #include <unordered_set>
@@ -9,6 +10,7 @@ protected:
     static std::unordered_set<std::string> dict;
     static bk::BKTree* bkTree;
     static queryTree::TermDictionary termDictionary;
+    static queryTree::PhraseMatcher* phrases;
 
     static void SetUpTestSuite() {
         // Define a small dictionary directly in the test
@@ -25,10 +27,14 @@ protected:
             {"fast runner", {}},
             {"mountain peak", {}}
         };
+
+        // Compile the phrases once for every query
+        phrases = new queryTree::PhraseMatcher(termDictionary);
     }
 
     static void TearDownTestSuite() {
         delete bkTree;
+        delete phrases;
     }
 };
 
@@ -36,11 +42,12 @@ protected:
 std::unordered_set<std::string> QueryTestFixture::dict;
 bk::BKTree* QueryTestFixture::bkTree = nullptr;
 queryTree::TermDictionary QueryTestFixture::termDictionary;
+queryTree::PhraseMatcher* QueryTestFixture::phrases = nullptr;
 
 // Test that processQuery corrects spelling errors
 TEST_F(QueryTestFixture, ProcessQueryReturnsCorrections) {
     std::string query = "Runnning happyness childrns toy";
-    queryTree::QueryTree tree = query::processQuery(query, dict, *bkTree, termDictionary);
+    queryTree::QueryTree tree = query::processQuery(query, dict, *bkTree, *phrases);
 
     ASSERT_FALSE(tree.getNode(0) == nullptr);
     EXPECT_EQ(tree.getNode(0)->getOperation(), queryTree::QueryOperator::COMBINE);
@@ -50,42 +57,87 @@ TEST_F(QueryTestFixture, ProcessQueryReturnsCorrections) {
     ASSERT_EQ(tree.getNode(4)->getValue(), "toy");
 }
 
+// Test that processQuery corrects spelling the same way through SymSpell
+TEST_F(QueryTestFixture, ProcessQueryWithSymSpellCorrector) {
+    std::string path = "./temp_query_symspell";
+    spell::SymSpell::Frequencies frequencies;
+    for (const std::string& word : dict) frequencies[word] = 1;
+    spell::SymSpell::build(frequencies, path);
+    spell::SymSpell corrector(path);
+
+    std::string query = "Runnning happyness childrns toy";
+    queryTree::QueryTree tree = query::processQuery(query, dict, corrector, *phrases);
+
+    ASSERT_FALSE(tree.getNode(0) == nullptr);
+    ASSERT_EQ(tree.getNode(1)->getValue(), "runn");
+    ASSERT_EQ(tree.getNode(2)->getValue(), "happy");
+    ASSERT_EQ(tree.getNode(3)->getValue(), "children");
+    ASSERT_EQ(tree.getNode(4)->getValue(), "toy");
+    std::remove(path.c_str());
+}
+
 // Test that processQuery handles punctuation and case correctly
 TEST_F(QueryTestFixture, ProcessQueryHandlesPunctuationAndCase) {
-    std::string query = "HeLLo, WoRLD!";
-    queryTree::QueryTree tree = query::processQuery(query, dict, *bkTree, termDictionary);
+    std::string query = "ToY, CHILDREN!";
+    queryTree::QueryTree tree = query::processQuery(query, dict, *bkTree, *phrases);
 
     ASSERT_FALSE(tree.getNode(0) == nullptr);
     EXPECT_EQ(tree.getNode(0)->getOperation(), queryTree::QueryOperator::COMBINE);
-    ASSERT_EQ(tree.getNode(1)->getValue(), "hello");
-    ASSERT_EQ(tree.getNode(2)->getValue(), "world");
+    ASSERT_EQ(tree.getNode(1)->getValue(), "toy");
+    ASSERT_EQ(tree.getNode(2)->getValue(), "children");
 }
 
 // Test that an empty query returns an empty result
 TEST_F(QueryTestFixture, ProcessQueryHandlesEmptyInput) {
     std::string query = "";
-    queryTree::QueryTree tree = query::processQuery(query, dict, *bkTree, termDictionary);
+    queryTree::QueryTree tree = query::processQuery(query, dict, *bkTree, *phrases);
     EXPECT_EQ(tree.getNode(0), nullptr);
 }
 
 // Test that processQuery removes only stop words
 TEST_F(QueryTestFixture, ProcessQueryRemovesOnlyStopWords) {
-    std::string query = "the and in on at";
-    queryTree::QueryTree tree = query::processQuery(query, dict, *bkTree, termDictionary);
+    std::string query = "the and in on at hello world";
+    queryTree::QueryTree tree = query::processQuery(query, dict, *bkTree, *phrases);
     EXPECT_EQ(tree.getNode(0), nullptr);
 }
 
 // Test that processQuery handles Unicode input
 TEST_F(QueryTestFixture, ProcessQueryHandlesUnicodeCharacters) {
     std::string query = "你好 世界"; // "Hello World" in Chinese
-    queryTree::QueryTree tree = query::processQuery(query, dict, *bkTree, termDictionary);
+    queryTree::QueryTree tree = query::processQuery(query, dict, *bkTree, *phrases);
+    ASSERT_FALSE(tree.getNode(0) == nullptr);
+}
+
+// Test that wildcard terms survive tokenization uncorrected and unstemmed
+TEST_F(QueryTestFixture, ProcessQueryKeepsWildcards) {
+    std::string query = "Comput* toys";
+    queryTree::QueryTree tree = query::processQuery(query, dict, *bkTree, *phrases);
+
+    ASSERT_FALSE(tree.getNode(0) == nullptr);
+    EXPECT_EQ(tree.getNode(1)->getOperation(), queryTree::QueryOperator::WILDCARD);
+    EXPECT_EQ(tree.getNode(1)->getValue(), "comput*");
+    EXPECT_EQ(tree.getNode(2)->getOperation(), queryTree::QueryOperator::TEXT);
+    EXPECT_EQ(tree.getNode(2)->getValue(), "toy");
+}
+
+// Test that fuzzy terms become FUZZY nodes, stemmed but uncorrected
+TEST_F(QueryTestFixture, ProcessQueryKeepsFuzzyTerms) {
+    std::string query = "Toys~1 colr~9";
+    queryTree::QueryTree tree = query::processQuery(query, dict, *bkTree, *phrases);
+
     ASSERT_FALSE(tree.getNode(0) == nullptr);
+    EXPECT_EQ(tree.getNode(1)->getOperation(), queryTree::QueryOperator::FUZZY);
+    EXPECT_EQ(tree.getNode(1)->getValue(), "toy~1");
+    EXPECT_EQ(tree.getNode(2)->getOperation(), queryTree::QueryOperator::FUZZY);
+    EXPECT_EQ(tree.getNode(2)->getValue(), "colr~9");
+    EXPECT_EQ(queryTree::splitFuzzy(tree.getNode(2)->getValue()),
+              (std::pair<std::string_view, int>{"colr", queryTree::MAX_FUZZY_DISTANCE}));
 }
 
 // Test that words without typos remain unchanged and phrases are detected
 TEST_F(QueryTestFixture, ProcessQueryBuildsQueryTreeForPhrases) {
     std::string query = "What are good skis?";
-    queryTree::QueryTree tree = query::processQuery(query, dict, *bkTree, termDictionary);
+    queryTree::QueryTree tree = query::processQuery(query, dict, *bkTree, *phrases);
 
     ASSERT_FALSE(tree.getNode(0) == nullptr);
     EXPECT_EQ(tree.getNode(0)->getOperation(), queryTree::QueryOperator::COMBINE);
@@ -1,10 +1,17 @@
 #include "../include/query-processing/queryTree.h"
+#include "../include/query-processing/phraseMatcher.h"
+#include "../include/query-processing/synonyms.h"
+#include "../include/index/Lexicon.h"
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <memory>
 #include <sstream>
+#include <vector>
 
 class QueryTreeTest : public ::testing::Test {
 protected:
     queryTree::TermDictionary termDictionary;
+    std::unique_ptr<queryTree::PhraseMatcher> phrases;
     queryTree::TokenList tokens;
 
     void SetUp() override {
@@ -12,6 +19,7 @@ protected:
         termDictionary = {
             {"good skis", {}},  // Ensures "good skis" is detected as a phrase
         };
+        phrases = std::make_unique<queryTree::PhraseMatcher>(termDictionary);
 
         // Sample processed query tokens (unaltered)
         tokens = {"good", "skis"};
@@ -20,7 +28,7 @@ protected:
 
 // Test building a query tree with phrase and term weighting
 TEST_F(QueryTreeTest, BuildQueryTreeBasic) {
-    queryTree::QueryTree tree(tokens, termDictionary);
+    queryTree::QueryTree tree(tokens, *phrases);
 
     // Check root node
     const auto* root = tree.getNode(0);
@@ -47,7 +55,7 @@ TEST_F(QueryTreeTest, BuildQueryTreeBasic) {
 }
 
 TEST_F(QueryTreeTest, TraverseQueryTreeWithDepthHelper) {
-    queryTree::QueryTree tree(tokens, termDictionary);
+    queryTree::QueryTree tree(tokens, *phrases);
     std::ostringstream oss;
 
     tree.forEachNodeWithDepth([&](const queryTree::QueryNode& node, int depth) {
@@ -82,7 +90,7 @@ TEST_F(QueryTreeTest, TraverseQueryTreeWithDepthHelper) {
 
 // Test printing the query tree
 TEST_F(QueryTreeTest, PrintsQueryTreeStructure) {
-    queryTree::QueryTree tree(tokens, termDictionary);
+    queryTree::QueryTree tree(tokens, *phrases);
 
     std::ostringstream oss;
     oss << tree;
@@ -95,3 +103,196 @@ TEST_F(QueryTreeTest, PrintsQueryTreeStructure) {
 
     EXPECT_EQ(oss.str(), expected);
 }
+
+// Test resolving term nodes to term ids and document frequencies
+TEST_F(QueryTreeTest, ResolveTermsAgainstLexicon) {
+    std::string path = "./temp_query_tree_lexicon";
+    LexiconBuilder builder;
+    builder.add("good", 7, 1.0f);
+    builder.add("skis", 3, 1.0f);
+    builder.add("snow", 5, 1.0f);
+    builder.write(path);
+    Lexicon lexicon(path);
+
+    queryTree::QueryTree tree({"good", "skis", "snow", "avalanche", "sno*"}, *phrases);
+    EXPECT_EQ(tree.getNode(1)->getTermId(), queryTree::UNKNOWN_TERM);  // unresolved
+    EXPECT_EQ(tree.resolveTerms(lexicon), 1u);
+
+    for (const queryTree::QueryNode& node : *tree.getNodes()) {
+        if (node.getOperation() != queryTree::QueryOperator::TEXT) {
+            EXPECT_EQ(node.getTermId(), queryTree::UNKNOWN_TERM) << node.getValue();
+            continue;
+        }
+        auto info = lexicon.find(node.getValue());
+        if (info) {
+            EXPECT_EQ(node.getTermId(), info->id) << node.getValue();
+            EXPECT_EQ(node.getDocFrequency(), info->df) << node.getValue();
+        } else {
+            EXPECT_EQ(node.getValue(), "avalanche");
+            EXPECT_EQ(node.getTermId(), queryTree::UNKNOWN_TERM);
+            EXPECT_EQ(node.getDocFrequency(), 0u);
+        }
+    }
+    std::remove(path.c_str());
+}
+
+// Test that parents and depths are set at construction, with phrases and terms mixed
+TEST_F(QueryTreeTest, StoresParentsAndDepths) {
+    queryTree::QueryTree tree({"good", "skis", "wax"}, *phrases);
+    ASSERT_EQ(tree.getNodes()->size(), 5u);
+
+    EXPECT_EQ(tree.getNode(0)->getParentIndex(), -1);
+    EXPECT_EQ(tree.getNode(0)->getDepth(), 0);
+    EXPECT_EQ(tree.getNode(1)->getParentIndex(), 0);   // #od
+    EXPECT_EQ(tree.getNode(1)->getDepth(), 1);
+    EXPECT_EQ(tree.getNode(2)->getParentIndex(), 1);   // good
+    EXPECT_EQ(tree.getNode(3)->getParentIndex(), 1);   // skis
+    EXPECT_EQ(tree.getNode(3)->getDepth(), 2);
+    EXPECT_EQ(tree.getNode(4)->getParentIndex(), 0);   // wax
+    EXPECT_EQ(tree.getNode(4)->getDepth(), 1);
+
+    std::ostringstream oss;
+    oss << tree;
+    EXPECT_EQ(oss.str(),
+              "#combine\n"
+              "  #od\n"
+              "    #text:good\n"
+              "    #text:skis\n"
+              "  #text:wax\n");
+}
+
+// Test that pre-order visits parents first and post-order visits them last
+TEST_F(QueryTreeTest, PreAndPostOrderTraversal) {
+    queryTree::QueryTree tree({"good", "skis", "wax", "good", "skis"}, *phrases);
+
+    std::vector<int> preOrder, postOrder;
+    tree.forEachPreOrder([&](const queryTree::QueryNode& node) { preOrder.push_back(node.getNodeIndex()); });
+    tree.forEachPostOrder([&](const queryTree::QueryNode& node) { postOrder.push_back(node.getNodeIndex()); });
+
+    // #combine(#od(good skis) #od(good skis) wax)
+    EXPECT_EQ(preOrder, (std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7}));
+    EXPECT_EQ(postOrder, (std::vector<int>{2, 3, 1, 5, 6, 4, 7, 0}));
+
+    queryTree::QueryTree empty(queryTree::TokenList{}, *phrases);
+    int visited = 0;
+    empty.forEachPostOrder([&](const queryTree::QueryNode&) { visited++; });
+    EXPECT_EQ(visited, 0);
+}
+
+// Test that the structural hash ignores term order under #combine only
+TEST_F(QueryTreeTest, StructuralHash) {
+    queryTree::PhraseMatcher noPhrases;
+    auto hash = [&](const queryTree::TokenList& terms, const queryTree::PhraseMatcher& matcher) {
+        return queryTree::QueryTree(terms, matcher).structuralHash();
+    };
+
+    EXPECT_EQ(hash({}, noPhrases), 0u);
+    EXPECT_EQ(hash({"snow", "skis", "wax"}, noPhrases), hash({"wax", "snow", "skis"}, noPhrases));
+    EXPECT_NE(hash({"snow", "skis"}, noPhrases), hash({"snow", "skis", "skis"}, noPhrases));
+    EXPECT_NE(hash({"snow", "skis"}, noPhrases), hash({"snow", "ski"}, noPhrases));
+    EXPECT_NE(hash({"sno*", "skis"}, noPhrases), hash({"sno", "skis"}, noPhrases));
+
+    // A phrase is not the same query as its words, and its words keep their order.
+    EXPECT_NE(hash({"good", "skis"}, *phrases), hash({"good", "skis"}, noPhrases));
+    EXPECT_EQ(hash({"wax", "good", "skis"}, *phrases), hash({"good", "skis", "wax"}, *phrases));
+    queryTree::PhraseMatcher both(queryTree::TermDictionary{{"good skis", {}}, {"skis good", {}}});
+    EXPECT_NE(hash({"good", "skis"}, both), hash({"skis", "good"}, both));
+}
+
+// Test that phrases longer than two words become one OD node
+TEST_F(QueryTreeTest, BuildsNodesForLongPhrases) {
+    queryTree::PhraseMatcher longPhrases(queryTree::TermDictionary{{"new york city", {}}, {"new york", {}}});
+    queryTree::QueryTree tree({"cheap", "new", "york", "city", "hotels"}, longPhrases);
+
+    std::ostringstream oss;
+    oss << tree;
+    EXPECT_EQ(oss.str(),
+              "#combine\n"
+              "  #od\n"
+              "    #text:new\n"
+              "    #text:york\n"
+              "    #text:city\n"
+              "  #text:cheap\n"
+              "  #text:hotels\n");
+    EXPECT_EQ(tree.getNode(1)->getValue(), "new york city");
+    EXPECT_EQ(tree.getNode(1)->getChildCount(), 3);
+    EXPECT_EQ(tree.getNode(4)->getParentIndex(), 1);
+}
+
+// Test that terms with synonyms become SYNONYM nodes and phrase terms do not
+TEST_F(QueryTreeTest, ExpandsSynonyms) {
+    synonyms::SynonymDictionary dictionary;
+    dictionary.addGroup({"skis", "snowboards"});
+    dictionary.addGroup({"cheap", "budget", "inexpensive"});
+
+    queryTree::QueryTree tree({"cheap", "good", "skis", "rental", "skis"}, *phrases);
+    uint64_t before = tree.structuralHash();
+    EXPECT_EQ(tree.expandSynonyms(dictionary), 2u);
+
+    std::ostringstream oss;
+    oss << tree;
+    EXPECT_EQ(oss.str(),
+              "#combine\n"
+              "  #od\n"
+              "    #text:good\n"
+              "    #text:skis\n"
+              "  #syn\n"
+              "    #text:cheap\n"
+              "    #text:budget\n"
+              "    #text:inexpensive\n"
+              "  #text:rental\n"
+              "  #syn\n"
+              "    #text:skis\n"
+              "    #text:snowboards\n");
+    EXPECT_NE(tree.structuralHash(), before);
+
+    const queryTree::QueryNode* synonym = tree.getNode(4);
+    EXPECT_EQ(synonym->getValue(), "#syn:budget,cheap,inexpensive");
+    EXPECT_EQ(synonym->getChildStart(), 5);
+    EXPECT_EQ(synonym->getChildCount(), 3);
+    EXPECT_EQ(tree.getNode(7)->getParentIndex(), 4);
+    EXPECT_EQ(tree.getNode(7)->getDepth(), 2);
+    EXPECT_EQ(tree.getNode(0)->getChildCount(), 4);
+    EXPECT_EQ(tree.getNode(8)->getParentIndex(), 0);
+
+    // The members' order under #syn does not matter.
+    queryTree::QueryTree other({"budget", "good", "skis", "rental", "snowboards"}, *phrases);
+    other.expandSynonyms(dictionary);
+    EXPECT_EQ(other.structuralHash(), tree.structuralHash());
+    EXPECT_EQ(tree.expandSynonyms(synonyms::SynonymDictionary{}), 0u);
+}
+
+// Test that a SYNONYM node resolves to its merged list when the index has one
+TEST_F(QueryTreeTest, ResolvesMergedSynonyms) {
+    synonyms::SynonymDictionary dictionary;
+    dictionary.addGroup({"skis", "snowboards"});
+    dictionary.addGroup({"wax", "polish"});
+
+    std::string path = "./temp_query_tree_synonym_lexicon";
+    LexiconBuilder builder;
+    builder.add(dictionary.mergedTerm(0), 9, 1.0f);
+    builder.add("skis", 4, 1.0f);
+    builder.add("snowboards", 6, 1.0f);
+    builder.add("wax", 2, 1.0f);
+    builder.write(path);
+    Lexicon lexicon(path);
+
+    queryTree::QueryTree tree({"skis", "wax"}, queryTree::PhraseMatcher{});
+    tree.expandSynonyms(dictionary);
+    EXPECT_EQ(tree.resolveTerms(lexicon), 0u);  // "polish" is missing, but "wax" stands in
+
+    synonyms::SynonymDictionary unindexed;
+    unindexed.addGroup({"boots", "bindings"});
+    queryTree::QueryTree missing({"boots", "wax"}, queryTree::PhraseMatcher{});
+    missing.expandSynonyms(unindexed);
+    EXPECT_EQ(missing.resolveTerms(lexicon), 1u);  // no member of the group is indexed
+
+    const queryTree::QueryNode* merged = tree.getNode(1);
+    ASSERT_EQ(merged->getOperation(), queryTree::QueryOperator::SYNONYM);
+    EXPECT_EQ(merged->getTermId(), lexicon.find(dictionary.mergedTerm(0))->id);
+    EXPECT_EQ(merged->getDocFrequency(), 9u);
+    const queryTree::QueryNode* unmerged = tree.getNode(4);
+    ASSERT_EQ(unmerged->getOperation(), queryTree::QueryOperator::SYNONYM);
+    EXPECT_EQ(unmerged->getTermId(), queryTree::UNKNOWN_TERM);
+    std::remove(path.c_str());
+}
@@ -1,5 +1,233 @@
 #include <gtest/gtest.h>
 #include "../include/query-processing/stemmer.h"
+#include <cctype>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The previous string-based implementation, kept to check that the in-place
+// stemmer produces identical output.
+namespace reference {
+
+bool isConsonant(const std::string &word, int i) {
+    char ch = word[i];
+    switch (ch) {
+        case 'a': case 'e': case 'i': case 'o': case 'u':
+            return false;
+        case 'y':
+            return (i == 0) ? true : !isConsonant(word, i - 1);
+        default:
+            return true;
+    }
+}
+
+int measure(const std::string &word) {
+    int count = 0;
+    int i = 0;
+    int n = word.size();
+    // Skip initial consonants.
+    while (i < n && isConsonant(word, i))
+        i++;
+    while (i < n) {
+        // Skip a sequence of vowels.
+        while (i < n && !isConsonant(word, i))
+            i++;
+        count++;
+        // Skip a sequence of consonants.
+        while (i < n && isConsonant(word, i))
+            i++;
+    }
+    return count;
+}
+
+bool containsVowel(const std::string &word) {
+    for (size_t i = 0; i < word.size(); ++i) {
+        if (!isConsonant(word, i))
+            return true;
+    }
+    return false;
+}
+
+bool endsWith(const std::string &word, const std::string &suffix) {
+    if (word.size() < suffix.size())
+        return false;
+    return word.compare(
+        word.size() - suffix.size(), suffix.size(), suffix
+    ) == 0;
+}
+
+bool cvc(const std::string &word) {
+    int n = word.size();
+    if (n < 3)
+        return false;
+    if (!isConsonant(word, n - 3) || !(!isConsonant(word, n - 2))
+        || !isConsonant(word, n - 1))
+        return false;
+    char ch = word[n - 1];
+    if (ch == 'w' || ch == 'x' || ch == 'y')
+        return false;
+    return true;
+}
+
+void step1a(std::string &word) {
+    if (endsWith(word, "sses")) {
+        word.replace(word.size() - 4, 4, "ss");
+    } else if (endsWith(word, "ies")) {
+        word.replace(word.size() - 3, 3, "i");
+    } else if (endsWith(word, "ss")) {
+        // do nothing
+    } else if (endsWith(word, "s")) {
+        word.erase(word.size() - 1);
+    }
+}
+
+void step1b(std::string &word) {
+    bool flag = false;
+    if (endsWith(word, "eed")) {
+        std::string stem = word.substr(0, word.size() - 3);
+        if (measure(stem) > 0) {
+            word.replace(word.size() - 3, 3, "ee");
+        }
+    } else if ((endsWith(word, "ed") && 
+                containsVowel(word.substr(0, word.size() - 2))) ||
+               (endsWith(word, "ing") && 
+                containsVowel(word.substr(0, word.size() - 3)))) {
+        if (endsWith(word, "ed"))
+            word.erase(word.size() - 2);
+        else
+            word.erase(word.size() - 3);
+        flag = true;
+    }
+    if (flag) {
+        if (endsWith(word, "at") || endsWith(word, "bl")
+            || endsWith(word, "iz")) {
+            word.push_back('e');
+        } else if (word.size() >= 2 &&
+                   word[word.size() - 1] == word[word.size() - 2] &&
+                   word[word.size() - 1] != 'l' &&
+                   word[word.size() - 1] != 's' &&
+                   word[word.size() - 1] != 'z') {
+            word.erase(word.size() - 1);
+        } else if (measure(word) == 1 && cvc(word)) {
+            word.push_back('e');
+        }
+    }
+}
+
+void step1c(std::string &word) {
+    if (endsWith(word, "y") && word.size() > 1 && isConsonant(word, word.size() - 2)) {
+        word[word.size() - 1] = 'i';
+    }
+}
+
+void step2(std::string &word) {
+    struct SuffixRule {
+        const char *suffix;
+        const char *replacement;
+    };
+    SuffixRule rules[] = {
+        {"ational", "ate"}, {"tional", "tion"}, {"enci", "ence"},
+        {"anci", "ance"},   {"izer", "ize"},   {"abli", "able"},
+        {"alli", "al"},     {"entli", "ent"},  {"eli", "e"},
+        {"ousli", "ous"},   {"ization", "ize"},{"ation", "ate"},
+        {"ator", "ate"},    {"alism", "al"},   {"iveness", "ive"},
+        {"fulness", "ful"}, {"ousness", "ous"},{"aliti", "al"},
+        {"iviti", "ive"},   {"biliti", "ble"}
+    };
+    for (auto &rule : rules) {
+        std::string suffix(rule.suffix);
+        if (endsWith(word, suffix)) {
+            std::string stem = word.substr(0, word.size() - suffix.size());
+            if (measure(stem) > 0) {
+                word.replace(
+                    word.size() - suffix.size(), suffix.size(), rule.replacement
+                );
+            }
+            break;
+        }
+    }
+}
+
+void step3(std::string &word) {
+    struct SuffixRule {
+        const char *suffix;
+        const char *replacement;
+    };
+    SuffixRule rules[] = {
+        {"icate", "ic"}, {"ative", ""}, {"alize", "al"},
+        {"iciti", "ic"}, {"ical", "ic"}, {"ful", ""},
+        {"ness", ""}
+    };
+    for (auto &rule : rules) {
+        std::string suffix(rule.suffix);
+        if (endsWith(word, suffix)) {
+            std::string stem = word.substr(0, word.size() - suffix.size());
+            if (measure(stem) > 0) {
+                word.replace(
+                    word.size() - suffix.size(), suffix.size(), rule.replacement
+                );
+            }
+            break;
+        }
+    }
+}
+
+void step4(std::string &word) {
+    const char* suffixes[] = {
+        "al", "ance", "ence", "er", "ic", "able", "ible",
+        "ant", "ement", "ment", "ent", "ion", "ou", "ism",
+        "ate", "iti", "ous", "ive", "ize"
+    };
+    for (auto s : suffixes) {
+        std::string suffix(s);
+        if (endsWith(word, suffix)) {
+            std::string stem = word.substr(0, word.size() - suffix.size());
+            if (measure(stem) > 1) {
+                if (std::string(s) == "ion") {
+                    if (!stem.empty() && (stem.back() == 's' || stem.back() == 't'))
+                        word.erase(word.size() - suffix.size());
+                } else {
+                    word.erase(word.size() - suffix.size());
+                }
+                break;
+            }
+        }
+    }
+}
+
+void step5(std::string &word) {
+    // Step 5a: Remove trailing 'e'
+    if (endsWith(word, "e")) {
+        std::string stem = word.substr(0, word.size() - 1);
+        int m = measure(stem);
+        if (m > 1 || (m == 1 && !cvc(stem)))
+            word.erase(word.size() - 1);
+    }
+    // Step 5b: Remove double 'l' if measure > 1.
+    if (measure(word) > 1 && word.size() >= 2 &&
+        word[word.size() - 1] == 'l' && word[word.size() - 2] == 'l') {
+        word.erase(word.size() - 1);
+    }
+}
+
+std::string stem(const std::string &input) {
+    std::string word = input;
+    if (word.size() <= 2)
+        return word; // Too short to stem reliably.
+    step1a(word);
+    step1b(word);
+    step1c(word);
+    step2(word);
+    step3(word);
+    step4(word);
+    step5(word);
+    return word;
+}
+
+} // namespace reference
 
 // Test fixture for the stemmer
 class StemmerTest : public ::testing::Test {
@@ -54,3 +282,114 @@ TEST_F(StemmerTest, ShortWords) {
     EXPECT_EQ(stem("a"), "a");
     EXPECT_EQ(stem("it"), "it");
 }
+
+// Test the in-place interface, including words past the stack buffer
+TEST_F(StemmerTest, StemInPlace) {
+    char word[] = "relational";
+    EXPECT_EQ(std::string(word, stemmer::stemInPlace(word, 10)), "relat");
+
+    std::string longWord(100, 'b');
+    longWord += "ational";
+    EXPECT_EQ(stemmer::stem(longWord), reference::stem(longWord));
+}
+
+// Random words built from the suffixes every step looks for.
+static std::vector<std::string> generateWords(size_t count, unsigned seed) {
+    static const char* suffixes[] = {
+        "", "s", "ss", "sses", "ies", "eed", "ed", "ing", "y", "e", "ll", "at", "bl", "iz",
+        "ational", "tional", "enci", "anci", "izer", "abli", "alli", "entli", "eli", "ousli",
+        "ization", "ation", "ator", "alism", "iveness", "fulness", "ousness", "aliti", "iviti",
+        "biliti", "icate", "ative", "alize", "iciti", "ical", "ful", "ness", "al", "ance",
+        "ence", "er", "ic", "able", "ible", "ant", "ement", "ment", "ent", "sion", "tion", "ion",
+        "ou", "ism", "ate", "iti", "ous", "ive", "ize", "ings", "ations", "fully", "ly"};
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> syllables(0, 4);
+    std::uniform_int_distribution<size_t> suffix(0, std::size(suffixes) - 1);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::uniform_int_distribution<int> vowel(0, 5);
+    std::vector<std::string> words;
+    words.reserve(count);
+    while (words.size() < count) {
+        std::string word;
+        for (int i = syllables(gen); i >= 0; --i) {
+            word += static_cast<char>(letter(gen));
+            word += "aeiouy"[vowel(gen)];
+            if (vowel(gen) < 2) word += static_cast<char>(letter(gen));
+        }
+        word += suffixes[suffix(gen)];
+        if (suffix(gen) < 6) word += suffixes[suffix(gen)];
+        words.push_back(word);
+    }
+    return words;
+}
+
+// Test that concurrent cache users all get the stems stem() computes
+TEST_F(StemmerTest, StemCacheConcurrentUse) {
+    std::vector<std::string> words = generateWords(20000, 8);
+    stemmer::StemCache cache(5000, 8);  // small enough to be cleared while in use
+
+    std::vector<int> mismatches(4, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int round = 0; round < 3; ++round) {
+                for (size_t i = t; i < words.size(); i += 2) {
+                    mismatches[t] += cache.stem(words[i]) != stem(words[i]);
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    for (int count : mismatches) EXPECT_EQ(count, 0);
+    EXPECT_GT(cache.size(), 0u);
+    EXPECT_LE(cache.size(), 5000u);
+    EXPECT_EQ(stemmer::StemCache(0).stem("running"), "run");
+}
+
+// Performance test: identical output to the previous implementation, and throughput
+TEST_F(StemmerTest, PerformanceTest_MatchesReference) {
+    std::vector<std::string> words = generateWords(300000, 1);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::string> expected;
+    expected.reserve(words.size());
+    for (const std::string& word : words) expected.push_back(reference::stem(word));
+    auto end = std::chrono::high_resolution_clock::now();
+    double referenceTime = std::chrono::duration<double>(end - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    std::vector<std::string> actual;
+    actual.reserve(words.size());
+    for (const std::string& word : words) actual.push_back(stem(word));
+    end = std::chrono::high_resolution_clock::now();
+    double inPlaceTime = std::chrono::duration<double>(end - start).count();
+
+    // A token stream repeats words: draw from a small vocabulary, most often its head.
+    std::mt19937 gen(2);
+    std::geometric_distribution<size_t> rank(0.001);
+    std::vector<const std::string*> stream;
+    for (size_t i = 0; i < words.size(); ++i) stream.push_back(&words[rank(gen) % 20000]);
+    stemmer::StemCache cache;
+    start = std::chrono::high_resolution_clock::now();
+    size_t cachedLength = 0;
+    for (const std::string* word : stream) cachedLength += cache.stem(*word).size();
+    end = std::chrono::high_resolution_clock::now();
+    double cacheTime = std::chrono::duration<double>(end - start).count();
+
+    size_t differences = 0;
+    for (size_t i = 0; i < words.size(); ++i) {
+        if (actual[i] != expected[i] && differences++ < 10) {
+            ADD_FAILURE() << words[i] << ": " << actual[i] << " != " << expected[i];
+        }
+    }
+
+    std::cout << "PerformanceTest: " << words.size() << " words, " << differences << " differences" << std::endl;
+    std::cout << "  previous stemmer: " << words.size() / referenceTime / 1e6 << " M words/sec" << std::endl;
+    std::cout << "  in-place stemmer: " << words.size() / inPlaceTime / 1e6 << " M words/sec" << std::endl;
+    std::cout << "  cached, repeating token stream: " << stream.size() / cacheTime / 1e6 << " M words/sec"
+              << std::endl;
+
+    EXPECT_EQ(differences, 0u);
+    EXPECT_GT(cachedLength, 0u);
+}
@@ -0,0 +1,100 @@
+#include "../include/query-processing/stopwords.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Test words from stopwords.txt, including ones normalized like tokens
+TEST(StopwordsTest, BuiltInList) {
+    for (const char* word : {"the", "a", "and", "what", "0o", "zz", "hello", "world", "youve", "aint", "etal"}) {
+        EXPECT_TRUE(stopwords::isStopWord(word)) << word;
+    }
+    for (const char* word : {"", "ain't", "The", "computer", "toy", "zzz", "zebra", "people"}) {
+        EXPECT_FALSE(stopwords::isStopWord(word)) << word;
+    }
+}
+
+// Test that every word of a runtime list is found and other words are not
+TEST(StopwordsTest, RuntimeSetMatchesHashSet) {
+    std::mt19937 gen(21);
+    std::uniform_int_distribution<size_t> len(1, 8);
+    std::uniform_int_distribution<int> letter('a', 'e');
+    auto randomWord = [&]() {
+        std::string word(len(gen), ' ');
+        for (char& c : word) c = static_cast<char>(letter(gen));
+        return word;
+    };
+
+    std::unordered_set<std::string> expected;
+    while (expected.size() < 3000) expected.insert(randomWord());
+    stopwords::StopwordSet set(std::vector<std::string>(expected.begin(), expected.end()));
+    EXPECT_EQ(set.size(), expected.size());
+
+    for (const std::string& word : expected) ASSERT_TRUE(set.contains(word)) << word;
+    for (int i = 0; i < 20000; ++i) {
+        std::string word = randomWord();
+        ASSERT_EQ(set.contains(word), expected.count(word) > 0) << word;
+    }
+}
+
+// Test loading both list formats, with normalization and duplicates
+TEST(StopwordsTest, LoadFromFile) {
+    std::string path = "./temp_stopwords.txt";
+    std::ofstream(path) << "\"Foo\", \"bar\", \"it's\"\nbaz\nfoo\n";
+    stopwords::StopwordSet set = stopwords::StopwordSet::load(path);
+    std::remove(path.c_str());
+
+    EXPECT_EQ(set.size(), 4u);
+    for (const char* word : {"foo", "bar", "its", "baz"}) EXPECT_TRUE(set.contains(word)) << word;
+    EXPECT_FALSE(set.contains("the"));
+
+    EXPECT_FALSE(stopwords::StopwordSet({}).contains("the"));
+    EXPECT_THROW(stopwords::StopwordSet::load("./missing_stopwords.txt"), std::runtime_error);
+}
+
+// Performance test: perfect hash lookups against std::unordered_set<std::string>
+TEST(StopwordsTest, PerformanceTest_Lookups) {
+    std::mt19937 gen(4);
+    std::uniform_int_distribution<size_t> len(1, 10);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::vector<std::string> tokens;
+    for (int i = 0; i < 1000000; ++i) {
+        if (i % 3 == 0) {
+            tokens.push_back(i % 2 ? "the" : "which");
+            continue;
+        }
+        std::string word(len(gen), ' ');
+        for (char& c : word) c = static_cast<char>(letter(gen));
+        tokens.push_back(word);
+    }
+    const std::unordered_set<std::string> hashSet = {"the", "of", "to", "a", "and", "in", "said", "for",
+        "that", "was", "on", "he", "is", "with", "at", "by", "it", "from", "as", "be", "were", "an",
+        "have", "his", "but", "has", "are", "not", "who", "they", "its", "had", "will", "would",
+        "about", "i", "been", "this", "their", "new", "or", "which", "we", "more", "after", "us",
+        "percent", "up", "one", "people", "what"};
+
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t hashSetHits = 0;
+    for (const std::string& token : tokens) hashSetHits += hashSet.count(std::string(std::string_view(token)));
+    auto end = std::chrono::high_resolution_clock::now();
+    double hashSetTime = std::chrono::duration<double, std::nano>(end - start).count() / tokens.size();
+
+    start = std::chrono::high_resolution_clock::now();
+    size_t perfectHashHits = 0;
+    for (const std::string& token : tokens) perfectHashHits += stopwords::isStopWord(token);
+    end = std::chrono::high_resolution_clock::now();
+    double perfectHashTime = std::chrono::duration<double, std::nano>(end - start).count() / tokens.size();
+
+    std::cout << "PerformanceTest: " << tokens.size() << " lookups" << std::endl;
+    std::cout << "  unordered_set<string> (51 words): " << hashSetTime << " ns per lookup" << std::endl;
+    std::cout << "  perfect hash (stopwords.txt):     " << perfectHashTime << " ns per lookup" << std::endl;
+
+    EXPECT_GE(perfectHashHits, tokens.size() / 3);
+    EXPECT_GE(hashSetHits, tokens.size() / 3);
+}
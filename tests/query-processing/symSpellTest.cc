@@ -0,0 +1,174 @@
+#include "../include/query-processing/symSpell.h"
+#include "../include/query-processing/bkTree.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+class SymSpellTest : public ::testing::Test {
+protected:
+    std::string path = "./temp_symspell_index";
+    spell::SymSpell::Frequencies frequencies = {
+        {"apple", 5}, {"banana", 3}, {"orange", 2}, {"grape", 1}, {"pineapple", 1},
+        {"card", 10}, {"cart", 1}};
+
+    void TearDown() override {
+        std::remove(path.c_str());
+    }
+};
+
+// Test the same corrections the BK-tree makes
+TEST_F(SymSpellTest, FindClosestWordWithThreshold) {
+    spell::SymSpell::build(frequencies, path);
+    spell::SymSpell corrector(path);
+    EXPECT_EQ(corrector.size(), frequencies.size());
+    EXPECT_EQ(corrector.maxDistance(), 2);
+
+    EXPECT_EQ(corrector.findClosest("appl", 2), "apple");
+    EXPECT_EQ(corrector.findClosest("banan", 2), "banana");
+    EXPECT_EQ(corrector.findClosest("orang", 2), "orange");
+    EXPECT_EQ(corrector.findClosest("apple", 1), "apple");
+    EXPECT_EQ(corrector.findClosest("xyz", 1), "xyz");
+    EXPECT_EQ(corrector.findClosest("", 2), "");
+}
+
+// Test that ties on distance go to the more frequent word
+TEST_F(SymSpellTest, PrefersFrequentWords) {
+    spell::SymSpell::build(frequencies, path);
+    spell::SymSpell corrector(path);
+    EXPECT_EQ(corrector.findClosest("carx", 1), "card");
+    EXPECT_EQ(corrector.findClosest("cartt", 1), "cart");  // closer wins over frequency
+}
+
+// Test that thresholds above the indexed distance are clamped
+TEST_F(SymSpellTest, ThresholdClampedToIndexDistance) {
+    spell::SymSpell::build(frequencies, path, 1);
+    spell::SymSpell corrector(path);
+    EXPECT_EQ(corrector.findClosest("aple", 5), "apple");
+    EXPECT_EQ(corrector.findClosest("apl", 5), "apl");
+}
+
+// Test that a file that is not an index is rejected
+TEST_F(SymSpellTest, RejectsCorruptIndex) {
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << std::string(200, 'x');
+    }
+    EXPECT_THROW(spell::SymSpell corrector(path), std::runtime_error);
+    EXPECT_THROW(spell::SymSpell corrector("./missing_symspell_index"), std::runtime_error);
+}
+
+// Plain dynamic programming edit distance, for checking answers.
+static int referenceDistance(const std::string& a, const std::string& b) {
+    std::vector<int> prev(b.size() + 1), curr(b.size() + 1);
+    for (size_t j = 0; j <= b.size(); ++j) prev[j] = j;
+    for (size_t i = 1; i <= a.size(); ++i) {
+        curr[0] = i;
+        for (size_t j = 1; j <= b.size(); ++j) {
+            curr[j] = std::min({prev[j] + 1, curr[j - 1] + 1, prev[j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1)});
+        }
+        std::swap(prev, curr);
+    }
+    return prev[b.size()];
+}
+
+// Test that the best word by (distance, frequency) is always found
+TEST_F(SymSpellTest, FindClosestMatchesBruteForce) {
+    std::mt19937 gen(9);
+    std::uniform_int_distribution<size_t> len(1, 9);
+    std::uniform_int_distribution<int> letter('a', 'f');
+    std::uniform_int_distribution<uint32_t> count(1, 1000);
+    auto randomWord = [&]() {
+        std::string word(len(gen), ' ');
+        for (char& c : word) c = static_cast<char>(letter(gen));
+        return word;
+    };
+
+    spell::SymSpell::Frequencies words;
+    while (words.size() < 1500) words[randomWord()] = count(gen);
+    spell::SymSpell::build(words, path);
+    spell::SymSpell corrector(path);
+
+    for (int i = 0; i < 300; ++i) {
+        std::string query = randomWord();
+        for (int threshold = 0; threshold <= 2; ++threshold) {
+            int best = threshold + 1;
+            uint32_t bestCount = 0;
+            for (const auto& [word, frequency] : words) {
+                int d = referenceDistance(query, word);
+                if (d < best || (d == best && frequency > bestCount)) {
+                    best = d;
+                    bestCount = frequency;
+                }
+            }
+            std::string found = corrector.findClosest(query, threshold);
+            if (best <= threshold) {
+                ASSERT_TRUE(words.count(found)) << query << " -> " << found;
+                EXPECT_EQ(referenceDistance(query, found), best) << query;
+                EXPECT_EQ(words[found], bestCount) << query << " -> " << found;
+            } else {
+                EXPECT_EQ(found, query);
+            }
+        }
+    }
+}
+
+// Performance test: SymSpell against the BK-tree on the same dictionary
+TEST_F(SymSpellTest, PerformanceTest_CompareWithBKTree) {
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<size_t> len(4, 12);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    bk::Dictionary dict;
+    spell::SymSpell::Frequencies words;
+    while (dict.size() < 100000) {
+        std::string word(len(gen), ' ');
+        for (char& c : word) c = static_cast<char>(letter(gen));
+        dict.insert(word);
+        words[word] = 1;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    spell::SymSpell::build(words, path);
+    spell::SymSpell symSpell(path);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> symSpellBuild = end - start;
+
+    start = std::chrono::high_resolution_clock::now();
+    bk::BKTree tree(dict);
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> treeBuild = end - start;
+
+    std::vector<std::string> queries;
+    for (auto it = dict.begin(); queries.size() < 500; ++it) {
+        std::string query = *it;
+        query[query.size() / 2] = query[query.size() / 2] == 'z' ? 'a' : query[query.size() / 2] + 1;
+        if (!dict.count(query)) queries.push_back(query);
+    }
+
+    auto timeLookups = [&](const spell::SpellingCorrector& corrector, size_t& corrected) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (const std::string& query : queries) {
+            corrected += corrector.findClosest(query, 2) != query;
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::micro>(end - start).count() / queries.size();
+    };
+    size_t symSpellCorrected = 0, treeCorrected = 0;
+    double symSpellLatency = timeLookups(symSpell, symSpellCorrected);
+    double treeLatency = timeLookups(tree, treeCorrected);
+
+    std::cout << "PerformanceTest: " << dict.size() << " words, distance 2" << std::endl;
+    std::cout << "  SymSpell: built in " << symSpellBuild.count() << " s, " << symSpell.memoryUsage() / 1024
+              << " KiB mapped, findClosest averaged " << symSpellLatency << " microseconds" << std::endl;
+    std::cout << "  BK-tree:  built in " << treeBuild.count() << " s, " << tree.memoryUsage() / 1024
+              << " KiB, findClosest averaged " << treeLatency << " microseconds" << std::endl;
+
+    EXPECT_EQ(symSpellCorrected, queries.size());
+    EXPECT_EQ(treeCorrected, queries.size());
+}
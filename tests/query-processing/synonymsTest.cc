@@ -0,0 +1,66 @@
+#include "../include/query-processing/synonyms.h"
+#include "../include/query-processing/stemmer.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using synonyms::NO_GROUP;
+using synonyms::SynonymDictionary;
+
+// Test that groups are sorted, deduplicated and keep their first terms
+TEST(SynonymsTest, AddsGroups) {
+    SynonymDictionary dictionary;
+    dictionary.addGroup({"car", "auto", "car", "automobil"});
+    dictionary.addGroup({"auto", "vehicl"});  // "auto" is taken, one term left
+    dictionary.addGroup({"run", "jog", ""});
+    ASSERT_EQ(dictionary.size(), 2u);
+
+    EXPECT_EQ(dictionary.groupOf("car"), 0u);
+    EXPECT_EQ(dictionary.groupOf("automobil"), 0u);
+    EXPECT_EQ(dictionary.groupOf("jog"), 1u);
+    EXPECT_EQ(dictionary.groupOf("vehicl"), NO_GROUP);
+    EXPECT_EQ(dictionary.members(0), (std::vector<std::string>{"auto", "automobil", "car"}));
+    EXPECT_EQ(dictionary.mergedTerm(0), "#syn:auto,automobil,car");
+    EXPECT_EQ(dictionary.mergedTerm(1), "#syn:jog,run");
+}
+
+// Test that a loaded file is normalized like query tokens
+TEST(SynonymsTest, LoadsNormalizedGroups) {
+    std::string path = "./temp_synonyms.txt";
+    {
+        std::ofstream file(path);
+        file << "Car, automobiles,AUTO\n"
+             << "running,jogging, new york\n"
+             << "\n"
+             << "lonely\n";
+    }
+    SynonymDictionary dictionary = SynonymDictionary::load(path);
+    std::remove(path.c_str());
+
+    ASSERT_EQ(dictionary.size(), 2u);
+    EXPECT_EQ(dictionary.groupOf(stemmer::stem("automobiles")), dictionary.groupOf("car"));
+    EXPECT_EQ(dictionary.groupOf("auto"), dictionary.groupOf("car"));
+    EXPECT_EQ(dictionary.groupOf(stemmer::stem("jogging")), dictionary.groupOf(stemmer::stem("running")));
+    EXPECT_EQ(dictionary.members(1).size(), 2u);  // "new york" is not one term
+    EXPECT_EQ(dictionary.groupOf("lonely"), NO_GROUP);
+
+    EXPECT_THROW(SynonymDictionary::load("./missing_synonyms.txt"), std::runtime_error);
+}
+
+// Test that groups are ranked by the number of queries using them
+TEST(SynonymsTest, RanksMostQueriedGroups) {
+    SynonymDictionary dictionary;
+    dictionary.addGroup({"car", "auto"});
+    dictionary.addGroup({"run", "jog"});
+    dictionary.addGroup({"big", "larg"});
+
+    std::vector<std::string> log = {
+        "Running shoes", "jogging and running", "car rental", "jog trails", "Cheap autos", "auto car",
+        "snow"};
+    EXPECT_EQ(dictionary.mostQueried(log, 5), (std::vector<uint32_t>{0, 1}));  // 4 and 3 queries
+    EXPECT_EQ(dictionary.mostQueried(log, 1), (std::vector<uint32_t>{0}));
+    EXPECT_TRUE(dictionary.mostQueried({}, 5).empty());
+}
@@ -0,0 +1,161 @@
+#include "../include/query-processing/tokenizer.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static std::vector<std::string> tokens(const std::string& text, bool keepOperators = false) {
+    tokenizer::TokenBuffer buffer;
+    tokenizer::tokenize(text, buffer, keepOperators);
+    return std::vector<std::string>(buffer.begin(), buffer.end());
+}
+
+using Tokens = std::vector<std::string>;
+
+// Test lowercasing, punctuation removal and whitespace splitting
+TEST(TokenizerTest, NormalizesAscii) {
+    EXPECT_EQ(tokens("HeLLo, WoRLD!"), (Tokens{"hello", "world"}));
+    EXPECT_EQ(tokens("  don't\tstop\r\nme-now  "), (Tokens{"dont", "stop", "menow"}));
+    EXPECT_EQ(tokens("R2D2 ... 42"), (Tokens{"r2d2", "42"}));
+    EXPECT_TRUE(tokens("").empty());
+    EXPECT_TRUE(tokens(" \t ?! -- ").empty());
+}
+
+// Test that the 16-byte blocks agree with the scalar path across block boundaries
+TEST(TokenizerTest, LongTokensAndBlockBoundaries) {
+    std::string word(40, 'A');
+    EXPECT_EQ(tokens(word + " x"), (Tokens{std::string(40, 'a'), "x"}));
+    EXPECT_EQ(tokens("ABCDEFGHIJKLMNO!PQRSTUVWXYZ"), (Tokens{"abcdefghijklmnopqrstuvwxyz"}));
+    EXPECT_EQ(tokens("abcdefghijklmno pqrstuvwxyz0123456789"),
+              (Tokens{"abcdefghijklmno", "pqrstuvwxyz0123456789"}));
+}
+
+// Test that wildcards are kept only when asked for, and bare wildcards are dropped
+TEST(TokenizerTest, Wildcards) {
+    EXPECT_EQ(tokens("Comput* c*t", true), (Tokens{"comput*", "c*t"}));
+    EXPECT_EQ(tokens("Comput* c*t"), (Tokens{"comput", "ct"}));
+    EXPECT_EQ(tokens("* ** toys", true), (Tokens{"toys"}));
+    // A bare wildcard ending one 16-byte block, with a space opening the next.
+    EXPECT_EQ(tokens("abcdefghijklmn * abcdefghijklmno", true), (Tokens{"abcdefghijklmn", "abcdefghijklmno"}));
+    EXPECT_EQ(tokens("abcdefghijklm ** abcdefghijklmno", true), (Tokens{"abcdefghijklm", "abcdefghijklmno"}));
+}
+
+// Test that '~' is kept only as the fuzzy suffix of a term, and only when asked for
+TEST(TokenizerTest, FuzzySuffix) {
+    EXPECT_EQ(tokens("Colour~1 colr~5 a~b ~2 x~ c*t~1 a~~1 ~", true),
+              (Tokens{"colour~1", "colr~5", "ab", "2", "x", "c*t1", "a1"}));
+    EXPECT_EQ(tokens("Colour~1 a~b"), (Tokens{"colour1", "ab"}));
+    // Suffixes and stray tildes in the 16-byte block path and across a boundary.
+    EXPECT_EQ(tokens("abcdefghijklmnopqrstu~2 abcdefghijk~lmnop", true),
+              (Tokens{"abcdefghijklmnopqrstu~2", "abcdefghijklmnop"}));
+    EXPECT_EQ(tokens("abcdefghijklmn~1 abcdefghijklmno", true), (Tokens{"abcdefghijklmn~1", "abcdefghijklmno"}));
+}
+
+// Test UTF-8 letters, Latin-1 lowercasing, Unicode spaces and malformed bytes
+TEST(TokenizerTest, Utf8) {
+    EXPECT_EQ(tokens("你好 世界"), (Tokens{"你好", "世界"}));
+    EXPECT_EQ(tokens("CAFÉ Über"), (Tokens{"café", "über"}));
+    EXPECT_EQ(tokens("naïve\xc2\xa0résumé"), (Tokens{"naïve", "résumé"}));      // no-break space
+    EXPECT_EQ(tokens("\xe2\x80\x9cquoted\xe2\x80\x9d \xc2\xbfs\xc3\xad?"),   // “quoted” ¿sí?
+              (Tokens{"quoted", "sí"}));
+    EXPECT_EQ(tokens("ab\xff" "cd \xc3"), (Tokens{"abcd"}));                  // stray and truncated bytes
+    EXPECT_EQ(tokens("\xc0\xaf" "x \xed\xa0\x80y"), (Tokens{"x", "y"}));       // overlong, surrogate
+    EXPECT_EQ(tokens("Ünïcödé in the middle of a long ASCII sentence"),
+              (Tokens{"ünïcödé", "in", "the", "middle", "of", "a", "long", "ascii", "sentence"}));
+}
+
+// Test random ASCII text against splitting and cleaning one token at a time
+TEST(TokenizerTest, MatchesReferenceOnRandomAscii) {
+    std::mt19937 gen(3);
+    const std::string alphabet = "abcXYZ09 \t\n.,!-'*~";
+    std::uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+    std::uniform_int_distribution<size_t> len(0, 80);
+
+    for (int round = 0; round < 2000; ++round) {
+        std::string text(len(gen), ' ');
+        for (char& c : text) c = alphabet[pick(gen)];
+        bool keepOperators = round % 2;
+
+        Tokens expected;
+        std::istringstream stream(text);
+        std::string token;
+        while (stream >> token) {
+            std::string cleaned;
+            for (unsigned char c : token) {
+                if (std::isalnum(c) || (keepOperators && (c == '*' || c == '~'))) {
+                    cleaned += static_cast<char>(std::tolower(c));
+                }
+            }
+            size_t tilde = cleaned.find('~');
+            bool fuzzy = tilde != std::string::npos && tilde > 0 && tilde + 2 == cleaned.size() &&
+                         std::isdigit(static_cast<unsigned char>(cleaned.back())) &&
+                         cleaned.find_first_of("*~") == tilde;
+            if (!fuzzy) cleaned.erase(std::remove(cleaned.begin(), cleaned.end(), '~'), cleaned.end());
+            if (cleaned.find_first_not_of("*~") != std::string::npos) expected.push_back(cleaned);
+        }
+        ASSERT_EQ(tokens(text, keepOperators), expected) << text;
+    }
+}
+
+// Test that a buffer can be reused for shorter and longer texts
+TEST(TokenizerTest, ReusesBuffer) {
+    tokenizer::TokenBuffer buffer;
+    tokenizer::tokenize("one two three four five six seven eight", buffer);
+    EXPECT_EQ(buffer.size(), 8u);
+    tokenizer::tokenize("Nine", buffer);
+    ASSERT_EQ(buffer.size(), 1u);
+    EXPECT_EQ(buffer[0], "nine");
+    tokenizer::tokenize("ten eleven twelve thirteen fourteen fifteen sixteen seventeen eighteen", buffer);
+    EXPECT_EQ(buffer.size(), 9u);
+    EXPECT_EQ(buffer[8], "eighteen");
+}
+
+// Performance test: tokens per second against stream splitting with per-token cleanup
+TEST(TokenizerTest, PerformanceTest_Throughput) {
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<size_t> len(1, 10);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::uniform_int_distribution<int> roll(0, 19);
+    std::string text;
+    size_t words = 0;
+    while (text.size() < (8u << 20)) {
+        std::string word(len(gen), ' ');
+        for (char& c : word) c = static_cast<char>(letter(gen));
+        if (roll(gen) == 0) word[0] = static_cast<char>(std::toupper(word[0]));
+        if (roll(gen) == 0) word += ',';
+        text += word;
+        text += roll(gen) == 0 ? "\n" : " ";
+        ++words;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::istringstream stream(text);
+    std::string token;
+    size_t streamTokens = 0;
+    while (stream >> token) {
+        std::transform(token.begin(), token.end(), token.begin(), [](unsigned char c) { return std::tolower(c); });
+        token.erase(std::remove_if(token.begin(), token.end(), [](unsigned char c) { return !std::isalnum(c); }),
+                    token.end());
+        streamTokens += !token.empty();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> streamTime = end - start;
+
+    tokenizer::TokenBuffer buffer;
+    start = std::chrono::high_resolution_clock::now();
+    tokenizer::tokenize(text, buffer);
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> tokenizerTime = end - start;
+
+    std::cout << "PerformanceTest: " << text.size() / (1 << 20) << " MiB, " << words << " words" << std::endl;
+    std::cout << "  istringstream: " << streamTokens / streamTime.count() / 1e6 << " M tokens/sec" << std::endl;
+    std::cout << "  tokenizer:     " << buffer.size() / tokenizerTime.count() / 1e6 << " M tokens/sec" << std::endl;
+
+    EXPECT_EQ(buffer.size(), words);
+    EXPECT_EQ(streamTokens, words);
+}
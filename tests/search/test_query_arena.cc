@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+
+#include "index/IDatabase.h"
+#include "index/Lexicon.h"
+#include "query-processing/query.h"
+#include "query-processing/queryResources.h"
+#include "search/QueryArena.h"
+#include "search/searcher.h"
+#include "search/weight.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Global allocations made by the current thread while counting is on. The
+// replacement operator new is shared by the whole test binary but only
+// counts inside the steady-state test below; the standard library's
+// operator delete already releases with free().
+namespace {
+thread_local bool counting = false;
+thread_local size_t allocations = 0;
+}
+
+void* operator new(std::size_t size) {
+    if (counting) {
+        allocations++;
+    }
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+namespace Ranking {
+
+// In-memory index whose batched reads copy straight into the caller's lists.
+class InMemoryDatabase : public IDatabase {
+public:
+    void add(const std::string& key, const Data& data) override { index[key].push_back(data); }
+    void remove(const std::string& key) override { index.erase(key); }
+    std::vector<Data> get(const std::string& key) override { return index.at(key); }
+    std::vector<Data> get(const std::string& key, size_t n) override {
+        std::vector<Data> values = index.at(key);
+        values.resize(std::min(n, values.size()));
+        return values;
+    }
+    unsigned int termDocCount(const std::string& key) override {
+        auto it = index.find(key);
+        return it == index.end() ? 0 : it->second.size();
+    }
+
+    void getManyInto(const std::pmr::vector<std::pmr::string>& keys, size_t n,
+                     std::pmr::vector<std::pmr::vector<Data>>& out) override {
+        out.clear();
+        out.resize(keys.size());
+        for (size_t i = 0; i < keys.size(); i++) {
+            auto it = index.find(std::string_view(keys[i]));
+            if (it != index.end()) {
+                out[i].assign(it->second.begin(), it->second.begin() + std::min(n, it->second.size()));
+            }
+        }
+    }
+
+private:
+    std::map<std::string, std::vector<Data>, std::less<>> index;
+};
+
+// Test that allocations are aligned and that reset() rewinds without freeing.
+TEST(QueryArenaTest, AllocatesAlignedAndRewinds) {
+    QueryArena arena(256);
+
+    void* first = arena.allocate(3, 1);
+    void* aligned = arena.allocate(8, 64);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 64, 0u);
+    void* large = arena.allocate(1000, 8); // larger than the first block
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(large) % 8, 0u);
+    EXPECT_GE(arena.used(), 1011u);
+    size_t capacity = arena.capacity();
+    EXPECT_GE(capacity, 1256u);
+
+    arena.reset();
+    EXPECT_EQ(arena.used(), 0u);
+    EXPECT_EQ(arena.capacity(), capacity);
+    EXPECT_EQ(arena.allocate(3, 1), first);
+
+    // Containers spanning several blocks stay intact.
+    std::pmr::vector<int> values(&arena);
+    for (int i = 0; i < 10000; i++) {
+        values.push_back(i);
+    }
+    EXPECT_EQ(values[9999], 9999);
+}
+
+// Test that reset() frees the blocks beyond the retained size.
+TEST(QueryArenaTest, ResetTrimsToRetainedSize) {
+    QueryArena arena(1024, 4096);
+    void* first = arena.allocate(16, 8);
+    EXPECT_NE(arena.allocate(100000, 8), nullptr);
+    EXPECT_GE(arena.capacity(), 100000u);
+
+    arena.reset();
+    EXPECT_EQ(arena.capacity(), 1024u);
+    EXPECT_EQ(arena.used(), 0u);
+    EXPECT_EQ(arena.allocate(16, 8), first);
+
+    // A first block larger than the retained size is not kept either.
+    QueryArena oversized(1024, 4096);
+    EXPECT_NE(oversized.allocate(100000, 8), nullptr);
+    oversized.reset();
+    EXPECT_EQ(oversized.capacity(), 0u);
+}
+
+// Test that every thread gets its own arena.
+TEST(QueryArenaTest, ForThreadIsPerThread) {
+    QueryArena* main = &QueryArena::for_thread();
+    EXPECT_EQ(main, &QueryArena::for_thread());
+
+    QueryArena* other = nullptr;
+    std::thread([&] { other = &QueryArena::for_thread(); }).join();
+    EXPECT_NE(main, other);
+}
+
+// Test that a query served again from a warmed-up arena makes no global
+// heap allocation, from tokenizing through to the ranked results.
+TEST(QueryArenaTest, SteadyStateQueryDoesNotAllocate) {
+    std::string resourcesPath = "./temp_arena_resources.img";
+    std::string lexiconPath = "./temp_arena_lexicon";
+
+    query::QueryResources::build({"good", "ski", "children", "toy", "resort"},
+                          {{"good ski", {}}, {"ski resort", {}}}, resourcesPath);
+    query::QueryResources resources(resourcesPath);
+
+    auto db = std::make_shared<InMemoryDatabase>();
+    db->add("good", {3, 1});
+    db->add("good", {1, 2});
+    db->add("ski", {4, 1});
+    db->add("children", {2, 3});
+    db->add("toy", {5, 2});
+
+    LexiconBuilder builder;
+    for (const char* term : {"children", "good", "ski", "toy"}) {
+        builder.add(term, db->termDocCount(term), 1.0f);
+    }
+    builder.write(lexiconPath);
+    auto lexicon = std::make_shared<const Lexicon>(lexiconPath);
+    Searcher searcher(db, std::make_shared<BM25Weight>(), lexicon);
+
+    QueryArena arena;
+    std::string rawQuery = "Good SKI for the children, toy!";
+    auto runQuery = [&]() {
+        arena.reset();
+        queryTree::QueryTree tree = query::processQuery(rawQuery, resources, &arena);
+        tree.resolveTerms(*lexicon);
+        Query query = Query::from_tree(tree, &arena);
+        MatchingDocs docs = searcher.Search(query, 10, &arena);
+        return docs.empty() ? -1 : docs.get_all_results()[0].get_docid();
+    };
+
+    int expected = runQuery(); // grows the arena and per-thread buffers
+    ASSERT_NE(expected, -1);
+
+    counting = true;
+    allocations = 0;
+    int topDoc = runQuery();
+    counting = false;
+
+    EXPECT_EQ(topDoc, expected);
+    EXPECT_EQ(allocations, 0u);
+    EXPECT_GT(arena.used(), 0u);
+
+    std::filesystem::remove(resourcesPath);
+    std::filesystem::remove(lexiconPath);
+}
+
+}
@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+
+#include "index/IDatabase.h"
+#include "index/Lexicon.h"
+#include "search/QueryOptimizer.h"
+#include "search/query.h"
+#include "search/searcher.h"
+#include "search/weight.h"
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Ranking {
+
+namespace {
+
+// In-memory index that records which keys were read.
+class RecordingDatabase : public IDatabase {
+public:
+    void add(const std::string& key, const Data& data) override { index[key].push_back(data); }
+    void remove(const std::string& key) override { index.erase(key); }
+    std::vector<Data> get(const std::string& key) override { return index.at(key); }
+    std::vector<Data> get(const std::string& key, size_t n) override {
+        fetched.push_back(key);
+        std::vector<Data> values = index.at(key);
+        values.resize(std::min(n, values.size()));
+        return values;
+    }
+    unsigned int termDocCount(const std::string& key) override {
+        auto it = index.find(key);
+        return it == index.end() ? 0 : it->second.size();
+    }
+
+    std::vector<std::string> fetched;
+
+private:
+    std::map<std::string, std::vector<Data>, std::less<>> index;
+};
+
+std::vector<uint32_t> ids(const std::pmr::vector<PlannedTerm>& terms) {
+    std::vector<uint32_t> result;
+    for (const PlannedTerm& term : terms) {
+        result.push_back(term.id);
+    }
+    return result;
+}
+
+}
+
+// Test that terms are scanned rarest first and repeats are fetched once
+TEST(QueryOptimizerTest, OrdersBySelectivityAndMergesRepeats) {
+    Query query;
+    query.addTerm(1, 50);
+    query.addTerm(2, 3);
+    query.addTerm(3, 20);
+    query.addTerm(2, 3);
+
+    QueryPlan plan = QueryOptimizer(1000).optimize(query);
+    EXPECT_EQ(ids(plan.terms()), (std::vector<uint32_t>{2, 3, 1}));
+    EXPECT_EQ(plan.terms()[0].weight, 2.0);
+    EXPECT_EQ(plan.terms()[1].weight, 1.0);
+    EXPECT_TRUE(plan.dropped().empty());
+    EXPECT_EQ(plan.estimated_cost(), 73u);
+
+    // The unoptimized plan keeps the query as it is.
+    QueryPlan unoptimized(query);
+    EXPECT_EQ(ids(unoptimized.terms()), (std::vector<uint32_t>{1, 2, 3, 2}));
+    EXPECT_EQ(unoptimized.estimated_cost(), 76u);
+}
+
+// Test that common terms are dropped or down-weighted, unless all terms are common
+TEST(QueryOptimizerTest, HandlesCommonTerms) {
+    Query query;
+    query.addTerm(1, 900);
+    query.addTerm(2, 12);
+    query.addTerm(3, 600);
+
+    QueryOptimizer optimizer(1000);
+    QueryPlan plan = optimizer.optimize(query);
+    EXPECT_EQ(ids(plan.terms()), (std::vector<uint32_t>{2}));
+    EXPECT_EQ(ids(plan.dropped()), (std::vector<uint32_t>{3, 1}));
+    EXPECT_EQ(plan.estimated_cost(), 12u);
+    EXPECT_EQ(plan.unoptimized_cost(), 1512u);
+    EXPECT_EQ(plan.describe(), "terms=[2:12] dropped=[3:600 1:900] cost=12/1512");
+
+    optimizer.set_common_term_weight(0.25);
+    plan = optimizer.optimize(query);
+    EXPECT_EQ(ids(plan.terms()), (std::vector<uint32_t>{2, 3, 1}));
+    EXPECT_EQ(plan.terms()[2].weight, 0.25);
+    EXPECT_TRUE(plan.dropped().empty());
+    EXPECT_EQ(plan.describe(), "terms=[2:12 3:600x0.25 1:900x0.25] dropped=[] cost=1512/1512");
+
+    optimizer.set_common_term_weight(0.0);
+    optimizer.set_common_term_ratio(0.95);
+    EXPECT_TRUE(optimizer.optimize(query).dropped().empty());
+
+    Query common;
+    common.addTerm(1, 900);
+    common.addTerm(3, 600);
+    optimizer.set_common_term_ratio(0.5);
+    plan = optimizer.optimize(common);
+    EXPECT_EQ(ids(plan.terms()), (std::vector<uint32_t>{3, 1}));
+    EXPECT_EQ(plan.terms()[1].weight, 1.0);
+}
+
+class OptimizedSearchTest : public ::testing::Test {
+protected:
+    std::string path = "./temp_optimizer_lexicon";
+    std::shared_ptr<RecordingDatabase> db = std::make_shared<RecordingDatabase>();
+    std::shared_ptr<const Lexicon> lexicon;
+
+    void write_lexicon(const std::vector<std::string>& terms) {
+        LexiconBuilder builder;
+        for (const std::string& term : terms) {
+            builder.add(term, db->termDocCount(term), 1.0f);
+        }
+        builder.write(path);
+        lexicon = std::make_shared<const Lexicon>(path);
+    }
+
+    Query make_query(const std::vector<std::string>& terms) {
+        Query query;
+        for (const std::string& term : terms) {
+            std::optional<TermInfo> info = lexicon->find(term);
+            query.addTerm(info->id, info->df);
+        }
+        return query;
+    }
+
+    void TearDown() override {
+        lexicon.reset();
+        std::filesystem::remove(path);
+    }
+};
+
+// Test that dropped terms are never fetched
+TEST_F(OptimizedSearchTest, SkipsDroppedTerms) {
+    for (int doc = 0; doc < 100; doc++) {
+        db->add("the", {1, doc});
+    }
+    db->add("ski", {3, 7});
+    db->add("ski", {1, 9});
+    write_lexicon({"ski", "the"});
+    Searcher searcher(db, std::make_shared<BM25Weight>(), lexicon);
+
+    Query query = make_query({"the", "ski"});
+    QueryPlan plan = QueryOptimizer(100).optimize(query);
+    auto docs = searcher.Search(query, plan, 10).get_all_results();
+
+    EXPECT_EQ(db->fetched, (std::vector<std::string>{"ski"}));
+    ASSERT_EQ(docs.size(), 2u);
+    EXPECT_EQ(docs[0].get_docid(), 7);
+    EXPECT_EQ(docs[1].get_docid(), 9);
+}
+
+// Test that reordered plans with merged repeats rank as the unoptimized query
+TEST_F(OptimizedSearchTest, PlanMatchesUnoptimizedSearch) {
+    std::mt19937 rng(5);
+    std::vector<std::string> terms = {"a", "b", "c", "d"};
+    std::vector<int> dfs = {30, 80, 150, 190};
+    for (size_t t = 0; t < terms.size(); t++) {
+        std::vector<int> docs(200);
+        for (int doc = 0; doc < 200; doc++) {
+            docs[doc] = doc;
+        }
+        std::shuffle(docs.begin(), docs.end(), rng);
+        for (int i = 0; i < dfs[t]; i++) {
+            db->add(terms[t], {1 + int(rng() % 20), docs[i]});
+        }
+    }
+    write_lexicon(terms);
+    Searcher searcher(db, std::make_shared<BM25Weight>(), lexicon);
+    QueryOptimizer optimizer(200);
+    optimizer.set_common_term_ratio(1.0);
+
+    for (const std::vector<std::string>& words : std::vector<std::vector<std::string>>{
+             {"a", "b"}, {"b", "a", "c"}, {"c", "d"}, {"d", "b"}, {"a", "b", "c", "d"}, {"c", "c", "d"}}) {
+        Query query = make_query(words);
+        for (unsigned int k : {1u, 3u, 10u}) {
+            QueryPlan plan = optimizer.optimize(query);
+            auto expected = searcher.Search(query, k).get_all_results();
+            auto actual = searcher.Search(query, plan, k).get_all_results();
+            ASSERT_EQ(actual.size(), expected.size());
+            for (size_t i = 0; i < expected.size(); i++) {
+                EXPECT_NEAR(actual[i].get_weight(), expected[i].get_weight(), 1e-9) << plan.describe();
+            }
+        }
+    }
+}
+
+// Performance test: a query of two rare terms and a stopword-like term
+TEST_F(OptimizedSearchTest, PerformanceTest_CommonTerms) {
+    const int numDocs = 100000;
+    const int numQueries = 50;
+    std::mt19937 rng(3);
+    for (int doc = 0; doc < numDocs; doc++) {
+        db->add("the", {1 + int(rng() % 5), doc});
+        if (doc % 2 == 0) db->add("snow", {1 + int(rng() % 5), doc});
+        if (doc % 50 == 0) db->add("ski", {1 + int(rng() % 5), doc});
+    }
+    write_lexicon({"ski", "snow", "the"});
+    Searcher searcher(db, std::make_shared<BM25Weight>(), lexicon);
+    Query query = make_query({"the", "ski", "snow"});
+    QueryOptimizer optimizer(numDocs);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int q = 0; q < numQueries; q++) {
+        searcher.Search(query, 10);
+    }
+    auto mid = std::chrono::high_resolution_clock::now();
+    QueryPlan plan = optimizer.optimize(query);
+    for (int q = 0; q < numQueries; q++) {
+        searcher.Search(query, optimizer.optimize(query), 10);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double> unoptimized = mid - start;
+    std::chrono::duration<double> optimized = end - mid;
+    std::cout << "PerformanceTest: " << numQueries << " queries unoptimized in " << unoptimized.count()
+              << " seconds, optimized in " << optimized.count() << " seconds (" << plan.describe() << ")"
+              << std::endl;
+
+    EXPECT_LT(plan.estimated_cost(), plan.unoptimized_cost() / 2);
+}
+
+}
@@ -0,0 +1,339 @@
+#include <gtest/gtest.h>
+
+#include "index/IDatabase.h"
+#include "index/Lexicon.h"
+#include "query-processing/query.h"
+#include "query-processing/queryResources.h"
+#include "search/SearchSession.h"
+#include "search/query.h"
+#include "search/searcher.h"
+#include "search/weight.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace Ranking {
+
+namespace {
+
+// In-memory index that counts the lists it reads.
+class CountingDatabase : public IDatabase {
+public:
+    void add(const std::string& key, const Data& data) override { index[key].push_back(data); }
+    void remove(const std::string& key) override { index.erase(key); }
+    std::vector<Data> get(const std::string& key) override { return get(key, SIZE_MAX); }
+    std::vector<Data> get(const std::string& key, size_t n) override {
+        reads++;
+        auto it = index.find(key);
+        if (it == index.end()) {
+            return {};
+        }
+        return std::vector<Data>(it->second.begin(), it->second.begin() + std::min(n, it->second.size()));
+    }
+    unsigned int termDocCount(const std::string& key) override {
+        auto it = index.find(key);
+        return it == index.end() ? 0 : it->second.size();
+    }
+
+    const std::map<std::string, std::vector<Data>, std::less<>>& terms() const { return index; }
+
+    size_t reads = 0;
+
+private:
+    std::map<std::string, std::vector<Data>, std::less<>> index;
+};
+
+// A random collection over words made of consonant-vowel syllables, which
+// the stemmer leaves as they are, with the query resources and lexicon.
+class Collection {
+public:
+    Collection(int words, int documents, unsigned int seed) {
+        std::mt19937 rng(seed);
+        const std::string consonants = "bdgklmnprt";
+        std::unordered_set<std::string> seen;
+        while ((int) vocabulary.size() < words) {
+            std::string word;
+            for (int n = 2 + rng() % 3; n > 0; --n) {
+                word.push_back(consonants[rng() % consonants.size()]);
+                word.push_back(rng() % 2 ? 'a' : 'o');
+            }
+            if (seen.insert(word).second) {
+                vocabulary.push_back(word);
+            }
+        }
+
+        db = std::make_shared<CountingDatabase>();
+        for (int doc = 0; doc < documents; ++doc) {
+            std::map<std::string, int> counts;
+            for (int n = 5 + rng() % 20; n > 0; --n) {
+                counts[vocabulary[std::min(rng() % vocabulary.size(), rng() % vocabulary.size())]]++;
+            }
+            for (const auto& [word, count] : counts) {
+                db->add(word, {count, doc});
+            }
+        }
+
+        query::QueryResources::build(seen, {{vocabulary[0] + " " + vocabulary[1], {}}}, resourcesPath);
+        resources = std::make_shared<const query::QueryResources>(resourcesPath);
+
+        LexiconBuilder builder;
+        for (const auto& [term, postings] : db->terms()) {
+            builder.add(term, postings.size(), 1.0f);
+        }
+        builder.write(lexiconPath);
+        lexicon = std::make_shared<const Lexicon>(lexiconPath);
+        db->reads = 0;
+    }
+
+    ~Collection() {
+        resources.reset();
+        lexicon.reset();
+        std::filesystem::remove(resourcesPath);
+        std::filesystem::remove(lexiconPath);
+    }
+
+    // The query a session evaluates for a text, searched from scratch.
+    MatchingDocs search(const std::string& text, unsigned int max_items) {
+        size_t space = text.find_last_of(' ');
+        std::string complete = space == std::string::npos ? "" : text.substr(0, space);
+        std::string word = space == std::string::npos ? text : text.substr(space + 1);
+
+        Query query;
+        if (!complete.empty()) {
+            queryTree::QueryTree tree = query::processQuery(complete, *resources);
+            tree.resolveTerms(*lexicon);
+            query = Query::from_tree(tree);
+        }
+        if (!word.empty()) {
+            query.addWildcard(word + "*");
+        }
+        Searcher searcher(db, std::make_shared<BM25Weight>(), lexicon);
+        return searcher.Search(query, max_items);
+    }
+
+    std::vector<std::string> vocabulary;
+    std::shared_ptr<CountingDatabase> db;
+    std::shared_ptr<const query::QueryResources> resources;
+    std::shared_ptr<const Lexicon> lexicon;
+
+private:
+    std::string resourcesPath = "./temp_session_resources.img";
+    std::string lexiconPath = "./temp_session_lexicon";
+};
+
+void expect_same_ranking(const MatchingDocs& actual, const MatchingDocs& expected, const std::string& text) {
+    ASSERT_EQ(actual.size(), expected.size()) << "'" << text << "'";
+    for (unsigned int i = 0; i < actual.size(); ++i) {
+        EXPECT_NEAR(actual.get_all_results()[i].get_weight(), expected.get_all_results()[i].get_weight(), 1e-9)
+                << "'" << text << "' rank " << i;
+    }
+}
+
+// Every prefix of a text, one keystroke at a time.
+std::vector<std::string> keystrokes(const std::string& text) {
+    std::vector<std::string> typed;
+    for (size_t i = 1; i <= text.size(); ++i) {
+        typed.push_back(text.substr(0, i));
+    }
+    return typed;
+}
+
+}
+
+// Test that every keystroke ranks as the same query searched from scratch,
+// including when words are deleted again
+TEST(SearchSessionTest, MatchesFullSearchAtEveryKeystroke) {
+    Collection collection(300, 2000, 5);
+    const std::vector<std::string>& words = collection.vocabulary;
+    SearchSession session(collection.db, std::make_shared<BM25Weight>(), collection.lexicon, collection.resources);
+
+    std::string text = words[0] + " " + words[1] + " " + words[7] + " " + words[3];
+    std::vector<std::string> typed = keystrokes(text);
+    // Backspace over the last two words, then type another.
+    std::string kept = words[0] + " " + words[1];
+    for (size_t length = text.size() - 1; length >= kept.size(); --length) {
+        typed.push_back(text.substr(0, length));
+    }
+    for (const std::string& next : keystrokes(" " + words[9] + " " + words[9])) {
+        typed.push_back(kept + next);
+    }
+
+    for (const std::string& keystroke : typed) {
+        expect_same_ranking(session.update(keystroke, 10), collection.search(keystroke, 10), keystroke);
+    }
+}
+
+// Test that fuzzy terms in the complete text rank as in a full search
+TEST(SearchSessionTest, ScoresFuzzyTerms) {
+    Collection collection(300, 2000, 12);
+    const std::vector<std::string>& words = collection.vocabulary;
+    SearchSession session(collection.db, std::make_shared<BM25Weight>(), collection.lexicon, collection.resources);
+
+    std::string misspelled = words[2];
+    misspelled[1] = misspelled[1] == 'a' ? 'o' : 'a';
+    for (const std::string& text : {misspelled + "~1 " + words[5].substr(0, 2), misspelled + "~1 " + words[5],
+                                    words[0] + " " + misspelled + "~2 " + words[5]}) {
+        expect_same_ranking(session.update(text, 10), collection.search(text, 10), text);
+    }
+}
+
+// Test that completing a word and adding one do not read lists again
+TEST(SearchSessionTest, ReusesListsWhileTyping) {
+    Collection collection(300, 2000, 6);
+    const std::vector<std::string>& words = collection.vocabulary;
+    SearchSession session(collection.db, std::make_shared<BM25Weight>(), collection.lexicon, collection.resources);
+
+    // The first letter reads the lists of every term it starts; longer
+    // prefixes and the completed word only use them.
+    session.update(words[2].substr(0, 1), 10);
+    size_t first = session.lists_read();
+    EXPECT_GT(first, 1u);
+    for (const std::string& keystroke : keystrokes(words[2] + " ")) {
+        session.update(keystroke, 10);
+    }
+    EXPECT_EQ(session.lists_read(), first);
+
+    // A second word reads only the lists of its own prefix.
+    session.update(words[2] + " " + words[4].substr(0, 3), 10);
+    size_t second = session.lists_read();
+    EXPECT_GT(second, first);
+    for (size_t length = 4; length <= words[4].size(); ++length) {
+        session.update(words[2] + " " + words[4].substr(0, length), 10);
+    }
+    EXPECT_EQ(session.lists_read(), second);
+    EXPECT_EQ(collection.db->reads, second);
+}
+
+// Test that a small expansion cap re-expands a longer prefix instead of narrowing
+TEST(SearchSessionTest, ReexpandsCappedPrefix) {
+    Collection collection(300, 2000, 7);
+    SearchSession session(collection.db, std::make_shared<BM25Weight>(), collection.lexicon, collection.resources);
+    session.set_max_expansions(3);
+
+    const std::string& word = collection.vocabulary[5];
+    for (const std::string& keystroke : keystrokes(word)) {
+        Searcher searcher(collection.db, std::make_shared<BM25Weight>(), collection.lexicon);
+        searcher.set_max_expansions(3);
+        Query query;
+        query.addWildcard(keystroke + "*");
+        expect_same_ranking(session.update(keystroke, 10), searcher.Search(query, 10), keystroke);
+    }
+}
+
+// Test that clients have sessions of their own and that ended sessions start over
+TEST(SearchSessionTest, KeepsOneSessionPerClient) {
+    Collection collection(100, 500, 8);
+    const std::vector<std::string>& words = collection.vocabulary;
+    SessionManager sessions(collection.db, std::make_shared<BM25Weight>(), collection.lexicon,
+                            collection.resources, 2);
+
+    for (const std::string& keystroke : keystrokes(words[0] + " " + words[1])) {
+        sessions.type("alice", keystroke, 10);
+        sessions.type("bob", words[2].substr(0, 2), 10);
+    }
+    MatchingDocs expected = collection.search(words[0] + " " + words[1], 10);
+    size_t reads = collection.db->reads;
+    expect_same_ranking(sessions.type("alice", words[0] + " " + words[1], 10), expected, "alice");
+    EXPECT_EQ(collection.db->reads, reads);
+
+    // A new session reads its lists again.
+    sessions.end("alice");
+    sessions.type("alice", words[0] + " " + words[1], 10);
+    EXPECT_GT(collection.db->reads, reads);
+
+    // Beyond the capacity the least recently used session is dropped.
+    reads = collection.db->reads;
+    sessions.type("carol", words[3], 10);
+    sessions.type("bob", words[2].substr(0, 2), 10);
+    EXPECT_GE(collection.db->reads, reads + 2);
+}
+
+// Test that a session over its budget drops cached lists and still ranks the same
+TEST(SearchSessionTest, BoundsCachedPostings) {
+    Collection collection(300, 2000, 10);
+    const std::vector<std::string>& words = collection.vocabulary;
+    SearchSession unbounded(collection.db, std::make_shared<BM25Weight>(), collection.lexicon, collection.resources);
+    SearchSession session(collection.db, std::make_shared<BM25Weight>(), collection.lexicon, collection.resources);
+    session.set_max_cached_postings(300);
+
+    std::string text = words[0] + " " + words[1] + " " + words[4];
+    std::vector<std::string> typed = keystrokes(text);
+    for (size_t length = text.size() - 1; length > words[0].size(); --length) {
+        typed.push_back(text.substr(0, length));
+    }
+    size_t largest = 0;
+    for (const std::string& keystroke : typed) {
+        expect_same_ranking(session.update(keystroke, 10), collection.search(keystroke, 10), keystroke);
+        EXPECT_LE(session.cached_postings(), 300u) << "'" << keystroke << "'";
+        unbounded.update(keystroke, 10);
+        largest = std::max(largest, unbounded.cached_postings());
+    }
+    EXPECT_GT(largest, 300u);
+    EXPECT_GT(session.lists_read(), unbounded.lists_read());
+}
+
+// Test that sessions are evicted while their cached postings exceed the total
+TEST(SearchSessionTest, BoundsPostingsAcrossSessions) {
+    Collection collection(100, 2000, 11);
+    const std::vector<std::string>& words = collection.vocabulary;
+    SessionManager sessions(collection.db, std::make_shared<BM25Weight>(), collection.lexicon,
+                            collection.resources, 100, 2000);
+
+    const std::vector<std::string> clients = {"alice", "bob", "carol", "dave", "erin", "frank"};
+    for (size_t i = 0; i < clients.size(); ++i) {
+        sessions.type(clients[i], words[i].substr(0, 1), 10);
+        EXPECT_LE(sessions.cached_postings(), 2000u) << clients[i];
+        EXPECT_GT(sessions.cached_postings(), 0u) << clients[i];
+    }
+
+    // The most recent session is kept, the oldest was evicted.
+    size_t reads = collection.db->reads;
+    sessions.type("frank", words[5].substr(0, 1), 10);
+    EXPECT_EQ(collection.db->reads, reads);
+    sessions.type("alice", words[0].substr(0, 1), 10);
+    EXPECT_GT(collection.db->reads, reads);
+
+    sessions.end("alice");
+    sessions.end("frank");
+    EXPECT_LE(sessions.cached_postings(), 2000u);
+}
+
+// Performance test: per-keystroke latency of a session against full queries
+TEST(SearchSessionTest, PerformanceTest_TypingVsFullQuery) {
+    Collection collection(2000, 100000, 9);
+    const std::vector<std::string>& words = collection.vocabulary;
+    std::vector<std::string> typed =
+            keystrokes(words[3] + " " + words[10] + " " + words[25] + " " + words[40] + " " + words[77]);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (const std::string& keystroke : typed) {
+        collection.search(keystroke, 10);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> full = end - start;
+    size_t full_reads = collection.db->reads;
+
+    collection.db->reads = 0;
+    SearchSession session(collection.db, std::make_shared<BM25Weight>(), collection.lexicon, collection.resources);
+    start = std::chrono::high_resolution_clock::now();
+    for (const std::string& keystroke : typed) {
+        session.update(keystroke, 10);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> incremental = end - start;
+
+    std::cout << "PerformanceTest: " << typed.size() << " keystrokes, full queries " << full.count() * 1000
+              << " ms (" << full_reads << " lists read), session " << incremental.count() * 1000 << " ms ("
+              << collection.db->reads << " lists read)" << std::endl;
+    EXPECT_LT(collection.db->reads, full_reads);
+}
+
+}
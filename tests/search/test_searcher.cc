@@ -5,8 +5,12 @@
 #include "search/searcher.h"
 #include "search/query.h"
 #include "search/weight.h"
+#include "query-processing/phraseMatcher.h"
+#include "query-processing/queryTree.h"
 
+#include <filesystem>
 #include <memory>
+#include <stdexcept>
 #include <vector>
 
 using ::testing::_;
@@ -43,7 +47,7 @@ TEST_F(SearcherTest, SearchReturnsExpectedDocs) {
 
     unsigned int maxDocs = 10;
     MatchingDocs results = searcher->Search(query, maxDocs);
-    std::vector<SearchResult> docs = results.get_all_results();
+    auto docs = results.get_all_results();
 
     ASSERT_EQ(docs.size(), 2u);
     EXPECT_EQ(docs[0].get_docid(), 123);
@@ -63,6 +67,123 @@ TEST_F(SearcherTest, SearchWithNoResults) {
     EXPECT_TRUE(results.get_all_results().empty());
 }
 
+// Terms missing from the index are skipped instead of failing the query
+TEST_F(SearcherTest, SearchSkipsMissingTerms) {
+    std::vector<Data> fooData = {
+        {10, 123}
+    };
+    EXPECT_CALL(*mockDB, get("foo", _))
+        .Times(1)
+        .WillOnce(Return(fooData));
+    EXPECT_CALL(*mockDB, get("misspeled", _))
+        .Times(1)
+        .WillOnce(::testing::Throw(std::runtime_error("Key not found: misspeled")));
+
+    Query query;
+    query.addTerm("misspeled");
+    query.addTerm("foo");
+
+    MatchingDocs results = searcher->Search(query, 10);
+    auto docs = results.get_all_results();
+
+    ASSERT_EQ(docs.size(), 1u);
+    EXPECT_EQ(docs[0].get_docid(), 123);
+}
+
+// Wildcard terms are expanded through the lexicon and scored as one pseudo-term
+TEST_F(SearcherTest, SearchExpandsWildcard) {
+    std::string path = "./temp_searcher_lexicon";
+    LexiconBuilder builder;
+    builder.add("computer", 2, 1.0f);
+    builder.add("computing", 1, 1.0f);
+    builder.add("cookie", 1, 1.0f);
+    builder.write(path);
+    auto lexicon = std::make_shared<const Lexicon>(path);
+    Searcher wildcardSearcher(mockDB, bm25Weight, lexicon);
+
+    EXPECT_CALL(*mockDB, get("computer", _))
+        .WillOnce(Return(std::vector<Data>{{3, 1}, {1, 2}}));
+    EXPECT_CALL(*mockDB, get("computing", _))
+        .WillOnce(Return(std::vector<Data>{{4, 2}}));
+    EXPECT_CALL(*mockDB, get("cookie", _)).Times(0);
+
+    Query query;
+    query.addWildcard("comput*");
+    auto docs = wildcardSearcher.Search(query, 10).get_all_results();
+
+    // Document 2 matches both expansions, so its frequencies add up.
+    ASSERT_EQ(docs.size(), 2u);
+    EXPECT_EQ(docs[0].get_docid(), 2);
+    EXPECT_EQ(docs[1].get_docid(), 1);
+
+    // Without a lexicon, wildcard terms match nothing.
+    EXPECT_TRUE(searcher->Search(query, 10).empty());
+    std::filesystem::remove(path);
+}
+
+// Fuzzy terms are expanded to the dictionary terms within the edit distance
+TEST_F(SearcherTest, SearchExpandsFuzzyTerm) {
+    std::string path = "./temp_searcher_fuzzy_lexicon";
+    LexiconBuilder builder;
+    builder.add("search", 2, 1.0f);
+    builder.add("starch", 1, 1.0f);
+    builder.add("sea", 1, 1.0f);
+    builder.write(path);
+    auto lexicon = std::make_shared<const Lexicon>(path);
+    Searcher fuzzySearcher(mockDB, bm25Weight, lexicon);
+
+    EXPECT_CALL(*mockDB, get("search", _))
+        .WillOnce(Return(std::vector<Data>{{1, 1}, {2, 2}}));
+    EXPECT_CALL(*mockDB, get("starch", _)).Times(0);
+    EXPECT_CALL(*mockDB, get("sea", _)).Times(0);
+
+    Query query;
+    query.addFuzzy("serch", 1);
+    auto docs = fuzzySearcher.Search(query, 10).get_all_results();
+
+    ASSERT_EQ(docs.size(), 2u);
+
+    // "term~N" in the query syntax parses to the same fuzzy term.
+    queryTree::QueryTree tree({"serch~1"}, queryTree::PhraseMatcher{});
+    Query parsed = Query::from_tree(tree);
+    ASSERT_EQ(parsed.fuzzy_terms().size(), 1u);
+    EXPECT_EQ(parsed.fuzzy_terms()[0].term, "serch");
+    EXPECT_EQ(parsed.fuzzy_terms()[0].max_distance, 1);
+    std::filesystem::remove(path);
+}
+
+// Resolved terms are fetched by id in one batch; unknown terms never reach the index
+TEST_F(SearcherTest, SearchResolvedTerms) {
+    std::string path = "./temp_searcher_resolved_lexicon";
+    LexiconBuilder builder;
+    builder.add("bar", 1, 1.0f);
+    builder.add("foo", 2, 1.0f);
+    builder.write(path);
+    Lexicon lexicon(path);
+    Searcher resolvedSearcher(mockDB, bm25Weight, std::make_shared<const Lexicon>(path));
+
+    queryTree::QueryTree tree({"foo", "missing", "bar", "ba*"}, queryTree::PhraseMatcher{});
+    EXPECT_EQ(tree.resolveTerms(lexicon), 1u);
+    Query query = Query::from_tree(tree);
+    ASSERT_EQ(query.term_ids().size(), 2u);
+    EXPECT_EQ(query.term_ids()[0].id, lexicon.find("foo")->id);
+    EXPECT_EQ(query.term_ids()[0].df, 2u);
+    ASSERT_EQ(query.wildcards().size(), 1u);
+    EXPECT_EQ(query.wildcards()[0], "ba*");
+    EXPECT_TRUE(query.terms().empty());
+
+    EXPECT_CALL(*mockDB, get("foo", _))
+        .WillOnce(Return(std::vector<Data>{{10, 123}, {5, 456}}));
+    EXPECT_CALL(*mockDB, get("bar", _))
+        .Times(2)  // once as a term, once as the wildcard expansion
+        .WillRepeatedly(Return(std::vector<Data>{{7, 789}}));
+    EXPECT_CALL(*mockDB, get("missing", _)).Times(0);
+
+    auto docs = resolvedSearcher.Search(query, 10).get_all_results();
+    ASSERT_EQ(docs.size(), 3u);
+    std::filesystem::remove(path);
+}
+
 // Test Max Docs Param
 TEST_F(SearcherTest, SearchExceedsMaxDocs) {
     std::vector<Data> fakeData = {
@@ -77,7 +198,7 @@ TEST_F(SearcherTest, SearchExceedsMaxDocs) {
 
     unsigned int maxDocs = 2;
     MatchingDocs results = searcher->Search(query, maxDocs);
-    std::vector<SearchResult> docs = results.get_all_results();
+    auto docs = results.get_all_results();
 
     ASSERT_EQ(docs.size(), 2u);
     EXPECT_EQ(docs[0].get_docid(), 100);
@@ -105,7 +226,7 @@ TEST_F(SearcherTest, SearchWithMultipleTerms) {
     query.addTerm("bar");
 
     MatchingDocs results = searcher->Search(query, 10);
-    std::vector<SearchResult> docs = results.get_all_results();
+    auto docs = results.get_all_results();
 
     ASSERT_EQ(docs.size(), 4u);
     std::vector<unsigned int> docIds;
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include "index/IDatabase.h"
+#include "index/Lexicon.h"
+#include "query-processing/phraseMatcher.h"
+#include "query-processing/queryTree.h"
+#include "query-processing/synonyms.h"
+#include "search/SynonymPostings.h"
+#include "search/query.h"
+#include "search/searcher.h"
+#include "search/weight.h"
+
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Ranking {
+
+namespace {
+
+// In-memory index that records which keys were read.
+class RecordingDatabase : public IDatabase {
+public:
+    void add(const std::string& key, const Data& data) override { index[key].push_back(data); }
+    void remove(const std::string& key) override { index.erase(key); }
+    std::vector<Data> get(const std::string& key) override { return index.at(key); }
+    std::vector<Data> get(const std::string& key, size_t n) override {
+        fetched.push_back(key);
+        std::vector<Data> values = index.at(key);
+        values.resize(std::min(n, values.size()));
+        return values;
+    }
+    unsigned int termDocCount(const std::string& key) override {
+        auto it = index.find(key);
+        return it == index.end() ? 0 : it->second.size();
+    }
+
+    std::vector<std::string> keys() const {
+        std::vector<std::string> result;
+        for (const auto& entry : index) {
+            result.push_back(entry.first);
+        }
+        return result;
+    }
+
+    std::vector<std::string> fetched;
+
+private:
+    std::map<std::string, std::vector<Data>, std::less<>> index;
+};
+
+}
+
+class SynonymPostingsTest : public ::testing::Test {
+protected:
+    std::string path = "./temp_synonym_lexicon";
+    std::shared_ptr<RecordingDatabase> db = std::make_shared<RecordingDatabase>();
+    synonyms::SynonymDictionary dictionary;
+
+    void SetUp() override {
+        dictionary.addGroup({"car", "auto", "automobil"});
+        db->add("car", {3, 1});
+        db->add("car", {1, 2});
+        db->add("auto", {2, 2});
+        db->add("auto", {1, 3});
+        db->add("automobil", {5, 4});
+        db->add("rental", {1, 2});
+    }
+
+    std::shared_ptr<const Lexicon> write_lexicon() {
+        LexiconBuilder builder;
+        for (const std::string& key : db->keys()) {
+            builder.add(key, db->termDocCount(key), 1.0f);
+        }
+        builder.write(path);
+        return std::make_shared<const Lexicon>(path);
+    }
+
+    Query parse(const queryTree::TokenList& tokens, const Lexicon& lexicon) {
+        queryTree::QueryTree tree(tokens, queryTree::PhraseMatcher{});
+        tree.expandSynonyms(dictionary);
+        tree.resolveTerms(lexicon);
+        return Query::from_tree(tree);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(path);
+    }
+};
+
+// Test that the merged list is the union of the members' lists
+TEST_F(SynonymPostingsTest, WritesUnionUnderMergedTerm) {
+    EXPECT_EQ(merge_synonym_postings(*db, dictionary, {0}), 4u);
+    std::vector<Data> merged = db->get(dictionary.mergedTerm(0));
+    ASSERT_EQ(merged.size(), 4u);
+    EXPECT_EQ(merged[1].docId, 2);
+    EXPECT_EQ(merged[1].priority, 3);  // car and auto both in document 2
+
+    // Merging again replaces the list.
+    EXPECT_EQ(merge_synonym_postings(*db, dictionary, {0}), 4u);
+    EXPECT_EQ(db->termDocCount(dictionary.mergedTerm(0)), 4u);
+}
+
+// Test that merged lists are a snapshot that a rerun brings up to date
+TEST_F(SynonymPostingsTest, RerunPicksUpIngestedPostings) {
+    merge_synonym_postings(*db, dictionary, {0});
+    db->add("auto", {4, 5});
+    db->add("car", {2, 3});
+    EXPECT_EQ(db->termDocCount(dictionary.mergedTerm(0)), 4u);  // stale until merged again
+
+    EXPECT_EQ(merge_synonym_postings(*db, dictionary, {0}), 5u);
+    std::vector<Data> merged = db->get(dictionary.mergedTerm(0));
+    ASSERT_EQ(merged.size(), 5u);
+    EXPECT_EQ(merged[2].docId, 3);
+    EXPECT_EQ(merged[2].priority, 3);
+    EXPECT_EQ(merged[4].docId, 5);
+    EXPECT_EQ(merged[4].priority, 4);
+}
+
+// Test that a merged group is read once and ranks exactly like its members
+TEST_F(SynonymPostingsTest, MergedGroupScoresLikeMembers) {
+    auto lexicon = write_lexicon();
+    Searcher searcher(db, std::make_shared<BM25Weight>(), lexicon);
+
+    Query unmerged = parse({"car", "rental"}, *lexicon);
+    ASSERT_EQ(unmerged.synonyms().size(), 1u);
+    EXPECT_EQ(unmerged.term_ids().size(), 1u);
+    auto expected = searcher.Search(unmerged, 10).get_all_results();
+    EXPECT_EQ(db->fetched, (std::vector<std::string>{"rental", "car", "auto", "automobil"}));
+    ASSERT_EQ(expected.size(), 4u);
+
+    merge_synonym_postings(*db, dictionary, {0});
+    lexicon = write_lexicon();
+    Searcher merged_searcher(db, std::make_shared<BM25Weight>(), lexicon);
+    Query merged = parse({"car", "rental"}, *lexicon);
+    EXPECT_TRUE(merged.synonyms().empty());
+    EXPECT_EQ(merged.term_ids().size(), 2u);
+
+    db->fetched.clear();
+    auto actual = merged_searcher.Search(merged, 10).get_all_results();
+    EXPECT_EQ(db->fetched, (std::vector<std::string>{dictionary.mergedTerm(0), "rental"}));
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        EXPECT_EQ(actual[i].get_docid(), expected[i].get_docid());
+        EXPECT_DOUBLE_EQ(actual[i].get_weight(), expected[i].get_weight());
+    }
+}
+
+}
@@ -0,0 +1,313 @@
+#include <gtest/gtest.h>
+
+#include "index/Lexicon.h"
+#include "search/LevenshteinAutomaton.h"
+#include "search/PostingUnion.h"
+#include "search/TermExpansion.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Ranking {
+
+class TermExpansionTest : public ::testing::Test {
+protected:
+    std::string path = "./temp_expansion_lexicon";
+    std::unique_ptr<Lexicon> lexicon;
+
+    void SetUp() override {
+        LexiconBuilder builder;
+        builder.add("cat", 50, 1.0f);
+        builder.add("coat", 5, 1.0f);
+        builder.add("compute", 10, 1.0f);
+        builder.add("computer", 30, 1.0f);
+        builder.add("computing", 20, 1.0f);
+        builder.add("contact", 8, 1.0f);
+        builder.add("cut", 3, 1.0f);
+        builder.add("dog", 40, 1.0f);
+        builder.write(path);
+        lexicon = std::make_unique<Lexicon>(path);
+    }
+
+    void TearDown() override {
+        lexicon.reset();
+        std::filesystem::remove(path);
+    }
+};
+
+TEST(WildcardMatchTest, MatchesPatterns) {
+    EXPECT_TRUE(wildcard_match("comput*", "computer"));
+    EXPECT_TRUE(wildcard_match("comput*", "comput"));
+    EXPECT_TRUE(wildcard_match("c*t", "cat"));
+    EXPECT_TRUE(wildcard_match("c*t", "contact"));
+    EXPECT_TRUE(wildcard_match("*ing", "computing"));
+    EXPECT_TRUE(wildcard_match("c**t", "ct"));
+    EXPECT_FALSE(wildcard_match("c*t", "coats"));
+    EXPECT_FALSE(wildcard_match("comput*", "compact"));
+    EXPECT_FALSE(wildcard_match("dog", "dogs"));
+}
+
+TEST_F(TermExpansionTest, ExpandsPrefix) {
+    EXPECT_EQ(expand_wildcard(*lexicon, "comput*"),
+              (std::vector<std::string>{"compute", "computer", "computing"}));
+    EXPECT_TRUE(expand_wildcard(*lexicon, "zeb*").empty());
+}
+
+TEST_F(TermExpansionTest, ExpandsInnerWildcard) {
+    EXPECT_EQ(expand_wildcard(*lexicon, "c*t"),
+              (std::vector<std::string>{"cat", "coat", "contact", "cut"}));
+    EXPECT_EQ(expand_wildcard(*lexicon, "*ing"), (std::vector<std::string>{"computing"}));
+}
+
+// Over the cap, the most frequent terms are kept.
+TEST_F(TermExpansionTest, CapKeepsHighestDocumentFrequency) {
+    EXPECT_EQ(expand_wildcard(*lexicon, "c*", 2), (std::vector<std::string>{"cat", "computer"}));
+    EXPECT_TRUE(expand_wildcard(*lexicon, "c*", 0).empty());
+}
+
+// Plain dynamic programming edit distance, for checking the automaton.
+static int reference_distance(const std::string& a, const std::string& b) {
+    std::vector<int> prev(b.size() + 1), cur(b.size() + 1);
+    for (size_t j = 0; j <= b.size(); j++) prev[j] = j;
+    for (size_t i = 1; i <= a.size(); i++) {
+        cur[0] = i;
+        for (size_t j = 1; j <= b.size(); j++) {
+            cur[j] = std::min({prev[j] + 1, cur[j - 1] + 1, prev[j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1)});
+        }
+        std::swap(prev, cur);
+    }
+    return prev[b.size()];
+}
+
+static std::vector<std::string> random_words(size_t count, const std::string& alphabet,
+                                             size_t min_len, size_t max_len, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<size_t> len(min_len, max_len);
+    std::uniform_int_distribution<size_t> letter(0, alphabet.size() - 1);
+    std::set<std::string> words;
+    while (words.size() < count) {
+        std::string word(len(gen), ' ');
+        for (char& c : word) c = alphabet[letter(gen)];
+        words.insert(word);
+    }
+    return std::vector<std::string>(words.begin(), words.end());
+}
+
+TEST(LevenshteinAutomatonTest, AcceptsWithinDistance) {
+    LevenshteinAutomaton automaton("kitten", 2);
+    std::vector<uint8_t> rows(automaton.row_size() * 2);
+
+    auto run = [&](const std::string& input) {
+        automaton.start(rows.data());
+        bool alive = true;
+        for (char c : input) {
+            alive = automaton.step(rows.data(), c, rows.data() + automaton.row_size());
+            std::copy(rows.begin() + automaton.row_size(), rows.end(), rows.begin());
+        }
+        return std::make_pair(alive, automaton.distance(rows.data()));
+    };
+
+    EXPECT_EQ(run("kitten").second, 0);
+    EXPECT_EQ(run("sitten").second, 1);
+    EXPECT_EQ(run("sittn").second, 2);
+    EXPECT_EQ(run("sitting").second, 3); // rejected: capped at max_distance + 1
+    EXPECT_FALSE(run("xyz").first);
+    EXPECT_TRUE(run("ki").first);
+}
+
+TEST_F(TermExpansionTest, FuzzyFindsCloseTerms) {
+    std::vector<FuzzyMatch> matches = expand_fuzzy(*lexicon, "compter", 1);
+    ASSERT_EQ(matches.size(), 1u);
+    EXPECT_EQ(matches[0].term, "computer");
+    EXPECT_EQ(matches[0].distance, 1);
+    EXPECT_EQ(matches[0].id, lexicon->find("computer")->id);
+
+    // Ties on distance are ordered by document frequency.
+    matches = expand_fuzzy(*lexicon, "cot", 1);
+    ASSERT_EQ(matches.size(), 3u);
+    EXPECT_EQ(matches[0].term, "cat");
+    EXPECT_EQ(matches[1].term, "coat");
+    EXPECT_EQ(matches[2].term, "cut");
+
+    matches = expand_fuzzy(*lexicon, "dog", 0);
+    ASSERT_EQ(matches.size(), 1u);
+    EXPECT_EQ(matches[0].distance, 0);
+
+    EXPECT_EQ(expand_fuzzy(*lexicon, "cot", 1, 1).size(), 1u);
+    EXPECT_THROW(expand_fuzzy(*lexicon, "cot", MAX_FUZZY_DISTANCE + 1), std::invalid_argument);
+}
+
+// Keys that are not words never come back from wildcard or fuzzy expansion.
+TEST(FuzzyExpansionTest, SkipsMergedListKeys) {
+    std::string path = "./temp_expansion_merged_lexicon";
+    LexiconBuilder builder;
+    builder.add("#at", 90, 1.0f);
+    builder.add("#syn:cat,kitten", 70, 1.0f);
+    builder.add("at", 10, 1.0f);
+    builder.add("cat", 50, 1.0f);
+    builder.write(path);
+    {
+        Lexicon lexicon(path);
+        std::vector<FuzzyMatch> matches = expand_fuzzy(lexicon, "at", 1);
+        ASSERT_EQ(matches.size(), 2u);
+        EXPECT_EQ(matches[0].term, "at");
+        EXPECT_EQ(matches[1].term, "cat");
+        EXPECT_EQ(expand_wildcard(lexicon, "*"), (std::vector<std::string>{"at", "cat"}));
+    }
+    std::filesystem::remove(path);
+}
+
+// The automaton walk must find exactly the terms a brute-force scan finds.
+TEST(FuzzyExpansionTest, MatchesBruteForce) {
+    std::string path = "./temp_fuzzy_lexicon";
+    std::vector<std::string> words = random_words(3000, "abcde", 1, 8, 7);
+    LexiconBuilder builder;
+    for (const std::string& word : words) {
+        builder.add(word, 1, 1.0f);
+    }
+    builder.write(path);
+    Lexicon lexicon(path);
+
+    std::vector<std::string> queries = random_words(40, "abcdef", 0, 9, 11);
+    for (int k = 0; k <= MAX_FUZZY_DISTANCE; k++) {
+        for (const std::string& query : queries) {
+            std::set<std::pair<std::string, int>> expected;
+            for (const std::string& word : words) {
+                int distance = reference_distance(query, word);
+                if (distance <= k) {
+                    expected.insert({word, distance});
+                }
+            }
+            std::set<std::pair<std::string, int>> actual;
+            for (const FuzzyMatch& match : expand_fuzzy(lexicon, query, k, words.size())) {
+                actual.insert({match.term, match.distance});
+            }
+            EXPECT_EQ(actual, expected) << "query '" << query << "' k=" << k;
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+// Performance test: fuzzy lookups against a large vocabulary.
+TEST(FuzzyExpansionTest, PerformanceTest_FuzzyLookup) {
+    std::string path = "./temp_fuzzy_perf_lexicon";
+    std::vector<std::string> words = random_words(300000, "abcdefghijklmnopqrstuvwxyz", 3, 12, 3);
+    LexiconBuilder builder;
+    for (size_t i = 0; i < words.size(); i++) {
+        builder.add(words[i], static_cast<uint32_t>(i % 100 + 1), 1.0f);
+    }
+    builder.write(path);
+    Lexicon lexicon(path);
+
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<size_t> pick(0, words.size() - 1);
+    const int numQueries = 200;
+    std::vector<std::string> queries;
+    for (int i = 0; i < numQueries; i++) {
+        // A one-character typo of a dictionary word.
+        std::string query = words[pick(gen)];
+        query[query.size() / 2] = query[query.size() / 2] == 'z' ? 'a' : query[query.size() / 2] + 1;
+        queries.push_back(query);
+    }
+
+    for (int distance = 1; distance <= MAX_FUZZY_DISTANCE; distance++) {
+        size_t found = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (const std::string& query : queries) {
+            found += expand_fuzzy(lexicon, query, distance).size();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double, std::micro> elapsed = end - start;
+
+        std::cout << "PerformanceTest: " << numQueries << " fuzzy lookups (distance " << distance << ") over "
+                  << words.size() << " terms averaged " << elapsed.count() / numQueries << " microseconds"
+                  << std::endl;
+        EXPECT_GE(found, static_cast<size_t>(numQueries));
+    }
+    std::filesystem::remove(path);
+}
+
+// Both merge strategies produce the same docId-ordered union.
+TEST(PostingUnionTest, HeapAndAccumulatorAgree) {
+    std::vector<std::vector<Data>> few = {
+        {{5, 3}, {2, 1}},
+        {{4, 1}, {1, 7}},
+        {{9, 3}},
+    };
+    std::vector<Data> merged = union_postings(few);
+    ASSERT_EQ(merged.size(), 3u);
+    EXPECT_EQ(merged[0].docId, 1);
+    EXPECT_EQ(merged[0].priority, 6);
+    EXPECT_EQ(merged[1].docId, 3);
+    EXPECT_EQ(merged[1].priority, 14);
+    EXPECT_EQ(merged[2].docId, 7);
+
+    std::vector<std::vector<Data>> many;
+    for (int i = 0; i < 40; i++) {
+        many.push_back({{1, i}, {1, i + 1}, {1, 100}});
+    }
+    std::vector<std::vector<Data>> copy = many;
+    copy.resize(HEAP_UNION_MAX_LISTS); // force the heap path on a prefix
+    std::vector<Data> accumulated = union_postings(many);
+    ASSERT_EQ(accumulated.size(), 42u);
+    EXPECT_EQ(accumulated.front().docId, 0);
+    EXPECT_EQ(accumulated.back().docId, 100);
+    EXPECT_EQ(accumulated.back().priority, 40);
+    EXPECT_EQ(union_postings(copy).back().priority, static_cast<int>(HEAP_UNION_MAX_LISTS));
+
+    // Many short lists over a huge docId range take the heap path.
+    std::vector<std::vector<Data>> sparse;
+    for (int i = 0; i < 40; i++) {
+        sparse.push_back({{1, 2000000000 - i}, {2, i}});
+    }
+    std::vector<Data> spread = union_postings(sparse);
+    ASSERT_EQ(spread.size(), 80u);
+    EXPECT_EQ(spread.front().docId, 0);
+    EXPECT_EQ(spread.front().priority, 2);
+    EXPECT_EQ(spread.back().docId, 2000000000);
+
+    // Lists already ordered by docId are merged in place, either way.
+    for (std::vector<std::vector<Data>>* lists : {&many, &sparse}) {
+        std::vector<const std::vector<Data>*> refs;
+        for (const std::vector<Data>& list : *lists) {
+            refs.push_back(&list);
+        }
+        std::vector<Data> expected = union_postings(*lists);
+        std::vector<Data> merged_in_place = union_sorted_postings(refs);
+        ASSERT_EQ(merged_in_place.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); i++) {
+            EXPECT_EQ(merged_in_place[i].docId, expected[i].docId);
+            EXPECT_EQ(merged_in_place[i].priority, expected[i].priority);
+        }
+    }
+}
+
+// Performance test: union of a wildcard with thousands of expansions.
+TEST(PostingUnionTest, PerformanceTest_ManyLists) {
+    const int numLists = 2000;
+    std::vector<std::vector<Data>> lists(numLists);
+    for (int i = 0; i < numLists; i++) {
+        for (int j = 0; j < 50; j++) {
+            lists[i].push_back({j % 7 + 1, (i * 31 + j * 97) % 20000});
+        }
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<Data> merged = union_postings(lists);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+
+    std::cout << "PerformanceTest: Merged " << numLists << " posting lists into " << merged.size()
+              << " documents in " << elapsed.count() << " seconds" << std::endl;
+
+    EXPECT_FALSE(merged.empty());
+}
+
+}
@@ -0,0 +1,65 @@
+/**
+ * @file  build_completions.cc
+ * @brief Compiles the query log and dictionary into a completion trie image
+ *
+ * Logged queries are weighted by how often they were asked and rank above
+ * dictionary words, which are weighted by the document frequency of their
+ * stem; words whose stem is not in the index are left out.
+ *
+ * Usage: build_completions <query_log.txt> <dictionary.txt> <lexicon> <output.img>
+ */
+
+#include "index/Lexicon.h"
+#include "query-processing/completionTrie.h"
+#include "query-processing/query.h"
+#include "query-processing/stemmer.h"
+
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+
+int main(int argc, char** argv) {
+    if (argc != 5) {
+        std::cerr << "Usage: " << argv[0] << " <query_log.txt> <dictionary.txt> <lexicon> <output.img>"
+                  << std::endl;
+        return 1;
+    }
+
+    try {
+        std::ifstream log(argv[1]);
+        if (!log) {
+            std::cerr << "Error: Unable to open query log " << argv[1] << std::endl;
+            return 1;
+        }
+        completion::Completions completions;
+        size_t queries = 0;
+        for (std::string line; std::getline(log, line);) {
+            std::string query = completion::CompletionTrie::normalize(line);
+            if (!query.empty()) {
+                completions[query] += uint64_t(1) << 32;
+                queries++;
+            }
+        }
+
+        Lexicon lexicon(argv[3]);
+        size_t words = 0;
+        for (const std::string& word : query::loadDictionary(argv[2])) {
+            std::string normalized = completion::CompletionTrie::normalize(word);
+            std::optional<TermInfo> info = lexicon.find(stemmer::stem(normalized));
+            if (!normalized.empty() && info) {
+                completions[normalized] += info->df;
+                words++;
+            }
+        }
+
+        completion::CompletionTrie::build(completions, argv[4]);
+        completion::CompletionTrie trie(argv[4]);
+        std::cout << "Wrote " << trie.size() << " completions (" << queries << " logged queries, " << words
+                  << " dictionary words, " << trie.memoryUsage() << " bytes) to " << argv[4] << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
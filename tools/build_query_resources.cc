@@ -0,0 +1,29 @@
+/**
+ * @file  build_query_resources.cc
+ * @brief Compiles the dictionary and phrase files into a query resources image
+ *
+ * Usage: build_query_resources <dictionary.txt> <phrases.txt> <output.img>
+ */
+
+#include "query-processing/query.h"
+
+#include <iostream>
+
+int main(int argc, char** argv) {
+    if (argc != 4) {
+        std::cerr << "Usage: " << argv[0] << " <dictionary.txt> <phrases.txt> <output.img>" << std::endl;
+        return 1;
+    }
+
+    try {
+        query::Dictionary dictionary = query::loadDictionary(argv[1]);
+        queryTree::TermDictionary phrases = query::loadTermDictionary(argv[2]);
+        query::QueryResources::build(dictionary, phrases, argv[3]);
+        std::cout << "Wrote " << dictionary.size() << " words and " << phrases.size()
+                  << " phrases to " << argv[3] << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
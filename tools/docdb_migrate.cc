@@ -0,0 +1,28 @@
+/**
+ * @file  docdb_migrate.cc
+ * @brief Converts a legacy text-format document database to the binary format
+ *
+ * Usage: docdb_migrate <legacy_db_dir> <new_db_dir>
+ */
+
+#include "index/DocDatabase.h"
+
+#include <filesystem>
+#include <iostream>
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <legacy_db_dir> <new_db_dir>" << std::endl;
+        return 1;
+    }
+
+    try {
+        std::filesystem::create_directories(argv[2]);
+        size_t migrated = DocDatabase::migrateLegacy(argv[1], argv[2]);
+        std::cout << "Migrated " << migrated << " documents to " << argv[2] << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
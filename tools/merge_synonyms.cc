@@ -0,0 +1,53 @@
+/**
+ * @file  merge_synonyms.cc
+ * @brief Pre-merges the posting lists of the most queried synonym groups
+ *
+ * Writes the merged lists into the inverted index and rebuilds its lexicon
+ * so that queries find them. The lists do not follow later writes to the
+ * index, so run this after every ingest.
+ *
+ * Usage: merge_synonyms <index_db_dir> <synonyms.txt> <query_log.txt> <group_count> <lexicon_out>
+ */
+
+#include "Database.h"
+#include "index/Lexicon.h"
+#include "query-processing/synonyms.h"
+#include "search/SynonymPostings.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    if (argc != 6) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <index_db_dir> <synonyms.txt> <query_log.txt> <group_count> <lexicon_out>" << std::endl;
+        return 1;
+    }
+
+    try {
+        synonyms::SynonymDictionary dictionary = synonyms::SynonymDictionary::load(argv[2]);
+
+        std::ifstream log(argv[3]);
+        if (!log) {
+            std::cerr << "Error: Unable to open query log " << argv[3] << std::endl;
+            return 1;
+        }
+        std::vector<std::string> queries;
+        for (std::string line; std::getline(log, line);) {
+            queries.push_back(line);
+        }
+
+        std::vector<uint32_t> groups = dictionary.mostQueried(queries, std::stoul(argv[4]));
+        Database db(argv[1]);
+        size_t postings = Ranking::merge_synonym_postings(db, dictionary, groups);
+        Lexicon::build(db, argv[5]);
+        std::cout << "Merged " << groups.size() << " of " << dictionary.size() << " synonym groups ("
+                  << postings << " postings) into " << argv[1] << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}